@@ -0,0 +1,270 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "LogonClient.h"
+#include "ByteBuffer.h"
+#include "Auth/BigNumber.h"
+#include "Auth/Sha1.h"
+
+#include <ace/SOCK_Connector.h>
+#include <ace/INET_Addr.h>
+
+#include <cstring>
+
+static int const CONNECT_TIMEOUT = 10;                      // Seconds
+static int const RESPONSE_TIMEOUT = 30;
+
+static uint8 const CMD_AUTH_LOGON_CHALLENGE = 0x00;
+static uint8 const CMD_AUTH_LOGON_PROOF = 0x01;
+static uint8 const CMD_REALM_LIST = 0x10;
+
+static uint16 const CLIENT_BUILD = 5875;                    // 1.12.1
+
+LogonStep LogonClient::Logon(std::string const& account)
+{
+    m_error.clear();
+    m_result = 0;
+
+    ACE_INET_Addr address(m_port, m_host.c_str());
+    ACE_SOCK_Connector connector;
+    ACE_SOCK_Stream socket;
+    ACE_Time_Value timeout(CONNECT_TIMEOUT);
+    if (connector.connect(socket, address, &timeout) == -1)
+    {
+        Fail("cannot connect to " + m_host + ":" + std::to_string(m_port));
+        return LOGON_STEP_CONNECT;
+    }
+
+    int noDelay = 1;
+    socket.set_option(ACE_IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+    LogonStep step = LOGON_STEP_CHALLENGE;
+    do
+    {
+        // sAuthLogonChallenge_C, the strings of the client are reversed
+        ByteBuffer challenge;
+        challenge << CMD_AUTH_LOGON_CHALLENGE;
+        challenge << uint8(3);
+        challenge << uint16(0);                             // size, set below
+        challenge.append("WoW", 4);
+        challenge << uint8(1) << uint8(12) << uint8(1);
+        challenge << CLIENT_BUILD;
+        challenge.append("68x", 4);                         // x86
+        challenge.append("niW", 4);                         // Win
+        challenge.append("SUne", 4);                        // enUS
+        challenge << uint32(0);                             // timezone_bias
+        challenge << uint32(0x0100007F);                    // ip
+        challenge << uint8(account.size());
+        challenge.append(account.c_str(), account.size());
+        challenge.put<uint16>(2, uint16(challenge.size() - 4));
+
+        if (socket.send_n(challenge.contents(), challenge.size()) != ssize_t(challenge.size()))
+        {
+            Fail("connection lost");
+            break;
+        }
+
+        uint8 header[3];                                    // cmd, 0, result
+        if (!Receive(socket, header, sizeof(header)))
+            break;
+        if (header[2] != 0)
+        {
+            Fail("logon challenge refused", header[2]);
+            break;
+        }
+
+        uint8 B_bytes[32], N_bytes[32], s_bytes[32], versionChallenge[16];
+        uint8 g_len, N_len, securityFlags;
+        if (!Receive(socket, B_bytes, sizeof(B_bytes)) || !Receive(socket, &g_len, 1) || g_len != 1)
+            break;
+        uint8 g_byte;
+        if (!Receive(socket, &g_byte, 1) || !Receive(socket, &N_len, 1) || N_len != 32 ||
+            !Receive(socket, N_bytes, sizeof(N_bytes)) || !Receive(socket, s_bytes, sizeof(s_bytes)) ||
+            !Receive(socket, versionChallenge, sizeof(versionChallenge)) || !Receive(socket, &securityFlags, 1))
+            break;
+
+        if (securityFlags)
+        {
+            Fail("the account asks for a PIN");
+            break;
+        }
+
+        step = LOGON_STEP_PROOF;
+
+        BigNumber N, g, s, B;
+        N.SetBinary(N_bytes, sizeof(N_bytes));
+        g.SetBinary(&g_byte, 1);
+        s.SetBinary(s_bytes, sizeof(s_bytes));
+        B.SetBinary(B_bytes, sizeof(B_bytes));
+
+        BigNumber a;
+        a.SetRand(19 * 8);
+        BigNumber A = g.ModExp(a, N);
+
+        Sha1Hash sha;
+        sha.UpdateBigNumbers(&A, &B, nullptr);
+        sha.Finalize();
+        BigNumber u;
+        u.SetBinary(sha.GetDigest(), 20);
+
+        // x = H(s, H(I:P)), the password is the account name
+        sha.Initialize();
+        sha.UpdateData(account);
+        sha.UpdateData(":");
+        sha.UpdateData(account);
+        sha.Finalize();
+        uint8 credentials[20];
+        memcpy(credentials, sha.GetDigest(), 20);
+
+        sha.Initialize();
+        sha.UpdateData(s.AsByteArray().data(), s.GetNumBytes());
+        sha.UpdateData(credentials, 20);
+        sha.Finalize();
+        BigNumber x;
+        x.SetBinary(sha.GetDigest(), 20);
+
+        // S = (B - 3 g^x) ^ (a + u x), 3 g^x % N is below 3 N
+        BigNumber gx = g.ModExp(x, N);
+        BigNumber base = (B + N * 3 - gx * 3) % N;
+        BigNumber S = base.ModExp(a + u * x, N);
+
+        // K, as SRP6::HashSessionKey
+        std::vector<uint8> S_bytes = S.AsByteArray(32);
+        uint8 half[16];
+        uint8 K_bytes[40];
+        for (int i = 0; i < 16; ++i)
+            half[i] = S_bytes[i * 2];
+        sha.Initialize();
+        sha.UpdateData(half, 16);
+        sha.Finalize();
+        for (int i = 0; i < 20; ++i)
+            K_bytes[i * 2] = sha.GetDigest()[i];
+        for (int i = 0; i < 16; ++i)
+            half[i] = S_bytes[i * 2 + 1];
+        sha.Initialize();
+        sha.UpdateData(half, 16);
+        sha.Finalize();
+        for (int i = 0; i < 20; ++i)
+            K_bytes[i * 2 + 1] = sha.GetDigest()[i];
+        BigNumber K;
+        K.SetBinary(K_bytes, 40);
+
+        // M1 = H(H(N) xor H(g), H(I), s, A, B, K), as SRP6::CalculateProof
+        uint8 hash[20];
+        sha.Initialize();
+        sha.UpdateBigNumbers(&N, nullptr);
+        sha.Finalize();
+        memcpy(hash, sha.GetDigest(), 20);
+        sha.Initialize();
+        sha.UpdateBigNumbers(&g, nullptr);
+        sha.Finalize();
+        for (int i = 0; i < 20; ++i)
+            hash[i] ^= sha.GetDigest()[i];
+        BigNumber Ng;
+        Ng.SetBinary(hash, 20);
+
+        sha.Initialize();
+        sha.UpdateData(account);
+        sha.Finalize();
+        uint8 I_hash[20];
+        memcpy(I_hash, sha.GetDigest(), 20);
+
+        sha.Initialize();
+        sha.UpdateBigNumbers(&Ng, nullptr);
+        sha.UpdateData(I_hash, 20);
+        sha.UpdateBigNumbers(&s, &A, &B, &K, nullptr);
+        sha.Finalize();
+        BigNumber M1;
+        M1.SetBinary(sha.GetDigest(), 20);
+
+        // sAuthLogonProof_C_1_11, without version proof (StrictVersionCheck 0)
+        ByteBuffer proof;
+        proof << CMD_AUTH_LOGON_PROOF;
+        proof.append(A.AsByteArray(32).data(), 32);
+        proof.append(M1.AsByteArray(20).data(), 20);
+        uint8 const crc[20] = {};
+        proof.append(crc, sizeof(crc));
+        proof << uint8(0);                                  // number_of_keys
+        proof << uint8(0);                                  // securityFlags
+
+        if (socket.send_n(proof.contents(), proof.size()) != ssize_t(proof.size()))
+        {
+            Fail("connection lost");
+            break;
+        }
+
+        uint8 proofHeader[2];                               // cmd, error
+        if (!Receive(socket, proofHeader, sizeof(proofHeader)))
+            break;
+        if (proofHeader[1] != 0)
+        {
+            Fail("logon proof refused", proofHeader[1]);
+            break;
+        }
+
+        uint8 M2[20];
+        uint32 surveyId;
+        if (!Receive(socket, M2, sizeof(M2)) || !Receive(socket, &surveyId, sizeof(surveyId)))
+            break;
+
+        sha.Initialize();
+        sha.UpdateBigNumbers(&A, &M1, &K, nullptr);
+        sha.Finalize();
+        if (memcmp(M2, sha.GetDigest(), sizeof(M2)) != 0)
+        {
+            Fail("wrong server proof");
+            break;
+        }
+
+        step = LOGON_STEP_REALM_LIST;
+
+        uint8 const realmList[5] = { CMD_REALM_LIST, 0, 0, 0, 0 };
+        if (socket.send_n(realmList, sizeof(realmList)) != ssize_t(sizeof(realmList)))
+        {
+            Fail("connection lost");
+            break;
+        }
+
+        uint8 realmListHeader[3];                           // cmd, size
+        if (!Receive(socket, realmListHeader, sizeof(realmListHeader)))
+            break;
+
+        std::vector<uint8> realms(realmListHeader[1] | (realmListHeader[2] << 8));
+        if (!realms.empty() && !Receive(socket, realms.data(), realms.size()))
+            break;
+
+        step = LOGON_STEP_DONE;
+    } while (false);
+
+    socket.close();
+    return step;
+}
+
+bool LogonClient::Receive(ACE_SOCK_Stream& socket, void* data, size_t size)
+{
+    ACE_Time_Value timeout(RESPONSE_TIMEOUT);
+    if (socket.recv_n(data, size, &timeout) == ssize_t(size))
+        return true;
+
+    return Fail(errno == ETIME ? "no response" : "connection closed by realmd");
+}
+
+bool LogonClient::Fail(std::string const& error, uint8 result)
+{
+    m_error = error;
+    m_result = result;
+    return false;
+}
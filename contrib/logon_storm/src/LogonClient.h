@@ -0,0 +1,64 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef _LOGON_CLIENT_H
+#define _LOGON_CLIENT_H
+
+#include "Common.h"
+
+#include <ace/SOCK_Stream.h>
+
+#include <string>
+
+enum LogonStep
+{
+    LOGON_STEP_CONNECT,
+    LOGON_STEP_CHALLENGE,
+    LOGON_STEP_PROOF,
+    LOGON_STEP_REALM_LIST,
+    LOGON_STEP_DONE,
+};
+
+/**
+ * @brief Client side of a realmd logon, as sent by a 1.12.1 client: logon
+ * challenge, SRP6 proof of the password and realm list request, on a new
+ * connection each time. Blocking, one client per thread.
+ * The password of the account is its name, as created by LoginStandIn.
+ */
+class LogonClient
+{
+    public:
+        LogonClient(std::string const& host, uint16 port) : m_host(host), m_port(port) {}
+
+        // Returns the step the logon stopped at, LOGON_STEP_DONE on success
+        LogonStep Logon(std::string const& account);
+
+        std::string const& GetError() const { return m_error; }
+        // realmd answer to the failed step, 0 when the connection failed
+        uint8 GetResult() const { return m_result; }
+
+    private:
+        bool Receive(ACE_SOCK_Stream& socket, void* data, size_t size);
+        bool Fail(std::string const& error, uint8 result = 0);
+
+        std::string m_host;
+        uint16 m_port;
+        std::string m_error;
+        uint8 m_result = 0;
+};
+
+#endif
@@ -0,0 +1,256 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/*
+ * Logs many clients in realmd at once, as after the restart of a realm, and
+ * reports the logons per second and their latency. See the readme file.
+ */
+
+#include "Common.h"
+#include "Database/DatabaseEnv.h"
+#include "Config/Config.h"
+#include "LatencyHistogram.h"
+#include "LoginStandIn.h"
+#include "LogonClient.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+DatabaseType LoginDatabase;
+DatabaseType CharacterDatabase;
+
+struct Arguments
+{
+    std::string config = "realmd.conf";
+    std::string loginDatabase;
+    std::string host = "127.0.0.1";
+    uint16 port = 3724;
+    std::string prefix = "STORM";
+    uint32 clients = 100;
+    uint32 accounts = 0;                                    // 0: one per client
+    uint32 duration = 30;
+    uint32 reportInterval = 1;
+};
+
+// Counters of all the clients, sampled by the report
+struct StormStats
+{
+    std::atomic<uint32> logons{0};
+    std::atomic<uint32> failed[LOGON_STEP_DONE] = {};
+    LatencyHistogram logonTime;                             // Microseconds from the connection to the realm list
+    LatencyHistogram intervalLogonTime;
+
+    std::mutex errorLock;
+    std::string lastError;
+};
+
+static char const* const StepNames[LOGON_STEP_DONE] = { "connect", "challenge", "proof", "realm list" };
+
+void printUsage()
+{
+    printf("Usage: logon_storm [options]\n\n");
+    printf("--clients [#] : Clients logging in at the same time, each on its own thread (default 100)\n");
+    printf("--accounts [#] : Accounts the clients log in, 0 for one per client (default 0)\n");
+    printf("--duration [#] : Seconds to run (default 30)\n");
+    printf("--config [file] : realmd.conf giving the login database and the port (default realmd.conf)\n");
+    printf("--logindb [info] : \"host;port;user;password;database\", overrides the config\n");
+    printf("--host [address] --port [#] : realmd to connect to (default 127.0.0.1 and RealmServerPort)\n");
+    printf("--prefix [name] : Prefix of the synthetic account names (default STORM)\n");
+    printf("--interval [#] : Seconds between two lines of the report (default 1)\n");
+}
+
+bool handleArgs(int argc, char** argv, Arguments& args, bool& portGiven)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if ((strcmp(argv[i], "-?") == 0) || (strcmp(argv[i], "/?") == 0) || (strcmp(argv[i], "-h") == 0))
+            return false;
+
+        char const* param = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!param)
+        {
+            printf("missing value of %s\n", argv[i]);
+            return false;
+        }
+        ++i;
+
+        if (strcmp(argv[i - 1], "--clients") == 0)
+            args.clients = atoi(param);
+        else if (strcmp(argv[i - 1], "--accounts") == 0)
+            args.accounts = atoi(param);
+        else if (strcmp(argv[i - 1], "--duration") == 0)
+            args.duration = atoi(param);
+        else if (strcmp(argv[i - 1], "--config") == 0)
+            args.config = param;
+        else if (strcmp(argv[i - 1], "--logindb") == 0)
+            args.loginDatabase = param;
+        else if (strcmp(argv[i - 1], "--host") == 0)
+            args.host = param;
+        else if (strcmp(argv[i - 1], "--port") == 0)
+        {
+            args.port = uint16(atoi(param));
+            portGiven = true;
+        }
+        else if (strcmp(argv[i - 1], "--prefix") == 0)
+            args.prefix = param;
+        else if (strcmp(argv[i - 1], "--interval") == 0)
+            args.reportInterval = std::max(1, atoi(param));
+        else
+        {
+            printf("unknown option %s\n", argv[i - 1]);
+            return false;
+        }
+    }
+
+    if (!args.clients || !args.duration)
+        return false;
+
+    return true;
+}
+
+void runClient(Arguments const& args, std::vector<std::string> const& accounts, uint32 first, StormStats& stats, std::atomic<bool> const& stop)
+{
+    LogonClient client(args.host, args.port);
+    for (uint32 i = first; !stop; i += args.clients)
+    {
+        std::string const& account = accounts[i % accounts.size()];
+
+        std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+        LogonStep const step = client.Logon(account);
+        uint32 const elapsedUs = uint32(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+
+        if (step == LOGON_STEP_DONE)
+        {
+            ++stats.logons;
+            stats.logonTime.Record(elapsedUs);
+            stats.intervalLogonTime.Record(elapsedUs);
+            continue;
+        }
+
+        ++stats.failed[step];
+        {
+            std::lock_guard<std::mutex> lock(stats.errorLock);
+            stats.lastError = account + ": " + StepNames[step] + ", " + client.GetError() + " (" + std::to_string(client.GetResult()) + ")";
+        }
+
+        // Do not spin on a realmd that is down
+        if (step == LOGON_STEP_CONNECT)
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Arguments args;
+    bool portGiven = false;
+    if (!handleArgs(argc, argv, args, portGiven))
+    {
+        printUsage();
+        return 1;
+    }
+
+    bool const hasConfig = sConfig.SetSource(args.config.c_str());
+    if (args.loginDatabase.empty())
+        args.loginDatabase = hasConfig ? sConfig.GetStringDefault("LoginDatabaseInfo", "") : "";
+    if (hasConfig && !portGiven)
+        args.port = uint16(sConfig.GetIntDefault("RealmServerPort", args.port));
+
+    if (args.loginDatabase.empty())
+    {
+        printf("Database not specified, give a realmd.conf with --config or use --logindb\n");
+        return 1;
+    }
+
+    if (!LoginDatabase.Initialize(args.loginDatabase.c_str()))
+    {
+        printf("Cannot connect to the login database\n");
+        return 1;
+    }
+
+    uint32 const accountCount = args.accounts ? args.accounts : args.clients;
+    std::vector<std::string> accounts;
+    accounts.reserve(accountCount);
+
+    // Only used for the accounts, the realm id is not needed
+    LoginStandIn standIn("127.0.0.1", 0);
+    for (uint32 i = 0; i < accountCount; ++i)
+    {
+        char account[32];
+        snprintf(account, sizeof(account), "%s%05u", args.prefix.c_str(), i);
+        if (!standIn.PrepareAccount(account, 0))
+        {
+            printf("Cannot prepare the account %s\n", account);
+            return 1;
+        }
+        accounts.push_back(account);
+    }
+
+    printf("Logging %u clients in %s:%u with %u accounts for %u s\n", args.clients, args.host.c_str(), args.port, accountCount, args.duration);
+
+    StormStats stats;
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> threads;
+    for (uint32 i = 0; i < args.clients; ++i)
+        threads.emplace_back(runClient, std::cref(args), std::cref(accounts), i, std::ref(stats), std::cref(stop));
+
+    std::chrono::steady_clock::time_point const startTime = std::chrono::steady_clock::now();
+    uint32 lastLogons = 0;
+    uint32 elapsed = 0;
+
+    while (elapsed < args.duration)
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(args.reportInterval));
+        elapsed = uint32(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - startTime).count());
+
+        uint32 const logons = stats.logons;
+        uint32 failed = 0;
+        for (auto const& count : stats.failed)
+            failed += count;
+
+        LatencyHistogram::Summary const interval = stats.intervalLogonTime.GetSummary();
+        stats.intervalLogonTime.Reset();
+
+        printf("%5us | %7.1f logons/s | failed %6u | latency p50 %7.1f ms p99 %7.1f ms max %7.1f ms\n", elapsed,
+               (logons - lastLogons) / double(args.reportInterval), failed, interval.p50 / 1000.0, interval.p99 / 1000.0, interval.max / 1000.0);
+        lastLogons = logons;
+    }
+
+    stop = true;
+    for (auto& thread : threads)
+        thread.join();
+
+    double const totalTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    LatencyHistogram::Summary const total = stats.logonTime.GetSummary();
+
+    printf("\n%u logons in %.1f s, %.1f logons/s\n", stats.logons.load(), totalTime, stats.logons / totalTime);
+    printf("Latency: mean %.1f ms, p50 %.1f ms, p99 %.1f ms, max %.1f ms\n", total.mean / 1000.0, total.p50 / 1000.0,
+           total.p99 / 1000.0, total.max / 1000.0);
+    for (uint32 step = 0; step < LOGON_STEP_DONE; ++step)
+        if (stats.failed[step])
+            printf("Failed at %s: %u\n", StepNames[step], stats.failed[step].load());
+    if (!stats.lastError.empty())
+        printf("Last error: %s\n", stats.lastError.c_str());
+
+    return 0;
+}
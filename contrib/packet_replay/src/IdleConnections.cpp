@@ -0,0 +1,89 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "IdleConnections.h"
+
+#include <ace/SOCK_Connector.h>
+#include <ace/INET_Addr.h>
+
+#include <cerrno>
+
+static int const CONNECT_TIMEOUT = 10;                      // Seconds
+
+IdleConnections::IdleConnections(std::string const& host, uint16 port) : m_host(host), m_port(port)
+{
+}
+
+IdleConnections::~IdleConnections()
+{
+    Close();
+}
+
+uint32 IdleConnections::Open(uint32 count)
+{
+    ACE_INET_Addr address(m_port, m_host.c_str());
+    ACE_SOCK_Connector connector;
+
+    uint32 opened = 0;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        std::unique_ptr<ACE_SOCK_Stream> socket(new ACE_SOCK_Stream());
+        ACE_Time_Value timeout(CONNECT_TIMEOUT);
+        if (connector.connect(*socket, address, &timeout) == -1)
+            continue;
+
+        m_sockets.push_back(std::move(socket));
+        ++opened;
+    }
+
+    return opened;
+}
+
+uint32 IdleConnections::Poll()
+{
+    uint32 open = 0;
+    for (auto& socket : m_sockets)
+    {
+        if (!socket)
+            continue;
+
+        uint8 buffer[256];
+        ACE_Time_Value const timeout(0);
+        ssize_t received;
+        while ((received = socket->recv(buffer, sizeof(buffer), &timeout)) > 0)
+            ;
+
+        if (received < 0 && errno == ETIME)
+        {
+            ++open;
+            continue;
+        }
+
+        // Closed by mangosd
+        socket->close();
+        socket.reset();
+    }
+
+    return open;
+}
+
+void IdleConnections::Close()
+{
+    for (auto& socket : m_sockets)
+        if (socket)
+            socket->close();
+    m_sockets.clear();
+}
@@ -0,0 +1,55 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _IDLE_CONNECTIONS_H
+#define _IDLE_CONNECTIONS_H
+
+#include "Common.h"
+
+#include <ace/SOCK_Stream.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Connections to mangosd that never authenticate, opened next to the
+ * replay sessions to measure the network threads with many mostly quiet
+ * sockets (a crowded realm has far more connected players than active ones).
+ * The server only sends them its SMSG_AUTH_CHALLENGE, which is read and
+ * dropped.
+ */
+class IdleConnections
+{
+    public:
+        IdleConnections(std::string const& host, uint16 port);
+        ~IdleConnections();
+
+        // Returns the number of connections opened
+        uint32 Open(uint32 count);
+
+        // Reads what mangosd sent, and returns the connections still open
+        uint32 Poll();
+
+        void Close();
+
+    private:
+        std::string m_host;
+        uint16 m_port;
+        std::vector<std::unique_ptr<ACE_SOCK_Stream>> m_sockets;
+};
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "LoginStandIn.h"
+#include "Database/DatabaseEnv.h"
+#include "SRP6/SRP6.h"
+#include "Auth/Sha1.h"
+#include "Util.h"
+
+#include <openssl/crypto.h>
+
+uint32 LoginStandIn::PrepareAccount(std::string const& name, uint8 gmLevel)
+{
+    uint32 accountId = 0;
+    if (QueryResult* result = LoginDatabase.PQuery("SELECT `id` FROM `account` WHERE `username` = '%s'", name.c_str()))
+    {
+        accountId = result->Fetch()[0].GetUInt32();
+        delete result;
+    }
+    else
+    {
+        // Same verifier as AccountMgr::CreateAccount, the password is the account name
+        Sha1Hash sha;
+        sha.Initialize();
+        sha.UpdateData(name);
+        sha.UpdateData(":");
+        sha.UpdateData(name);
+        sha.Finalize();
+
+        std::string shaPassHash;
+        hexEncodeByteArray(sha.GetDigest(), sha.GetLength(), shaPassHash);
+
+        SRP6 srp;
+        srp.CalculateVerifier(shaPassHash);
+        char const* s_hex = srp.GetSalt().AsHexStr();
+        char const* v_hex = srp.GetVerifier().AsHexStr();
+
+        bool const created = LoginDatabase.DirectPExecute("INSERT INTO `account` (`username`, `v`, `s`, `joindate`) VALUES ('%s', '%s', '%s', NOW())",
+                                                          name.c_str(), v_hex, s_hex);
+
+        OPENSSL_free((void*)s_hex);
+        OPENSSL_free((void*)v_hex);
+
+        if (!created)
+            return 0;
+
+        LoginDatabase.DirectExecute("REPLACE INTO `realmcharacters` (`realmid`, `acctid`, `numchars`) SELECT `realmlist`.`id`, `account`.`id`, 0 FROM `realmlist`,`account` LEFT JOIN `realmcharacters` ON `acctid`=`account`.`id` WHERE `acctid` IS NULL");
+
+        if (QueryResult* result = LoginDatabase.PQuery("SELECT `id` FROM `account` WHERE `username` = '%s'", name.c_str()))
+        {
+            accountId = result->Fetch()[0].GetUInt32();
+            delete result;
+        }
+    }
+
+    if (accountId && gmLevel)
+        LoginDatabase.DirectPExecute("INSERT INTO `account_access` (`id`, `gmlevel`, `RealmID`) VALUES ('%u', '%u', '%u') "
+                                     "ON DUPLICATE KEY UPDATE `gmlevel` = GREATEST(`gmlevel`, VALUES(`gmlevel`))", accountId, gmLevel, m_realmId);
+
+    return accountId;
+}
+
+bool LoginStandIn::StartSession(std::string const& name, BigNumber& sessionKey)
+{
+    // K is the 40 bytes hash of the SRP6 session key
+    sessionKey.SetRand(40 * 8);
+    char const* K_hex = sessionKey.AsHexStr();
+
+    // As AuthSocket::_HandleLogonProof
+    bool const updated = LoginDatabase.DirectPExecute("UPDATE `account` SET `sessionkey` = '%s', `last_ip` = '%s', `last_login` = NOW(), `locale` = '0', `failed_logins` = 0, `os` = 'Win', `platform` = 'x86' WHERE `username` = '%s'",
+                                                      K_hex, m_address.c_str(), name.c_str());
+
+    OPENSSL_free((void*)K_hex);
+    return updated;
+}
+
+bool LoginStandIn::PlaceCharacter(uint32 guid, uint32 mapId, float x, float y, float z, float o)
+{
+    return CharacterDatabase.DirectPExecute("UPDATE `characters` SET `map` = '%u', `position_x` = '%f', `position_y` = '%f', `position_z` = '%f', `orientation` = '%f', `transport_guid` = 0 WHERE `guid` = '%u' AND `online` = 0",
+                                            mapId, x, y, z, o, guid);
+}
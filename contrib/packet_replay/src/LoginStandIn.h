@@ -0,0 +1,53 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef _LOGIN_STAND_IN_H
+#define _LOGIN_STAND_IN_H
+
+#include "Common.h"
+#include "Auth/BigNumber.h"
+
+#include <string>
+
+/**
+ * @brief Stands in for realmd for the synthetic sessions.
+ * Does what realmd leaves in the realmd database after a successful SRP6 logon
+ * (session key, address, last login time, os and platform), which is all
+ * mangosd checks in WorldSocket::HandleAuthSession. The accounts are created
+ * on first use, with their name as password so that they can also be logged
+ * in with a real client.
+ * Also places the characters on the map of the capture while they are
+ * offline, through the characters database.
+ */
+class LoginStandIn
+{
+    public:
+        LoginStandIn(std::string const& address, uint32 realmId) : m_address(address), m_realmId(realmId) {}
+
+        // Returns the id of the account, 0 on error. gmLevel is only raised, never lowered.
+        uint32 PrepareAccount(std::string const& name, uint8 gmLevel);
+        // New session key of the account, valid for a day
+        bool StartSession(std::string const& name, BigNumber& sessionKey);
+
+        bool PlaceCharacter(uint32 guid, uint32 mapId, float x, float y, float z, float o);
+
+    private:
+        std::string m_address;                              // Address mangosd sees the sessions connect from
+        uint32 m_realmId;
+};
+
+#endif
@@ -0,0 +1,184 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "ReplayCapture.h"
+#include "SniffFile.h"
+
+#include <cstring>
+
+bool ReplayCapture::IsMovementOpcode(uint16 opcode)
+{
+    switch (opcode)
+    {
+        case MSG_MOVE_START_FORWARD:
+        case MSG_MOVE_START_BACKWARD:
+        case MSG_MOVE_STOP:
+        case MSG_MOVE_START_STRAFE_LEFT:
+        case MSG_MOVE_START_STRAFE_RIGHT:
+        case MSG_MOVE_STOP_STRAFE:
+        case MSG_MOVE_JUMP:
+        case MSG_MOVE_START_TURN_LEFT:
+        case MSG_MOVE_START_TURN_RIGHT:
+        case MSG_MOVE_STOP_TURN:
+        case MSG_MOVE_START_PITCH_UP:
+        case MSG_MOVE_START_PITCH_DOWN:
+        case MSG_MOVE_STOP_PITCH:
+        case MSG_MOVE_SET_RUN_MODE:
+        case MSG_MOVE_SET_WALK_MODE:
+        case MSG_MOVE_FALL_LAND:
+        case MSG_MOVE_START_SWIM:
+        case MSG_MOVE_STOP_SWIM:
+        case MSG_MOVE_SET_FACING:
+        case MSG_MOVE_SET_PITCH:
+        case MSG_MOVE_HEARTBEAT:
+        case CMSG_MOVE_FALL_RESET:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void ReplayCapture::GetStartPosition(float& x, float& y, float& z, float& o) const
+{
+    x = m_startPosition[0];
+    y = m_startPosition[1];
+    z = m_startPosition[2];
+    o = m_startPosition[3];
+}
+
+bool ReplayCapture::Load(char const* fileName, uint64 playerGuid, std::string& error)
+{
+    m_playerGuid = playerGuid;
+
+    SniffFileReader reader(fileName);
+    if (!reader.IsOpen())
+    {
+        error = "cannot open the file";
+        return false;
+    }
+
+    uint16 gameBuild;
+    if (!reader.ReadHeader(gameBuild))
+    {
+        error = "not a packet log";
+        return false;
+    }
+    if (gameBuild != SUPPORTED_CLIENT_BUILD)
+    {
+        error = "packet log of client build " + std::to_string(gameBuild);
+        return false;
+    }
+
+    WorldPacket packet;
+    bool isClientPacket;
+    uint32 unixTime;
+    bool first = true;
+    bool useUnixTime = false;
+    uint32 firstTime = 0;
+    uint32 currentMap = 0;
+    bool hasCurrentMap = false;
+
+    while (reader.ReadPacket(packet, isClientPacket, unixTime))
+    {
+        uint16 const opcode = packet.GetOpcode();
+        if (!isClientPacket)
+        {
+            if ((opcode == SMSG_LOGIN_VERIFY_WORLD || opcode == SMSG_NEW_WORLD) && packet.size() >= 4)
+            {
+                currentMap = packet.read<uint32>(0);
+                hasCurrentMap = true;
+            }
+            continue;
+        }
+
+        if (opcode == MSG_MOVE_WORLDPORT_ACK)
+            break;
+
+        switch (opcode)
+        {
+            case CMSG_PLAYER_LOGIN:
+                if (packet.size() >= 8)
+                    m_playerGuid = packet.read<uint64>(0);
+                continue;
+            case CMSG_AUTH_SESSION:
+            case CMSG_CHAR_ENUM:
+            case CMSG_CHAR_CREATE:
+            case CMSG_CHAR_DELETE:
+            case CMSG_CHAR_RENAME:
+            case CMSG_LOGOUT_REQUEST:
+            case CMSG_LOGOUT_CANCEL:
+            case CMSG_PLAYER_LOGOUT:
+            case MSG_MOVE_TELEPORT_ACK:
+                continue;
+            default:
+                break;
+        }
+
+        bool const movement = IsMovementOpcode(opcode);
+        // MovementInfo: flags, time, x, y, z, o
+        if (movement && packet.size() < 24)
+            continue;
+
+        if (movement && !m_hasStartPosition)
+        {
+            for (int i = 0; i < 4; ++i)
+                m_startPosition[i] = packet.read<float>(8 + i * 4);
+            m_hasStartPosition = true;
+            m_hasStartMap = hasCurrentMap;
+            m_startMap = currentMap;
+        }
+
+        // Old logs of sessions without a ms time are replayed at a one second resolution
+        if (first)
+        {
+            useUnixTime = !packet.GetPacketTime();
+            firstTime = useUnixTime ? unixTime : packet.GetPacketTime();
+            first = false;
+        }
+
+        ReplayPacket replayPacket;
+        replayPacket.time = useUnixTime ? uint64(unixTime - firstTime) * IN_MILLISECONDS : uint64(packet.GetPacketTime() - firstTime);
+        replayPacket.movement = movement;
+        if (!m_packets.empty() && replayPacket.time < m_packets.back().time)
+            replayPacket.time = m_packets.back().time;
+        replayPacket.packet = std::move(packet);
+        packet = WorldPacket();
+        m_packets.push_back(std::move(replayPacket));
+    }
+
+    // The guid is only known once the whole log is read, CMSG_PLAYER_LOGIN being optional
+    if (m_playerGuid)
+    {
+        for (ReplayPacket& replayPacket : m_packets)
+        {
+            WorldPacket const& data = replayPacket.packet;
+            for (uint32 offset = 0; offset + 8 <= data.size(); ++offset)
+            {
+                if (!memcmp(data.contents() + offset, &m_playerGuid, 8))
+                    replayPacket.guidOffsets.push_back(offset);
+            }
+        }
+    }
+
+    if (m_packets.empty())
+    {
+        error = "no client packet to replay";
+        return false;
+    }
+
+    return true;
+}
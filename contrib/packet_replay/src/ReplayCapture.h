@@ -0,0 +1,79 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef _REPLAY_CAPTURE_H
+#define _REPLAY_CAPTURE_H
+
+#include "Common.h"
+#include "WorldPacket.h"
+
+#if SUPPORTED_CLIENT_BUILD > CLIENT_BUILD_1_8_4
+#include "Opcodes_1_12_1.h"
+#else
+#include "Opcodes_1_8_0.h"
+#endif
+
+#include <string>
+#include <vector>
+
+struct ReplayPacket
+{
+    uint64 time;                                            // Milliseconds since the first replayed packet
+    WorldPacket packet;
+    bool movement;                                          // Starts with a MovementInfo (MSG_MOVE_*)
+    std::vector<uint32> guidOffsets;                        // Where the recorded player guid is written
+};
+
+/**
+ * @brief Client packets of a packet log (SniffFile) to replay once a synthetic
+ * character is in world.
+ * The authentication and character screen packets are left out, the
+ * synthetic sessions send their own. The capture stops at the first far
+ * teleport (MSG_MOVE_WORLDPORT_ACK): the packets past it were sent on another
+ * map than the one the characters are placed on.
+ */
+class ReplayCapture
+{
+    public:
+        // playerGuid is used when the log started in world, without the CMSG_PLAYER_LOGIN of the player
+        bool Load(char const* fileName, uint64 playerGuid, std::string& error);
+
+        std::vector<ReplayPacket> const& GetPackets() const { return m_packets; }
+        uint64 GetDuration() const { return m_packets.empty() ? 0 : m_packets.back().time; }
+
+        // Guid of the recorded player, from its CMSG_PLAYER_LOGIN (0 if the log started in world)
+        uint64 GetPlayerGuid() const { return m_playerGuid; }
+
+        // Map of the last SMSG_LOGIN_VERIFY_WORLD or SMSG_NEW_WORLD before the first movement
+        bool HasStartMap() const { return m_hasStartMap; }
+        uint32 GetStartMap() const { return m_startMap; }
+        // Position of the first movement packet
+        bool HasStartPosition() const { return m_hasStartPosition; }
+        void GetStartPosition(float& x, float& y, float& z, float& o) const;
+
+        static bool IsMovementOpcode(uint16 opcode);
+
+    private:
+        std::vector<ReplayPacket> m_packets;
+        uint64 m_playerGuid = 0;
+        bool m_hasStartMap = false;
+        uint32 m_startMap = 0;
+        bool m_hasStartPosition = false;
+        float m_startPosition[4] = {};
+};
+
+#endif
@@ -0,0 +1,479 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "ReplaySession.h"
+#include "ReplayCapture.h"
+#include "Auth/Sha1.h"
+
+#include <ace/SOCK_Connector.h>
+#include <ace/INET_Addr.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <random>
+
+// Values of ResponseCodes (SharedDefines.h)
+static uint8 const AUTH_OK = 0x0C;
+static uint8 const AUTH_WAIT_QUEUE = 0x1B;
+static uint8 const CHAR_CREATE_SUCCESS = 0x2E;
+
+static uint8 const CHAT_MSG_SAY = 0x00;
+static uint8 const CHAT_MSG_SYSTEM = 0x0A;
+
+static uint32 const MOVEFLAG_ONTRANSPORT = 0x02000000;
+
+static uint32 const CONNECT_TIMEOUT = 10;                   // Seconds
+static uint32 const RESPONSE_TIMEOUT = 30 * IN_MILLISECONDS;
+static uint32 const LOGIN_TIMEOUT = 60 * IN_MILLISECONDS;
+// Upper bound of a wait for server packets between two packets of the capture
+static std::chrono::milliseconds const MAX_RECEIVE_WAIT(100);
+
+ReplaySession::ReplaySession(std::string const& account, std::string const& characterName, BigNumber const& sessionKey,
+                             ReplayOptions const& options, ReplayCapture const* capture, ReplayStats& stats,
+                             std::atomic<bool> const& released, std::atomic<bool> const& stop) :
+    m_account(account), m_characterName(characterName), m_sessionKey(sessionKey), m_options(options), m_capture(capture),
+    m_stats(stats), m_released(released), m_stop(stop), m_state(REPLAY_SESSION_CONNECTING), m_characterGuid(0),
+    m_offsetX(0.0f), m_offsetY(0.0f), m_loginDelay(0), m_recvOffset(0), m_headerDecrypted(false),
+    m_crypt(false), m_sendI(0), m_sendJ(0), m_recvI(0), m_recvJ(0)
+{
+}
+
+ReplaySession::~ReplaySession()
+{
+    m_socket.close();
+}
+
+bool ReplaySession::Fail(std::string const& error)
+{
+    if (m_state != REPLAY_SESSION_FAILED)
+    {
+        if (m_state == REPLAY_SESSION_IN_WORLD)
+            --m_stats.inWorld;
+        ++m_stats.failed;
+        m_error = error;
+        m_state = REPLAY_SESSION_FAILED;
+    }
+    return false;
+}
+
+void ReplaySession::Run()
+{
+    m_startTime = Clock::now();
+
+    if (!Connect() || !Authenticate() || !SelectCharacter())
+    {
+        m_socket.close();
+        return;
+    }
+
+    m_state = REPLAY_SESSION_CHARACTER_READY;
+
+    // Characters are placed by the main thread meanwhile. The server packets are
+    // drained so that the socket buffers of mangosd do not fill up.
+    WorldPacket packet;
+    while (!m_released && !m_stop)
+    {
+        if (!ReceivePacket(packet, Clock::now() + MAX_RECEIVE_WAIT) && m_state == REPLAY_SESSION_FAILED)
+            return;
+    }
+
+    Clock::time_point const loginTime = Clock::now() + std::chrono::milliseconds(m_loginDelay);
+    while (!m_stop && Clock::now() < loginTime)
+    {
+        if (!ReceivePacket(packet, std::min(loginTime, Clock::now() + MAX_RECEIVE_WAIT)) && m_state == REPLAY_SESSION_FAILED)
+            return;
+    }
+
+    if (m_stop || !EnterWorld())
+    {
+        m_socket.close();
+        return;
+    }
+
+    if (m_capture)
+        Replay();
+    else
+        Observe();
+
+    // mangosd logs the character out when the socket is closed
+    m_socket.close();
+    if (m_state == REPLAY_SESSION_IN_WORLD)
+    {
+        --m_stats.inWorld;
+        m_state = REPLAY_SESSION_FINISHED;
+    }
+}
+
+bool ReplaySession::Connect()
+{
+    ACE_INET_Addr address(m_options.port, m_options.host.c_str());
+    ACE_SOCK_Connector connector;
+    ACE_Time_Value timeout(CONNECT_TIMEOUT);
+    if (connector.connect(m_socket, address, &timeout) == -1)
+        return Fail("cannot connect to " + m_options.host + ":" + std::to_string(m_options.port));
+
+    int noDelay = 1;
+    m_socket.set_option(ACE_IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    return true;
+}
+
+bool ReplaySession::Authenticate()
+{
+    WorldPacket packet;
+    if (!WaitForPacket(SMSG_AUTH_CHALLENGE, packet, RESPONSE_TIMEOUT))
+        return false;
+
+    uint32 serverSeed;
+    packet >> serverSeed;
+
+    std::random_device random;
+    uint32 clientSeed = random();
+
+    // As checked by WorldSocket::HandleAuthSession
+    Sha1Hash sha;
+    uint32 t = 0;
+    sha.UpdateData(m_account);
+    sha.UpdateData((uint8*)&t, 4);
+    sha.UpdateData((uint8*)&clientSeed, 4);
+    sha.UpdateData((uint8*)&serverSeed, 4);
+    sha.UpdateBigNumbers(&m_sessionKey, nullptr);
+    sha.Finalize();
+
+    WorldPacket authSession(CMSG_AUTH_SESSION, 4 + 4 + m_account.size() + 1 + 4 + 20 + 4);
+    authSession << uint32(SUPPORTED_CLIENT_BUILD);
+    authSession << uint32(0);                               // Server id
+    authSession << m_account;
+    authSession << uint32(clientSeed);
+    authSession.append(sha.GetDigest(), 20);
+    authSession << uint32(0);                               // No addon info
+    if (!SendPacket(authSession))
+        return false;
+
+    // The server encrypts its headers from the auth response on
+    m_key = m_sessionKey.AsByteArray();
+    m_crypt = true;
+
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(RESPONSE_TIMEOUT);
+    while (!m_stop)
+    {
+        if (!ReceivePacket(packet, std::min(deadline, Clock::now() + MAX_RECEIVE_WAIT)))
+        {
+            if (m_state == REPLAY_SESSION_FAILED)
+                return false;
+            if (Clock::now() >= deadline)
+                return Fail("no auth response");
+            continue;
+        }
+
+        if (packet.GetOpcode() != SMSG_AUTH_RESPONSE)
+            continue;
+
+        uint8 result;
+        packet >> result;
+        if (result == AUTH_OK)
+            return true;
+        if (result != AUTH_WAIT_QUEUE)
+            return Fail("auth response " + std::to_string(result));
+
+        // Queued: the server sends AUTH_OK once the session gets in
+        deadline = Clock::time_point::max();
+    }
+
+    return false;
+}
+
+bool ReplaySession::SelectCharacter()
+{
+    bool created = false;
+    for (;;)
+    {
+        WorldPacket packet(CMSG_CHAR_ENUM, 0);
+        if (!SendPacket(packet) || !WaitForPacket(SMSG_CHAR_ENUM, packet, RESPONSE_TIMEOUT))
+            return false;
+
+        uint8 count;
+        packet >> count;
+        if (count)
+        {
+            packet >> m_characterGuid;
+            return true;
+        }
+
+        if (created)
+            return Fail("created character not listed");
+
+        WorldPacket charCreate(CMSG_CHAR_CREATE, m_characterName.size() + 1 + 9);
+        charCreate << m_characterName;
+        charCreate << uint8(m_options.race);
+        charCreate << uint8(m_options.playerClass);
+        charCreate << uint8(0);                             // Gender
+        charCreate << uint8(0);                             // Skin
+        charCreate << uint8(0);                             // Face
+        charCreate << uint8(0);                             // Hair style
+        charCreate << uint8(0);                             // Hair color
+        charCreate << uint8(0);                             // Facial hair
+        charCreate << uint8(0);                             // Outfit
+        if (!SendPacket(charCreate) || !WaitForPacket(SMSG_CHAR_CREATE, packet, RESPONSE_TIMEOUT))
+            return false;
+
+        uint8 result;
+        packet >> result;
+        if (result != CHAR_CREATE_SUCCESS)
+            return Fail("character creation of " + m_characterName + " failed with code " + std::to_string(result));
+        created = true;
+    }
+}
+
+bool ReplaySession::EnterWorld()
+{
+    WorldPacket packet(CMSG_PLAYER_LOGIN, 8);
+    packet << m_characterGuid;
+    if (!SendPacket(packet))
+        return false;
+
+    if (!WaitForPacket(SMSG_LOGIN_VERIFY_WORLD, packet, LOGIN_TIMEOUT, SMSG_CHARACTER_LOGIN_FAILED))
+        return false;
+
+    m_state = REPLAY_SESSION_IN_WORLD;
+    ++m_stats.inWorld;
+    return true;
+}
+
+void ReplaySession::Replay()
+{
+    std::vector<ReplayPacket> const& packets = m_capture->GetPackets();
+    Clock::time_point start = Clock::now();
+    size_t next = 0;
+    WorldPacket packet;
+
+    while (!m_stop && m_state == REPLAY_SESSION_IN_WORLD)
+    {
+        if (next == packets.size())
+        {
+            if (!m_options.loop)
+                break;
+            next = 0;
+            start = Clock::now();
+        }
+
+        Clock::time_point const due = start + std::chrono::milliseconds(uint64(packets[next].time / m_options.speed));
+        if (Clock::now() >= due)
+        {
+            SendReplayPacket(packets[next]);
+            ++next;
+            continue;
+        }
+
+        while (ReceivePacket(packet, std::min(due, Clock::now() + MAX_RECEIVE_WAIT)))
+            HandleServerPacket(packet);
+    }
+}
+
+void ReplaySession::Observe()
+{
+    Clock::time_point nextProfile = Clock::now() + std::chrono::seconds(m_options.profileInterval);
+    WorldPacket packet;
+
+    while (!m_stop && m_state == REPLAY_SESSION_IN_WORLD)
+    {
+        if (m_options.profileInterval && Clock::now() >= nextProfile)
+        {
+            // Each profile covers one interval
+            SendChatCommand(".server profile");
+            SendChatCommand(".server profile reset");
+            nextProfile += std::chrono::seconds(m_options.profileInterval);
+        }
+
+        while (ReceivePacket(packet, Clock::now() + MAX_RECEIVE_WAIT))
+            HandleServerPacket(packet);
+    }
+}
+
+void ReplaySession::SendReplayPacket(ReplayPacket const& replayPacket)
+{
+    WorldPacket packet(replayPacket.packet);
+    for (uint32 offset : replayPacket.guidOffsets)
+        packet.put<uint64>(offset, m_characterGuid);
+
+    if (replayPacket.movement)
+    {
+        uint32 const moveFlags = packet.read<uint32>(0);
+        packet.put<uint32>(4, uint32(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - m_startTime).count()));
+        // Transport positions are relative to the transport
+        if (!(moveFlags & MOVEFLAG_ONTRANSPORT))
+        {
+            packet.put<float>(8, packet.read<float>(8) + m_offsetX);
+            packet.put<float>(12, packet.read<float>(12) + m_offsetY);
+        }
+    }
+
+    SendPacket(packet);
+}
+
+void ReplaySession::HandleServerPacket(WorldPacket const& packet)
+{
+    if (m_capture || packet.GetOpcode() != SMSG_MESSAGECHAT || packet.size() < 18)
+        return;
+
+    // type, language, sender guid, length, text, tag
+    if (packet.read<uint8>(0) != CHAT_MSG_SYSTEM)
+        return;
+
+    char const* text = reinterpret_cast<char const*>(packet.contents() + 17);
+    size_t const length = strnlen(text, packet.size() - 17);
+    uint32 const seconds = uint32(std::chrono::duration_cast<std::chrono::seconds>(Clock::now() - m_startTime).count());
+
+    std::lock_guard<std::mutex> guard(m_stats.profileLock);
+    m_stats.profileLines.push_back(std::to_string(seconds) + "\t" + std::string(text, length));
+}
+
+void ReplaySession::SendChatCommand(char const* command)
+{
+    WorldPacket packet(CMSG_MESSAGECHAT, 8 + strlen(command) + 1);
+    packet << uint32(CHAT_MSG_SAY);
+    packet << uint32(0);                                    // LANG_UNIVERSAL
+    packet << command;
+    SendPacket(packet);
+}
+
+bool ReplaySession::WaitForPacket(uint16 opcode, WorldPacket& packet, uint32 timeoutMs, uint16 failOpcode)
+{
+    Clock::time_point const deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (ReceivePacket(packet, deadline))
+    {
+        if (packet.GetOpcode() == opcode)
+            return true;
+        if (failOpcode && packet.GetOpcode() == failOpcode)
+            return Fail("server answered with opcode " + std::to_string(failOpcode));
+        HandleServerPacket(packet);
+    }
+
+    if (m_state != REPLAY_SESSION_FAILED)
+        Fail("timed out waiting for opcode " + std::to_string(opcode));
+    return false;
+}
+
+bool ReplaySession::SendPacket(WorldPacket const& packet)
+{
+    // ClientPktHeader: big endian size (opcode included), opcode
+    uint16 const size = uint16(packet.size() + 4);
+    uint32 const opcode = packet.GetOpcode();
+
+    std::vector<uint8> data(6 + packet.size());
+    data[0] = uint8(size >> 8);
+    data[1] = uint8(size);
+    data[2] = uint8(opcode);
+    data[3] = uint8(opcode >> 8);
+    data[4] = uint8(opcode >> 16);
+    data[5] = uint8(opcode >> 24);
+    if (m_crypt)
+        EncryptHeader(data.data());
+    if (packet.size())
+        std::copy(packet.contents(), packet.contents() + packet.size(), data.begin() + 6);
+
+    if (m_socket.send_n(data.data(), data.size()) != ssize_t(data.size()))
+        return Fail("connection lost");
+
+    m_stats.clientBytes += data.size();
+    ++m_stats.clientPackets;
+    return true;
+}
+
+bool ReplaySession::ReceivePacket(WorldPacket& packet, Clock::time_point deadline)
+{
+    for (;;)
+    {
+        // ServerPktHeader: big endian size (opcode included), opcode
+        size_t const available = m_recvBuffer.size() - m_recvOffset;
+        if (available >= 4)
+        {
+            uint8* header = m_recvBuffer.data() + m_recvOffset;
+            if (!m_headerDecrypted)
+            {
+                if (m_crypt)
+                    DecryptHeader(header);
+                m_headerDecrypted = true;
+            }
+
+            uint16 const size = uint16((header[0] << 8) | header[1]);
+            if (size < 2)
+                return Fail("invalid packet header");
+
+            if (available >= size_t(2 + size))
+            {
+                packet.Initialize(uint16(header[2] | (header[3] << 8)), size - 2);
+                if (size > 2)
+                    packet.append(header + 4, size - 2);
+                m_recvOffset += 2 + size;
+                m_headerDecrypted = false;
+
+                m_stats.serverBytes += 2 + size;
+                ++m_stats.serverPackets;
+                return true;
+            }
+        }
+
+        if (m_recvOffset == m_recvBuffer.size())
+        {
+            m_recvBuffer.clear();
+            m_recvOffset = 0;
+        }
+
+        Clock::time_point const now = Clock::now();
+        int64 const waitUs = now < deadline ? int64(std::chrono::duration_cast<std::chrono::microseconds>(deadline - now).count()) : 0;
+        ACE_Time_Value timeout(0, long(waitUs));
+
+        uint8 buffer[4096];
+        ssize_t const received = m_socket.recv(buffer, sizeof(buffer), &timeout);
+        if (received > 0)
+        {
+            m_recvBuffer.insert(m_recvBuffer.end(), buffer, buffer + received);
+            continue;
+        }
+
+        if (received < 0 && errno == ETIME)
+            return false;
+
+        return Fail("connection closed by the server");
+    }
+}
+
+void ReplaySession::EncryptHeader(uint8* header)
+{
+    // Mirror of AuthCrypt::DecryptRecv
+    for (size_t t = 0; t < 6; ++t)
+    {
+        m_sendI %= m_key.size();
+        uint8 x = (header[t] ^ m_key[m_sendI]) + m_sendJ;
+        ++m_sendI;
+        header[t] = m_sendJ = x;
+    }
+}
+
+void ReplaySession::DecryptHeader(uint8* header)
+{
+    // Mirror of AuthCrypt::EncryptSend
+    for (size_t t = 0; t < 4; ++t)
+    {
+        m_recvI %= m_key.size();
+        uint8 x = (header[t] - m_recvJ) ^ m_key[m_recvI];
+        ++m_recvI;
+        m_recvJ = header[t];
+        header[t] = x;
+    }
+}
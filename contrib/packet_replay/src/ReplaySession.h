@@ -0,0 +1,153 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef _REPLAY_SESSION_H
+#define _REPLAY_SESSION_H
+
+#include "Common.h"
+#include "WorldPacket.h"
+#include "Auth/BigNumber.h"
+
+#include <ace/SOCK_Stream.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class ReplayCapture;
+struct ReplayPacket;
+
+struct ReplayOptions
+{
+    std::string host = "127.0.0.1";
+    uint16 port = 8085;
+    double speed = 1.0;                                     // Time scale of the capture, 2 replays it twice as fast
+    bool loop = false;
+    uint8 race = 1;                                         // Of the characters created for the synthetic accounts
+    uint8 playerClass = 1;
+    uint32 profileInterval = 0;                             // Seconds between two `.server profile` of the observer
+};
+
+// Counters of all the sessions, sampled by the report
+struct ReplayStats
+{
+    std::atomic<uint64> serverBytes{0};                     // Received from mangosd, headers included
+    std::atomic<uint64> serverPackets{0};
+    std::atomic<uint64> clientBytes{0};
+    std::atomic<uint64> clientPackets{0};
+    std::atomic<uint32> inWorld{0};
+    std::atomic<uint32> failed{0};
+
+    std::mutex profileLock;
+    std::vector<std::string> profileLines;                  // System messages received by the observer
+};
+
+enum ReplaySessionState
+{
+    REPLAY_SESSION_CONNECTING,
+    REPLAY_SESSION_CHARACTER_READY,                         // At the character screen, waits for the release
+    REPLAY_SESSION_IN_WORLD,
+    REPLAY_SESSION_FINISHED,
+    REPLAY_SESSION_FAILED,
+};
+
+/**
+ * @brief One synthetic client of the load test, run on its own thread.
+ * It authenticates with the session key set by LoginStandIn, creates a
+ * character when the account has none, and waits at the character screen
+ * until the characters are placed. Once in world, it sends the client packets
+ * of the capture at their recorded time (scaled by ReplayOptions::speed), with
+ * the guid of the recorded player replaced by its own and its movement shifted
+ * by its offset. Server packets are only counted.
+ * Without a capture, the session is the observer: a GM that asks mangosd for
+ * its map tick profile at ReplayOptions::profileInterval.
+ */
+class ReplaySession
+{
+    public:
+        ReplaySession(std::string const& account, std::string const& characterName, BigNumber const& sessionKey,
+                      ReplayOptions const& options, ReplayCapture const* capture, ReplayStats& stats,
+                      std::atomic<bool> const& released, std::atomic<bool> const& stop);
+        ~ReplaySession();
+
+        void SetOffset(float dx, float dy) { m_offsetX = dx; m_offsetY = dy; }
+        void GetOffset(float& dx, float& dy) const { dx = m_offsetX; dy = m_offsetY; }
+        void SetLoginDelay(uint32 delayMs) { m_loginDelay = delayMs; }
+
+        void Run();
+
+        bool IsReplaying() const { return m_capture != nullptr; }
+        ReplaySessionState GetState() const { return m_state; }
+        uint32 GetCharacterGuid() const { return uint32(m_characterGuid); }
+        std::string const& GetAccount() const { return m_account; }
+        std::string const& GetError() const { return m_error; }
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        bool Connect();
+        bool Authenticate();
+        bool SelectCharacter();
+        bool EnterWorld();
+        void Replay();
+        void Observe();
+
+        void SendReplayPacket(ReplayPacket const& replayPacket);
+        void HandleServerPacket(WorldPacket const& packet);
+
+        bool SendPacket(WorldPacket const& packet);
+        // False once the deadline is passed, or on error (see m_error)
+        bool ReceivePacket(WorldPacket& packet, Clock::time_point deadline);
+        bool WaitForPacket(uint16 opcode, WorldPacket& packet, uint32 timeoutMs, uint16 failOpcode = 0);
+        void SendChatCommand(char const* command);
+
+        bool Fail(std::string const& error);
+
+        // Client side of AuthCrypt: encrypts the 6 bytes headers sent, decrypts the 4 bytes headers received
+        void EncryptHeader(uint8* header);
+        void DecryptHeader(uint8* header);
+
+        std::string m_account;
+        std::string m_characterName;
+        BigNumber m_sessionKey;
+        ReplayOptions const& m_options;
+        ReplayCapture const* m_capture;
+        ReplayStats& m_stats;
+        std::atomic<bool> const& m_released;
+        std::atomic<bool> const& m_stop;
+
+        std::atomic<ReplaySessionState> m_state;
+        std::string m_error;
+        uint64 m_characterGuid;
+        float m_offsetX;
+        float m_offsetY;
+        uint32 m_loginDelay;
+        Clock::time_point m_startTime;
+
+        ACE_SOCK_Stream m_socket;
+        std::vector<uint8> m_recvBuffer;
+        size_t m_recvOffset;
+        bool m_headerDecrypted;
+
+        bool m_crypt;
+        std::vector<uint8> m_key;
+        uint8 m_sendI, m_sendJ, m_recvI, m_recvJ;
+};
+
+#endif
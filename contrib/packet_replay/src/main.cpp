@@ -0,0 +1,409 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/*
+ * Replays the client packets of a packet log (see WorldSession::StartSniffing)
+ * with many synthetic sessions against a local mangosd, and records the
+ * bandwidth sent by mangosd and its map tick profile. See the readme file.
+ */
+
+#include "Common.h"
+#include "Database/DatabaseEnv.h"
+#include "Config/Config.h"
+#include "Log.h"
+#include "IdleConnections.h"
+#include "LoginStandIn.h"
+#include "ReplayCapture.h"
+#include "ReplaySession.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+DatabaseType LoginDatabase;
+DatabaseType CharacterDatabase;
+
+struct Arguments
+{
+    std::string capture;
+    std::string config = "mangosd.conf";
+    std::string loginDatabase;
+    std::string characterDatabase;
+    std::string address = "127.0.0.1";
+    std::string prefix = "REPLAY";
+    std::string report = "replay_report.csv";
+    std::string profileReport = "replay_profile.txt";
+    uint32 sessions = 10;
+    uint32 idle = 0;
+    int32 realmId = -1;
+    int32 mapId = -1;
+    uint32 guid = 0;
+    float jitter = 10.0f;
+    uint32 rampMs = 50;
+    uint32 duration = 0;
+    uint32 reportInterval = 1;
+    ReplayOptions options;
+};
+
+void printUsage()
+{
+    printf("Usage: packet_replay --capture <packet_log.pkt> [options]\n\n");
+    printf("--sessions [#] : Synthetic sessions replaying the capture (default 10)\n");
+    printf("--idle [#] : Connections opened before the sessions that never authenticate (default 0)\n");
+    printf("--config [file] : mangosd.conf giving the databases, the port and the realm id (default mangosd.conf)\n");
+    printf("--logindb [info] / --chardb [info] : \"host;port;user;password;database\", override the config\n");
+    printf("--host [address] --port [#] : mangosd to connect to (default 127.0.0.1 and WorldServerPort)\n");
+    printf("--address [address] : Address mangosd sees the sessions connect from (default 127.0.0.1)\n");
+    printf("--realm [#] : Realm id of mangosd, for the observer access (default RealmID)\n");
+    printf("--prefix [name] : Prefix of the synthetic account names (default REPLAY)\n");
+    printf("--speed [#] : Time scale of the capture, 2 replays it twice as fast (default 1)\n");
+    printf("--jitter [#] : Yards around the recorded positions the sessions are spread on (default 10)\n");
+    printf("--map [#] : Map of the recorded positions, when the capture started in world\n");
+    printf("--guid [#] : Guid of the recorded player, when the capture started in world\n");
+    printf("--race [#] --class [#] : Of the characters created for the accounts without one (default 1 1)\n");
+    printf("--ramp [#] : Milliseconds between the logins of two sessions (default 50)\n");
+    printf("--duration [#] : Seconds to run, 0 to stop at the end of the capture (default 0)\n");
+    printf("--loop : Replay the capture again when it ends\n");
+    printf("--report [file] --interval [#] : Bandwidth report and its sampling interval in seconds (default replay_report.csv 1)\n");
+    printf("--profile [#] : Seconds between two map tick profiles, 0 for none (default 0)\n");
+    printf("--profile-report [file] : Map tick profiles (default replay_profile.txt)\n");
+}
+
+bool handleArgs(int argc, char** argv, Arguments& args)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        char const* param = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool const hasParam = param != nullptr;
+
+        if (strcmp(argv[i], "--loop") == 0)
+        {
+            args.options.loop = true;
+            continue;
+        }
+        if ((strcmp(argv[i], "-?") == 0) || (strcmp(argv[i], "/?") == 0) || (strcmp(argv[i], "-h") == 0))
+            return false;
+
+        if (!hasParam)
+        {
+            printf("missing value of %s\n", argv[i]);
+            return false;
+        }
+        ++i;
+
+        if (strcmp(argv[i - 1], "--capture") == 0)
+            args.capture = param;
+        else if (strcmp(argv[i - 1], "--sessions") == 0)
+            args.sessions = atoi(param);
+        else if (strcmp(argv[i - 1], "--idle") == 0)
+            args.idle = atoi(param);
+        else if (strcmp(argv[i - 1], "--config") == 0)
+            args.config = param;
+        else if (strcmp(argv[i - 1], "--logindb") == 0)
+            args.loginDatabase = param;
+        else if (strcmp(argv[i - 1], "--chardb") == 0)
+            args.characterDatabase = param;
+        else if (strcmp(argv[i - 1], "--host") == 0)
+            args.options.host = param;
+        else if (strcmp(argv[i - 1], "--port") == 0)
+            args.options.port = uint16(atoi(param));
+        else if (strcmp(argv[i - 1], "--address") == 0)
+            args.address = param;
+        else if (strcmp(argv[i - 1], "--realm") == 0)
+            args.realmId = atoi(param);
+        else if (strcmp(argv[i - 1], "--prefix") == 0)
+            args.prefix = param;
+        else if (strcmp(argv[i - 1], "--speed") == 0)
+            args.options.speed = atof(param);
+        else if (strcmp(argv[i - 1], "--jitter") == 0)
+            args.jitter = float(atof(param));
+        else if (strcmp(argv[i - 1], "--map") == 0)
+            args.mapId = atoi(param);
+        else if (strcmp(argv[i - 1], "--guid") == 0)
+            args.guid = atoi(param);
+        else if (strcmp(argv[i - 1], "--race") == 0)
+            args.options.race = uint8(atoi(param));
+        else if (strcmp(argv[i - 1], "--class") == 0)
+            args.options.playerClass = uint8(atoi(param));
+        else if (strcmp(argv[i - 1], "--ramp") == 0)
+            args.rampMs = atoi(param);
+        else if (strcmp(argv[i - 1], "--duration") == 0)
+            args.duration = atoi(param);
+        else if (strcmp(argv[i - 1], "--report") == 0)
+            args.report = param;
+        else if (strcmp(argv[i - 1], "--interval") == 0)
+            args.reportInterval = std::max(1, atoi(param));
+        else if (strcmp(argv[i - 1], "--profile") == 0)
+            args.options.profileInterval = atoi(param);
+        else if (strcmp(argv[i - 1], "--profile-report") == 0)
+            args.profileReport = param;
+        else
+        {
+            printf("unknown option %s\n", argv[i - 1]);
+            return false;
+        }
+    }
+
+    if (args.capture.empty() || !args.sessions || args.options.speed <= 0.0)
+        return false;
+
+    return true;
+}
+
+// Pronounceable names made of letters only, as required by ObjectMgr::CheckPlayerName
+std::string characterName(uint32 index)
+{
+    static char const consonants[] = "bdfgklmnprstvz";
+    static char const vowels[] = "aeiou";
+    uint32 const consonantCount = sizeof(consonants) - 1;
+    uint32 const vowelCount = sizeof(vowels) - 1;
+
+    std::string name = "Rp";
+    for (int i = 0; i < 4; ++i)
+    {
+        name += consonants[index % consonantCount];
+        index /= consonantCount;
+        name += vowels[index % vowelCount];
+        index /= vowelCount;
+    }
+    return name;
+}
+
+int main(int argc, char** argv)
+{
+    Arguments args;
+    if (!handleArgs(argc, argv, args))
+    {
+        printUsage();
+        return 1;
+    }
+
+    ReplayCapture capture;
+    std::string error;
+    if (!capture.Load(args.capture.c_str(), args.guid, error))
+    {
+        printf("Cannot replay %s: %s\n", args.capture.c_str(), error.c_str());
+        return 1;
+    }
+
+    if (!capture.GetPlayerGuid())
+        printf("The guid of the recorded player is unknown (--guid), the packets naming it are sent unchanged\n");
+
+    uint32 mapId = args.mapId >= 0 ? uint32(args.mapId) : capture.GetStartMap();
+    if (capture.HasStartPosition() && args.mapId < 0 && !capture.HasStartMap())
+    {
+        printf("The capture started in world, give the map of its positions with --map\n");
+        return 1;
+    }
+
+    bool const hasConfig = sConfig.SetSource(args.config.c_str());
+    if (args.loginDatabase.empty())
+        args.loginDatabase = hasConfig ? sConfig.GetStringDefault("LoginDatabaseInfo", "") : "";
+    if (args.characterDatabase.empty())
+        args.characterDatabase = hasConfig ? sConfig.GetStringDefault("CharacterDatabaseInfo", "") : "";
+    if (args.realmId < 0)
+        args.realmId = hasConfig ? sConfig.GetIntDefault("RealmID", 1) : 1;
+    if (hasConfig && args.options.port == ReplayOptions().port)
+        args.options.port = uint16(sConfig.GetIntDefault("WorldServerPort", args.options.port));
+
+    if (args.loginDatabase.empty() || args.characterDatabase.empty())
+    {
+        printf("Database not specified, give a mangosd.conf with --config or use --logindb and --chardb\n");
+        return 1;
+    }
+
+    if (!LoginDatabase.Initialize(args.loginDatabase.c_str()) || !CharacterDatabase.Initialize(args.characterDatabase.c_str()))
+    {
+        printf("Cannot connect to the databases\n");
+        return 1;
+    }
+
+    printf("Replaying %u client packets (%.1f s) of %s with %u sessions\n", uint32(capture.GetPackets().size()),
+           capture.GetDuration() / 1000.0, args.capture.c_str(), args.sessions);
+
+    IdleConnections idle(args.options.host, args.options.port);
+    if (args.idle)
+    {
+        std::chrono::steady_clock::time_point const connectStart = std::chrono::steady_clock::now();
+        uint32 const opened = idle.Open(args.idle);
+        double const connectTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - connectStart).count();
+        printf("Opened %u idle connections out of %u in %.2f s\n", opened, args.idle, connectTime);
+    }
+
+    LoginStandIn standIn(args.address, uint32(args.realmId));
+    ReplayStats stats;
+    std::atomic<bool> released(false);
+    std::atomic<bool> stop(false);
+    std::vector<std::unique_ptr<ReplaySession>> sessions;
+
+    std::mt19937 random(std::random_device{}());
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    for (uint32 i = 0; i <= args.sessions; ++i)
+    {
+        // The last session is the observer, a GM account asking for the tick profiles
+        bool const observer = i == args.sessions;
+        if (observer && !args.options.profileInterval)
+            break;
+
+        char account[32];
+        if (observer)
+            snprintf(account, sizeof(account), "%sGM", args.prefix.c_str());
+        else
+            snprintf(account, sizeof(account), "%s%04u", args.prefix.c_str(), i);
+
+        BigNumber sessionKey;
+        if (!standIn.PrepareAccount(account, observer ? 3 : 0) || !standIn.StartSession(account, sessionKey))
+        {
+            printf("Cannot prepare the account %s\n", account);
+            return 1;
+        }
+
+        std::unique_ptr<ReplaySession> session(new ReplaySession(account, characterName(i), sessionKey, args.options,
+                                                                 observer ? nullptr : &capture, stats, released, stop));
+        if (!observer)
+        {
+            // Uniform in a disc, the same offset for the whole replay so the paths stay coherent
+            float const radius = args.jitter * std::sqrt(unit(random));
+            float const angle = 2.0f * float(M_PI) * unit(random);
+            session->SetOffset(radius * std::cos(angle), radius * std::sin(angle));
+            session->SetLoginDelay(i * args.rampMs);
+        }
+        sessions.push_back(std::move(session));
+    }
+
+    std::vector<std::thread> threads;
+    for (auto& session : sessions)
+        threads.emplace_back(&ReplaySession::Run, session.get());
+
+    // Characters are offline until released
+    for (;;)
+    {
+        bool const waiting = std::any_of(sessions.begin(), sessions.end(), [](std::unique_ptr<ReplaySession> const& session)
+        {
+            return session->GetState() == REPLAY_SESSION_CONNECTING;
+        });
+        if (!waiting)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    float startX, startY, startZ, startO;
+    capture.GetStartPosition(startX, startY, startZ, startO);
+    for (auto& session : sessions)
+    {
+        if (session->GetState() == REPLAY_SESSION_FAILED)
+        {
+            printf("%s: %s\n", session->GetAccount().c_str(), session->GetError().c_str());
+            continue;
+        }
+
+        if (session->IsReplaying() && capture.HasStartPosition())
+        {
+            float dx, dy;
+            session->GetOffset(dx, dy);
+            standIn.PlaceCharacter(session->GetCharacterGuid(), mapId, startX + dx, startY + dy, startZ, startO);
+        }
+    }
+    released = true;
+
+    FILE* report = fopen(args.report.c_str(), "w");
+    if (report)
+        fprintf(report, "seconds,in_world,failed,idle,server_bytes_per_s,server_packets_per_s,client_bytes_per_s,client_packets_per_s\n");
+
+    std::chrono::steady_clock::time_point const startTime = std::chrono::steady_clock::now();
+    uint64 lastServerBytes = 0, lastServerPackets = 0, lastClientBytes = 0, lastClientPackets = 0;
+    uint32 elapsed = 0;
+
+    for (;;)
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(args.reportInterval));
+        elapsed = uint32(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - startTime).count());
+
+        uint64 const serverBytes = stats.serverBytes;
+        uint64 const serverPackets = stats.serverPackets;
+        uint64 const clientBytes = stats.clientBytes;
+        uint64 const clientPackets = stats.clientPackets;
+        double const interval = double(args.reportInterval);
+        uint32 const idleOpen = idle.Poll();
+
+        printf("%5us | in world %4u | failed %4u | idle %5u | mangosd out %9.0f B/s %7.0f packets/s | clients out %8.0f B/s\n",
+               elapsed, stats.inWorld.load(), stats.failed.load(), idleOpen, (serverBytes - lastServerBytes) / interval,
+               (serverPackets - lastServerPackets) / interval, (clientBytes - lastClientBytes) / interval);
+        if (report)
+        {
+            fprintf(report, "%u,%u,%u,%u,%.0f,%.0f,%.0f,%.0f\n", elapsed, stats.inWorld.load(), stats.failed.load(), idleOpen,
+                    (serverBytes - lastServerBytes) / interval, (serverPackets - lastServerPackets) / interval,
+                    (clientBytes - lastClientBytes) / interval, (clientPackets - lastClientPackets) / interval);
+            fflush(report);
+        }
+
+        lastServerBytes = serverBytes;
+        lastServerPackets = serverPackets;
+        lastClientBytes = clientBytes;
+        lastClientPackets = clientPackets;
+
+        if (args.duration && elapsed >= args.duration)
+            break;
+
+        // Without a duration, the replay ends with the capture
+        bool const replaying = std::any_of(sessions.begin(), sessions.end(), [](std::unique_ptr<ReplaySession> const& session)
+        {
+            ReplaySessionState const state = session->GetState();
+            return session->IsReplaying() && (state == REPLAY_SESSION_CHARACTER_READY || state == REPLAY_SESSION_IN_WORLD);
+        });
+        if (!replaying)
+            break;
+    }
+
+    stop = true;
+    for (auto& thread : threads)
+        thread.join();
+    idle.Close();
+
+    if (report)
+        fclose(report);
+
+    if (args.options.profileInterval)
+    {
+        if (FILE* profile = fopen(args.profileReport.c_str(), "w"))
+        {
+            for (std::string const& line : stats.profileLines)
+                fprintf(profile, "%s\n", line.c_str());
+            fclose(profile);
+        }
+    }
+
+    for (auto& session : sessions)
+    {
+        if (session->GetState() == REPLAY_SESSION_FAILED)
+            printf("%s: %s\n", session->GetAccount().c_str(), session->GetError().c_str());
+    }
+
+    printf("Done in %u s: mangosd sent " UI64FMTD " bytes in " UI64FMTD " packets, the clients " UI64FMTD " bytes in " UI64FMTD " packets\n",
+           elapsed, stats.serverBytes.load(), stats.serverPackets.load(), stats.clientBytes.load(), stats.clientPackets.load());
+
+    LoginDatabase.HaltDelayThread();
+    CharacterDatabase.HaltDelayThread();
+    return 0;
+}
@@ -12,15 +12,19 @@
 #include <ace/Unbounded_Queue.h>
 #include <ace/Message_Block.h>
 #include <mutex>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <vector>
 
 #if !defined (ACE_LACKS_PRAGMA_ONCE)
 #pragma once
 #endif /* ACE_LACKS_PRAGMA_ONCE */
 
 #include "Common.h"
+#include "WorldPacket.h"
 
 class ACE_Message_Block;
-class WorldPacket;
 class WorldSession;
 
 
@@ -59,12 +63,15 @@ typedef ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH> WorldHandler;
  * Most methods return -1 on failure.
  * The class uses reference counting.
  *
- * For output the class uses one buffer (64K usually) and
- * a queue where it stores packet if there is no place on
- * the queue. The reason this is done, is because the server
- * does really a lot of small-size writes to it, and it doesn't
- * scale well to allocate memory for every. When something is
- * written to the output buffer the socket is not immediately
+ * For output the class keeps a queue of packets, which is flushed
+ * with one writev/sendmsg call per handle_output, speculatively until
+ * the kernel buffer is full. Packets sent to several sockets are
+ * queued by reference with their header (encrypted when queued, so
+ * the headers keep the order of the packets). The other packets
+ * are copied with their header in blocks (64K usually) as the
+ * server does really a lot of small-size writes, and it doesn't
+ * scale well to allocate memory for every; the big ones get their
+ * own copy. When something is queued the socket is not immediately
  * activated for output (again for the same reason), there
  * is 10ms celling (thats why there is Update() method).
  * This concept is similar to TCP_CORK, but TCP_CORK
@@ -105,9 +112,6 @@ class MangosSocket : public WorldHandler
         using LockType = std::mutex;
         typedef std::unique_lock<LockType> GuardType;
 
-        // Queue for storing packets for which there is no space.
-        typedef ACE_Unbounded_Queue<WorldPacket*> PacketQueueT;
-
         // Check if socket is closed.
         bool IsClosed() const { return closing_; }
 
@@ -128,6 +132,22 @@ class MangosSocket : public WorldHandler
         // @return -1 of failure
         int SendPacket (const WorldPacket& pct);
 
+        // Send a packet which is also sent to other sockets, the payload
+        // is only referenced if it has to wait in the queue.
+        int SendPacket (SharedWorldPacket const& pct);
+
+        // Payload bytes copied to the output queues, and queued by reference, by all sockets.
+        static uint64 GetBytesCopied() { return s_BytesCopied; }
+        static uint64 GetBytesShared() { return s_BytesShared; }
+        // Bytes written, and writev/sendmsg calls made, by all sockets.
+        static uint64 GetBytesSent() { return s_BytesSent; }
+        static uint64 GetSendCalls() { return s_SendCalls; }
+
+        // Bytes waiting in the output queue of this socket.
+        size_t GetOutQueuedBytes() const { return m_OutQueuedBytes; }
+        // writev/sendmsg calls made by this socket during the last second it sent something.
+        uint32 GetSendCallsPerSecond() const;
+
         // Add reference to this object.
         long AddReference() { return static_cast<long>(add_reference()); }
 
@@ -169,15 +189,16 @@ class MangosSocket : public WorldHandler
         int cancel_wakeup_output (GuardType& g);
         int schedule_wakeup_output (GuardType& g);
 
-        // Try to write WorldPacket to m_OutBuffer ,return -1 if no space
+        // Queue a packet, copied unless shared is set.
         // Need to be called with m_OutBufferLock lock held
-        int iSendPacket (const WorldPacket& pct);
+        void iSendPacket (const WorldPacket& pct, SharedWorldPacket const* shared);
 
-        // Flush m_PacketQueue if there are packets in it
+        // Drop the bytes written from the front of m_OutQueue.
         // Need to be called with m_OutBufferLock lock held
-        // @return true if it wrote to the buffer ( AKA you need
-        // to mark the socket for output ).
-        bool iFlushPacketQueue ();
+        void ConsumeOutQueue (size_t bytes);
+
+        // Count a writev/sendmsg call for the per second rate.
+        void CountSendCall ();
 
         // Time in which the last ping was received
         ACE_Time_Value m_LastPingTime;
@@ -211,22 +232,52 @@ class MangosSocket : public WorldHandler
         // Mutex for protecting output related data.
         LockType m_OutBufferLock;
 
-        // Buffer used for writing output.
-        ACE_Message_Block *m_OutBuffer;
+        // Entry of the output queue.
+        struct OutputEntry
+        {
+            // Payload sent by reference, with its header. Null for a block.
+            SharedWorldPacket packet;
+            ServerPktHeader header;
+            // Packets copied with their headers, when packet is null.
+            std::vector<uint8> block;
+            // Bytes of the entry already written.
+            size_t sent;
+
+            size_t size() const { return packet ? sizeof(ServerPktHeader) + packet->size() : block.size(); }
+        };
 
-        // Size of the m_OutBuffer.
+        // Packets waiting to be written, in order.
+        std::deque<OutputEntry> m_OutQueue;
+
+        // Bytes waiting in m_OutQueue.
+        std::atomic<size_t> m_OutQueuedBytes;
+
+        // Capacity of the blocks packets are copied to, packets bigger
+        // than a quarter of it get their own copy.
         size_t m_OutBufferSize;
 
-        // Here are stored packets for which there was no space on m_OutBuffer,
-        // this allows not-to kick player if its buffer is overflowed.
-        PacketQueueT m_PacketQueue;
+        // Block released by the last write, reused for the next packets.
+        std::vector<uint8> m_SpareBlock;
 
         // True if the socket is registered with the reactor for output
         bool m_OutActive;
 
+        // True once open() is called.
+        bool m_Opened;
+
+        // writev/sendmsg calls of the current and of the last second.
+        uint32 m_SendCallsThisSecond;
+        std::atomic<uint32> m_SendCallsLastSecond;
+        std::atomic<time_t> m_SendSecond;
+
         uint32 m_Seed;
 
         bool m_isServerSocket;
+
+        static std::atomic<uint64> s_BytesCopied;
+        static std::atomic<uint64> s_BytesShared;
+        static std::atomic<uint64> s_BytesSent;
+        static std::atomic<uint64> s_SendCalls;
 };
 
 #endif // MANGOSSOCKET_H
@@ -5,6 +5,7 @@
 #include <ace/os_include/netinet/os_tcp.h>
 #include <ace/os_include/sys/os_types.h>
 #include <ace/os_include/sys/os_socket.h>
+#include <ace/OS_NS_sys_socket.h>
 #include <ace/OS_NS_string.h>
 #include <ace/Reactor.h>
 
@@ -22,6 +23,20 @@
 #include "Log.h"
 #include "DBCStores.h"
 
+template <typename SessionType, typename SocketName, typename Crypt>
+std::atomic<uint64> MangosSocket<SessionType, SocketName, Crypt>::s_BytesCopied(0);
+
+template <typename SessionType, typename SocketName, typename Crypt>
+std::atomic<uint64> MangosSocket<SessionType, SocketName, Crypt>::s_BytesShared(0);
+
+template <typename SessionType, typename SocketName, typename Crypt>
+std::atomic<uint64> MangosSocket<SessionType, SocketName, Crypt>::s_BytesSent(0);
+
+template <typename SessionType, typename SocketName, typename Crypt>
+std::atomic<uint64> MangosSocket<SessionType, SocketName, Crypt>::s_SendCalls(0);
+
+// Buffers written by one writev/sendmsg call
+static int const MAX_SEND_IOVECS = 64;
 
 template <typename SessionType, typename SocketName, typename Crypt>
 MangosSocket<SessionType, SocketName, Crypt>::MangosSocket() :
@@ -32,9 +47,13 @@ MangosSocket<SessionType, SocketName, Crypt>::MangosSocket() :
     m_RecvWPct(0),
     m_RecvPct(),
     m_Header(sizeof(ClientPktHeader)),
-    m_OutBuffer(0),
+    m_OutQueuedBytes(0),
     m_OutBufferSize(65536),
     m_OutActive(false),
+    m_Opened(false),
+    m_SendCallsThisSecond(0),
+    m_SendCallsLastSecond(0),
+    m_SendSecond(0),
     m_Seed(static_cast<uint32>(rand32())),
     m_isServerSocket(true)
 {
@@ -46,16 +65,9 @@ MangosSocket<SessionType, SocketName, Crypt>::~MangosSocket(void)
 {
     delete m_RecvWPct;
 
-    if (m_OutBuffer)
-        m_OutBuffer->release();
-
     closing_ = true;
 
     peer().close();
-
-    WorldPacket* pct;
-    while (m_PacketQueue.dequeue_head(pct) == 0)
-        delete pct;
 }
 
 template <typename SessionType, typename SocketName, typename Crypt>
@@ -86,21 +98,22 @@ int MangosSocket<SessionType, SocketName, Crypt>::SendPacket(const WorldPacket&
     if (closing_)
         return -1;
 
-    if (((SocketName*)this)->iSendPacket(pct) == -1)
-    {
-        WorldPacket* npct;
+    // NOTE maybe check of the size of the queue can be good ?
+    // to make it bounded instead of unbounded
+    ((SocketName*)this)->iSendPacket(pct, nullptr);
 
-        ACE_NEW_RETURN(npct, WorldPacket(pct), -1);
+    return 0;
+}
 
-        // NOTE maybe check of the size of the queue can be good ?
-        // to make it bounded instead of unbounded
-        if (m_PacketQueue.enqueue_tail(npct) == -1)
-        {
-            delete npct;
-            sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "MangosSocket<SessionType, SocketName, Crypt>::SendPacket: m_PacketQueue.enqueue_tail failed");
-            return -1;
-        }
-    }
+template <typename SessionType, typename SocketName, typename Crypt>
+int MangosSocket<SessionType, SocketName, Crypt>::SendPacket(SharedWorldPacket const& pct)
+{
+    GuardType lock(m_OutBufferLock);
+
+    if (closing_)
+        return -1;
+
+    ((SocketName*)this)->iSendPacket(*pct, &pct);
 
     return 0;
 }
@@ -111,9 +124,11 @@ int MangosSocket<SessionType, SocketName, Crypt>::open(void *a)
     ACE_UNUSED_ARG(a);
 
     // Prevent double call to this func.
-    if (m_OutBuffer)
+    if (m_Opened)
         return -1;
 
+    m_Opened = true;
+
     // This will also prevent the socket from being Updated
     // while we are initializing it.
     m_OutActive = true;
@@ -122,9 +137,6 @@ int MangosSocket<SessionType, SocketName, Crypt>::open(void *a)
     if (((SocketName*)this)->OnSocketOpen() == -1)
         return -1;
 
-    // Allocate the buffer.
-    ACE_NEW_RETURN(m_OutBuffer, ACE_Message_Block(m_OutBufferSize), -1);
-
     // Store peer address.
     ACE_INET_Addr remote_addr;
 
@@ -209,51 +221,82 @@ int MangosSocket<SessionType, SocketName, Crypt>::handle_output(ACE_HANDLE)
     if (closing_)
         return -1;
 
-    const size_t send_len = m_OutBuffer->length();
+    while (!m_OutQueue.empty())
+    {
+        iovec iov[MAX_SEND_IOVECS];
+        int count = 0;
+        size_t send_len = 0;
+
+        for (OutputEntry& entry : m_OutQueue)
+        {
+            if (count + 2 > MAX_SEND_IOVECS)
+                break;
 
-    if (send_len == 0)
-        return cancel_wakeup_output(lock);
+            if (entry.packet)
+            {
+                size_t const headerSize = sizeof(ServerPktHeader);
+                if (entry.sent < headerSize)
+                {
+                    iov[count].iov_base = reinterpret_cast<char*>(&entry.header) + entry.sent;
+                    iov[count].iov_len = headerSize - entry.sent;
+                    send_len += iov[count].iov_len;
+                    ++count;
+                }
+
+                size_t const payloadSent = entry.sent > headerSize ? entry.sent - headerSize : 0;
+                if (entry.packet->size() > payloadSent)
+                {
+                    iov[count].iov_base = (char*)entry.packet->contents() + payloadSent;
+                    iov[count].iov_len = entry.packet->size() - payloadSent;
+                    send_len += iov[count].iov_len;
+                    ++count;
+                }
+            }
+            else
+            {
+                iov[count].iov_base = reinterpret_cast<char*>(entry.block.data()) + entry.sent;
+                iov[count].iov_len = entry.block.size() - entry.sent;
+                send_len += iov[count].iov_len;
+                ++count;
+            }
+        }
 
 #ifdef MSG_NOSIGNAL
-    ssize_t n = peer().send(m_OutBuffer->rd_ptr(), send_len, MSG_NOSIGNAL);
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+        ssize_t n = ACE_OS::sendmsg(get_handle(), &msg, MSG_NOSIGNAL);
 #else
-    ssize_t n = peer().send(m_OutBuffer->rd_ptr(), send_len);
+        ssize_t n = peer().sendv(iov, count);
 #endif // MSG_NOSIGNAL
 
-    if (n == 0)
-        return -1;
-    else if (n == -1)
-    {
+        CountSendCall();
+
+        if (n == 0)
+            return -1;
+        else if (n == -1)
+        {
 #ifdef _WIN32
-        if (WSAGetLastError() == WSAEWOULDBLOCK)
-            return schedule_wakeup_output(lock);
+            if (WSAGetLastError() == WSAEWOULDBLOCK)
+                return schedule_wakeup_output(lock);
 #endif
 
-        if (errno == EWOULDBLOCK || errno == EAGAIN)
-            return schedule_wakeup_output(lock);
-
-        return -1;
-    }
-    else if (n < (ssize_t)send_len) //now n > 0
-    {
-        m_OutBuffer->rd_ptr(static_cast<size_t>(n));
+            if (errno == EWOULDBLOCK || errno == EAGAIN)
+                return schedule_wakeup_output(lock);
 
-        // move the data to the base of the buffer
-        m_OutBuffer->crunch();
+            return -1;
+        }
 
-        return schedule_wakeup_output(lock);
-    }
-    else //now n == send_len
-    {
-        m_OutBuffer->reset();
+        s_BytesSent += n;
+        ConsumeOutQueue(static_cast<size_t>(n));
 
-        if (!iFlushPacketQueue())
-            return cancel_wakeup_output(lock);
-        else
+        // the kernel buffer is full
+        if (static_cast<size_t>(n) < send_len)
             return schedule_wakeup_output(lock);
     }
 
-    ACE_NOTREACHED(return 0);
+    return cancel_wakeup_output(lock);
 }
 
 template <typename SessionType, typename SocketName, typename Crypt>
@@ -286,7 +329,7 @@ int MangosSocket<SessionType, SocketName, Crypt>::Update(void)
     if (closing_)
         return -1;
 
-    if (m_OutActive || m_OutBuffer->length() == 0)
+    if (m_OutActive || m_OutQueuedBytes == 0)
         return 0;
 
     return handle_output(get_handle());
@@ -486,14 +529,8 @@ int MangosSocket<SessionType, SocketName, Crypt>::schedule_wakeup_output(GuardTy
 }
 
 template <typename SessionType, typename SocketName, typename Crypt>
-int MangosSocket<SessionType, SocketName, Crypt>::iSendPacket(const WorldPacket& pct)
+void MangosSocket<SessionType, SocketName, Crypt>::iSendPacket(const WorldPacket& pct, SharedWorldPacket const* shared)
 {
-    if (m_OutBuffer->space() < pct.size() + sizeof(ServerPktHeader))
-    {
-        errno = ENOBUFS;
-        return -1;
-    }
-
     ServerPktHeader header;
 
     header.cmd = pct.GetOpcode();
@@ -505,41 +542,94 @@ int MangosSocket<SessionType, SocketName, Crypt>::iSendPacket(const WorldPacket&
 
     m_Crypt.EncryptSend((uint8*) & header, sizeof(header));
 
-    if (m_OutBuffer->copy((char*) & header, sizeof(header)) == -1)
-        ACE_ASSERT(false);
+    size_t const size = sizeof(header) + pct.size();
+    m_OutQueuedBytes += size;
 
-    if (!pct.empty())
-        if (m_OutBuffer->copy((char*) pct.contents(), pct.size()) == -1)
-            ACE_ASSERT(false);
+    // Small packets are appended to the last block
+    if (!shared && size <= m_OutBufferSize / 4)
+    {
+        if (m_OutQueue.empty() || m_OutQueue.back().packet ||
+            m_OutQueue.back().block.size() + size > m_OutQueue.back().block.capacity())
+        {
+            m_OutQueue.emplace_back();
+            OutputEntry& entry = m_OutQueue.back();
+            entry.sent = 0;
+            entry.block.swap(m_SpareBlock);
+            entry.block.reserve(m_OutBufferSize);
+        }
 
-    return 0;
+        std::vector<uint8>& block = m_OutQueue.back().block;
+        uint8 const* headerBytes = reinterpret_cast<uint8 const*>(&header);
+        block.insert(block.end(), headerBytes, headerBytes + sizeof(header));
+        if (!pct.empty())
+            block.insert(block.end(), pct.contents(), pct.contents() + pct.size());
+
+        s_BytesCopied += pct.size();
+        return;
+    }
+
+    m_OutQueue.emplace_back();
+    OutputEntry& entry = m_OutQueue.back();
+    entry.header = header;
+    entry.sent = 0;
+    if (shared)
+    {
+        entry.packet = *shared;
+        s_BytesShared += pct.size();
+    }
+    else
+    {
+        entry.packet = std::make_shared<WorldPacket const>(pct);
+        s_BytesCopied += pct.size();
+    }
 }
 
 template <typename SessionType, typename SocketName, typename Crypt>
-bool MangosSocket<SessionType, SocketName, Crypt>::iFlushPacketQueue()
+void MangosSocket<SessionType, SocketName, Crypt>::ConsumeOutQueue(size_t bytes)
 {
-    WorldPacket *pct;
-    bool haveone = false;
+    m_OutQueuedBytes -= bytes;
 
-    while (m_PacketQueue.dequeue_head(pct) == 0)
+    while (bytes)
     {
-        if (((SocketName*)this)->iSendPacket(*pct) == -1)
+        OutputEntry& entry = m_OutQueue.front();
+        size_t const left = entry.size() - entry.sent;
+        if (bytes < left)
         {
-            if (m_PacketQueue.enqueue_head(pct) == -1)
-            {
-                delete pct;
-                sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "MangosSocket<SessionType, SocketName, Crypt>::iFlushPacketQueue m_PacketQueue->enqueue_head");
-                return false;
-            }
-
-            break;
+            entry.sent += bytes;
+            return;
         }
-        else
+
+        bytes -= left;
+        if (!entry.packet && m_SpareBlock.capacity() == 0)
         {
-            haveone = true;
-            delete pct;
+            entry.block.clear();
+            m_SpareBlock.swap(entry.block);
         }
+        m_OutQueue.pop_front();
+    }
+}
+
+template <typename SessionType, typename SocketName, typename Crypt>
+void MangosSocket<SessionType, SocketName, Crypt>::CountSendCall()
+{
+    ++s_SendCalls;
+
+    time_t const now = time(nullptr);
+    if (now != m_SendSecond)
+    {
+        m_SendCallsLastSecond = now == m_SendSecond + 1 ? m_SendCallsThisSecond : 0;
+        m_SendCallsThisSecond = 0;
+        m_SendSecond = now;
     }
+    ++m_SendCallsThisSecond;
+}
+
+template <typename SessionType, typename SocketName, typename Crypt>
+uint32 MangosSocket<SessionType, SocketName, Crypt>::GetSendCallsPerSecond() const
+{
+    // Nothing sent for more than a second
+    if (time(nullptr) > m_SendSecond + 1)
+        return 0;
 
-    return haveone;
+    return m_SendCallsLastSecond;
 }
@@ -4,6 +4,7 @@
 #include <ace/Basic_Types.h>
 
 #include <string>
+#include <vector>
 
 template <typename T>
 class MangosSocketAcceptor;
@@ -31,6 +32,7 @@ class MangosSocketMgr
         void SetThreads(int v) { m_NetThreadsCount = v; }
         void SetTcpNodelay(bool v) { m_UseNoDelay = v; }
         void SetInterval(int v) { m_Interval = v * 1000; /* to microseconds */ }
+        void SetReusePort(bool v) { m_ReusePort = v; }
 
         int Connect(int port, std::string const& address, SocketType*& sock);
     protected:
@@ -48,11 +50,13 @@ class MangosSocketMgr
         int m_SockOutUBuff;
         bool m_UseNoDelay;
         int m_Interval;
+        bool m_ReusePort;
 
         std::string m_addr;
         ACE_UINT16 m_port;
 
-        MangosSocketAcceptor<SocketType>* m_Acceptor;
+        // One per network thread with Network.ReusePort
+        std::vector<MangosSocketAcceptor<SocketType>*> m_Acceptors;
 };
 
 #endif // MANGOSSOCKETMGR_H
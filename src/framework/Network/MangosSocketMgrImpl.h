@@ -12,6 +12,7 @@
 #include <ace/os_include/netinet/os_tcp.h>
 #include <ace/os_include/sys/os_types.h>
 #include <ace/os_include/sys/os_socket.h>
+#include <ace/OS_NS_sys_socket.h>
 #include <ace/Acceptor.h>
 #include <ace/SOCK_Acceptor.h>
 
@@ -23,8 +24,54 @@
 #include "Config/Config.h"
 #include "Database/DatabaseEnv.h"
 
+/**
+* Listening socket of the acceptor. With SetReusePort, SO_REUSEPORT is set
+* before the bind: every network thread then listens on the same port, and
+* the kernel spreads the incoming connections between them.
+*/
+class MangosSockAcceptor : public ACE_SOCK_Acceptor
+{
+public:
+    MangosSockAcceptor() : m_ReusePort(false) { }
+
+    void SetReusePort(bool v) { m_ReusePort = v; }
+
+    // Hides ACE_SOCK_Acceptor::open, called by ACE_Acceptor::open
+    int open(const ACE_Addr& local_sap, int reuse_addr = 0, int protocol_family = PF_UNSPEC,
+             int backlog = ACE_DEFAULT_BACKLOG, int protocol = 0)
+    {
+        if (!m_ReusePort)
+            return ACE_SOCK_Acceptor::open(local_sap, reuse_addr, protocol_family, backlog, protocol);
+
+#ifdef SO_REUSEPORT
+        if (protocol_family == PF_UNSPEC)
+            protocol_family = local_sap.get_type();
+
+        if (ACE_SOCK::open(SOCK_STREAM, protocol_family, protocol, reuse_addr) == -1)
+            return -1;
+
+        int one = 1;
+        if (set_option(SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) == -1 ||
+            ACE_OS::bind(get_handle(), reinterpret_cast<sockaddr*>(local_sap.get_addr()), local_sap.get_size()) == -1 ||
+            ACE_OS::listen(get_handle(), backlog) == -1)
+        {
+            close();
+            return -1;
+        }
+
+        return 0;
+#else
+        errno = ENOTSUP;
+        return -1;
+#endif
+    }
+
+private:
+    bool m_ReusePort;
+};
+
 template <typename SocketType>
-class MangosSocketAcceptor : public ACE_Acceptor<SocketType, ACE_SOCK_Acceptor>
+class MangosSocketAcceptor : public ACE_Acceptor<SocketType, MangosSockAcceptor>
 {
 public:
     MangosSocketAcceptor(void) { }
@@ -124,6 +171,16 @@ public:
         return m_Connections;
     }
 
+    // Sockets accepted by the acceptor of this thread, called by the thread itself
+    int AddOwnSocket(SocketType* sock)
+    {
+        ++m_Connections;
+        sock->AddReference();
+        m_Sockets.insert(sock);
+
+        return 0;
+    }
+
     int AddSocket(SocketType* sock)
     {
         std::unique_lock<std::mutex> lock(m_NewSockets_Lock);
@@ -141,6 +198,17 @@ public:
         return m_Reactor;
     }
 
+    static char const* GetReactorName()
+    {
+#if defined (ACE_HAS_EVENT_POLL)
+        return "epoll";
+#elif defined (ACE_HAS_DEV_POLL)
+        return "/dev/poll";
+#else
+        return "select (ACE built without ACE_HAS_EVENT_POLL)";
+#endif
+    }
+
 protected:
     void AddNewSockets()
     {
@@ -232,8 +300,8 @@ MangosSocketMgr<SocketType>::MangosSocketMgr():
     m_SockOutUBuff(65536),
     m_UseNoDelay(true),
     m_Interval(10000),
-    m_port(0),
-    m_Acceptor(0)
+    m_ReusePort(false),
+    m_port(0)
 {
 }
 
@@ -241,7 +309,8 @@ template <typename SocketType>
 MangosSocketMgr<SocketType>::~MangosSocketMgr()
 {
     delete [] m_NetThreads;
-    delete m_Acceptor;
+    for (MangosSocketAcceptor<SocketType>* acceptor : m_Acceptors)
+        delete acceptor;
 }
 
 template <typename SocketType>
@@ -249,6 +318,8 @@ int MangosSocketMgr<SocketType>::StartThreadsIfNeeded()
 {
     if (m_NetThreads)
         return 0;
+    sLog.Out(LOG_BASIC, LOG_LVL_BASIC, "Starting %u network threads, reactor: %s", uint32(m_NetThreadsCount),
+        ReactorRunnable<SocketType>::GetReactorName());
     m_NetThreads = new ReactorRunnable<SocketType>[m_NetThreadsCount];
     for (size_t i = 0; i < m_NetThreadsCount; ++i)
         m_NetThreads[i].Start(m_Interval);
@@ -269,14 +340,31 @@ int MangosSocketMgr<SocketType>::StartReactiveIO(ACE_UINT16 port, const char* ad
         return -1;
     }
 
-    m_Acceptor = new MangosSocketAcceptor<SocketType>();
-
     ACE_INET_Addr listen_addr(port, address);
 
-    if (m_Acceptor->open(listen_addr, m_NetThreads[0].GetReactor(), ACE_NONBLOCK) == -1)
+#ifndef SO_REUSEPORT
+    if (m_ReusePort)
     {
-        sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "Failed to open acceptor, check if the port is free");
-        return -1;
+        sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "Network.ReusePort is not supported on this system, using a single acceptor");
+        m_ReusePort = false;
+    }
+#endif
+
+    // The first thread runs the acceptor, or nothing when every other thread has its own
+    for (size_t i = m_ReusePort && m_NetThreadsCount > 1 ? 1 : 0; i < m_NetThreadsCount; ++i)
+    {
+        MangosSocketAcceptor<SocketType>* acceptor = new MangosSocketAcceptor<SocketType>();
+        m_Acceptors.push_back(acceptor);
+        acceptor->acceptor().SetReusePort(m_ReusePort);
+
+        if (acceptor->open(listen_addr, m_NetThreads[i].GetReactor(), ACE_NONBLOCK) == -1)
+        {
+            sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "Failed to open acceptor, check if the port is free");
+            return -1;
+        }
+
+        if (!m_ReusePort)
+            break;
     }
 
     return 0;
@@ -297,8 +385,8 @@ int MangosSocketMgr<SocketType>::StartNetwork(ACE_UINT16 port, std::string& addr
 template <typename SocketType>
 void MangosSocketMgr<SocketType>::StopNetwork()
 {
-    if (m_Acceptor)
-        m_Acceptor->close();
+    for (MangosSocketAcceptor<SocketType>* acceptor : m_Acceptors)
+        acceptor->close();
 
     if (m_NetThreadsCount != 0)
     {
@@ -349,11 +437,19 @@ int MangosSocketMgr<SocketType>::OnSocketOpen(SocketType* sock)
 
     sock->m_OutBufferSize = static_cast<size_t>(m_SockOutUBuff);
 
+    MANGOS_ASSERT(m_NetThreadsCount >= 1);
+
+    // Sockets accepted by a network thread stay on it, no need to hand them over
+    if (m_ReusePort)
+    {
+        for (size_t i = 0; i < m_NetThreadsCount; ++i)
+            if (sock->reactor() == m_NetThreads[i].GetReactor())
+                return m_NetThreads[i].AddOwnSocket(sock);
+    }
+
     // we skip the Acceptor Thread
     size_t min = 1;
 
-    MANGOS_ASSERT(m_NetThreadsCount >= 1);
-
     for (size_t i = 1; i < m_NetThreadsCount; ++i)
         if (m_NetThreads[i].Connections() < m_NetThreads[min].Connections())
             min = i;
@@ -106,6 +106,7 @@ public:
     uint32 Update(Player* pPlayer, uint32 diff, std::stringstream& reason) { return CHEAT_ACTION_NONE; }
     uint32 Finalize(Player* pPlayer, std::stringstream& reason) { return CHEAT_ACTION_NONE; }
     void AddCheats(uint32 cheats, uint32 count = 1) {}
+    void AddOverspeedDistance(float /*distance*/) {}
     void HandleCommand(ChatHandler* handler) const {}
     void OnKnockBack(Player* pPlayer, float speedxy, float speedz, float cos, float sin) {}
 
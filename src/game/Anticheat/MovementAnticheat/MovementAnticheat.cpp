@@ -12,6 +12,8 @@
 #include "MovementPacketSender.h"
 #include "Geometry.h"
 #include "AccountMgr.h"
+#include "Map.h"
+#include "MovementCheckBatch.h"
 
 using namespace Geometry;
 
@@ -1164,26 +1166,30 @@ uint32 MovementAnticheat::CheckSpeedHack(MovementInfo const& movementInfo, uint1
     {
         float intX, intY, intZ, intO;
 
-        // Check vs extrapolation
-        if (me->ExtrapolateMovement(GetLastMovementInfo(), clientTimeDiff, intX, intY, intZ, intO))
+        // The extrapolation queries the height and the line of sight, done with the
+        // batch of the map once the packets of the tick are handled. Not on transports,
+        // the extrapolation does not handle them.
+        if (sWorld.getConfig(CONFIG_BOOL_AC_MOVEMENT_ASYNC_CHECKS) && me->IsInWorld() && m_session->GetPlayer() &&
+            !GetLastMovementInfo().HasMovementFlag(MOVEFLAG_ONTRANSPORT))
         {
-            auto const intDX = intX - movementInfo.pos.x;
-            auto const intDY = intY - movementInfo.pos.y;
-            auto const intDZ = intZ - movementInfo.pos.z;
-
-            auto interpolDist = pow(intDX, 2) + pow(intDY, 2);
-            if ((movementInfo.moveFlags | GetLastMovementInfo().moveFlags) & MOVEFLAG_JUMPING)
-                interpolDist += pow(intDZ, 2);
-            interpolDist = sqrt(interpolDist);
-
-            float allowedDX = pow(intX - GetLastMovementInfo().pos.x, 2);
-            float allowedDY = pow(intY - GetLastMovementInfo().pos.y, 2);
-            float allowedDXY = sqrt(allowedDX + allowedDY);
-            float realDistance2D_sq = pow(movementInfo.pos.x - GetLastMovementInfo().pos.x, 2) + pow(movementInfo.pos.y - GetLastMovementInfo().pos.y, 2);
-
-            if (realDistance2D_sq > (allowedDY + allowedDX) * 1.1f)
-                m_overspeedDistance += sqrt(realDistance2D_sq) - sqrt(allowedDY + allowedDX);
+            // As Unit::ExtrapolateMovement, no check while a spline moves the player
+            if (me->movespline->Finalized() && me->IsMovedByPlayer())
+            {
+                MovementCheckBatch::Check check;
+                check.playerGuid = m_session->GetPlayer()->GetObjectGuid();
+                check.previous = GetLastMovementInfo();
+                check.current = movementInfo;
+                check.clientTimeDiff = clientTimeDiff;
+                check.speed = me->GetSpeedForMovementInfo(GetLastMovementInfo());
+                check.turnRate = me->GetSpeed(MOVE_TURN_RATE);
+                check.jumpInitialSpeed = me->GetJumpInitialSpeed();
+                check.overspeedDistance = 0.0f;
+                me->GetMap()->GetMovementCheckBatch().Add(check);
+            }
         }
+        // Check vs extrapolation
+        else if (me->ExtrapolateMovement(GetLastMovementInfo(), clientTimeDiff, intX, intY, intZ, intO))
+            m_overspeedDistance += MovementCheckBatch::GetOverspeedDistance(GetLastMovementInfo(), movementInfo, intX, intY);
         // Simple calculation for transports
         else if (!movementInfo.t_guid.IsEmpty() && (movementInfo.moveFlags & MOVEFLAG_ONTRANSPORT) &&
                  !GetLastMovementInfo().t_guid.IsEmpty() && (GetLastMovementInfo().moveFlags & MOVEFLAG_ONTRANSPORT))
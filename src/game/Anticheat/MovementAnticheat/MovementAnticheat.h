@@ -73,6 +73,8 @@ class MovementAnticheat
 
         void AddCheats(uint32 cheats, uint32 count = 1);
         void StoreCheat(uint32 type, uint32 count = 1);
+        // Result of the speed check run by the MovementCheckBatch of the map
+        void AddOverspeedDistance(float distance) { m_overspeedDistance += distance; }
         uint32 ComputeCheatAction(std::stringstream& reason);
 
         void HandleCommand(ChatHandler* handler) const;
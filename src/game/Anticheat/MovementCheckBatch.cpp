@@ -0,0 +1,123 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "MovementCheckBatch.h"
+#include "Anticheat.h"
+#include "Map.h"
+#include "Player.h"
+#include "World.h"
+#include "Multithreading/TaskScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+float MovementCheckBatch::GetOverspeedDistance(MovementInfo const& previous, MovementInfo const& current, float x, float y)
+{
+    float const allowedDX = pow(x - previous.pos.x, 2);
+    float const allowedDY = pow(y - previous.pos.y, 2);
+    float const realDistance2D_sq = pow(current.pos.x - previous.pos.x, 2) + pow(current.pos.y - previous.pos.y, 2);
+
+    if (realDistance2D_sq > (allowedDY + allowedDX) * 1.1f)
+        return sqrt(realDistance2D_sq) - sqrt(allowedDY + allowedDX);
+
+    return 0.0f;
+}
+
+void MovementCheckBatch::Add(Check const& check)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_checks.push_back(check);
+}
+
+void MovementCheckBatch::Run(Map const* map, Check& check)
+{
+    float x, y, z, o;
+    if (Unit::ExtrapolateMovement(map, check.previous, check.clientTimeDiff, check.speed, check.turnRate, check.jumpInitialSpeed, x, y, z, o))
+        check.overspeedDistance = GetOverspeedDistance(check.previous, check.current, x, y);
+}
+
+void MovementCheckBatch::Process(Map* map)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (m_checks.empty())
+            return;
+        m_processing.swap(m_checks);
+    }
+
+    std::chrono::steady_clock::time_point const startTime = std::chrono::steady_clock::now();
+
+    uint32 const count = m_processing.size();
+    uint32 const taskSize = std::max(1u, sWorld.getConfig(CONFIG_UINT32_AC_MOVEMENT_ASYNC_TASK_SIZE));
+    {
+        // The first slice is run by the map thread
+        TaskGroup checks(TASK_PHASE_ANTICHEAT);
+        for (uint32 begin = taskSize; begin < count; begin += taskSize)
+        {
+            checks.Run([this, map, begin, taskSize, count]()
+            {
+                for (uint32 i = begin; i < std::min(begin + taskSize, count); ++i)
+                    Run(map, m_processing[i]);
+            });
+        }
+        for (uint32 i = 0; i < std::min(taskSize, count); ++i)
+            Run(map, m_processing[i]);
+        checks.Wait();
+    }
+
+    uint64 overspeeds = 0;
+    uint64 dropped = 0;
+    for (Check const& check : m_processing)
+    {
+        if (check.overspeedDistance <= 0.0f)
+            continue;
+
+        ++overspeeds;
+        Player* player = map->GetPlayer(check.playerGuid);
+        MovementAnticheat* cheatData = player ? player->GetCheatData() : nullptr;
+        if (!cheatData)
+        {
+            ++dropped;
+            continue;
+        }
+        cheatData->AddOverspeedDistance(check.overspeedDistance);
+    }
+    m_processing.clear();
+
+    uint64 const elapsed = uint64(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count());
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_stats.checks += count;
+    m_stats.overspeeds += overspeeds;
+    m_stats.dropped += dropped;
+    ++m_stats.batches;
+    m_stats.totalUs += elapsed;
+    m_stats.maxUs = std::max(m_stats.maxUs, elapsed);
+    m_stats.maxBatchSize = std::max(m_stats.maxBatchSize, count);
+}
+
+MovementCheckBatch::Stats MovementCheckBatch::GetStats() const
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_stats;
+}
+
+void MovementCheckBatch::ResetStats()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_stats = Stats();
+}
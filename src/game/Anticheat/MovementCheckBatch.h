@@ -0,0 +1,86 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_MOVEMENTCHECKBATCH_H
+#define MANGOS_MOVEMENTCHECKBATCH_H
+
+#include "Common.h"
+#include "Object.h"
+
+#include <mutex>
+#include <vector>
+
+class Map;
+
+/**
+ * @brief Speed checks of the movement packets received by the players of a map
+ * during its tick (Anticheat.AsyncChecks).
+ * The movement handler only runs the cheap checks of MovementAnticheat, the
+ * extrapolation of the previous position (height and line of sight queries) is
+ * queued here with a copy of the speeds of the player. The map processes the
+ * whole batch on the task scheduler once the packets are handled, and adds the
+ * overspeed found to the cheat data of the players, for ComputeCheatAction.
+ */
+class MovementCheckBatch
+{
+    public:
+        struct Check
+        {
+            ObjectGuid playerGuid;                          // Player of the session owning the cheat data
+            MovementInfo previous;
+            MovementInfo current;
+            int32 clientTimeDiff;
+            float speed;                                    // Unit::GetSpeedForMovementInfo(previous)
+            float turnRate;
+            float jumpInitialSpeed;
+            float overspeedDistance;                        // Result of the worker
+        };
+
+        struct Stats
+        {
+            uint64 checks = 0;
+            uint64 overspeeds = 0;                          // Checks finding an overspeed
+            uint64 dropped = 0;                             // Players gone before the results were applied
+            uint64 batches = 0;
+            uint64 totalUs = 0;                             // Microseconds spent on the batches
+            uint64 maxUs = 0;
+            uint32 maxBatchSize = 0;
+        };
+
+        // Distance moved past the extrapolated position (x, y) of the previous movement
+        static float GetOverspeedDistance(MovementInfo const& previous, MovementInfo const& current, float x, float y);
+
+        void Add(Check const& check);
+
+        /**
+         * @brief Process runs the queued checks on the task scheduler, and applies the
+         * results on the calling (map) thread.
+         */
+        void Process(Map* map);
+
+        Stats GetStats() const;
+        void ResetStats();
+
+    private:
+        static void Run(Map const* map, Check& check);
+
+        mutable std::mutex m_lock;
+        std::vector<Check> m_checks;
+        std::vector<Check> m_processing;
+        Stats m_stats;
+};
+
+#endif
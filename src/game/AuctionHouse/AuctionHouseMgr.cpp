@@ -60,6 +60,8 @@ bool AuctionHouseObject::RemoveAuction(AuctionEntry* entry)
         }
     }
 
+    SearchIndex.Remove(entry);
+
     if (AuctionsMap.erase(entry->Id) > 0)
     {
         sObjectMgr.FreeAuctionID(entry->Id);
@@ -74,6 +76,10 @@ void AuctionHouseObject::AddAuction(AuctionEntry* ah)
     AuctionsMap[ah->Id] = ah;
     OrderedAuctionMap.insert(std::pair<uint32, AuctionEntry*>(ah->buyout, ah));
     AccountAuctionMap.insert(std::pair<uint32, AuctionEntry*>(ah->ownerAccount, ah));
+
+    // Auctions without item are never listed
+    if (Item* item = sAuctionMgr.GetAItem(ah->itemGuidLow))
+        SearchIndex.Add(ah, item->GetProto(), item->GetItemRandomPropertyId());
 }
 
 AuctionHouseMgr::AuctionHouseMgr()
@@ -761,13 +767,22 @@ void AuctionHouseObject::BuildListAuctionItems(WorldPacket& data, Player* player
     int loc_idx = player->GetSession()->GetSessionDbLocaleIndex();
     LocaleConstant dbc_loc = player->GetSession()->GetSessionDbcLocale();
 
+    // Only walk the auctions of the most selective index
+    std::vector<AuctionEntry*> candidates;
+    bool nameChecked = false;
+    if (!SearchIndex.GetCandidates(query, loc_idx, dbc_loc, candidates, nameChecked))
+    {
+        candidates.reserve(OrderedAuctionMap.size());
+        for (const auto& itr : OrderedAuctionMap)
+            candidates.push_back(itr.second);
+    }
+
     // Micro opt on name/suffix initialization
     std::string name;
     name.reserve(140);
 
-    for (const auto& itr : OrderedAuctionMap)
+    for (AuctionEntry* auctionEntry : candidates)
     {
-        AuctionEntry* auctionEntry = itr.second;
         Item *item = sAuctionMgr.GetAItem(auctionEntry->itemGuidLow);
         if (!item)
             continue;
@@ -803,7 +818,7 @@ void AuctionHouseObject::BuildListAuctionItems(WorldPacket& data, Player* player
             if (!auctionEntry->IsAvailableFor(player))
                 continue;
 
-            if (!query.wsearchedname.empty())
+            if (!query.wsearchedname.empty() && !nameChecked)
             {
                 name = proto->Name1;
                 if (name.empty())
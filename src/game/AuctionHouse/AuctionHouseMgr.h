@@ -29,6 +29,7 @@
 #include "SharedDefines.h"
 #include "Policies/Singleton.h"
 #include "DBCStructure.h"
+#include "AuctionSearchIndex.h"
 
 class Item;
 class Player;
@@ -147,6 +148,8 @@ class AuctionHouseObject
         AuctionMultiMap OrderedAuctionMap;
         AuctionMultiMap AccountAuctionMap;
         AuctionEntryMap AuctionsMap;
+        // Narrows the filtered searches of BuildListAuctionItems
+        AuctionSearchIndex SearchIndex;
 };
 
 class AuctionHouseMgr
@@ -0,0 +1,331 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "AuctionSearchIndex.h"
+#include "AuctionHouseMgr.h"
+#include "DBCStores.h"
+#include "Item.h"
+#include "ItemPrototype.h"
+#include "ObjectMgr.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+// Below this number of candidates from the other indexes, the name is checked by the caller on each candidate
+static size_t const NAME_INDEX_MIN_CANDIDATES = 256;
+
+static uint64 MakeTrigram(std::wstring const& str, size_t pos)
+{
+    // Unicode code points fit on 21 bits
+    return (uint64(str[pos]) << 42) | (uint64(str[pos + 1]) << 21) | uint64(str[pos + 2]);
+}
+
+void AuctionSearchIndex::Add(AuctionEntry* entry, ItemPrototype const* proto, int32 randomPropertyId)
+{
+    Record record;
+    record.key = OrderKey(entry->buyout, ++m_sequence);
+    record.itemClass = proto->Class;
+    record.subClass = proto->SubClass;
+    record.inventoryType = proto->InventoryType;
+    record.quality = proto->Quality;
+    record.requiredLevel = proto->RequiredLevel;
+
+    uint64 const groupKey = (uint64(proto->ItemId) << 32) | uint32(randomPropertyId);
+    auto groupItr = m_nameGroupIds.find(groupKey);
+    if (groupItr == m_nameGroupIds.end())
+    {
+        record.nameGroup = m_nameGroups.size();
+        m_nameGroups.push_back({ proto->ItemId, randomPropertyId, AuctionSet() });
+        m_nameGroupIds[groupKey] = record.nameGroup;
+
+        // Not concurrent with the searches, no need to lock
+        for (auto const& locale : m_locales)
+            IndexGroupName(*locale.second, record.nameGroup);
+    }
+    else
+        record.nameGroup = groupItr->second;
+
+    m_byClass[record.itemClass][record.key] = entry;
+    m_bySubClass[SubClassKey(record.itemClass, record.subClass)][record.key] = entry;
+    m_byInventoryType[record.inventoryType][record.key] = entry;
+    m_byQuality[record.quality][record.key] = entry;
+    m_byRequiredLevel[record.requiredLevel][record.key] = entry;
+    m_nameGroups[record.nameGroup].auctions[record.key] = entry;
+
+    m_records[entry->Id] = record;
+}
+
+void AuctionSearchIndex::Remove(AuctionEntry const* entry)
+{
+    auto itr = m_records.find(entry->Id);
+    if (itr == m_records.end())
+        return;
+
+    Record const& record = itr->second;
+    Erase(m_byClass, record.itemClass, record.key);
+    Erase(m_bySubClass, SubClassKey(record.itemClass, record.subClass), record.key);
+    Erase(m_byInventoryType, record.inventoryType, record.key);
+    Erase(m_byQuality, record.quality, record.key);
+    Erase(m_byRequiredLevel, record.requiredLevel, record.key);
+    // Name groups are kept, the distinct item names are few
+    m_nameGroups[record.nameGroup].auctions.erase(record.key);
+
+    m_records.erase(itr);
+}
+
+void AuctionSearchIndex::Erase(BucketMap& buckets, uint32 key, OrderKey const& orderKey)
+{
+    auto itr = buckets.find(key);
+    if (itr == buckets.end())
+        return;
+
+    itr->second.erase(orderKey);
+    if (itr->second.empty())
+        buckets.erase(itr);
+}
+
+size_t AuctionSearchIndex::CountBuckets(BucketMap const& buckets, uint32 first, uint32 last)
+{
+    size_t count = 0;
+    for (uint32 key = first; key <= last; ++key)
+    {
+        auto itr = buckets.find(key);
+        if (itr != buckets.end())
+            count += itr->second.size();
+    }
+    return count;
+}
+
+void AuctionSearchIndex::CollectBuckets(BucketMap const& buckets, uint32 first, uint32 last, std::vector<std::pair<OrderKey, AuctionEntry*>>& result)
+{
+    for (uint32 key = first; key <= last; ++key)
+    {
+        auto itr = buckets.find(key);
+        if (itr != buckets.end())
+            result.insert(result.end(), itr->second.begin(), itr->second.end());
+    }
+}
+
+void AuctionSearchIndex::IndexGroupName(LocaleNames& locale, uint32 groupId) const
+{
+    NameGroup const& group = m_nameGroups[groupId];
+    if (locale.names.size() <= groupId)
+        locale.names.resize(groupId + 1);
+
+    ItemPrototype const* proto = sObjectMgr.GetItemPrototype(group.itemId);
+    if (!proto || !proto->Name1 || !*proto->Name1)
+        return;
+
+    ItemRandomPropertiesEntry const* randomProperty = nullptr;
+    if (group.randomPropertyId > 0)
+        randomProperty = sItemRandomPropertiesStore.LookupEntry(static_cast<uint32>(group.randomPropertyId));
+
+    // Same name as the one the client searches in, see the previous full scan of BuildListAuctionItems
+    std::string name = proto->Name1;
+    Item::GetLocalizedNameWithSuffix(name, proto, randomProperty, locale.dbLocale, locale.dbcLocale);
+
+    std::wstring& wname = locale.names[groupId];
+    if (!Utf8toWStr(name, wname))
+    {
+        wname.clear();
+        return;
+    }
+    wstrToLower(wname);
+
+    std::unordered_set<uint64> trigrams;
+    for (size_t i = 0; i + 3 <= wname.size(); ++i)
+        if (trigrams.insert(MakeTrigram(wname, i)).second)
+            locale.trigrams[MakeTrigram(wname, i)].push_back(groupId);
+}
+
+AuctionSearchIndex::LocaleNames const* AuctionSearchIndex::GetLocaleNames(int dbLocale, LocaleConstant dbcLocale)
+{
+    std::lock_guard<std::mutex> guard(m_localeLock);
+
+    std::unique_ptr<LocaleNames>& locale = m_locales[LocaleKey(dbLocale, dbcLocale)];
+    if (!locale)
+    {
+        locale.reset(new LocaleNames());
+        locale->dbLocale = dbLocale;
+        locale->dbcLocale = dbcLocale;
+        locale->names.reserve(m_nameGroups.size());
+        for (uint32 groupId = 0; groupId < m_nameGroups.size(); ++groupId)
+            IndexGroupName(*locale, groupId);
+    }
+
+    return locale.get();
+}
+
+bool AuctionSearchIndex::GetCandidates(AuctionHouseClientQuery const& query, int dbLocale, LocaleConstant dbcLocale,
+    std::vector<AuctionEntry*>& candidates, bool& nameChecked)
+{
+    enum CandidateSource
+    {
+        SOURCE_NONE,
+        SOURCE_CLASS,
+        SOURCE_SUBCLASS,
+        SOURCE_INVENTORY_TYPE,
+        SOURCE_QUALITY,
+        SOURCE_REQUIRED_LEVEL,
+        SOURCE_NAME
+    };
+
+    nameChecked = false;
+
+    CandidateSource source = SOURCE_NONE;
+    size_t best = m_records.size();
+    auto consider = [&source, &best](CandidateSource candidate, size_t count)
+    {
+        if (count < best)
+        {
+            source = candidate;
+            best = count;
+        }
+    };
+
+    uint32 const maxLevel = query.levelmax != 0x00 ? query.levelmax : 0xFF;
+
+    if (query.auctionMainCategory != 0xffffffff)
+    {
+        auto itr = m_byClass.find(query.auctionMainCategory);
+        consider(SOURCE_CLASS, itr != m_byClass.end() ? itr->second.size() : 0);
+
+        if (query.auctionSubCategory != 0xffffffff)
+        {
+            itr = m_bySubClass.find(SubClassKey(query.auctionMainCategory, query.auctionSubCategory));
+            consider(SOURCE_SUBCLASS, itr != m_bySubClass.end() ? itr->second.size() : 0);
+        }
+    }
+
+    if (query.auctionSlotID != 0xffffffff)
+        consider(SOURCE_INVENTORY_TYPE, CountBuckets(m_byInventoryType, query.auctionSlotID, query.auctionSlotID) +
+            (query.auctionSlotID == INVTYPE_CHEST ? CountBuckets(m_byInventoryType, INVTYPE_ROBE, INVTYPE_ROBE) : 0));
+
+    if (query.quality != 0xffffffff && query.quality < MAX_ITEM_QUALITY)
+        consider(SOURCE_QUALITY, CountBuckets(m_byQuality, query.quality, MAX_ITEM_QUALITY - 1));
+
+    if (query.levelmin != 0x00)
+        consider(SOURCE_REQUIRED_LEVEL, query.levelmin <= maxLevel ? CountBuckets(m_byRequiredLevel, query.levelmin, maxLevel) : 0);
+
+    // Name groups matching the searched name, in the name group id order
+    std::vector<uint32> matchingGroups;
+    if (!query.wsearchedname.empty() && best >= NAME_INDEX_MIN_CANDIDATES)
+    {
+        LocaleNames const* locale = GetLocaleNames(dbLocale, dbcLocale);
+        std::wstring const& search = query.wsearchedname;
+
+        auto checkGroup = [&](uint32 groupId)
+        {
+            if (groupId < locale->names.size() && !m_nameGroups[groupId].auctions.empty() &&
+                locale->names[groupId].find(search) != std::wstring::npos)
+                matchingGroups.push_back(groupId);
+        };
+
+        if (search.size() >= 3)
+        {
+            // Rarest trigram of the searched name
+            std::vector<uint32> const* rarest = nullptr;
+            static std::vector<uint32> const noGroup;
+            for (size_t i = 0; i + 3 <= search.size(); ++i)
+            {
+                auto itr = locale->trigrams.find(MakeTrigram(search, i));
+                std::vector<uint32> const* groups = itr != locale->trigrams.end() ? &itr->second : &noGroup;
+                if (!rarest || groups->size() < rarest->size())
+                    rarest = groups;
+            }
+
+            for (uint32 groupId : *rarest)
+                checkGroup(groupId);
+        }
+        else
+        {
+            for (uint32 groupId = 0; groupId < m_nameGroups.size(); ++groupId)
+                checkGroup(groupId);
+        }
+
+        size_t count = 0;
+        for (uint32 groupId : matchingGroups)
+            count += m_nameGroups[groupId].auctions.size();
+
+        // The name index is exact, prefer it on equal counts
+        if (count <= best)
+        {
+            source = SOURCE_NAME;
+            best = count;
+        }
+    }
+
+    if (source == SOURCE_NONE)
+        return false;
+
+    std::vector<std::pair<OrderKey, AuctionEntry*>> result;
+    result.reserve(best);
+
+    switch (source)
+    {
+        case SOURCE_CLASS:
+            CollectBuckets(m_byClass, query.auctionMainCategory, query.auctionMainCategory, result);
+            break;
+        case SOURCE_SUBCLASS:
+        {
+            uint32 const key = SubClassKey(query.auctionMainCategory, query.auctionSubCategory);
+            CollectBuckets(m_bySubClass, key, key, result);
+            break;
+        }
+        case SOURCE_INVENTORY_TYPE:
+            CollectBuckets(m_byInventoryType, query.auctionSlotID, query.auctionSlotID, result);
+            if (query.auctionSlotID == INVTYPE_CHEST)
+                CollectBuckets(m_byInventoryType, INVTYPE_ROBE, INVTYPE_ROBE, result);
+            break;
+        case SOURCE_QUALITY:
+            CollectBuckets(m_byQuality, query.quality, MAX_ITEM_QUALITY - 1, result);
+            break;
+        case SOURCE_REQUIRED_LEVEL:
+            if (query.levelmin <= maxLevel)
+                CollectBuckets(m_byRequiredLevel, query.levelmin, maxLevel, result);
+            break;
+        case SOURCE_NAME:
+            for (uint32 groupId : matchingGroups)
+                result.insert(result.end(), m_nameGroups[groupId].auctions.begin(), m_nameGroups[groupId].auctions.end());
+            nameChecked = true;
+            break;
+        default:
+            break;
+    }
+
+    // Buckets are each in buyout order, several of them have to be merged
+    if (source != SOURCE_CLASS && source != SOURCE_SUBCLASS)
+        std::sort(result.begin(), result.end(), [](std::pair<OrderKey, AuctionEntry*> const& a, std::pair<OrderKey, AuctionEntry*> const& b) { return a.first < b.first; });
+
+    // Candidates of another index can still be filtered by name when it was computed
+    if (!nameChecked && !matchingGroups.empty())
+    {
+        std::unordered_set<uint32> groups(matchingGroups.begin(), matchingGroups.end());
+        result.erase(std::remove_if(result.begin(), result.end(), [this, &groups](std::pair<OrderKey, AuctionEntry*> const& candidate)
+        {
+            auto itr = m_records.find(candidate.second->Id);
+            return itr == m_records.end() || groups.find(itr->second.nameGroup) == groups.end();
+        }), result.end());
+        nameChecked = true;
+    }
+
+    candidates.reserve(candidates.size() + result.size());
+    for (auto const& candidate : result)
+        candidates.push_back(candidate.second);
+
+    return true;
+}
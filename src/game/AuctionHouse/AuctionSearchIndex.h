@@ -0,0 +1,121 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUCTION_SEARCH_INDEX_H
+#define _AUCTION_SEARCH_INDEX_H
+
+#include "Common.h"
+#include "SharedDefines.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct AuctionEntry;
+struct AuctionHouseClientQuery;
+struct ItemPrototype;
+
+/**
+ * @brief Secondary indexes of an auction house, used to narrow CMSG_AUCTION_LIST_ITEMS searches.
+ * Auctions are indexed by item class, subclass, inventory type, quality and
+ * required level, each bucket keeps them in the order of the buyout map. Names
+ * are indexed per (item, random property) group: the lower case localized name
+ * of each group and its trigrams are built the first time a locale searches
+ * by name, then maintained on add / remove.
+ * The candidates are a superset of the matching auctions: the caller still
+ * applies every filter, except the name when nameChecked is set.
+ * Searches can run concurrently with each other (asynchronous tasks), but not
+ * with Add / Remove.
+ */
+class AuctionSearchIndex
+{
+    public:
+        AuctionSearchIndex() : m_sequence(0) {}
+
+        void Add(AuctionEntry* entry, ItemPrototype const* proto, int32 randomPropertyId);
+        void Remove(AuctionEntry const* entry);
+
+        /**
+         * @brief GetCandidates returns false when no index is narrower than the whole auction house.
+         * Otherwise candidates are in buyout order, like AuctionHouseObject::OrderedAuctionMap.
+         */
+        bool GetCandidates(AuctionHouseClientQuery const& query, int dbLocale, LocaleConstant dbcLocale,
+            std::vector<AuctionEntry*>& candidates, bool& nameChecked);
+
+        uint32 GetCount() const { return m_records.size(); }
+
+    private:
+        typedef std::pair<uint32, uint64> OrderKey;         // Buyout, insertion sequence
+        typedef std::map<OrderKey, AuctionEntry*> AuctionSet;
+        typedef std::unordered_map<uint32, AuctionSet> BucketMap;
+
+        struct Record
+        {
+            OrderKey key;
+            uint32 itemClass;
+            uint32 subClass;
+            uint32 inventoryType;
+            uint32 quality;
+            uint32 requiredLevel;
+            uint32 nameGroup;
+        };
+
+        struct NameGroup
+        {
+            uint32 itemId;
+            int32 randomPropertyId;
+            AuctionSet auctions;
+        };
+
+        struct LocaleNames
+        {
+            int dbLocale;
+            LocaleConstant dbcLocale;
+            std::vector<std::wstring> names;                // Lower case name of each group
+            std::unordered_map<uint64, std::vector<uint32>> trigrams;
+        };
+
+        static uint32 SubClassKey(uint32 itemClass, uint32 subClass) { return (itemClass << 16) | subClass; }
+        static uint32 LocaleKey(int dbLocale, LocaleConstant dbcLocale) { return uint32(dbLocale + 1) << 8 | uint32(dbcLocale); }
+
+        void IndexGroupName(LocaleNames& locale, uint32 groupId) const;
+        LocaleNames const* GetLocaleNames(int dbLocale, LocaleConstant dbcLocale);
+
+        static void Erase(BucketMap& buckets, uint32 key, OrderKey const& orderKey);
+        static size_t CountBuckets(BucketMap const& buckets, uint32 first, uint32 last);
+        static void CollectBuckets(BucketMap const& buckets, uint32 first, uint32 last, std::vector<std::pair<OrderKey, AuctionEntry*>>& result);
+
+        uint64 m_sequence;
+        std::unordered_map<uint32, Record> m_records;       // By auction id
+
+        BucketMap m_byClass;
+        BucketMap m_bySubClass;
+        BucketMap m_byInventoryType;
+        BucketMap m_byQuality;
+        BucketMap m_byRequiredLevel;
+
+        std::vector<NameGroup> m_nameGroups;
+        std::unordered_map<uint64, uint32> m_nameGroupIds;  // item id << 32 | random property id
+
+        std::mutex m_localeLock;                            // Locales are built lazily by the searches
+        std::map<uint32, std::unique_ptr<LocaleNames>> m_locales;
+};
+
+#endif
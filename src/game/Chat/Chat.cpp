@@ -293,6 +293,7 @@ ChatCommand * ChatHandler::getCommandTable()
     {
         { "check",          SEC_DEVELOPER,      false, &ChatHandler::HandleDebugLoSCommand,                 "", nullptr },
         { "allow",          SEC_DEVELOPER,      false, &ChatHandler::HandleDebugLoSAllowCommand,            "", nullptr },
+        { "cache",          SEC_GAMEMASTER,     false, &ChatHandler::HandleDebugLoSCacheCommand,            "", nullptr },
         { nullptr,          0,                  false, nullptr,                                             "", nullptr }
     };
 
@@ -361,6 +362,18 @@ ChatCommand * ChatHandler::getCommandTable()
         { "loottable",      SEC_DEVELOPER,      true,  &ChatHandler::HandleDebugLootTableCommand,           "", nullptr },
         { "utf8overflow",   SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugOverflowCommand,            "", nullptr },
         { "chatfreeze",     SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugChatFreezeCommand,          "", nullptr },
+        { "lookupbench",    SEC_CONSOLE,        true,  &ChatHandler::HandleDebugLookupBenchCommand,         "", nullptr },
+        { "threatbench",    SEC_CONSOLE,        true,  &ChatHandler::HandleDebugThreatBenchCommand,         "", nullptr },
+        { "auctionbench",   SEC_CONSOLE,        true,  &ChatHandler::HandleDebugAuctionBenchCommand,        "", nullptr },
+        { "losbench",       SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugLosBenchCommand,            "", nullptr },
+        { "savestats",      SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugSaveStatsCommand,           "", nullptr },
+        { "pathfinding",    SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugPathfindingCommand,         "", nullptr },
+        { "pathcache",      SEC_GAMEMASTER,     false, &ChatHandler::HandleDebugPathCacheCommand,           "", nullptr },
+        { "movementchecks", SEC_GAMEMASTER,     false, &ChatHandler::HandleDebugMovementChecksCommand,      "", nullptr },
+        { "procindex",      SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugProcIndexCommand,           "", nullptr },
+#ifdef ENABLE_ELUNA
+        { "elunalock",      SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugElunaLockCommand,           "", nullptr },
+#endif /* ENABLE_ELUNA */
         {  nullptr,         0,                  false, nullptr,                                             "", nullptr }
     };
 
@@ -736,6 +749,7 @@ ChatCommand * ChatHandler::getCommandTable()
     {
         { "stats",          SEC_ADMINISTRATOR,  true,  &ChatHandler::HandlePBCastStatsCommand,         "", nullptr },
         { "setthreads",     SEC_ADMINISTRATOR,  true,  &ChatHandler::HandlePBCastSetThreadsCommand,    "", nullptr },
+        { "sockets",        SEC_ADMINISTRATOR,  true,  &ChatHandler::HandlePBCastSocketsCommand,       "", nullptr },
         { nullptr,          0,                  false, nullptr,                                        "", nullptr }
     };
 
@@ -978,6 +992,9 @@ ChatCommand * ChatHandler::getCommandTable()
         { "plimit",         SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerPLimitCommand,        "", nullptr },
         { "resetallraids",  SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerResetAllRaidCommand,  "", nullptr },
         { "restart",        SEC_ADMINISTRATOR,  true, nullptr,                                         "", serverRestartCommandTable },
+        { "scheduler",      SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerSchedulerCommand,     "", nullptr },
+        { "profile",        SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerProfileCommand,       "", nullptr },
+        { "database",       SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerDatabaseCommand,      "", nullptr },
         { "shutdown",       SEC_ADMINISTRATOR,  true, nullptr,                                         "", serverShutdownCommandTable },
         { "set",            SEC_ADMINISTRATOR,  true, nullptr,                                         "", serverSetCommandTable },
         { nullptr,          0,                  false, nullptr,                                        "", nullptr }
@@ -330,6 +330,7 @@ class ChatHandler
         // Debug
         bool HandleDebugLoSCommand(char* args);
         bool HandleDebugLoSAllowCommand(char* args);
+        bool HandleDebugLoSCacheCommand(char* args);
         bool HandleDebugAssertFalseCommand(char* args);
         bool HandleDebugPvPCreditCommand(char* args);
         bool HandleDebugMonsterChatCommand(char *args);
@@ -463,6 +464,18 @@ class ChatHandler
         bool HandleDebugSpellModsCommand(char* args);
         bool HandleDebugOverflowCommand(char* args);
         bool HandleDebugChatFreezeCommand(char* args);
+        bool HandleDebugLookupBenchCommand(char* args);
+        bool HandleDebugThreatBenchCommand(char* args);
+        bool HandleDebugAuctionBenchCommand(char* args);
+        bool HandleDebugLosBenchCommand(char* args);
+        bool HandleDebugSaveStatsCommand(char* args);
+        bool HandleDebugPathfindingCommand(char* args);
+        bool HandleDebugPathCacheCommand(char* args);
+        bool HandleDebugMovementChecksCommand(char* args);
+        bool HandleDebugProcIndexCommand(char* args);
+#ifdef ENABLE_ELUNA
+        bool HandleDebugElunaLockCommand(char* args);
+#endif /* ENABLE_ELUNA */
 
         bool HandleDebugPlayCinematicCommand(char* args);
         bool HandleDebugPlaySoundCommand(char* args);
@@ -569,6 +582,7 @@ class ChatHandler
         bool HandleInstanceBindingMode(char* args);
         bool HandlePBCastStatsCommand(char* args);
         bool HandlePBCastSetThreadsCommand(char* args);
+        bool HandlePBCastSocketsCommand(char* args);
 
         bool HandleLearnCommand(char* args);
         bool HandleLearnAllCommand(char* args);
@@ -870,6 +884,9 @@ class ChatHandler
         bool HandleServerMotdCommand(char* args);
         bool HandleServerPLimitCommand(char* args);
         bool HandleServerResetAllRaidCommand(char* args);
+        bool HandleServerSchedulerCommand(char* args);
+        bool HandleServerProfileCommand(char* args);
+        bool HandleServerDatabaseCommand(char* args);
         bool HandleServerRestartCommand(char* args);
         bool HandleServerSetMotdCommand(char* args);
         bool HandleServerShutDownCommand(char* args);
@@ -31,6 +31,8 @@
 #include "Language.h"
 #include "BattleGroundMgr.h"
 #include <fstream>
+#include <shared_mutex>
+#include <thread>
 #include "ObjectMgr.h"
 #include "ObjectGuid.h"
 #include "SpellMgr.h"
@@ -41,6 +43,7 @@
  // VMAPS
 #include "VMapFactory.h"
 #include "ModelInstance.h"
+#include "BIH.h"                                            // for the ray packet size
  // MMAPS
 #include "MoveMap.h"                                        // for mmap manager
 #include "PathFinder.h"                                     // for mmap commands
@@ -49,6 +52,14 @@
 #include "CellImpl.h"
 #include "MoveSplineInit.h"
 #include "MoveSpline.h"
+#include "Multithreading/ShardedReadMap.h"
+#include "AuctionHouseMgr.h"
+#include "PlayerSaveScheduler.h"
+#include "MapManager.h"
+#include "PathfindingService.h"
+#ifdef ENABLE_ELUNA
+#include "LuaEngine.h"
+#endif /* ENABLE_ELUNA */
 
 bool ChatHandler::HandleSpellIconFixCommand(char *args)
 {
@@ -1692,6 +1703,9 @@ bool ChatHandler::HandleDebugLoSAllowCommand(char* args)
             spawn->flags &= ~VMAP::MOD_NO_BREAK_LOS;
             PSendSysMessage("'%s' will break LOS.", spawn->name.c_str());
         }
+        // The model is shared by all the instances of the map
+        auto clearCache = [](Map* map) { map->ClearQueryCache(); };
+        sMapMgr.DoForAllMapsWithMapId(m_session->GetPlayer()->GetMapId(), clearCache);
         if (FILE* f = fopen("los_mods", "a"))
         {
             fprintf(f, "%u %u %s\n", !value, spawn->ID, spawn->name.c_str());
@@ -1703,6 +1717,35 @@ bool ChatHandler::HandleDebugLoSAllowCommand(char* args)
     return true;
 }
 
+// Hit rates of the line of sight and height cache of the current map, to tune Map.QueryCache.Grid
+bool ChatHandler::HandleDebugLoSCacheCommand(char* args)
+{
+    Map* map = m_session->GetPlayer()->GetMap();
+    if (args && strcmp(args, "reset") == 0)
+    {
+        map->ResetQueryCacheStats();
+        SendSysMessage("Query cache counters reset.");
+        return true;
+    }
+
+    if (!sWorld.getConfig(CONFIG_UINT32_MAP_QUERY_CACHE_SIZE))
+        SendSysMessage("Query cache is disabled (Map.QueryCache.Size).");
+
+    MapQueryCache::Stats const stats = map->GetQueryCacheStats();
+    PSendSysMessage("Query cache of map %u instance %u: %u / %u entries, grid %.2f yards, " UI64FMTD " evictions",
+        map->GetId(), map->GetInstanceId(), stats.size, stats.capacity, sWorld.getConfig(CONFIG_FLOAT_MAP_QUERY_CACHE_GRID), stats.evictions);
+
+    char const* names[MAX_MAP_QUERY_TYPE] = { "Line of sight", "Height" };
+    for (uint8 i = 0; i < MAX_MAP_QUERY_TYPE; ++i)
+    {
+        uint64 const total = stats.hits[i] + stats.misses[i];
+        PSendSysMessage("  %s: " UI64FMTD " hits, " UI64FMTD " misses (%.1f%% hits)", names[i], stats.hits[i], stats.misses[i],
+            total ? 100.0 * stats.hits[i] / total : 0.0);
+    }
+    PSendSysMessage("  Hits computed again after a door / transport change: " UI64FMTD, stats.dynamicRefreshes);
+    return true;
+}
+
 bool ChatHandler::HandleSendSpellVisualCommand(char *args)
 {
     Unit* pTarget = GetSelectedUnit();
@@ -1795,6 +1838,621 @@ bool ChatHandler::HandleDebugOverflowCommand(char* args)
     return true;
 }
 
+// Compares the lookups of the shared_timed_mutex map HashMapHolder used to rely on with the lock free ShardedReadMap,
+// N reader threads look up random guids while a writer inserts and removes an object every millisecond
+bool ChatHandler::HandleDebugLookupBenchCommand(char* args)
+{
+    uint32 threads, durationMs;
+    if (!ExtractOptUInt32(&args, threads, 4) || !ExtractOptUInt32(&args, durationMs, 1000))
+        return false;
+
+    threads = std::min(std::max(threads, 1u), 64u);
+    durationMs = std::min(std::max(durationMs, 100u), 10000u);
+
+    uint32 const objectCount = 2000;
+
+    std::unordered_map<ObjectGuid, void*> lockedMap;
+    std::shared_timed_mutex lock;
+    ShardedReadMap<ObjectGuid, void*> shardedMap;
+    for (uint32 i = 1; i <= objectCount; ++i)
+    {
+        ObjectGuid const guid(HIGHGUID_PLAYER, i);
+        lockedMap[guid] = &lockedMap;
+        shardedMap.Insert(guid, &lockedMap);
+    }
+
+    auto run = [&](std::function<bool(ObjectGuid)> const& find, std::function<void(ObjectGuid, bool)> const& write)
+    {
+        std::atomic<bool> stop(false);
+        std::atomic<uint64> lookups(0);
+        std::vector<std::thread> readers;
+        for (uint32 t = 0; t < threads; ++t)
+        {
+            readers.emplace_back([&, t]()
+            {
+                uint32 seed = 2166136261u ^ t;
+                uint64 count = 0;
+                while (!stop.load(std::memory_order_relaxed))
+                {
+                    for (uint32 i = 0; i < 256; ++i)
+                    {
+                        seed = seed * 1664525u + 1013904223u;
+                        find(ObjectGuid(HIGHGUID_PLAYER, seed % (objectCount + 100) + 1));
+                    }
+                    count += 256;
+                }
+                lookups += count;
+            });
+        }
+
+        std::chrono::steady_clock::time_point const end = std::chrono::steady_clock::now() + std::chrono::milliseconds(durationMs);
+        for (uint32 i = 0; std::chrono::steady_clock::now() < end; ++i)
+        {
+            write(ObjectGuid(HIGHGUID_PLAYER, objectCount + 1 + i % 100), (i / 100) % 2 == 0);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        stop = true;
+        for (auto& reader : readers)
+            reader.join();
+
+        return lookups.load() * 1000 / durationMs;
+    };
+
+    uint64 const lockedRate = run([&](ObjectGuid guid)
+    {
+        std::shared_lock<std::shared_timed_mutex> guard(lock);
+        return lockedMap.find(guid) != lockedMap.end();
+    }, [&](ObjectGuid guid, bool insert)
+    {
+        std::unique_lock<std::shared_timed_mutex> guard(lock);
+        if (insert)
+            lockedMap[guid] = &lockedMap;
+        else
+            lockedMap.erase(guid);
+    });
+
+    uint64 const shardedRate = run([&](ObjectGuid guid)
+    {
+        void* object;
+        return shardedMap.Find(guid, object);
+    }, [&](ObjectGuid guid, bool insert)
+    {
+        if (insert)
+            shardedMap.Insert(guid, &lockedMap);
+        else
+            shardedMap.Erase(guid);
+    });
+
+    PSendSysMessage("Lookups of %u objects, %u reader threads, %u ms:", objectCount, threads, durationMs);
+    PSendSysMessage("  shared_timed_mutex map: " UI64FMTD " lookups/s", lockedRate);
+    PSendSysMessage("  sharded read map:       " UI64FMTD " lookups/s (x%.2f)", shardedRate, lockedRate ? double(shardedRate) / lockedRate : 0.0);
+    PSendSysMessage("  objects waiting for reclamation: %u", sEpochReclaimer.GetPendingCount());
+    return true;
+}
+
+// Simulates a raid boss threat list: every hit looks up the attacker by guid and changes its threat,
+// the victim is selected every 10 hits. Compares the previous std::list storage (full sort when dirty)
+// with the contiguous storage of ThreatContainer (guid array scan, insertion sort when dirty)
+bool ChatHandler::HandleDebugThreatBenchCommand(char* args)
+{
+    uint32 attackers, hits;
+    if (!ExtractOptUInt32(&args, attackers, 40) || !ExtractOptUInt32(&args, hits, 1000000))
+        return false;
+
+    attackers = std::min(std::max(attackers, 1u), 1000u);
+    hits = std::min(std::max(hits, 1000u), 100000000u);
+
+    struct BenchRef
+    {
+        ObjectGuid guid;
+        float threat;
+        char padding[96];                                   // HostileReference is about this size
+    };
+
+    // Interleave the references with other allocations, like in a running server
+    std::vector<std::unique_ptr<BenchRef>> refs;
+    std::vector<std::unique_ptr<char[]>> noise;
+    for (uint32 i = 0; i < attackers; ++i)
+    {
+        refs.emplace_back(new BenchRef());
+        refs.back()->guid = ObjectGuid(HIGHGUID_PLAYER, i + 1);
+        refs.back()->threat = float(urand(0, 1000));
+        noise.emplace_back(new char[urand(64, 512)]);
+    }
+
+    std::vector<uint32> hitOrder(4096);
+    std::vector<float> hitThreat(4096);
+    for (uint32 i = 0; i < hitOrder.size(); ++i)
+    {
+        hitOrder[i] = urand(0, attackers - 1);
+        hitThreat[i] = float(urand(1, 3000));
+    }
+
+    auto byThreat = [](BenchRef const* lhs, BenchRef const* rhs) { return lhs->threat > rhs->threat; };
+    uintptr_t checksum = 0;
+
+    std::list<BenchRef*> oldList;
+    for (auto& ref : refs)
+        oldList.push_back(ref.get());
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool dirty = false;
+    for (uint32 i = 0; i < hits; ++i)
+    {
+        ObjectGuid const guid(HIGHGUID_PLAYER, hitOrder[i & 4095] + 1);
+        for (BenchRef* ref : oldList)
+        {
+            if (ref->guid == guid)
+            {
+                ref->threat += hitThreat[i & 4095];
+                dirty = true;
+                break;
+            }
+        }
+
+        if (i % 10 == 0)
+        {
+            if (dirty)
+                oldList.sort(byThreat);
+            dirty = false;
+            checksum += uintptr_t(oldList.front());
+        }
+    }
+    uint64 const oldNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    for (uint32 i = 0; i < attackers; ++i)
+        refs[i]->threat = 0.0f;
+
+    std::vector<BenchRef*> newList;
+    std::vector<ObjectGuid> newGuids;
+    for (auto& ref : refs)
+    {
+        newList.push_back(ref.get());
+        newGuids.push_back(ref->guid);
+    }
+
+    start = std::chrono::steady_clock::now();
+    dirty = false;
+    for (uint32 i = 0; i < hits; ++i)
+    {
+        ObjectGuid const guid(HIGHGUID_PLAYER, hitOrder[i & 4095] + 1);
+        for (size_t j = 0; j < newGuids.size(); ++j)
+        {
+            if (newGuids[j] == guid)
+            {
+                newList[j]->threat += hitThreat[i & 4095];
+                dirty = true;
+                break;
+            }
+        }
+
+        if (i % 10 == 0)
+        {
+            if (dirty)
+            {
+                for (size_t j = 1; j < newList.size(); ++j)
+                {
+                    BenchRef* ref = newList[j];
+                    ObjectGuid const refGuid = newGuids[j];
+                    size_t k = j;
+                    for (; k > 0 && newList[k - 1]->threat < ref->threat; --k)
+                    {
+                        newList[k] = newList[k - 1];
+                        newGuids[k] = newGuids[k - 1];
+                    }
+                    newList[k] = ref;
+                    newGuids[k] = refGuid;
+                }
+            }
+            dirty = false;
+            checksum += uintptr_t(newList.front());
+        }
+    }
+    uint64 const newNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    PSendSysMessage("Threat list of %u attackers, %u hits (victim selected every 10 hits, checksum %u):", attackers, hits, uint32(checksum & 0xFF));
+    PSendSysMessage("  std::list storage:  %.1f ns/hit", double(oldNs) / hits);
+    PSendSysMessage("  contiguous storage: %.1f ns/hit (x%.2f)", double(newNs) / hits, newNs ? double(oldNs) / newNs : 0.0);
+    return true;
+}
+
+// Replays a mix of client searches against a synthetic auction house, with the previous full scan
+// of BuildListAuctionItems and with the AuctionSearchIndex candidates
+bool ChatHandler::HandleDebugAuctionBenchCommand(char* args)
+{
+    uint32 auctionCount, queryCount;
+    if (!ExtractOptUInt32(&args, auctionCount, 50000) || !ExtractOptUInt32(&args, queryCount, 1000))
+        return false;
+
+    auctionCount = std::min(std::max(auctionCount, 100u), 500000u);
+    queryCount = std::min(std::max(queryCount, 10u), 100000u);
+
+    std::vector<ItemPrototype const*> protos;
+    for (auto const& itr : sObjectMgr.GetItemPrototypeMap())
+        if (itr.second.Name1 && *itr.second.Name1 && itr.second.Quality > ITEM_QUALITY_POOR)
+            protos.push_back(&itr.second);
+
+    if (protos.empty())
+        return false;
+
+    struct BenchAuction
+    {
+        AuctionEntry entry;
+        ItemPrototype const* proto;
+        int32 randomPropertyId;
+    };
+
+    std::vector<std::unique_ptr<BenchAuction>> auctions;
+    std::multimap<uint32, BenchAuction*> byBuyout;
+    AuctionSearchIndex index;
+    for (uint32 i = 0; i < auctionCount; ++i)
+    {
+        // A few popular items (trade goods) and a long tail, like a real auction house
+        ItemPrototype const* proto = protos[urand(0, 3) ? urand(0, std::min<uint32>(protos.size(), 500) - 1) : urand(0, protos.size() - 1)];
+        auctions.emplace_back(new BenchAuction());
+        BenchAuction& auction = *auctions.back();
+        auction.entry.Id = i + 1;
+        auction.entry.itemTemplate = proto->ItemId;
+        auction.entry.buyout = urand(1, 1000000);
+        auction.proto = proto;
+        auction.randomPropertyId = proto->RandomProperty && urand(0, 1) ? int32(urand(1, 2000)) : 0;
+        if (auction.randomPropertyId && !sItemRandomPropertiesStore.LookupEntry(auction.randomPropertyId))
+            auction.randomPropertyId = 0;
+
+        byBuyout.insert(std::make_pair(auction.entry.buyout, &auction));
+        index.Add(&auction.entry, proto, auction.randomPropertyId);
+    }
+
+    int const locIdx = GetSessionDbLocaleIndex();
+    LocaleConstant const dbcLoc = m_session ? m_session->GetSessionDbcLocale() : sWorld.GetDefaultDbcLocale();
+
+    std::vector<AuctionHouseClientQuery> queries(queryCount);
+    for (auto& query : queries)
+    {
+        query.levelmin = query.levelmax = 0;
+        query.usable = 0;
+        query.listfrom = 0;
+        query.auctionSlotID = query.auctionMainCategory = query.auctionSubCategory = query.quality = 0xffffffff;
+
+        ItemPrototype const* proto = auctions[urand(0, auctions.size() - 1)]->proto;
+        uint32 const type = urand(0, 9);
+        if (type < 4 || type == 9)
+        {
+            // Part of a word of an existing item name
+            std::wstring wname;
+            if (Utf8toWStr(proto->Name1, wname) && !wname.empty())
+            {
+                wstrToLower(wname);
+                size_t const length = std::min<size_t>(wname.size(), urand(3, 8));
+                query.wsearchedname = wname.substr(urand(0, wname.size() - length), length);
+            }
+        }
+        if (type >= 4)
+        {
+            query.auctionMainCategory = proto->Class;
+            if (type >= 5)
+                query.auctionSubCategory = proto->SubClass;
+        }
+        if (type == 6)
+            query.quality = urand(ITEM_QUALITY_NORMAL, ITEM_QUALITY_EPIC);
+        if (type == 7)
+        {
+            query.auctionMainCategory = query.auctionSubCategory = 0xffffffff;
+            query.auctionSlotID = proto->InventoryType;
+        }
+        if (type == 8)
+        {
+            query.levelmin = urand(1, 50);
+            query.levelmax = query.levelmin + 10;
+        }
+    }
+
+    auto matches = [locIdx, dbcLoc](AuctionHouseClientQuery const& query, ItemPrototype const* proto, int32 randomPropertyId, bool checkName, std::string& name)
+    {
+        if (query.auctionMainCategory != 0xffffffff && proto->Class != query.auctionMainCategory)
+            return false;
+        if (query.auctionSubCategory != 0xffffffff && proto->SubClass != query.auctionSubCategory)
+            return false;
+        if (query.auctionSlotID != 0xffffffff && proto->InventoryType != query.auctionSlotID &&
+                (query.auctionSlotID != INVTYPE_CHEST || proto->InventoryType != INVTYPE_ROBE))
+            return false;
+        if (query.quality != 0xffffffff && proto->Quality < query.quality)
+            return false;
+        if (query.levelmin != 0x00 && (proto->RequiredLevel < query.levelmin || (query.levelmax != 0x00 && proto->RequiredLevel > query.levelmax)))
+            return false;
+
+        if (checkName && !query.wsearchedname.empty())
+        {
+            name = proto->Name1;
+            ItemRandomPropertiesEntry const* randomProperty = randomPropertyId > 0 ? sItemRandomPropertiesStore.LookupEntry(randomPropertyId) : nullptr;
+            Item::GetLocalizedNameWithSuffix(name, proto, randomProperty, locIdx, dbcLoc);
+            if (!Utf8FitTo(name, query.wsearchedname))
+                return false;
+        }
+        return true;
+    };
+
+    std::string name;
+    name.reserve(140);
+    std::vector<uint32> scanResults(queries.size(), 0);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries.size(); ++i)
+        for (auto const& itr : byBuyout)
+            if (matches(queries[i], itr.second->proto, itr.second->randomPropertyId, true, name))
+                ++scanResults[i];
+    uint64 const scanUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    // The first name search of a locale builds its name index, not part of the steady state
+    {
+        AuctionHouseClientQuery warmup = queries.front();
+        warmup.wsearchedname = L"warmup";
+        std::vector<AuctionEntry*> candidates;
+        bool nameChecked;
+        index.GetCandidates(warmup, locIdx, dbcLoc, candidates, nameChecked);
+    }
+
+    uint32 mismatches = 0;
+    uint64 candidateCount = 0;
+    std::vector<AuctionEntry*> candidates;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries.size(); ++i)
+    {
+        uint32 results = 0;
+        bool nameChecked = false;
+        candidates.clear();
+        if (index.GetCandidates(queries[i], locIdx, dbcLoc, candidates, nameChecked))
+        {
+            candidateCount += candidates.size();
+            for (AuctionEntry* entry : candidates)
+            {
+                BenchAuction const* auction = auctions[entry->Id - 1].get();
+                if (matches(queries[i], auction->proto, auction->randomPropertyId, !nameChecked, name))
+                    ++results;
+            }
+        }
+        else
+        {
+            candidateCount += byBuyout.size();
+            for (auto const& itr : byBuyout)
+                if (matches(queries[i], itr.second->proto, itr.second->randomPropertyId, true, name))
+                    ++results;
+        }
+
+        if (results != scanResults[i])
+            ++mismatches;
+    }
+    uint64 const indexUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    PSendSysMessage("%u auctions, %u searches (name, category, slot, quality, level mix):", auctionCount, queryCount);
+    PSendSysMessage("  full scan: %.1f us/search", double(scanUs) / queryCount);
+    PSendSysMessage("  indexed:   %.1f us/search (x%.2f), %.0f candidates/search", double(indexUs) / queryCount,
+        indexUs ? double(scanUs) / indexUs : 0.0, double(candidateCount) / queryCount);
+    PSendSysMessage("  searches with different results: %u", mismatches);
+    return true;
+}
+
+// Line of sight of area spells cast at the player position, segment by segment and as ray packets
+bool ChatHandler::HandleDebugLosBenchCommand(char* args)
+{
+    uint32 castCount, targetCount, radius;
+    if (!ExtractOptUInt32(&args, castCount, 1000) || !ExtractOptUInt32(&args, targetCount, 20) || !ExtractOptUInt32(&args, radius, 30))
+        return false;
+
+    castCount = std::min(std::max(castCount, 1u), 100000u);
+    targetCount = std::min(std::max(targetCount, 1u), 256u);
+    radius = std::min(std::max(radius, 1u), 100u);
+
+    Player* player = m_session->GetPlayer();
+    Map const* map = player->GetMap();
+
+    // Targets on the ground around a random point in range, the segments end at the caster
+    std::vector<VMAP::LineOfSightQuery> queries(castCount * targetCount);
+    for (uint32 i = 0; i < castCount; ++i)
+    {
+        float const centerX = player->GetPositionX() + frand(-float(radius), float(radius));
+        float const centerY = player->GetPositionY() + frand(-float(radius), float(radius));
+        for (uint32 j = 0; j < targetCount; ++j)
+        {
+            VMAP::LineOfSightQuery& query = queries[i * targetCount + j];
+            query.x1 = centerX + frand(-10.0f, 10.0f);
+            query.y1 = centerY + frand(-10.0f, 10.0f);
+            query.z1 = map->GetHeight(query.x1, query.y1, player->GetPositionZ() + 10.0f);
+            if (query.z1 <= INVALID_HEIGHT)
+                query.z1 = player->GetPositionZ();
+            query.z1 += 2.0f;
+            query.x2 = player->GetPositionX();
+            query.y2 = player->GetPositionY();
+            query.z2 = player->GetPositionZ() + player->GetCollisionHeight();
+            query.result = true;
+        }
+    }
+
+    std::vector<bool> expected(queries.size());
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32 i = 0; i < queries.size(); ++i)
+    {
+        VMAP::LineOfSightQuery const& query = queries[i];
+        expected[i] = map->isInLineOfSight(query.x1, query.y1, query.z1, query.x2, query.y2, query.z2);
+    }
+    uint64 const singleUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (uint32 i = 0; i < castCount; ++i)
+        map->isInLineOfSight(&queries[i * targetCount], targetCount);
+    uint64 const batchUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    uint32 visible = 0;
+    uint32 mismatches = 0;
+    for (uint32 i = 0; i < queries.size(); ++i)
+    {
+        visible += expected[i];
+        mismatches += expected[i] != queries[i].result;
+    }
+
+    PSendSysMessage("%u casts of %u targets within %u yards on map %u, %u of %u segments in line of sight:",
+        castCount, targetCount, radius, map->GetId(), visible, uint32(queries.size()));
+    PSendSysMessage("  one at a time: %.2f us/segment", double(singleUs) / queries.size());
+    PSendSysMessage("  %u-ray packets: %.2f us/segment (x%.2f)", BIHPacket::SIZE, double(batchUs) / queries.size(),
+        batchUs ? double(singleUs) / batchUs : 0.0);
+    PSendSysMessage("  segments with different results: %u", mismatches);
+    return true;
+}
+
+// Statements and bytes written by Player::SaveToDB, to measure the autosave load on the character database
+bool ChatHandler::HandleDebugSaveStatsCommand(char* args)
+{
+    if (args && strcmp(args, "reset") == 0)
+    {
+        Player::ResetSaveStats();
+        sPlayerSaveScheduler.ResetStats();
+        SendSysMessage("Player save counters reset.");
+        return true;
+    }
+
+    Player::SaveStats const stats = Player::GetSaveStats();
+    PSendSysMessage("Player saves: " UI64FMTD ", " UI64FMTD " statements (%.1f per save), " UI64FMTD " KB (%.1f bytes per save)",
+        stats.saves, stats.statements, stats.saves ? double(stats.statements) / stats.saves : 0.0,
+        stats.bytes / 1024, stats.saves ? double(stats.bytes) / stats.saves : 0.0);
+
+    PlayerSaveScheduler::Stats const scheduler = sPlayerSaveScheduler.GetStats();
+    PSendSysMessage("Autosave backlog: %u players (max %u), last tick %u saves (max %u), " UI64FMTD " slots granted, " UI64FMTD " expired",
+        scheduler.backlog, scheduler.maxBacklog, scheduler.lastTickGranted, scheduler.maxTickGranted, scheduler.granted, scheduler.expired);
+
+    if (Player* player = GetSelectedPlayer())
+        PSendSysMessage("Last save of %s: %u statements, " UI64FMTD " bytes", player->GetName(), player->GetLastSaveStatements(), player->GetLastSaveBytes());
+    return true;
+}
+
+// Queue latency and throughput of the pathfinding workers, to tune Pathfinding.AsyncThreads
+bool ChatHandler::HandleDebugPathfindingCommand(char* args)
+{
+    if (args && strcmp(args, "reset") == 0)
+    {
+        sPathfindingService.ResetStats();
+        SendSysMessage("Pathfinding counters reset.");
+        return true;
+    }
+
+    if (!sPathfindingService.IsEnabled())
+    {
+        SendSysMessage("Paths are computed by the map updates (Pathfinding.AsyncThreads = 0).");
+        return true;
+    }
+
+    PathfindingService::Stats const stats = sPathfindingService.GetStats();
+    PSendSysMessage("Pathfinding: %u threads, %u queued (max %u), %.1f paths per second",
+        stats.threads, stats.queueSize, stats.maxQueueSize, stats.elapsedSeconds > 0.0 ? stats.completed / stats.elapsedSeconds : 0.0);
+    PSendSysMessage("  Requests: " UI64FMTD " submitted, " UI64FMTD " shared with another unit (%.1f%%), " UI64FMTD " computed, " UI64FMTD " canceled",
+        stats.submitted, stats.deduplicated, stats.submitted ? 100.0 * stats.deduplicated / stats.submitted : 0.0, stats.completed, stats.canceled);
+    PSendSysMessage("  Queue latency: %.3f ms average, %.3f ms max",
+        stats.started ? stats.totalQueueTime / 1000.0 / stats.started : 0.0, stats.maxQueueTime / 1000.0);
+    PSendSysMessage("  Path computation: %.3f ms average, %.3f ms max",
+        stats.completed ? stats.totalComputeTime / 1000.0 / stats.completed : 0.0, stats.maxComputeTime / 1000.0);
+    return true;
+}
+
+// Hit rates of the Detour path cache of the current map, to tune Map.PathCache.Size
+bool ChatHandler::HandleDebugPathCacheCommand(char* args)
+{
+    Map* map = m_session->GetPlayer()->GetMap();
+    if (args && strcmp(args, "reset") == 0)
+    {
+        map->ResetPathCacheStats();
+        SendSysMessage("Path cache counters reset.");
+        return true;
+    }
+
+    if (!sWorld.getConfig(CONFIG_UINT32_MAP_PATH_CACHE_SIZE))
+        SendSysMessage("Path cache is disabled (Map.PathCache.Size).");
+
+    MapPathCache::Stats const stats = map->GetPathCacheStats();
+    uint64 const corridors = stats.corridorHits + stats.corridorMisses;
+    uint64 const points = stats.pointHits + stats.pointMisses;
+    PSendSysMessage("Path cache of map %u instance %u: %u / %u paths, " UI64FMTD " evictions, " UI64FMTD " dropped after a tile change",
+        map->GetId(), map->GetInstanceId(), stats.size, stats.capacity, stats.evictions, stats.stale);
+    PSendSysMessage("  Corridors: " UI64FMTD " hits, " UI64FMTD " misses (%.1f%% hits)",
+        stats.corridorHits, stats.corridorMisses, corridors ? 100.0 * stats.corridorHits / corridors : 0.0);
+    PSendSysMessage("  Point paths: " UI64FMTD " hits, " UI64FMTD " misses (%.1f%% hits)",
+        stats.pointHits, stats.pointMisses, points ? 100.0 * stats.pointHits / points : 0.0);
+    return true;
+}
+
+// Batched anticheat speed checks of the current map, see Anticheat.AsyncChecks
+bool ChatHandler::HandleDebugMovementChecksCommand(char* args)
+{
+    Map* map = m_session->GetPlayer()->GetMap();
+    if (args && strcmp(args, "reset") == 0)
+    {
+        map->GetMovementCheckBatch().ResetStats();
+        SendSysMessage("Movement check counters reset.");
+        return true;
+    }
+
+    if (!sWorld.getConfig(CONFIG_BOOL_AC_MOVEMENT_ASYNC_CHECKS))
+        SendSysMessage("Asynchronous movement checks are disabled (Anticheat.AsyncChecks).");
+
+    MovementCheckBatch::Stats const stats = map->GetMovementCheckBatch().GetStats();
+    PSendSysMessage("Movement checks of map %u instance %u: " UI64FMTD " checks in " UI64FMTD " batches (max %u per batch)",
+        map->GetId(), map->GetInstanceId(), stats.checks, stats.batches, stats.maxBatchSize);
+    PSendSysMessage("  Batch time: %.1f us avg, " UI64FMTD " us max",
+        stats.batches ? double(stats.totalUs) / stats.batches : 0.0, stats.maxUs);
+    PSendSysMessage("  Overspeeds: " UI64FMTD ", " UI64FMTD " dropped (player gone)", stats.overspeeds, stats.dropped);
+    return true;
+}
+
+// Auras checked by the proc system with the per unit proc index, against all the auras of the units
+bool ChatHandler::HandleDebugProcIndexCommand(char* args)
+{
+    if (args && strcmp(args, "reset") == 0)
+    {
+        Unit::ResetProcIndexStats();
+        SendSysMessage("Proc index counters reset.");
+        return true;
+    }
+
+    Unit::ProcIndexStats const stats = Unit::GetProcIndexStats();
+    PSendSysMessage("Proc passes: " UI64FMTD ", " UI64FMTD " auras on the units (%.1f per pass)",
+        stats.passes, stats.holders, stats.passes ? double(stats.holders) / stats.passes : 0.0);
+    PSendSysMessage("  Visited: " UI64FMTD " (%.1f per pass, %.1f%% of the auras)",
+        stats.visited, stats.passes ? double(stats.visited) / stats.passes : 0.0, stats.holders ? 100.0 * stats.visited / stats.holders : 0.0);
+    PSendSysMessage("  Fired: " UI64FMTD " (%.1f%% of the visited auras)",
+        stats.fired, stats.visited ? 100.0 * stats.fired / stats.visited : 0.0);
+    return true;
+}
+
+#ifdef ENABLE_ELUNA
+// Contention of the Lua state locks, to compare Eluna.PerMapStates against the single world state
+bool ChatHandler::HandleDebugElunaLockCommand(char* args)
+{
+    if (args && strcmp(args, "reset") == 0)
+    {
+        Eluna::ResetLockCounters();
+        SendSysMessage("Eluna lock counters reset.");
+        return true;
+    }
+
+    ElunaLock::Counters world;
+    ElunaLock::Counters maps;
+    uint32 mapStateCount;
+    Eluna::GetLockCounters(world, maps, mapStateCount);
+
+    auto show = [this](char const* name, ElunaLock::Counters const& counters)
+    {
+        PSendSysMessage("%s: " UI64FMTD " locks, " UI64FMTD " contended (%.2f%%), waited " UI64FMTD " ms (%.1f us/contended lock)",
+            name, counters.acquisitions, counters.contended,
+            counters.acquisitions ? 100.0 * counters.contended / counters.acquisitions : 0.0,
+            counters.waitUs / 1000, counters.contended ? double(counters.waitUs) / counters.contended : 0.0);
+    };
+
+    PSendSysMessage("Eluna per map states: %s, %u map states", Eluna::IsPerMapStates() ? "enabled" : "disabled", mapStateCount);
+    show("World state", world);
+    if (Eluna::IsPerMapStates())
+        show("Map states", maps);
+    return true;
+}
+#endif /* ENABLE_ELUNA */
+
 bool ChatHandler::HandleDebugLootTableCommand(char* args)
 {
     std::stringstream in(args);
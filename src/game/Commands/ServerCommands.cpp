@@ -38,6 +38,8 @@
 #include "CharacterDatabaseCache.h"
 #include "AuraRemovalMgr.h"
 #include "AutoBroadCastMgr.h"
+#include "MapTickProfiler.h"
+#include "Multithreading/TaskScheduler.h"
 #include "SpellModMgr.h"
 #include "CreatureGroups.h"
 
@@ -312,6 +314,147 @@ bool ChatHandler::HandleServerInfoCommand(char* /*args*/)
     return true;
 }
 
+// Display queue depth and steal counts of the map update scheduler, 'reset' clears the counters
+bool ChatHandler::HandleServerSchedulerCommand(char* args)
+{
+    if (!sTaskScheduler.IsRunning())
+    {
+        SendSysMessage("Task scheduler is not running.");
+        return true;
+    }
+
+    if (char* param = ExtractLiteralArg(&args))
+    {
+        if (strncmp(param, "reset", strlen(param)) != 0)
+            return false;
+
+        sTaskScheduler.ResetStats();
+        SendSysMessage("Task scheduler statistics reset.");
+        return true;
+    }
+
+    PSendSysMessage("Task scheduler: %u workers", sTaskScheduler.GetWorkerCount());
+    for (uint8 i = 0; i < MAX_TASK_PHASE; ++i)
+    {
+        TaskScheduler::PhaseStats stats = sTaskScheduler.GetStats(TaskPhase(i));
+        if (!stats.submitted)
+            continue;
+
+        PSendSysMessage("%-14s queued %4u (peak %5u) | tasks " UI64FMTD " | stolen " UI64FMTD " | helped " UI64FMTD,
+            GetTaskPhaseName(TaskPhase(i)), uint32(stats.queued), uint32(stats.peakQueued),
+            stats.submitted, stats.stolen, stats.helped);
+    }
+    return true;
+}
+
+// Display the map tick profile: all maps, or every phase of one map
+bool ChatHandler::HandleServerProfileCommand(char* args)
+{
+    uint32 mapId = 0;
+    bool singleMap = false;
+    if (ExtractUInt32(&args, mapId))
+        singleMap = true;
+    else if (char* param = ExtractLiteralArg(&args))
+    {
+        if (strncmp(param, "reset", strlen(param)) != 0)
+            return false;
+
+        sMapTickProfiler.Reset();
+        SendSysMessage("Map tick profile reset.");
+        return true;
+    }
+
+    if (!sMapTickProfiler.IsEnabled())
+        SendSysMessage("Map tick profiler is disabled (TickProfiler.Enable), showing old data.");
+
+    SendSysMessage("Map tick profile in microseconds: ticks | p50 | p99 | max");
+    for (MapTickStats const* stats : sMapTickProfiler.GetAllStats())
+    {
+        if (singleMap && stats->GetMapId() != mapId)
+            continue;
+
+        LatencyHistogram::Summary total = stats->GetPhase(MAP_TICK_TOTAL).GetSummary();
+        if (!singleMap)
+        {
+            // Point out the phase most likely responsible for the spikes
+            MapTickPhase worst = MAP_TICK_TOTAL;
+            uint64 worstP99 = 0;
+            for (uint8 i = MAP_TICK_TOTAL + 1; i < MAX_MAP_TICK_PHASE; ++i)
+            {
+                if (i == MAP_TICK_CONTINENT_WAIT)
+                    continue;
+
+                uint64 p99 = stats->GetPhase(MapTickPhase(i)).GetPercentile(99.0);
+                if (p99 > worstP99)
+                {
+                    worstP99 = p99;
+                    worst = MapTickPhase(i);
+                }
+            }
+
+            PSendSysMessage("Map %3u %-20s " UI64FMTD " | " UI64FMTD " | " UI64FMTD " | " UI64FMTD " [worst: %s]",
+                stats->GetMapId(), stats->GetMapName(), total.count, total.p50, total.p99, total.max, GetMapTickPhaseName(worst));
+            continue;
+        }
+
+        PSendSysMessage("Map %u (%s):", stats->GetMapId(), stats->GetMapName());
+        for (uint8 i = 0; i < MAX_MAP_TICK_PHASE; ++i)
+        {
+            LatencyHistogram::Summary summary = stats->GetPhase(MapTickPhase(i)).GetSummary();
+            if (!summary.count)
+                continue;
+
+            PSendSysMessage("  %-14s " UI64FMTD " | " UI64FMTD " | " UI64FMTD " | " UI64FMTD,
+                GetMapTickPhaseName(MapTickPhase(i)), summary.count, summary.p50, summary.p99, summary.max);
+        }
+
+        PacketCompressor::Stats const compression = stats->GetCompression();
+        if (compression.calls)
+            PSendSysMessage("  Compression: " UI64FMTD " packets (" UI64FMTD " from cache), ratio %.2f, " UI64FMTD " us (%.1f us/packet)",
+                compression.calls, compression.cacheHits, compression.outBytes ? double(compression.inBytes) / compression.outBytes : 0.0,
+                compression.us, double(compression.us) / compression.calls);
+    }
+    return true;
+}
+
+// Display the asynchronous queue and batching statistics of each database
+bool ChatHandler::HandleServerDatabaseCommand(char* args)
+{
+    std::pair<char const*, Database*> const databases[] =
+    {
+        { "World", &WorldDatabase },
+        { "Characters", &CharacterDatabase },
+        { "Login", &LoginDatabase },
+        { "Logs", &LogsDatabase },
+    };
+
+    if (char* param = ExtractLiteralArg(&args))
+    {
+        if (strncmp(param, "reset", strlen(param)) != 0)
+            return false;
+
+        for (auto const& db : databases)
+            db.second->ResetAsyncStats();
+        SendSysMessage("Database statistics reset.");
+        return true;
+    }
+
+    if (sWorld.IsCharacterDatabaseBackpressured())
+        SendSysMessage("Character database backpressure active: autosaves and queued logins are delayed.");
+
+    for (auto const& db : databases)
+    {
+        Database::AsyncStats stats = db.second->GetAsyncStats();
+        PSendSysMessage("%-10s queued " SI64FMTD " (peak " SI64FMTD ") | executed " UI64FMTD " | batches " UI64FMTD " (avg %.1f, max %u, replayed " UI64FMTD ")",
+            db.first, stats.queued, stats.peakQueued, stats.executed, stats.batches,
+            stats.batches ? float(stats.batchedOperations) / stats.batches : 0.0f, stats.maxBatchSize, stats.replayedBatches);
+        if (stats.flushTime.count)
+            PSendSysMessage("%-10s flush time (us): p50 " UI64FMTD " | p99 " UI64FMTD " | max " UI64FMTD,
+                db.first, stats.flushTime.p50, stats.flushTime.p99, stats.flushTime.max);
+    }
+    return true;
+}
+
 // Display the 'Message of the day' for the realm
 bool ChatHandler::HandleServerMotdCommand(char* /*args*/)
 {
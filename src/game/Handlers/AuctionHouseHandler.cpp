@@ -400,9 +400,10 @@ void WorldSession::HandleAuctionSellItem(WorldPacket& recv_data)
     data.parts[1].money = buyout;
     sWorld.LogTransaction(data);
 
+    // The item is indexed by the auction house search
+    sAuctionMgr.AddAItem(it);
     auctionHouse->AddAuction(AH);
 
-    sAuctionMgr.AddAItem(it);
     pl->MoveItemFromInventory(it->GetBagSlot(), it->GetSlot(), true);
 
     CharacterDatabase.BeginTransaction(pl->GetGUIDLow());
@@ -837,7 +837,7 @@ void WorldSession::HandleEmoteOpcode(WorldPacket& recv_data)
 
     // Used by Eluna
 #ifdef ENABLE_ELUNA
-    sEluna->OnEmote(GetPlayer(), emote);
+    GetPlayer()->GetEluna()->OnEmote(GetPlayer(), emote);
 #endif /* ENABLE_ELUNA */
 
     GetPlayer()->InterruptSpellsWithChannelFlags(AURA_INTERRUPT_ANIM_CANCELS);
@@ -898,7 +898,7 @@ void WorldSession::HandleTextEmoteOpcode(WorldPacket& recv_data)
 
     // Used by Eluna
 #ifdef ENABLE_ELUNA
-    sEluna->OnTextEmote(GetPlayer(), textEmote, emoteNum, guid);
+    GetPlayer()->GetEluna()->OnTextEmote(GetPlayer(), textEmote, emoteNum, guid);
 #endif /* ENABLE_ELUNA */
 
 
@@ -292,7 +292,7 @@ void WorldSession::HandleLootMoneyOpcode(WorldPacket& /*recv_data*/)
 
         // Used by Eluna
 #ifdef ENABLE_ELUNA
-        sEluna->OnLootMoney(player, pLoot->gold);
+        player->GetEluna()->OnLootMoney(player, pLoot->gold);
 #endif /* ENABLE_ELUNA */
 
         pLoot->gold = 0;
@@ -699,7 +699,7 @@ void WorldSession::HandleLootMasterGiveOpcode(WorldPacket& recv_data)
 
     // Used by Eluna
 #ifdef ENABLE_ELUNA
-    	sEluna->OnLootItem(target, newitem, item.count, lootGuid);
+    	target->GetEluna()->OnLootItem(target, newitem, item.count, lootGuid);
 #endif /* ENABLE_ELUNA */
 
     }
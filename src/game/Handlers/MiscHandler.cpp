@@ -70,7 +70,7 @@ void WorldSession::HandleRepopRequestOpcode(WorldPacket& /*recv_data*/)
 
     // Used by Eluna
 #ifdef ENABLE_ELUNA
-    sEluna->OnRepop(GetPlayer());
+    GetPlayer()->GetEluna()->OnRepop(GetPlayer());
 #endif /* ENABLE_ELUNA */
 
     player->BuildPlayerRepop();
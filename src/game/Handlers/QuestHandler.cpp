@@ -506,7 +506,7 @@ void WorldSession::HandleQuestLogRemoveQuest(WorldPacket& recv_data)
 #ifdef ENABLE_ELUNA
     if (slot < MAX_QUEST_LOG_SIZE)
         if(uint32 quest = _player->GetQuestSlotQuestId(slot))
-            sEluna->OnQuestAbandon(_player, quest);
+            _player->GetEluna()->OnQuestAbandon(_player, quest);
 #endif /* ENABLE_ELUNA */
 
     _player->RemoveQuestAtSlot(slot);
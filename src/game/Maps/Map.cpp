@@ -41,6 +41,7 @@
 #include "DynamicTree.h"
 #include "RegularGrid.h"
 #include "PathFinder.h"
+#include "PathfindingService.h"
 #include "Detour/Include/DetourNavMesh.h"
 #include "Detour/Include/DetourNavMeshQuery.h"
 #include "MoveMap.h"
@@ -51,7 +52,8 @@
 #include "MovementBroadcaster.h"
 #include "PlayerBroadcaster.h"
 #include "GridSearchers.h"
-#include "ThreadPool.h"
+#include "Multithreading/TaskScheduler.h"
+#include "MapTickProfiler.h"
 #include "AuraRemovalMgr.h"
 #include "world/world_event_wareffort.h"
 #include "CreatureGroups.h"
@@ -64,8 +66,11 @@
 
 Map::~Map()
 {
+    // The pathfinding workers use the grids and the dynamic tree, none may run past this point
+    sPathfindingService.CancelMapRequests(this);
+
 #ifdef ENABLE_ELUNA
-    sEluna->OnDestroy(this);
+    GetEluna()->OnDestroy(this);
 #endif /* ENABLE_ELUNA */
     UnloadAll(true);
 
@@ -77,7 +82,7 @@ Map::~Map()
 
 #ifdef ENABLE_ELUNA
     if (Instanceable())
-        sEluna->FreeInstanceId(GetInstanceId());
+        GetEluna()->FreeInstanceId(GetInstanceId());
 #endif /* ENABLE_ELUNA */
 
     if (i_data)
@@ -86,6 +91,11 @@ Map::~Map()
         i_data = nullptr;
     }
 
+#ifdef ENABLE_ELUNA
+    Eluna::DestroyMapState(m_eluna);
+    m_eluna = nullptr;
+#endif /* ENABLE_ELUNA */
+
     //release reference count
     if (m_TerrainData->Release())
         sTerrainMgr.UnloadTerrain(m_TerrainData->GetMapId());
@@ -144,8 +154,15 @@ Map::Map(uint32 id, time_t expiry, uint32 InstanceId)
       _lastPlayersUpdate(WorldTimer::getMSTime()), _lastMapUpdate(WorldTimer::getMSTime()),
       _lastCellsUpdate(WorldTimer::getMSTime()), _inactivePlayersSkippedUpdates(0),
       _objUpdatesThreads(0), _unitRelocationThreads(0), _lastPlayerLeftTime(0),
-      m_lastMvtSpellsUpdate(0), _bonesCleanupTimer(0), m_uiScriptedEventsTimer(1000)
+      m_lastMvtSpellsUpdate(0), _bonesCleanupTimer(0), m_uiScriptedEventsTimer(1000),
+      m_tickStats(sMapTickProfiler.GetMapStats(id)),
+      m_queryCache(sWorld.getConfig(CONFIG_UINT32_MAP_QUERY_CACHE_SIZE), sWorld.getConfig(CONFIG_FLOAT_MAP_QUERY_CACHE_GRID)),
+      m_dynamicTreeGeneration(0), m_pathCache(sWorld.getConfig(CONFIG_UINT32_MAP_PATH_CACHE_SIZE))
 {
+#ifdef ENABLE_ELUNA
+    m_eluna = Eluna::CreateMapState(this);
+#endif /* ENABLE_ELUNA */
+
     m_CreatureGuids.Set(sObjectMgr.GetFirstTemporaryCreatureLowGuid());
     m_GameObjectGuids.Set(sObjectMgr.GetFirstTemporaryGameObjectLowGuid());
 
@@ -169,29 +186,25 @@ Map::Map(uint32 id, time_t expiry, uint32 InstanceId)
     m_persistentState->SetUsedByMapState(this);
     m_weatherSystem = new WeatherSystem(this);
 
-    int numObjThreads = (int)sWorld.getConfig(CONFIG_UINT32_MAP_OBJECTSUPDATE_THREADS);
-    if (numObjThreads > 1)
-    {
-        m_objectThreads.reset(new ThreadPool(numObjThreads -1));
-        m_objectThreads->start<ThreadPool::MySQL<ThreadPool::MultiQueue>>();
-    }
-    if (IsContinent())
-    {
-        m_motionThreads.reset(new ThreadPool(sWorld.getConfig(CONFIG_UINT32_CONTINENTS_MOTIONUPDATE_THREADS)));
-        m_visibilityThreads.reset(new ThreadPool(std::max((int)sWorld.getConfig(CONFIG_UINT32_MAP_VISIBILITYUPDATE_THREADS) -1,0)));
-        m_cellThreads.reset(new ThreadPool(std::max((int)sWorld.getConfig(CONFIG_UINT32_MTCELLS_THREADS) - 1, 0)));
-        m_visibilityThreads->start<ThreadPool::MySQL<ThreadPool::MultiQueue>>();
-        m_cellThreads->start();
-        m_motionThreads->start();
-    }
-
 	LoadElevatorTransports();
 
 #ifdef ENABLE_ELUNA
-    sEluna->OnCreate(this);
+    GetEluna()->OnCreate(this);
 #endif /* ENABLE_ELUNA */
 }
 
+#ifdef ENABLE_ELUNA
+Eluna* Map::GetEluna() const
+{
+    return m_eluna ? m_eluna : sEluna;
+}
+
+Eluna** Map::GetElunaPtr()
+{
+    return m_eluna ? &m_eluna : &Eluna::GEluna;
+}
+#endif /* ENABLE_ELUNA */
+
 // Nostalrius
 // Active objects system
 class ActiveObjectsGridLoader
@@ -445,8 +458,8 @@ bool Map::Add(Player* player)
     UpdateObjectVisibility(player, cell, p);
 
 #ifdef ENABLE_ELUNA
-    sEluna->OnMapChanged(player);
-    sEluna->OnPlayerEnter(this, player);
+    GetEluna()->OnMapChanged(player);
+    GetEluna()->OnPlayerEnter(this, player);
 #endif /* ENABLE_ELUNA */
 
     if (i_data)
@@ -799,17 +812,17 @@ inline void Map::UpdateActiveCellsAsynch(uint32 now, uint32 diff)
     for (m_activeNonPlayersIter = m_activeNonPlayers.begin(); m_activeNonPlayersIter != m_activeNonPlayers.end(); ++m_activeNonPlayersIter)
         MarkCellsAroundObject(*m_activeNonPlayersIter);
 
-    const int nthreads = m_cellThreads->size();
+    // Cells of the same step are far enough from each other to be updated at the same time
+    const int nthreads = sWorld.getConfig(CONFIG_UINT32_MTCELLS_THREADS);
     for (int step = 0; step < 2; step++)
     {
-        for (int i = 0; i < nthreads; ++i)
-            m_cellThreads << [this, diff, now, i, nthreads, step](){
-                UpdateActiveCellsCallback(diff, now, i, nthreads+1, step);
-            };
-        std::future<void> job = m_cellThreads->processWorkload();
-        UpdateActiveCellsCallback(diff, now, nthreads, nthreads+1, step);
-        if (job.valid())
-            job.wait();
+        TaskGroup cells(TASK_PHASE_CELLS);
+        for (int i = 0; i < nthreads - 1; ++i)
+            cells.Run([this, diff, now, i, nthreads, step](){
+                UpdateActiveCellsCallback(diff, now, i, nthreads, step);
+            });
+        UpdateActiveCellsCallback(diff, now, nthreads - 1, nthreads, step);
+        cells.Wait();
     }
 }
 
@@ -847,19 +860,31 @@ inline void Map::UpdateCells(uint32 map_diff)
     _lastCellsUpdate = now;
 
     // update active cells around players and active objects
-    if (IsContinent() && m_cellThreads->status() == ThreadPool::Status::READY)
-        UpdateActiveCellsAsynch(now, diff);
-    else
-        UpdateActiveCellsSynch(now, diff);
+    {
+        MapTickPhaseTimer timer(m_tickStats, MAP_TICK_CELLS);
+        if (IsContinent() && sWorld.getConfig(CONFIG_UINT32_MTCELLS_THREADS) > 1)
+            UpdateActiveCellsAsynch(now, diff);
+        else
+            UpdateActiveCellsSynch(now, diff);
+    }
 
-    if (IsContinent() && m_motionThreads->status() == ThreadPool::Status::READY && !unitsMvtUpdate.empty())
+    uint32 const motionThreads = sWorld.getConfig(CONFIG_UINT32_CONTINENTS_MOTIONUPDATE_THREADS);
+    if (IsContinent() && motionThreads && !unitsMvtUpdate.empty())
     {
-        for (std::unordered_set<Unit*>::iterator it = unitsMvtUpdate.begin(); it != unitsMvtUpdate.end(); it++)
-            m_motionThreads << [it,diff](){
-                 if ((*it)->IsInWorld())
-                    (*it)->GetMotionMaster()->UpdateMotionAsync(diff);
-            };
-        m_motionThreads->processWorkload().wait();
+        MapTickPhaseTimer timer(m_tickStats, MAP_TICK_MOTION);
+        std::vector<Unit*> units(unitsMvtUpdate.begin(), unitsMvtUpdate.end());
+        std::atomic<uint32> index(0);
+        auto f = [&units, &index, diff](){
+            uint32 i;
+            while ((i = index++) < units.size())
+                if (units[i]->IsInWorld())
+                    units[i]->GetMotionMaster()->UpdateMotionAsync(diff);
+        };
+
+        TaskGroup motion(TASK_PHASE_MOTION);
+        for (uint32 i = 0; i < motionThreads; ++i)
+            motion.Run(f);
+        motion.Wait();
     }
     unitsMvtUpdate.clear();
 }
@@ -943,44 +968,70 @@ void Map::DoUpdate(uint32 maxDiff)
 
 void Map::Update(uint32 t_diff)
 {
+    MapTickPhaseTimer totalTimer(m_tickStats, MAP_TICK_TOTAL);
+    MapCompressionScope compressionScope(m_tickStats);
+    // The players and scripts phases run in two sections each
+    MapTickPhaseSample playersSample(m_tickStats, MAP_TICK_PLAYERS);
+    MapTickPhaseSample scriptsSample(m_tickStats, MAP_TICK_SCRIPTS);
     uint32 updateMapTime = WorldTimer::getMSTime();
     _dynamicTree.update(t_diff);
 
-    UpdateSessionsMovementAndSpellsIfNeeded();
-    // update worldsessions for existing players
-    for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
     {
-        Player* plr = m_mapRefIter->getSource();
-        if (plr && plr->IsInWorld())
+        MapTickPhaseTimer timer(m_tickStats, MAP_TICK_SESSIONS);
+        UpdateSessionsMovementAndSpellsIfNeeded();
+        // update worldsessions for existing players
+        for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
         {
-            WorldSession* pSession = plr->GetSession();
-            MapSessionFilter updater(pSession);
+            Player* plr = m_mapRefIter->getSource();
+            if (plr && plr->IsInWorld())
+            {
+                WorldSession* pSession = plr->GetSession();
+                MapSessionFilter updater(pSession);
 
-            pSession->Update(updater);
+                pSession->Update(updater);
+            }
         }
     }
     uint32 sessionsUpdateTime = WorldTimer::getMSTimeDiffToNow(updateMapTime);
 
     // update players at tick
     std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
-    UpdateSessionsMovementAndSpellsIfNeeded();
-    UpdatePlayers();
+    {
+        MapTickPhaseTimer timer(playersSample);
+        UpdateSessionsMovementAndSpellsIfNeeded();
+        UpdatePlayers();
+    }
     uint32 playersUpdateTime = WorldTimer::getMSTimeDiffToNow(updateMapTime) - sessionsUpdateTime;
 
     UpdateCells(t_diff);
     uint32 activeCellsUpdateTime = WorldTimer::getMSTimeDiffToNow(updateMapTime) - playersUpdateTime - sessionsUpdateTime;
 
     // Send world objects and item update field changes
-    SendObjectUpdates();
+    {
+        MapTickPhaseTimer timer(m_tickStats, MAP_TICK_OBJECT_UPDATES);
+        SendObjectUpdates();
+    }
     uint32 objectsUpdateTime = WorldTimer::getMSTimeDiffToNow(updateMapTime) - activeCellsUpdateTime - playersUpdateTime - sessionsUpdateTime;
 
-    UpdateVisibilityForRelocations();
+    {
+        MapTickPhaseTimer timer(m_tickStats, MAP_TICK_VISIBILITY);
+        UpdateVisibilityForRelocations();
+    }
     uint32 visibilityUpdateTime = WorldTimer::getMSTimeDiffToNow(updateMapTime) - objectsUpdateTime - activeCellsUpdateTime - playersUpdateTime - sessionsUpdateTime;
 
-    UpdateSessionsMovementAndSpellsIfNeeded();
-    UpdatePlayers();
+    {
+        MapTickPhaseTimer timer(playersSample);
+        UpdateSessionsMovementAndSpellsIfNeeded();
+        UpdatePlayers();
+    }
     uint32 playersUpdateTime2 = WorldTimer::getMSTimeDiffToNow(updateMapTime) - objectsUpdateTime - activeCellsUpdateTime - playersUpdateTime - sessionsUpdateTime - visibilityUpdateTime;
 
+    // Speed checks of the movement packets handled during the tick
+    {
+        MapTickPhaseTimer timer(m_tickStats, MAP_TICK_ANTICHEAT);
+        m_movementChecks.Process(this);
+    }
+
     RemoveCorpses();
     RemoveOldBones(t_diff);
 
@@ -990,6 +1041,7 @@ void Map::Update(uint32 t_diff)
     uint32 additionnalUpdateCounts = 0;
     if (!Instanceable())
     {
+        MapTickPhaseTimer timer(m_tickStats, MAP_TICK_CONTINENT_WAIT);
         additionnalWaitTime = WorldTimer::getMSTime();
         sMapMgr.MarkContinentUpdateFinished();
         while (!sMapMgr.waitContinentUpdateFinishedUntil(start + std::chrono::milliseconds(sWorld.getConfig(CONFIG_UINT32_INTERVAL_MAPUPDATE))))
@@ -1005,6 +1057,7 @@ void Map::Update(uint32 t_diff)
     // This isn't really bother us, since as soon as we have instanced BG-s, the whole map unloads as the BG gets ended
     if (!IsBattleGround())
     {
+        MapTickPhaseTimer timer(m_tickStats, MAP_TICK_GRIDS);
         for (GridRefManager<NGridType>::iterator i = GridRefManager<NGridType>::begin(); i != GridRefManager<NGridType>::end();)
         {
             NGridType* grid = i->getSource();
@@ -1016,24 +1069,35 @@ void Map::Update(uint32 t_diff)
     }
 
     // Process necessary scripts
-    if (m_uiScriptedEventsTimer <= t_diff)
     {
-        UpdateScriptedEvents();
-        m_uiScriptedEventsTimer = 1000u;
-    }
-    else
-        m_uiScriptedEventsTimer -= t_diff;
+        MapTickPhaseTimer timer(scriptsSample);
+        if (m_uiScriptedEventsTimer <= t_diff)
+        {
+            UpdateScriptedEvents();
+            m_uiScriptedEventsTimer = 1000u;
+        }
+        else
+            m_uiScriptedEventsTimer -= t_diff;
 
-    ScriptsProcess();
+        ScriptsProcess();
+    }
 
 #ifdef ENABLE_ELUNA
-    sEluna->OnUpdate(this, t_diff);
+    {
+        MapTickPhaseTimer timer(m_tickStats, MAP_TICK_ELUNA);
+        if (m_eluna)
+            m_eluna->UpdateMapState(t_diff);
+        GetEluna()->OnUpdate(this, t_diff);
+    }
 #endif /* ENABLE_ELUNA */
 
-    if (i_data)
-        i_data->Update(t_diff);
+    {
+        MapTickPhaseTimer timer(scriptsSample);
+        if (i_data)
+            i_data->Update(t_diff);
 
-    m_weatherSystem->UpdateWeathers(t_diff);
+        m_weatherSystem->UpdateWeathers(t_diff);
+    }
 
     bool packetBroadcastSlow = sWorld.GetBroadcaster()->IsMapSlow(GetInstanceId());
     if (sWorld.getConfig(CONFIG_UINT32_PERFLOG_SLOW_MAP_UPDATE) && updateMapTime > sWorld.getConfig(CONFIG_UINT32_PERFLOG_SLOW_MAP_UPDATE))
@@ -1211,7 +1275,7 @@ void Map::Remove(Player* player, bool remove)
 {
 
 #ifdef ENABLE_ELUNA
-    sEluna->OnPlayerLeave(this, player);
+    GetEluna()->OnPlayerLeave(this, player);
 #endif /* ENABLE_ELUNA */
 
     if (i_data)
@@ -1766,9 +1830,9 @@ void Map::AddObjectToRemoveList(WorldObject* obj)
 
 #ifdef ENABLE_ELUNA
     if (Creature* creature = obj->ToCreature())
-        sEluna->OnRemove(creature);
+        GetEluna()->OnRemove(creature);
     else if (GameObject* gameobject = obj->ToGameObject())
-        sEluna->OnRemove(gameobject);
+        GetEluna()->OnRemove(gameobject);
 #endif /* ENABLE_ELUNA */
 
     obj->CleanupsBeforeDelete();                            // remove or simplify at least cross referenced links
@@ -1982,7 +2046,7 @@ void Map::CreateInstanceData(bool load)
         return;
 
 #ifdef ENABLE_ELUNA
-    i_data = sEluna->GetInstanceData(this);
+    i_data = GetEluna()->GetInstanceData(this);
 #endif /* ENABLE_ELUNA */
 
     if (!i_mapEntry->scriptId)
@@ -2820,8 +2884,6 @@ void Map::RemoveUnitFromMovementUpdate(Unit *unit)
 }
 
 
-//#define MAP_SENDOBJECTUPDATES_PROFILE
-
 void Map::SendObjectUpdates()
 {
     // VERY HEAVY LOAD in case of a lot of players at the same place
@@ -2835,11 +2897,11 @@ void Map::SendObjectUpdates()
     // Compute maximum number of threads
 //#define FORCE_OLD_THREADCOUNT
 #ifndef FORCE_OLD_THREADCOUNT
-    int threads = m_objectThreads ? m_objectThreads->size() +1 : 1;
+    int threads = sWorld.getConfig(CONFIG_UINT32_MAP_OBJECTSUPDATE_THREADS);
 #else
     int threads = 1;
     if (IsContinent())
-        threads = m_objectThreads ? m_objectThreads->size() +1 : 1;
+        threads = sWorld.getConfig(CONFIG_UINT32_MAP_OBJECTSUPDATE_THREADS);
     if (!_objUpdatesThreads)
         _objUpdatesThreads = 1;
     if (threads < _objUpdatesThreads)
@@ -2864,7 +2926,8 @@ void Map::SendObjectUpdates()
 //#define FORCE_NO_ATOMIC_INT
 #if ATOMIC_INT_LOCK_FREE == 2 && !defined(FORCE_NO_ATOMIC_INT)
     std::atomic_int ait(0);
-    auto f = [&t, &ait, beginTime=now, timeout](){
+    auto f = [&t, &ait, beginTime=now, timeout, stats=m_tickStats](){
+        MapCompressionScope compressionScope(stats);
         UpdateDataMapType update_players; // Player -> UpdateData
         int it;
         while ((it = ait++) < t.size() -1)
@@ -2877,17 +2940,13 @@ void Map::SendObjectUpdates()
         for (UpdateDataMapType::iterator iter = update_players.begin(); iter != update_players.end(); ++iter)
             iter->second.Send(iter->first->GetSession());
     };
-    std::future<void> job;
-    if (m_objectThreads) {
-        for (int i = 1; i < threads; i++)
-            m_objectThreads << f;
-        job = m_objectThreads->processWorkload();
-    }
+    TaskGroup job(TASK_PHASE_OBJECT_UPDATES);
+    for (int i = 1; i < threads; i++)
+        job.Run(f);
 
     f();
 
-    if (job.valid())
-        job.wait();
+    job.Wait();
     if (ait >= i_objectsToClientUpdate.size()) //ait is increased before checks, so max value is `objectsCount + threads`
         i_objectsToClientUpdate.clear();
     else
@@ -2896,7 +2955,8 @@ void Map::SendObjectUpdates()
     std::vector<int> counters;
     for (int i = 0; i < threads; i++)
         counters.push_back(i * step);
-    auto f = [&t, &counters, step, beginTime=now, timeout](int id){
+    auto f = [&t, &counters, step, beginTime=now, timeout, stats=m_tickStats](int id){
+        MapCompressionScope compressionScope(stats);
         UpdateDataMapType update_players; // Player -> UpdateData
         for (int &it = counters[id]; it < std::min((int)t.size() -1, step * (id + 1)); it++)
         {
@@ -2907,17 +2967,13 @@ void Map::SendObjectUpdates()
         for (UpdateDataMapType::iterator iter = update_players.begin(); iter != update_players.end(); ++iter)
             iter->second.Send(iter->first->GetSession());
     };
-    std::future<void> job;
-    if (m_objectThreads) {
-        for (int i = 1; i < threads; i++)
-            m_objectThreads << std::bind(f, i);
-        job = m_objectThreads->processWorkload();
-    }
+    TaskGroup job(TASK_PHASE_OBJECT_UPDATES);
+    for (int i = 1; i < threads; i++)
+        job.Run(std::bind(f, i));
 
     f(0);
 
-    if (job.valid())
-        job.wait();
+    job.Wait();
     for (int i = 0; i < threads; i++)
         i_objectsToClientUpdate.erase(t[step * i], t[counters[i]]);
 #endif
@@ -2931,11 +2987,6 @@ void Map::SendObjectUpdates()
 #endif
 
     _processingSendObjUpdates = false;
-#ifdef MAP_SENDOBJECTUPDATES_PROFILE
-    uint32 diff = WorldTimer::getMSTimeDiffToNow(now);
-    if (diff > 50)
-        sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "SendObjectUpdates in %04u ms [%u threads. %3u/%3u]", diff, threads, objectsCount - i_objectsToClientUpdate.size(), objectsCount);
-#endif
 }
 
 //#define MAP_UPDATEVISIBILITY_PROFILE
@@ -2952,7 +3003,7 @@ void Map::UpdateVisibilityForRelocations()
     // Compute number of threads to spawn
     uint32 threads = 1;
     if (IsContinent())
-        threads = m_visibilityThreads->size() + 1;
+        threads = sWorld.getConfig(CONFIG_UINT32_MAP_VISIBILITYUPDATE_THREADS);
     if (!_unitRelocationThreads)
         _unitRelocationThreads = 1;
     if (threads < _unitRelocationThreads)
@@ -2979,16 +3030,12 @@ void Map::UpdateVisibilityForRelocations()
             it = ait++;
         }
     };
+    TaskGroup job(TASK_PHASE_VISIBILITY);
     for (uint32 i = 0; i < threads -1; ++i)
-        m_visibilityThreads << f;
-
-    std::future<void> job;
-    if (m_visibilityThreads)
-        job = m_visibilityThreads->processWorkload();
+        job.Run(f);
 
     f();
-    if (job.valid())
-        job.wait();
+    job.Wait();
     if (ait >= i_unitsRelocated.size()) //ait is increased before checks, so max value is `objectsCount + threads`
         i_unitsRelocated.clear();
     else
@@ -3086,8 +3133,58 @@ bool Map::isInLineOfSight(float x1, float y1, float z1, float x2, float y2, floa
     ASSERT(MaNGOS::IsValidMapCoord(x1, y1, z1));
     ASSERT(MaNGOS::IsValidMapCoord(x2, y2, z2));
 
-    return VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), x1, y1, z1, x2, y2, z2, ignoreM2Model)
-    && (!checkDynLos || CheckDynamicTreeLoS(x1, y1, z1, x2, y2, z2, ignoreM2Model));
+    if (!m_queryCache.IsEnabled())
+        return VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), x1, y1, z1, x2, y2, z2, ignoreM2Model)
+        && (!checkDynLos || CheckDynamicTreeLoS(x1, y1, z1, x2, y2, z2, ignoreM2Model));
+
+    MapQueryCache::Key const key = m_queryCache.LineOfSightKey(x1, y1, z1, x2, y2, z2, ignoreM2Model ? 1 : 0);
+    MapQueryCache::Entry entry;
+    bool const cached = m_queryCache.Find(key, entry);
+    bool changed = !cached;
+    if (!cached)
+    {
+        entry.staticValue = VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), x1, y1, z1, x2, y2, z2, ignoreM2Model) ? 1.0f : 0.0f;
+        entry.dynamicValue = 1.0f;
+        entry.dynamicGeneration = MapQueryCache::DYNAMIC_NOT_SET;
+    }
+
+    // Read before the test: a model changing meanwhile makes the next query test again
+    uint32 const generation = m_dynamicTreeGeneration;
+    if (checkDynLos && entry.staticValue != 0.0f && entry.dynamicGeneration != generation)
+    {
+        if (entry.dynamicGeneration != MapQueryCache::DYNAMIC_NOT_SET)
+            m_queryCache.CountDynamicRefresh();
+        entry.dynamicValue = CheckDynamicTreeLoS(x1, y1, z1, x2, y2, z2, ignoreM2Model) ? 1.0f : 0.0f;
+        entry.dynamicGeneration = generation;
+        changed = true;
+    }
+
+    if (changed)
+        m_queryCache.Store(key, entry);
+
+    return entry.staticValue != 0.0f && (!checkDynLos || entry.dynamicValue != 0.0f);
+}
+
+void Map::isInLineOfSight(VMAP::LineOfSightQuery* queries, uint32 count, bool checkDynLos, bool ignoreM2Model) const
+{
+    for (uint32 i = 0; i < count; ++i)
+    {
+        ASSERT(MaNGOS::IsValidMapCoord(queries[i].x1, queries[i].y1, queries[i].z1));
+        ASSERT(MaNGOS::IsValidMapCoord(queries[i].x2, queries[i].y2, queries[i].z2));
+    }
+
+    VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), queries, count, ignoreM2Model);
+    if (!checkDynLos)
+        return;
+
+    // Few gameobject models per map, the dynamic tree keeps testing one segment at a time
+    std::shared_lock<std::shared_timed_mutex> lock(_dynamicTree_lock);
+    for (uint32 i = 0; i < count; ++i)
+    {
+        VMAP::LineOfSightQuery& query = queries[i];
+        if (query.result)
+            query.result = _dynamicTree.isInLineOfSight(query.x1, query.y1, query.z1, query.x2, query.y2, query.z2, ignoreM2Model);
+    }
 }
 
 bool Map::GetLosHitPosition(float srcX, float srcY, float srcZ, float& destX, float& destY, float& destZ, float modifyDist) const
@@ -3350,7 +3447,27 @@ bool Map::GetWalkRandomPosition(GenericTransport* transport, float &x, float &y,
 float Map::GetHeight(float x, float y, float z, bool vmap/*=true*/, float maxSearchDist/*=DEFAULT_HEIGHT_SEARCH*/) const
 {
     ASSERT(MaNGOS::IsValidMapCoord(x, y, z));
-    return std::max<float>(GetTerrain()->GetHeightStatic(x, y, z, vmap, maxSearchDist), GetDynamicTreeHeight(x, y, z, maxSearchDist));
+    // Without vmaps, the height is read from the grid map at once
+    if (!vmap || !m_queryCache.IsEnabled())
+        return std::max<float>(GetTerrain()->GetHeightStatic(x, y, z, vmap, maxSearchDist), GetDynamicTreeHeight(x, y, z, maxSearchDist));
+
+    MapQueryCache::Key const key = m_queryCache.HeightKey(x, y, z, maxSearchDist);
+    MapQueryCache::Entry entry;
+    bool const cached = m_queryCache.Find(key, entry);
+    if (!cached)
+        entry.staticValue = GetTerrain()->GetHeightStatic(x, y, z, vmap, maxSearchDist);
+
+    uint32 const generation = m_dynamicTreeGeneration;
+    if (!cached || entry.dynamicGeneration != generation)
+    {
+        if (cached)
+            m_queryCache.CountDynamicRefresh();
+        entry.dynamicValue = GetDynamicTreeHeight(x, y, z, maxSearchDist);
+        entry.dynamicGeneration = generation;
+        m_queryCache.Store(key, entry);
+    }
+
+    return std::max<float>(entry.staticValue, entry.dynamicValue);
 }
 
 VMAP::ModelInstance* Map::FindCollisionModel(float x1, float y1, float z1, float x2, float y2, float z2)
@@ -3365,6 +3482,7 @@ void Map::RemoveGameObjectModel(const GameObjectModel &model)
     std::lock_guard<std::shared_timed_mutex> lock(_dynamicTree_lock);
     _dynamicTree.remove(model);
     _dynamicTree.balance();
+    InvalidateDynamicQueries();
 }
 
 void Map::InsertGameObjectModel(const GameObjectModel &model)
@@ -3372,6 +3490,7 @@ void Map::InsertGameObjectModel(const GameObjectModel &model)
     std::lock_guard<std::shared_timed_mutex> lock(_dynamicTree_lock);
     _dynamicTree.insert(model);
     _dynamicTree.balance();
+    InvalidateDynamicQueries();
 }
 
 bool Map::ContainsGameObjectModel(const GameObjectModel &model) const
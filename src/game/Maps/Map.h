@@ -38,6 +38,9 @@
 #include "SQLStorages.h"
 #include "ScriptCommands.h"
 #include "CreatureLinkingMgr.h"
+#include "MapQueryCache.h"
+#include "MapPathCache.h"
+#include "MovementCheckBatch.h"
 
 #include <bitset>
 #include <list>
@@ -63,10 +66,15 @@ class WeatherSystem;
 class GenericTransport;
 class ElevatorTransport;
 class Transport;
+class MapTickStats;
+#ifdef ENABLE_ELUNA
+class Eluna;
+#endif /* ENABLE_ELUNA */
 
 namespace VMAP
 {
     class ModelInstance;
+    struct LineOfSightQuery;
 };
 
 // GCC have alternative #pragma pack(N) syntax and old gcc version not support pack(push,N), also any gcc version not support it at some platform
@@ -314,7 +322,6 @@ struct ScriptedEvent
     ScriptedEvent(ScriptedEvent const&) = delete;
 };
 
-class ThreadPool;
 
 class Map : public GridRefManager<NGridType>
 {
@@ -549,6 +556,8 @@ class Map : public GridRefManager<NGridType>
         // GameObjectCollision
         float GetHeight(float x, float y, float z, bool vmap = true, float maxSearchDist = DEFAULT_HEIGHT_SEARCH) const;
         bool isInLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2, bool checkDynLos = true, bool ignoreM2Model = true) const;
+        // Batched version for many segments, the static models are traced as ray packets
+        void isInLineOfSight(VMAP::LineOfSightQuery* queries, uint32 count, bool checkDynLos = true, bool ignoreM2Model = true) const;
         // First collision with object
         bool GetLosHitPosition(float srcX, float srcY, float srcZ, float& destX, float& destY, float& destZ, float modifyDist) const;
         // Use navemesh to walk
@@ -565,6 +574,18 @@ class Map : public GridRefManager<NGridType>
         bool GetDynamicObjectHitPos(Vector3 start, Vector3 end, Vector3& out, float finalDistMod) const;
         float GetDynamicTreeHeight(float x, float y, float z, float maxSearchDist) const;
         bool CheckDynamicTreeLoS(float x1, float y1, float z1, float x2, float y2, float z2, bool ignoreM2Model) const;
+        // Cached line of sight / height results of gameobject models are computed again after a call
+        void InvalidateDynamicQueries() { ++m_dynamicTreeGeneration; }
+        MapQueryCache::Stats GetQueryCacheStats() const { return m_queryCache.GetStats(); }
+        void ResetQueryCacheStats() { m_queryCache.ResetStats(); }
+        // After a change of the static models (.debug los allow)
+        void ClearQueryCache() { m_queryCache.Clear(); }
+        // Detour corridors and point paths, see PathInfo::BuildPolyPath
+        MapPathCache& GetPathCache() { return m_pathCache; }
+        MapPathCache::Stats GetPathCacheStats() const { return m_pathCache.GetStats(); }
+        void ResetPathCacheStats() { m_pathCache.ResetStats(); }
+        // Movement anticheat checks of the packets of the tick, see MovementAnticheat::CheckSpeedHack
+        MovementCheckBatch& GetMovementCheckBatch() { return m_movementChecks; }
         bool IsUnloading() const { return m_unloading; }
         void MarkAsCrashed() { m_crashed = true; }
         bool IsCrashed() const { return m_crashed; }
@@ -597,6 +618,12 @@ class Map : public GridRefManager<NGridType>
         bool ShouldUpdateMap(uint32 now, uint32 inactiveTimeLimit);
         void RemoveBones(Corpse* corpse);
 
+#ifdef ENABLE_ELUNA
+        // Lua state running the scripts of the map, the world state unless Eluna.PerMapStates is enabled
+        Eluna* GetEluna() const;
+        Eluna** GetElunaPtr();
+#endif /* ENABLE_ELUNA */
+
     private:
         void LoadMapAndVMap(int gx, int gy);
 
@@ -661,11 +688,6 @@ class Map : public GridRefManager<NGridType>
         void RemoveCorpses(bool unload = false);
         void RemoveOldBones(uint32 const diff);
 
-        std::unique_ptr<ThreadPool> m_objectThreads;
-        std::unique_ptr<ThreadPool> m_motionThreads;
-        std::unique_ptr<ThreadPool> m_visibilityThreads;
-        std::unique_ptr<ThreadPool> m_cellThreads;
-
     protected:
         MapEntry const* i_mapEntry;
         uint32 i_id;
@@ -761,6 +783,14 @@ class Map : public GridRefManager<NGridType>
         std::map<uint32, ScriptedEvent> m_mScriptedEvents;
         void UpdateScriptedEvents();
         uint32 m_uiScriptedEventsTimer;
+        MapTickStats* m_tickStats;                          // shared by all instances of the map id
+        mutable MapQueryCache m_queryCache;
+        std::atomic<uint32> m_dynamicTreeGeneration;        // Changes of _dynamicTree, for m_queryCache
+        MapPathCache m_pathCache;
+        MovementCheckBatch m_movementChecks;
+#ifdef ENABLE_ELUNA
+        Eluna* m_eluna;                                     // own Lua state, nullptr when using the world state
+#endif /* ENABLE_ELUNA */
 
         // Functions to handle all db script commands.
         bool ScriptCommand_Talk(ScriptInfo const& script, WorldObject* source, WorldObject* target);
@@ -31,7 +31,7 @@
 #include "Group.h"
 #include "ZoneScriptMgr.h"
 #include "Map.h"
-#include "ThreadPool.h"
+#include "Multithreading/TaskScheduler.h"
 
 typedef MaNGOS::ClassLevelLockable<MapManager, std::recursive_mutex> MapManagerLock;
 INSTANTIATE_SINGLETON_2(MapManager, MapManagerLock);
@@ -40,11 +40,9 @@ INSTANTIATE_CLASS_MUTEX(MapManager, std::recursive_mutex);
 MapManager::MapManager()
     :
     i_gridCleanUpDelay(sWorld.getConfig(CONFIG_UINT32_INTERVAL_GRIDCLEAN)),
-    i_MaxInstanceId(RESERVED_INSTANCES_LAST),
-    m_threads(new ThreadPool(sWorld.getConfig(CONFIG_UINT32_MAPUPDATE_INSTANCED_UPDATE_THREADS)))
+    i_MaxInstanceId(RESERVED_INSTANCES_LAST)
 {
     i_timer.SetInterval(sWorld.getConfig(CONFIG_UINT32_INTERVAL_MAPUPDATE));
-    m_threads->start<ThreadPool::MySQL<>>();
 }
 
 MapManager::~MapManager()
@@ -308,6 +306,8 @@ void MapManager::Update(uint32 diff)
     std::vector<std::function<void()>> continentsUpdaters;
     std::vector<std::function<void()>> instancesUpdaters;
 
+    bool const asyncInstances = sWorld.getConfig(CONFIG_UINT32_MAPUPDATE_INSTANCED_UPDATE_THREADS) && sTaskScheduler.IsRunning();
+
     for (MapMapType::iterator iter = i_maps.begin(); iter != i_maps.end(); ++iter)
     {
         // If this map has been empty for too long, we no longer update it.
@@ -318,7 +318,7 @@ void MapManager::Update(uint32 diff)
         iter->second->MarkNotUpdated();
         if (iter->second->Instanceable())
         {
-            if (m_threads->status() == ThreadPool::Status::READY)
+            if (asyncInstances)
                 instancesUpdaters.emplace_back([iter,mapsDiff](){
                     iter->second->DoUpdate(mapsDiff);
                 });
@@ -341,28 +341,24 @@ void MapManager::Update(uint32 diff)
     i_maxContinentThread = continentsIdx;
     i_continentUpdateFinished.store(0);
 
-    if (!m_continentThreads || m_continentThreads->size() < continentsUpdaters.size())
-    {
-        m_continentThreads.reset(new ThreadPool(continentsUpdaters.size()));
-        m_continentThreads->start<>();
-    }
-    std::future<void> continents = m_continentThreads->processWorkload(std::move(continentsUpdaters),
-                                                                       ThreadPool::Callable());
+    // Continents, instances and all their inner phases share the scheduler workers
+    TaskGroup continents(TASK_PHASE_MAP_UPDATE);
+    for (auto& updater : continentsUpdaters)
+        continents.Run(std::move(updater));
 
     std::chrono::high_resolution_clock::time_point start;
     do {
         start = std::chrono::high_resolution_clock::now();
-        std::future<void> f = m_threads->processWorkload(instancesUpdaters,
-                                                         ThreadPool::Callable());
-
-        if (f.valid())
-            f.wait();
-        else
+        if (instancesUpdaters.empty())
             break;
+
+        TaskGroup instances(TASK_PHASE_MAP_UPDATE);
+        for (auto const& updater : instancesUpdaters)
+            instances.Run(updater);
+        instances.Wait();
     }while(!sMapMgr.waitContinentUpdateFinishedUntil(start + std::chrono::milliseconds(sWorld.getConfig(CONFIG_UINT32_INTERVAL_MAPUPDATE))));
 
-    if (continents.valid())
-        continents.wait();
+    continents.Wait();
 
     SwitchPlayersInstances();
     asyncMapUpdating = false;
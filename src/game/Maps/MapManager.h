@@ -73,7 +73,6 @@ struct MapID
     uint32 nInstanceId;
 };
 
-class ThreadPool;
 struct ScheduledTeleportData;
 
 class MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::ClassLevelLockable<MapManager, std::recursive_mutex> >
@@ -223,8 +222,6 @@ class MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::ClassLevelLockab
         mutable std::condition_variable      m_continentCV;
         std::atomic<int> i_continentUpdateFinished{0};
 
-        std::unique_ptr<ThreadPool> m_threads;
-        std::unique_ptr<ThreadPool> m_continentThreads;
         bool asyncMapUpdating = false;
 
         // Instanced continent zones
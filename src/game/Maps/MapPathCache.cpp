@@ -0,0 +1,194 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "MapPathCache.h"
+
+#include <algorithm>
+
+// Start and end positions closer than this to the cached ones get the cached point path
+static float const POINT_PATH_TOLERANCE = 0.5f;
+
+static bool IsNear(float const* a, float const* b)
+{
+    float const dx = a[0] - b[0];
+    float const dy = a[1] - b[1];
+    float const dz = a[2] - b[2];
+    return dx * dx + dy * dy + dz * dz < POINT_PATH_TOLERANCE * POINT_PATH_TOLERANCE;
+}
+
+MapPathCache::MapPathCache(uint32 capacity) :
+    m_shardCapacity(capacity ? std::max(capacity / SHARD_COUNT, 1u) : 0),
+    m_corridorHits(0), m_corridorMisses(0), m_pointHits(0), m_pointMisses(0), m_stale(0), m_evictions(0)
+{
+}
+
+size_t MapPathCache::KeyHash::operator()(Key const& key) const
+{
+    // FNV-1a over the polygons and the filter
+    uint64 hash = 14695981039346656037ULL;
+    auto mix = [&hash](uint32 value)
+    {
+        hash ^= value;
+        hash *= 1099511628211ULL;
+    };
+    mix(uint32(key.startPoly));
+    mix(uint32(key.startPoly >> 32));
+    mix(uint32(key.endPoly));
+    mix(uint32(key.endPoly >> 32));
+    mix(uint32(key.includeFlags) | (uint32(key.excludeFlags) << 16));
+    return size_t(hash ^ (hash >> 32));
+}
+
+MapPathCache::Entry* MapPathCache::FindEntry(Shard& shard, Key const& key, uint32 generation)
+{
+    auto itr = shard.index.find(key);
+    if (itr == shard.index.end())
+        return nullptr;
+
+    if (itr->second->second.generation != generation)
+    {
+        shard.entries.erase(itr->second);
+        shard.index.erase(itr);
+        ++m_stale;
+        return nullptr;
+    }
+
+    shard.entries.splice(shard.entries.begin(), shard.entries, itr->second);
+    return &itr->second->second;
+}
+
+bool MapPathCache::FindCorridor(Key const& key, uint32 generation, std::vector<uint64>& corridor)
+{
+    Shard& shard = GetShard(key);
+    {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        if (Entry* entry = FindEntry(shard, key, generation))
+        {
+            corridor = entry->corridor;
+            ++m_corridorHits;
+            return true;
+        }
+    }
+
+    ++m_corridorMisses;
+    return false;
+}
+
+void MapPathCache::StoreCorridor(Key const& key, uint32 generation, std::vector<uint64> corridor)
+{
+    Shard& shard = GetShard(key);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    auto itr = shard.index.find(key);
+    if (itr != shard.index.end())
+    {
+        Entry& entry = itr->second->second;
+        entry.generation = generation;
+        entry.corridor = std::move(corridor);
+        entry.points.clear();
+        shard.entries.splice(shard.entries.begin(), shard.entries, itr->second);
+        return;
+    }
+
+    if (shard.index.size() >= m_shardCapacity)
+    {
+        shard.index.erase(shard.entries.back().first);
+        shard.entries.pop_back();
+        ++m_evictions;
+    }
+
+    Entry entry;
+    entry.generation = generation;
+    entry.corridor = std::move(corridor);
+    entry.straight = false;
+    entry.limit = 0;
+    shard.entries.emplace_front(key, std::move(entry));
+    shard.index.emplace(key, shard.entries.begin());
+}
+
+bool MapPathCache::FindPoints(Key const& key, uint32 generation, float const* startPoint, float const* endPoint,
+                              bool straight, uint32 limit, std::vector<float>& points)
+{
+    Shard& shard = GetShard(key);
+    {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        Entry* entry = FindEntry(shard, key, generation);
+        if (entry && !entry->points.empty() && entry->straight == straight && entry->limit == limit &&
+            IsNear(entry->startPoint, startPoint) && IsNear(entry->endPoint, endPoint))
+        {
+            points = entry->points;
+            ++m_pointHits;
+            return true;
+        }
+    }
+
+    ++m_pointMisses;
+    return false;
+}
+
+void MapPathCache::StorePoints(Key const& key, uint32 generation, float const* startPoint, float const* endPoint,
+                               bool straight, uint32 limit, float const* points, uint32 pointCount)
+{
+    Shard& shard = GetShard(key);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    // Only along a cached corridor
+    Entry* entry = FindEntry(shard, key, generation);
+    if (!entry)
+        return;
+
+    std::copy(startPoint, startPoint + 3, entry->startPoint);
+    std::copy(endPoint, endPoint + 3, entry->endPoint);
+    entry->straight = straight;
+    entry->limit = limit;
+    entry->points.assign(points, points + pointCount * 3);
+}
+
+void MapPathCache::Clear()
+{
+    for (Shard& shard : m_shards)
+    {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        shard.index.clear();
+        shard.entries.clear();
+    }
+}
+
+MapPathCache::Stats MapPathCache::GetStats() const
+{
+    Stats stats;
+    stats.corridorHits = m_corridorHits;
+    stats.corridorMisses = m_corridorMisses;
+    stats.pointHits = m_pointHits;
+    stats.pointMisses = m_pointMisses;
+    stats.stale = m_stale;
+    stats.evictions = m_evictions;
+    stats.capacity = m_shardCapacity * SHARD_COUNT;
+    for (Shard const& shard : m_shards)
+    {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        stats.size += shard.index.size();
+    }
+    return stats;
+}
+
+void MapPathCache::ResetStats()
+{
+    m_corridorHits = 0;
+    m_corridorMisses = 0;
+    m_pointHits = 0;
+    m_pointMisses = 0;
+    m_stale = 0;
+    m_evictions = 0;
+}
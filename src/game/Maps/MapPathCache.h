@@ -0,0 +1,129 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_MAPPATHCACHE_H
+#define MANGOS_MAPPATHCACHE_H
+
+#include "Common.h"
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief LRU cache of the Detour paths of a map, for the routes asked again and
+ * again (waypoints, escorts, battlebot waypoints).
+ * An entry is keyed by the start and end polygons and the filter flags, and
+ * holds the polygon corridor found by findPath. It also holds the point path
+ * built along the corridor the last time, served again when the start and end
+ * positions are the same (within POINT_PATH_TOLERANCE yards).
+ * Entries are tagged with the tile generation of the navmesh
+ * (MMapManager::GetTileGeneration): loading or unloading a tile of the map
+ * makes every cached path of the map stale.
+ */
+class MapPathCache
+{
+    public:
+        struct Key
+        {
+            uint64 startPoly;
+            uint64 endPoly;
+            uint16 includeFlags;
+            uint16 excludeFlags;
+
+            bool operator==(Key const& other) const
+            {
+                return startPoly == other.startPoly && endPoly == other.endPoly &&
+                       includeFlags == other.includeFlags && excludeFlags == other.excludeFlags;
+            }
+        };
+
+        struct Stats
+        {
+            uint64 corridorHits = 0;
+            uint64 corridorMisses = 0;
+            uint64 pointHits = 0;                           // Point paths served with a cached corridor
+            uint64 pointMisses = 0;
+            uint64 stale = 0;                               // Entries dropped after a tile change
+            uint64 evictions = 0;
+            uint32 size = 0;
+            uint32 capacity = 0;
+        };
+
+        explicit MapPathCache(uint32 capacity);
+
+        bool IsEnabled() const { return m_shardCapacity != 0; }
+
+        bool FindCorridor(Key const& key, uint32 generation, std::vector<uint64>& corridor);
+        void StoreCorridor(Key const& key, uint32 generation, std::vector<uint64> corridor);
+
+        // Points are Detour coordinates (y, z, x), straight selects findStraightPath over the smooth path
+        bool FindPoints(Key const& key, uint32 generation, float const* startPoint, float const* endPoint,
+                        bool straight, uint32 limit, std::vector<float>& points);
+        void StorePoints(Key const& key, uint32 generation, float const* startPoint, float const* endPoint,
+                         bool straight, uint32 limit, float const* points, uint32 pointCount);
+
+        void Clear();
+
+        Stats GetStats() const;
+        void ResetStats();
+
+    private:
+        struct KeyHash
+        {
+            size_t operator()(Key const& key) const;
+        };
+
+        struct Entry
+        {
+            uint32 generation;
+            std::vector<uint64> corridor;
+            float startPoint[3];
+            float endPoint[3];
+            bool straight;
+            uint32 limit;
+            std::vector<float> points;                      // Empty until the point path is stored
+        };
+
+        typedef std::list<std::pair<Key, Entry>> EntryList;
+
+        struct Shard
+        {
+            mutable std::mutex lock;
+            EntryList entries;                              // Most recently used first
+            std::unordered_map<Key, EntryList::iterator, KeyHash> index;
+        };
+
+        static uint32 const SHARD_COUNT = 4;
+
+        Shard& GetShard(Key const& key) { return m_shards[KeyHash()(key) % SHARD_COUNT]; }
+        // Returns the entry of the key, dropped and not returned when stale
+        Entry* FindEntry(Shard& shard, Key const& key, uint32 generation);
+
+        uint32 m_shardCapacity;
+        Shard m_shards[SHARD_COUNT];
+
+        std::atomic<uint64> m_corridorHits;
+        std::atomic<uint64> m_corridorMisses;
+        std::atomic<uint64> m_pointHits;
+        std::atomic<uint64> m_pointMisses;
+        std::atomic<uint64> m_stale;
+        std::atomic<uint64> m_evictions;
+};
+
+#endif
@@ -0,0 +1,154 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "MapQueryCache.h"
+
+#include <cstring>
+
+MapQueryCache::MapQueryCache(uint32 capacity, float grid) :
+    m_shardCapacity(capacity ? std::max(capacity / SHARD_COUNT, 1u) : 0),
+    m_invGrid(grid > 0.0f ? 1.0f / grid : 1.0f), m_dynamicRefreshes(0), m_evictions(0)
+{
+    for (uint8 i = 0; i < MAX_MAP_QUERY_TYPE; ++i)
+    {
+        m_hits[i] = 0;
+        m_misses[i] = 0;
+    }
+}
+
+size_t MapQueryCache::KeyHash::operator()(Key const& key) const
+{
+    // FNV-1a over the cells, the flags and the type
+    uint64 hash = 14695981039346656037ULL;
+    auto mix = [&hash](uint32 value)
+    {
+        hash ^= value;
+        hash *= 1099511628211ULL;
+    };
+    for (int32 cell : key.cells)
+        mix(uint32(cell));
+    mix(key.extra);
+    mix(key.type);
+    return size_t(hash ^ (hash >> 32));
+}
+
+MapQueryCache::Key MapQueryCache::LineOfSightKey(float x1, float y1, float z1, float x2, float y2, float z2, uint32 flags) const
+{
+    Key key;
+    key.cells[0] = Quantize(x1);
+    key.cells[1] = Quantize(y1);
+    key.cells[2] = Quantize(z1);
+    key.cells[3] = Quantize(x2);
+    key.cells[4] = Quantize(y2);
+    key.cells[5] = Quantize(z2);
+    key.extra = flags;
+    key.type = MAP_QUERY_LINE_OF_SIGHT;
+    return key;
+}
+
+MapQueryCache::Key MapQueryCache::HeightKey(float x, float y, float z, float maxSearchDist) const
+{
+    Key key;
+    key.cells[0] = Quantize(x);
+    key.cells[1] = Quantize(y);
+    key.cells[2] = Quantize(z);
+    key.cells[3] = key.cells[4] = key.cells[5] = 0;
+    std::memcpy(&key.extra, &maxSearchDist, sizeof(key.extra));
+    key.type = MAP_QUERY_HEIGHT;
+    return key;
+}
+
+bool MapQueryCache::Find(Key const& key, Entry& entry)
+{
+    Shard& shard = GetShard(key);
+    {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        auto itr = shard.index.find(key);
+        if (itr != shard.index.end())
+        {
+            shard.entries.splice(shard.entries.begin(), shard.entries, itr->second);
+            entry = itr->second->second;
+            ++m_hits[key.type];
+            return true;
+        }
+    }
+
+    ++m_misses[key.type];
+    return false;
+}
+
+void MapQueryCache::Store(Key const& key, Entry const& entry)
+{
+    Shard& shard = GetShard(key);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    auto itr = shard.index.find(key);
+    if (itr != shard.index.end())
+    {
+        itr->second->second = entry;
+        shard.entries.splice(shard.entries.begin(), shard.entries, itr->second);
+        return;
+    }
+
+    if (shard.index.size() >= m_shardCapacity)
+    {
+        shard.index.erase(shard.entries.back().first);
+        shard.entries.pop_back();
+        ++m_evictions;
+    }
+
+    shard.entries.emplace_front(key, entry);
+    shard.index.emplace(key, shard.entries.begin());
+}
+
+void MapQueryCache::Clear()
+{
+    for (Shard& shard : m_shards)
+    {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        shard.index.clear();
+        shard.entries.clear();
+    }
+}
+
+MapQueryCache::Stats MapQueryCache::GetStats() const
+{
+    Stats stats;
+    for (uint8 i = 0; i < MAX_MAP_QUERY_TYPE; ++i)
+    {
+        stats.hits[i] = m_hits[i];
+        stats.misses[i] = m_misses[i];
+    }
+    stats.dynamicRefreshes = m_dynamicRefreshes;
+    stats.evictions = m_evictions;
+    stats.capacity = m_shardCapacity * SHARD_COUNT;
+    for (Shard const& shard : m_shards)
+    {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        stats.size += shard.index.size();
+    }
+    return stats;
+}
+
+void MapQueryCache::ResetStats()
+{
+    for (uint8 i = 0; i < MAX_MAP_QUERY_TYPE; ++i)
+    {
+        m_hits[i] = 0;
+        m_misses[i] = 0;
+    }
+    m_dynamicRefreshes = 0;
+    m_evictions = 0;
+}
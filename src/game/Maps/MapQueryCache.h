@@ -0,0 +1,125 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_MAPQUERYCACHE_H
+#define MANGOS_MAPQUERYCACHE_H
+
+#include "Common.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+enum MapQueryType : uint8
+{
+    MAP_QUERY_LINE_OF_SIGHT = 0,                            // Map::isInLineOfSight
+    MAP_QUERY_HEIGHT        = 1,                            // Map::GetHeight with vmaps
+    MAX_MAP_QUERY_TYPE
+};
+
+/**
+ * @brief LRU cache of the line of sight and height queries of a map.
+ * Positions are rounded to a grid (Map.QueryCache.Grid yards), queries rounding
+ * to the same cells share the result of the first one. The static part (terrain
+ * and vmaps) never changes and is cached as is. The dynamic part (gameobject
+ * models: doors, transports) is cached with the generation of the dynamic tree,
+ * and computed again when the tree changed since.
+ * Entries are spread over shards with their own lock, for the map update and
+ * its asynchronous tasks.
+ */
+class MapQueryCache
+{
+    public:
+        struct Key
+        {
+            int32 cells[6];
+            uint32 extra;                                   // Flags or search distance of the query
+            MapQueryType type;
+
+            bool operator==(Key const& other) const
+            {
+                return type == other.type && extra == other.extra && std::equal(cells, cells + 6, other.cells);
+            }
+        };
+
+        struct Entry
+        {
+            float staticValue;
+            float dynamicValue;
+            uint32 dynamicGeneration;                       // DYNAMIC_NOT_SET until the dynamic part is computed
+        };
+
+        struct Stats
+        {
+            uint64 hits[MAX_MAP_QUERY_TYPE] = {};
+            uint64 misses[MAX_MAP_QUERY_TYPE] = {};
+            uint64 dynamicRefreshes = 0;                    // Hits computed again after a dynamic tree change
+            uint64 evictions = 0;
+            uint32 size = 0;
+            uint32 capacity = 0;
+        };
+
+        static uint32 const DYNAMIC_NOT_SET = 0xFFFFFFFF;
+
+        MapQueryCache(uint32 capacity, float grid);
+
+        bool IsEnabled() const { return m_shardCapacity != 0; }
+
+        Key LineOfSightKey(float x1, float y1, float z1, float x2, float y2, float z2, uint32 flags) const;
+        Key HeightKey(float x, float y, float z, float maxSearchDist) const;
+
+        bool Find(Key const& key, Entry& entry);
+        void Store(Key const& key, Entry const& entry);
+        void CountDynamicRefresh() { ++m_dynamicRefreshes; }
+        void Clear();
+
+        Stats GetStats() const;
+        void ResetStats();
+
+    private:
+        struct KeyHash
+        {
+            size_t operator()(Key const& key) const;
+        };
+
+        typedef std::list<std::pair<Key, Entry>> EntryList;
+
+        struct Shard
+        {
+            mutable std::mutex lock;
+            EntryList entries;                              // Most recently used first
+            std::unordered_map<Key, EntryList::iterator, KeyHash> index;
+        };
+
+        static uint32 const SHARD_COUNT = 8;
+
+        int32 Quantize(float value) const { return int32(std::floor(value * m_invGrid)); }
+        Shard& GetShard(Key const& key) { return m_shards[KeyHash()(key) % SHARD_COUNT]; }
+
+        uint32 m_shardCapacity;
+        float m_invGrid;
+        Shard m_shards[SHARD_COUNT];
+
+        std::atomic<uint64> m_hits[MAX_MAP_QUERY_TYPE];
+        std::atomic<uint64> m_misses[MAX_MAP_QUERY_TYPE];
+        std::atomic<uint64> m_dynamicRefreshes;
+        std::atomic<uint64> m_evictions;
+};
+
+#endif
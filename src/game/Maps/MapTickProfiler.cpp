@@ -0,0 +1,197 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "MapTickProfiler.h"
+#include "Map.h"
+#include "Policies/SingletonImp.h"
+#include "Config/Config.h"
+#include "Log.h"
+#include "Util.h"
+
+#include <algorithm>
+
+INSTANTIATE_SINGLETON_1(MapTickProfiler);
+
+char const* GetMapTickPhaseName(MapTickPhase phase)
+{
+    switch (phase)
+    {
+        case MAP_TICK_TOTAL:            return "Total";
+        case MAP_TICK_SESSIONS:         return "Sessions";
+        case MAP_TICK_PLAYERS:          return "Players";
+        case MAP_TICK_CELLS:            return "Cells";
+        case MAP_TICK_MOTION:           return "Motion";
+        case MAP_TICK_OBJECT_UPDATES:   return "ObjectUpdates";
+        case MAP_TICK_VISIBILITY:       return "Visibility";
+        case MAP_TICK_CONTINENT_WAIT:   return "ContinentWait";
+        case MAP_TICK_GRIDS:            return "Grids";
+        case MAP_TICK_SCRIPTS:          return "Scripts";
+        case MAP_TICK_ELUNA:            return "Eluna";
+        case MAP_TICK_ANTICHEAT:        return "Anticheat";
+        default:                        return "Unknown";
+    }
+}
+
+MapTickStats::MapTickStats(uint32 mapId) : m_mapId(mapId),
+    m_compressCalls(0), m_compressCacheHits(0), m_compressInBytes(0), m_compressOutBytes(0), m_compressUs(0)
+{
+    if (MapEntry const* entry = sMapStorage.LookupEntry<MapEntry>(mapId))
+        m_mapName = entry->name;
+}
+
+void MapTickStats::Reset()
+{
+    for (auto& phase : m_phases)
+        phase.Reset();
+
+    m_compressCalls = 0;
+    m_compressCacheHits = 0;
+    m_compressInBytes = 0;
+    m_compressOutBytes = 0;
+    m_compressUs = 0;
+}
+
+void MapTickStats::RecordCompression(PacketCompressor::Stats const& delta)
+{
+    if (!delta.calls)
+        return;
+
+    m_compressCalls.fetch_add(delta.calls, std::memory_order_relaxed);
+    m_compressCacheHits.fetch_add(delta.cacheHits, std::memory_order_relaxed);
+    m_compressInBytes.fetch_add(delta.inBytes, std::memory_order_relaxed);
+    m_compressOutBytes.fetch_add(delta.outBytes, std::memory_order_relaxed);
+    m_compressUs.fetch_add(delta.us, std::memory_order_relaxed);
+}
+
+PacketCompressor::Stats MapTickStats::GetCompression() const
+{
+    PacketCompressor::Stats stats;
+    stats.calls = m_compressCalls.load(std::memory_order_relaxed);
+    stats.cacheHits = m_compressCacheHits.load(std::memory_order_relaxed);
+    stats.inBytes = m_compressInBytes.load(std::memory_order_relaxed);
+    stats.outBytes = m_compressOutBytes.load(std::memory_order_relaxed);
+    stats.us = m_compressUs.load(std::memory_order_relaxed);
+    return stats;
+}
+
+static thread_local bool t_inCompressionScope = false;
+
+MapCompressionScope::MapCompressionScope(MapTickStats* stats) : m_stats(nullptr)
+{
+    if (t_inCompressionScope || !stats || !sMapTickProfiler.IsEnabled())
+        return;
+
+    t_inCompressionScope = true;
+    m_stats = stats;
+    m_start = PacketCompressor::GetThreadStats();
+}
+
+MapCompressionScope::~MapCompressionScope()
+{
+    if (!m_stats)
+        return;
+
+    PacketCompressor::Stats const& now = PacketCompressor::GetThreadStats();
+    PacketCompressor::Stats delta;
+    delta.calls = now.calls - m_start.calls;
+    delta.cacheHits = now.cacheHits - m_start.cacheHits;
+    delta.inBytes = now.inBytes - m_start.inBytes;
+    delta.outBytes = now.outBytes - m_start.outBytes;
+    delta.us = now.us - m_start.us;
+    m_stats->RecordCompression(delta);
+
+    t_inCompressionScope = false;
+}
+
+MapTickStats* MapTickProfiler::GetMapStats(uint32 mapId)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    for (auto const& stats : m_stats)
+        if (stats->GetMapId() == mapId)
+            return stats.get();
+
+    m_stats.emplace_back(new MapTickStats(mapId));
+    return m_stats.back().get();
+}
+
+std::vector<MapTickStats const*> MapTickProfiler::GetAllStats() const
+{
+    std::vector<MapTickStats const*> result;
+    std::lock_guard<std::mutex> lock(m_lock);
+    result.reserve(m_stats.size());
+    for (auto const& stats : m_stats)
+        if (stats->GetPhase(MAP_TICK_TOTAL).GetCount())
+            result.push_back(stats.get());
+
+    std::sort(result.begin(), result.end(), [](MapTickStats const* a, MapTickStats const* b) { return a->GetMapId() < b->GetMapId(); });
+    return result;
+}
+
+void MapTickProfiler::Reset()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    for (auto const& stats : m_stats)
+        stats->Reset();
+}
+
+void MapTickProfiler::SetDumpFile(std::string const& fileName)
+{
+    m_dumpFile.clear();
+    if (fileName.empty())
+        return;
+
+    m_dumpFile = sConfig.GetStringDefault("LogsDir", "");
+    if (!m_dumpFile.empty() && m_dumpFile.back() != '/' && m_dumpFile.back() != '\\')
+        m_dumpFile += '/';
+    m_dumpFile += fileName;
+}
+
+void MapTickProfiler::DumpToFile()
+{
+    if (m_dumpFile.empty())
+        return;
+
+    FILE* file = fopen(m_dumpFile.c_str(), "a");
+    if (!file)
+    {
+        sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "MapTickProfiler: unable to open %s", m_dumpFile.c_str());
+        return;
+    }
+
+    fprintf(file, "[%s] map tick profile (us): count p50 p99 max mean\n", TimeToTimestampStr(time(nullptr)).c_str());
+    for (MapTickStats const* stats : GetAllStats())
+    {
+        fprintf(file, "Map %u (%s)\n", stats->GetMapId(), stats->GetMapName());
+        for (uint8 i = 0; i < MAX_MAP_TICK_PHASE; ++i)
+        {
+            LatencyHistogram::Summary summary = stats->GetPhase(MapTickPhase(i)).GetSummary();
+            if (!summary.count)
+                continue;
+
+            fprintf(file, "  %-14s " UI64FMTD " " UI64FMTD " " UI64FMTD " " UI64FMTD " " UI64FMTD "\n", GetMapTickPhaseName(MapTickPhase(i)),
+                summary.count, summary.p50, summary.p99, summary.max, summary.mean);
+        }
+
+        PacketCompressor::Stats const compression = stats->GetCompression();
+        if (compression.calls)
+            fprintf(file, "  Compression    " UI64FMTD " packets (" UI64FMTD " cached) " UI64FMTD " -> " UI64FMTD " bytes in " UI64FMTD " us\n",
+                compression.calls, compression.cacheHits, compression.inBytes, compression.outBytes, compression.us);
+    }
+    fclose(file);
+
+    // Each dump covers the time since the previous one
+    Reset();
+}
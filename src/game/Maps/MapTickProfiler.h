@@ -0,0 +1,215 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_MAPTICKPROFILER_H
+#define MANGOS_MAPTICKPROFILER_H
+
+#include "Common.h"
+#include "LatencyHistogram.h"
+#include "Policies/Singleton.h"
+#include "UpdateData.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum MapTickPhase : uint8
+{
+    MAP_TICK_TOTAL          = 0,                            // Whole Map::Update
+    MAP_TICK_SESSIONS       = 1,                            // WorldSession updates of the players on the map
+    MAP_TICK_PLAYERS        = 2,                            // Movement / spell packets and Player::Update
+    MAP_TICK_CELLS          = 3,                            // Active cells (creatures, gameobjects, ...)
+    MAP_TICK_MOTION         = 4,                            // Asynchronous MotionMaster updates
+    MAP_TICK_OBJECT_UPDATES = 5,                            // SendObjectUpdates
+    MAP_TICK_VISIBILITY     = 6,                            // UpdateVisibilityForRelocations
+    MAP_TICK_CONTINENT_WAIT = 7,                            // Continents waiting for each other
+    MAP_TICK_GRIDS          = 8,                            // Grid state machine (loading / unloading)
+    MAP_TICK_SCRIPTS        = 9,                            // Map scripts, instance data and weather
+    MAP_TICK_ELUNA          = 10,                           // Eluna map hooks
+    MAP_TICK_ANTICHEAT      = 11,                           // Batched movement anticheat checks
+    MAX_MAP_TICK_PHASE
+};
+
+char const* GetMapTickPhaseName(MapTickPhase phase);
+
+/**
+ * @brief Tick durations (in microseconds) of all the instances sharing a map id.
+ */
+class MapTickStats
+{
+    public:
+        explicit MapTickStats(uint32 mapId);
+
+        void Record(MapTickPhase phase, uint32 us) { m_phases[phase].Record(us); }
+        void RecordCompression(PacketCompressor::Stats const& delta);
+        void Reset();
+
+        uint32 GetMapId() const { return m_mapId; }
+        char const* GetMapName() const { return m_mapName.c_str(); }
+        LatencyHistogram const& GetPhase(MapTickPhase phase) const { return m_phases[phase]; }
+        PacketCompressor::Stats GetCompression() const;
+
+    private:
+        uint32 m_mapId;
+        std::string m_mapName;
+        LatencyHistogram m_phases[MAX_MAP_TICK_PHASE];
+
+        // Update packets compressed by the map (see MapCompressionScope)
+        std::atomic<uint64> m_compressCalls;
+        std::atomic<uint64> m_compressCacheHits;
+        std::atomic<uint64> m_compressInBytes;
+        std::atomic<uint64> m_compressOutBytes;
+        std::atomic<uint64> m_compressUs;
+};
+
+/**
+ * @brief Always-on profiler of the map update phases.
+ * Recording only touches atomics of the map's own MapTickStats, lookups by
+ * map id are done once when a map is created.
+ */
+class MapTickProfiler
+{
+    public:
+        MapTickProfiler() : m_enabled(true) {}
+
+        void SetEnabled(bool enabled) { m_enabled = enabled; }
+        bool IsEnabled() const { return m_enabled; }
+
+        /**
+         * @brief GetMapStats returns the stats of the given map id, created on first use and never freed.
+         */
+        MapTickStats* GetMapStats(uint32 mapId);
+
+        /**
+         * @brief GetAllStats returns the stats of every map that recorded at least one tick.
+         */
+        std::vector<MapTickStats const*> GetAllStats() const;
+
+        void Reset();
+
+        /**
+         * @brief SetDumpFile sets the file used by DumpToFile, relative to LogsDir.
+         */
+        void SetDumpFile(std::string const& fileName);
+
+        /**
+         * @brief DumpToFile appends a report of all maps to the dump file and resets the stats.
+         */
+        void DumpToFile();
+
+    private:
+        std::atomic<bool> m_enabled;
+        std::string m_dumpFile;
+        mutable std::mutex m_lock;
+        std::vector<std::unique_ptr<MapTickStats>> m_stats;
+};
+
+#define sMapTickProfiler MaNGOS::Singleton<MapTickProfiler>::Instance()
+
+/**
+ * @brief One sample of a phase run in several sections of the same tick.
+ * The sections add their time to it (see MapTickPhaseTimer), the total is
+ * recorded once when the sample goes out of scope.
+ */
+class MapTickPhaseSample
+{
+    public:
+        MapTickPhaseSample(MapTickStats* stats, MapTickPhase phase) :
+            m_stats(sMapTickProfiler.IsEnabled() ? stats : nullptr), m_phase(phase), m_us(0) {}
+
+        ~MapTickPhaseSample()
+        {
+            if (m_stats)
+                m_stats->Record(m_phase, m_us);
+        }
+
+        MapTickPhaseSample(MapTickPhaseSample const&) = delete;
+        MapTickPhaseSample& operator=(MapTickPhaseSample const&) = delete;
+
+        bool IsActive() const { return m_stats != nullptr; }
+        void Add(uint32 us) { m_us += us; }
+
+    private:
+        MapTickStats* m_stats;
+        MapTickPhase m_phase;
+        uint32 m_us;
+};
+
+/**
+ * @brief Records the time spent in the enclosing scope in a phase of the map tick,
+ * or adds it to a sample of the phase.
+ */
+class MapTickPhaseTimer
+{
+    public:
+        MapTickPhaseTimer(MapTickStats* stats, MapTickPhase phase) :
+            m_stats(sMapTickProfiler.IsEnabled() ? stats : nullptr), m_sample(nullptr), m_phase(phase)
+        {
+            if (m_stats)
+                m_start = std::chrono::steady_clock::now();
+        }
+
+        explicit MapTickPhaseTimer(MapTickPhaseSample& sample) :
+            m_stats(nullptr), m_sample(sample.IsActive() ? &sample : nullptr), m_phase(MAP_TICK_TOTAL)
+        {
+            if (m_sample)
+                m_start = std::chrono::steady_clock::now();
+        }
+
+        ~MapTickPhaseTimer()
+        {
+            if (!m_stats && !m_sample)
+                return;
+
+            uint32 const us = uint32(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count());
+            if (m_sample)
+                m_sample->Add(us);
+            else
+                m_stats->Record(m_phase, us);
+        }
+
+        MapTickPhaseTimer(MapTickPhaseTimer const&) = delete;
+        MapTickPhaseTimer& operator=(MapTickPhaseTimer const&) = delete;
+
+    private:
+        MapTickStats* m_stats;
+        MapTickPhaseSample* m_sample;
+        MapTickPhase m_phase;
+        std::chrono::steady_clock::time_point m_start;
+};
+
+/**
+ * @brief Attributes the packets compressed by the current thread in the enclosing scope to a map.
+ * Nested scopes of the same thread are ignored, the outermost one records.
+ */
+class MapCompressionScope
+{
+    public:
+        explicit MapCompressionScope(MapTickStats* stats);
+        ~MapCompressionScope();
+
+        MapCompressionScope(MapCompressionScope const&) = delete;
+        MapCompressionScope& operator=(MapCompressionScope const&) = delete;
+
+    private:
+        MapTickStats* m_stats;
+        PacketCompressor::Stats m_start;
+};
+
+#endif
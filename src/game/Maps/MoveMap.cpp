@@ -101,7 +101,7 @@ bool MMapManager::loadMapData(uint32 mapId)
     sLog.Out(LOG_BASIC, LOG_LVL_DETAIL, "MMAP:loadMapData: Loaded %03i.mmap", mapId);
 
     // store inside our map list
-    MMapData* mmap_data = new MMapData(mesh);
+    MMapData* mmap_data = new MMapData(mesh, ++tileGenerations);
     mmap_data->mmapLoadedTiles.clear();
 
     std::unique_lock<std::shared_timed_mutex> wlock(loadedMMaps_lock);
@@ -194,6 +194,7 @@ bool MMapManager::loadMap(uint32 mapId, int32 x, int32 y)
     if (dtStatusSucceed(dResult))
     {
         mmap->mmapLoadedTiles.insert(std::pair<uint32, dtTileRef>(packedGridPos, tileRef));
+        mmap->tileGeneration = ++tileGenerations;
         ++loadedTiles;
         return true;
     }
@@ -243,6 +244,7 @@ bool MMapManager::unloadMap(uint32 mapId, int32 x, int32 y)
     else
     {
         mmap->mmapLoadedTiles.erase(packedGridPos);
+        mmap->tileGeneration = ++tileGenerations;
         --loadedTiles;
         return true;
     }
@@ -321,6 +323,13 @@ dtNavMesh const* MMapManager::GetGONavMesh(uint32 mapId)
     return loadedModels[mapId]->navMesh;
 }
 
+uint32 MMapManager::GetTileGeneration(uint32 mapId)
+{
+    std::shared_lock<std::shared_timed_mutex> lock(loadedMMaps_lock);
+    MMapDataSet::const_iterator itr = loadedMMaps.find(mapId);
+    return itr != loadedMMaps.end() ? itr->second->tileGeneration.load() : 0;
+}
+
 dtNavMeshQuery const* MMapManager::GetNavMeshQuery(uint32 mapId)
 {
     if (loadedMMaps.find(mapId) == loadedMMaps.end())
@@ -426,7 +435,7 @@ bool MMapManager::loadGameObject(uint32 displayId)
     sLog.Out(LOG_BASIC, LOG_LVL_DETAIL, "MMAP:loadGameObject: Loaded file %s [size=%u]", fileName, fileHeader.size);
     delete [] fileName;
 
-    MMapData* mmap_data = new MMapData(mesh);
+    MMapData* mmap_data = new MMapData(mesh, ++tileGenerations);
     loadedModels.insert(std::pair<uint32, MMapData*>(displayId, mmap_data));
     return true;
 }
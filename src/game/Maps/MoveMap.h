@@ -29,6 +29,7 @@
 #include "Detour/Include/DetourNavMesh.h"
 #include "Detour/Include/DetourNavMeshQuery.h"
 
+#include <atomic>
 #include <thread>
 #include <shared_mutex>
 
@@ -52,7 +53,7 @@ namespace MMAP
     // dummy struct to hold map's mmap data
     struct MMapData
     {
-        MMapData(dtNavMesh* mesh) : navMesh(mesh) {}
+        MMapData(dtNavMesh* mesh, uint32 generation) : navMesh(mesh), tileGeneration(generation) {}
         ~MMapData()
         {
             for (const auto& itr : navMeshQueries)
@@ -69,6 +70,7 @@ namespace MMAP
         std::shared_timed_mutex navMeshQueries_lock;
         MMapTileSet mmapLoadedTiles;        // maps [map grid coords] to [dtTile]
         std::mutex tilesLoading_lock;
+        std::atomic<uint32> tileGeneration; // changes with every tile loaded or unloaded
     };
 
     typedef std::unordered_map<uint32, MMapData*> MMapDataSet;
@@ -78,7 +80,7 @@ namespace MMAP
     class MMapManager
     {
         public:
-            MMapManager() : loadedTiles(0) {}
+            MMapManager() : loadedTiles(0), tileGenerations(0) {}
             ~MMapManager();
 
             bool loadMap(uint32 mapId, int32 x, int32 y);
@@ -94,6 +96,8 @@ namespace MMAP
             dtNavMeshQuery const* GetModelNavMeshQuery(uint32 displayId);
             dtNavMesh const* GetNavMesh(uint32 mapId);
             dtNavMesh const* GetGONavMesh(uint32 displayId);
+            // paths found on the navmesh of the map are outdated once this changes, see MapPathCache
+            uint32 GetTileGeneration(uint32 mapId);
 
             uint32 getLoadedTilesCount() const { return loadedTiles; }
             uint32 getLoadedMapsCount() const { return loadedMMaps.size(); }
@@ -107,6 +111,7 @@ namespace MMAP
 
             uint32 loadedTiles;
             std::mutex lockForModels;
+            std::atomic<uint32> tileGenerations; // never the same generation twice, even after a map unload
     };
 
     // static class
@@ -39,6 +39,7 @@ PathInfo::PathInfo(Unit const* owner) :
     m_navMesh(nullptr), m_navMeshQuery(nullptr), m_targetAllowedFlags(0)
 {
     //DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::PathInfo for %u \n", m_sourceUnit->GetGUIDLow());
+    SnapshotSource();
     createFilter();
 }
 
@@ -53,15 +54,39 @@ void PathInfo::setPathLengthLimit(float dist)
     m_pointPathLimit = std::min<uint32>(MAX_POINT_PATH_LENGTH, uint32(dist / SMOOTH_PATH_STEP_SIZE));
 }
 
-bool PathInfo::calculate(float destX, float destY, float destZ, bool forceDest, bool offsets)
+void PathInfo::SnapshotSource()
 {
     float x, y, z;
     m_sourceUnit->GetSafePosition(x, y, z, m_transport);
+    m_source.position = Vector3(x, y, z);
+
+    m_source.map = m_sourceUnit->FindMap();
+    m_source.terrain = m_source.map ? m_source.map->GetTerrain() : nullptr;
+    m_source.mapId = m_sourceUnit->GetMapId();
+    m_source.guidLow = m_sourceUnit->GetGUIDLow();
+    m_source.boundingRadius = m_sourceUnit->GetObjectBoundingRadius();
+    m_source.minSwimDepth = m_sourceUnit->GetMinSwimDepth();
+    m_source.canFly = m_sourceUnit->CanFly();
+    m_source.canSwim = m_sourceUnit->CanSwim();
+    m_source.canWalk = m_sourceUnit->CanWalk();
+    m_source.isPlayer = m_sourceUnit->GetTypeId() == TYPEID_PLAYER;
+    m_source.isFlyingCreature = m_sourceUnit->GetTypeId() == TYPEID_UNIT && ((Creature*)m_sourceUnit)->CanFly();
+    m_source.ignorePathfinding = m_sourceUnit->HasUnitState(UNIT_STAT_IGNORE_PATHFINDING);
+}
 
-    return calculate(Vector3(x, y, z), Vector3(destX, destY, destZ), forceDest, offsets);
+bool PathInfo::calculate(float destX, float destY, float destZ, bool forceDest, bool offsets)
+{
+    SnapshotSource();
+    return calculateFromSnapshot(m_source.position, Vector3(destX, destY, destZ), forceDest, offsets);
 }
 
 bool PathInfo::calculate(Vector3 const& start, Vector3 dest, bool forceDest, bool offsets)
+{
+    SnapshotSource();
+    return calculateFromSnapshot(start, dest, forceDest, offsets);
+}
+
+bool PathInfo::calculateFromSnapshot(Vector3 const& start, Vector3 dest, bool forceDest, bool offsets)
 {
     m_pathPoints.clear();
     m_forceDestination = forceDest;
@@ -83,7 +108,7 @@ bool PathInfo::calculate(Vector3 const& start, Vector3 dest, bool forceDest, boo
         }
         m_navMeshQuery = mmap->GetModelNavMeshQuery(m_transport->GetDisplayId());
     }
-    else if (!(m_navMeshQuery = mmap->GetNavMeshQuery(m_sourceUnit->GetMapId())))
+    else if (!(m_navMeshQuery = mmap->GetNavMeshQuery(m_source.mapId)))
     {
         if (BuildPathWithoutMMaps(start, dest))
         {
@@ -99,7 +124,7 @@ bool PathInfo::calculate(Vector3 const& start, Vector3 dest, bool forceDest, boo
 
     // make sure navMesh works - we can run on map w/o mmap
     // check if the start and end point have a .mmtile loaded (can we pass via not loaded tile on the way?)
-    if (!m_navMesh || !m_navMeshQuery || m_sourceUnit->HasUnitState(UNIT_STAT_IGNORE_PATHFINDING) ||
+    if (!m_navMesh || !m_navMeshQuery || m_source.ignorePathfinding ||
         !HaveTiles(start) || !HaveTiles(dest))
     {
         BuildShortcut();
@@ -111,7 +136,7 @@ bool PathInfo::calculate(Vector3 const& start, Vector3 dest, bool forceDest, boo
 
     // check if destination moved - if not we can optimize something here
     // we are following old, precalculated path?
-    float dist = m_sourceUnit->GetObjectBoundingRadius();
+    float dist = m_source.boundingRadius;
     if (inRange(oldDest, dest, dist, dist) && m_pathPoints.size() > 2)
     {
         // our target is not moving - we just coming closer
@@ -128,6 +153,26 @@ bool PathInfo::calculate(Vector3 const& start, Vector3 dest, bool forceDest, boo
     }
 }
 
+void PathInfo::AdoptPath(PathInfo const& other, Vector3 const& dest)
+{
+    m_pathPoints = other.m_pathPoints;
+    m_type = other.m_type;
+    m_forceDestination = other.m_forceDestination;
+    m_polyLength = other.m_polyLength;
+    memcpy(m_pathPolyRefs, other.m_pathPolyRefs, sizeof(dtPolyRef) * m_polyLength);
+    setStartPosition(other.m_startPosition);
+    m_endPosition = other.m_endPosition;
+    m_actualEndPosition = other.m_actualEndPosition;
+
+    // the path was computed for a destination next to ours, take the last step to ours
+    if (!m_pathPoints.empty() && (m_type & PATHFIND_NORMAL) && inRange(m_endPosition, m_actualEndPosition, 1.0f, 1.0f) &&
+        inRange(m_endPosition, dest, 3.0f, 3.0f))
+    {
+        m_pathPoints.back() = dest;
+        setEndPosition(dest);
+    }
+}
+
 dtPolyRef PathInfo::FindWalkPoly(dtNavMeshQuery const* query, float const* pointYZX, dtQueryFilter const& filter, float* closestPointYZX, float zSearchDist)
 {
     ASSERT(query);
@@ -167,14 +212,14 @@ void PathInfo::BuildPolyPath(Vector3 const& startPos, Vector3 const& endPos)
     float startPoint[VERTEX_SIZE] = {startPos.y, startPos.z, startPos.x};
     float endPoint[VERTEX_SIZE] = {endPos.y, endPos.z, endPos.x};
 
-    bool const canSwimToDestination = m_sourceUnit->CanSwim() &&
-                                      m_sourceUnit->CanSwimAtPosition(startPos) &&
-                                      m_sourceUnit->CanSwimAtPosition(endPos);
+    bool const canSwimToDestination = m_source.canSwim &&
+                                      CanSwimAtPosition(startPos) &&
+                                      CanSwimAtPosition(endPos);
 
     // First case : easy flying / swimming
-    if (canSwimToDestination || m_sourceUnit->CanFly())
+    if (canSwimToDestination || m_source.canFly)
     {
-        if (!m_sourceUnit->GetMap()->FindCollisionModel(startPos.x, startPos.y, startPos.z, endPos.x, endPos.y, endPos.z))
+        if (!m_source.map->FindCollisionModel(startPos.x, startPos.y, startPos.z, endPos.x, endPos.y, endPos.z))
         {
             if (canSwimToDestination)
                 BuildUnderwaterPath();
@@ -185,7 +230,7 @@ void PathInfo::BuildPolyPath(Vector3 const& startPos, Vector3 const& endPos)
             }
             return;
         }
-        else if (m_sourceUnit->CanFly())
+        else if (m_source.canFly)
             m_forceDestination = true;
     }
     dtPolyRef startPoly = getPolyByLocation(startPoint, &distToStartPoly);
@@ -199,11 +244,11 @@ void PathInfo::BuildPolyPath(Vector3 const& startPos, Vector3 const& endPos)
         //DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: (startPoly == 0 || endPoly == 0)\n");
         BuildShortcut();
         // Check for swimming or flying shortcut
-        if ((startPoly == INVALID_POLYREF && m_sourceUnit->GetTerrain()->IsSwimmable(startPos.x, startPos.y, startPos.z)) ||
-            (endPoly == INVALID_POLYREF && m_sourceUnit->GetTerrain()->IsSwimmable(endPos.x, endPos.y, endPos.z)))
-            m_type = m_sourceUnit->CanSwim() ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH;
+        if ((startPoly == INVALID_POLYREF && m_source.terrain->IsSwimmable(startPos.x, startPos.y, startPos.z)) ||
+            (endPoly == INVALID_POLYREF && m_source.terrain->IsSwimmable(endPos.x, endPos.y, endPos.z)))
+            m_type = m_source.canSwim ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH;
         else
-            m_type = (m_sourceUnit->GetTypeId() == TYPEID_UNIT && ((Creature*)m_sourceUnit)->CanFly())
+            m_type = m_source.isFlyingCreature
                      ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH | PATHFIND_FLYPATH) : PATHFIND_NOPATH;
         return;
     }
@@ -220,7 +265,7 @@ void PathInfo::BuildPolyPath(Vector3 const& startPos, Vector3 const& endPos)
             return;
         }
 
-        if (m_sourceUnit->CanFly())
+        if (m_source.canFly)
         {
             BuildShortcut();
             m_type = PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH);
@@ -234,7 +279,7 @@ void PathInfo::BuildPolyPath(Vector3 const& startPos, Vector3 const& endPos)
             setActualEndPosition(Vector3(endPoint[2], endPoint[0], endPoint[1]));
         }
 
-        if (!(m_sourceUnit->CanSwim() && m_sourceUnit->CanSwimAtPosition(m_actualEndPosition)))
+        if (!(m_source.canSwim && CanSwimAtPosition(m_actualEndPosition)))
             m_type = PATHFIND_INCOMPLETE;
     }
 
@@ -246,6 +291,8 @@ void PathInfo::BuildPolyPath(Vector3 const& startPos, Vector3 const& endPos)
     bool endPolyFound = false;
     uint32 pathStartIndex = 0;
     uint32 pathEndIndex = 0;
+    // only for a whole new path, a cut or extended one does not match the cached corridor
+    PathCacheQuery cacheQuery = PathCacheQuery();
 
     if (m_polyLength)
     {
@@ -336,7 +383,7 @@ void PathInfo::BuildPolyPath(Vector3 const& startPos, Vector3 const& endPos)
             // this is probably an error state, but we'll leave it
             // and hopefully recover on the next Update
             // we still need to copy our preffix
-            sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "%u's Path Build failed: 0 length path r=0x%x", m_sourceUnit->GetGUIDLow(), dtResult);
+            sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "%u's Path Build failed: 0 length path r=0x%x", m_source.guidLow, dtResult);
         }
 
         //DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++  m_polyLength=%u prefixPolyLength=%u suffixPolyLength=%u \n",m_polyLength, prefixPolyLength, suffixPolyLength);
@@ -360,23 +407,47 @@ void PathInfo::BuildPolyPath(Vector3 const& startPos, Vector3 const& endPos)
         //if (threadId != m_navMeshQuery->m_owningThread)
             //sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "CRASH: We are using a dtNavMeshQuery from thread %u which belongs to thread %u!", threadId, m_navMeshQuery->m_owningThread);
 
-        dtStatus dtResult = m_navMeshQuery->findPath(
-                                startPoly,          // start polygon
-                                endPoly,            // end polygon
-                                startPoint,         // start position
-                                endPoint,           // end position
-                                &m_filter,           // polygon search filter
-                                m_pathPolyRefs,     // [out] path
-                                (int*)&m_polyLength,
-                                MAX_PATH_LENGTH);   // max number of polygons in output path
+        // routes asked again and again (waypoints, escorts) are served by the path cache of the map
+        Map* map = m_transport ? nullptr : m_source.map;
+        if (map && map->GetPathCache().IsEnabled())
+        {
+            cacheQuery.cache = &map->GetPathCache();
+            cacheQuery.key.startPoly = startPoly;
+            cacheQuery.key.endPoly = endPoly;
+            cacheQuery.key.includeFlags = m_filter.getIncludeFlags();
+            cacheQuery.key.excludeFlags = m_filter.getExcludeFlags();
+            cacheQuery.generation = MMAP::MMapFactory::createOrGetMMapManager()->GetTileGeneration(m_source.mapId);
+        }
 
-        if (!m_polyLength || dtStatusFailed(dtResult))
+        std::vector<uint64> corridor;
+        if (cacheQuery.cache && cacheQuery.cache->FindCorridor(cacheQuery.key, cacheQuery.generation, corridor))
         {
-            // only happens if we passed bad data to findPath(), or navmesh is messed up
-            sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "%u's Path Build failed: 0 length path. Result=0x%x", m_sourceUnit->GetGUIDLow(), dtResult);
-            BuildShortcut();
-            m_type = PATHFIND_NOPATH;
-            return;
+            m_polyLength = corridor.size();
+            std::copy(corridor.begin(), corridor.end(), m_pathPolyRefs);
+        }
+        else
+        {
+            dtStatus dtResult = m_navMeshQuery->findPath(
+                                    startPoly,          // start polygon
+                                    endPoly,            // end polygon
+                                    startPoint,         // start position
+                                    endPoint,           // end position
+                                    &m_filter,           // polygon search filter
+                                    m_pathPolyRefs,     // [out] path
+                                    (int*)&m_polyLength,
+                                    MAX_PATH_LENGTH);   // max number of polygons in output path
+
+            if (!m_polyLength || dtStatusFailed(dtResult))
+            {
+                // only happens if we passed bad data to findPath(), or navmesh is messed up
+                sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "%u's Path Build failed: 0 length path. Result=0x%x", m_source.guidLow, dtResult);
+                BuildShortcut();
+                m_type = PATHFIND_NOPATH;
+                return;
+            }
+
+            if (cacheQuery.cache)
+                cacheQuery.cache->StoreCorridor(cacheQuery.key, cacheQuery.generation, std::vector<uint64>(m_pathPolyRefs, m_pathPolyRefs + m_polyLength));
         }
     }
 
@@ -386,16 +457,25 @@ void PathInfo::BuildPolyPath(Vector3 const& startPos, Vector3 const& endPos)
     else
         m_type = PATHFIND_INCOMPLETE;
 
-    BuildPointPath(startPoint, endPoint, distToStartPoly, distToEndPoly);
+    BuildPointPath(startPoint, endPoint, distToStartPoly, distToEndPoly, cacheQuery.cache ? &cacheQuery : nullptr);
 }
 
-void PathInfo::BuildPointPath(float const* startPoint, float const* endPoint, float distToStartPoly, float distToEndPoly)
+void PathInfo::BuildPointPath(float const* startPoint, float const* endPoint, float distToStartPoly, float distToEndPoly, PathCacheQuery const* cacheQuery)
 {
     // generate the point-path out of our up-to-date poly-path
     float pathPoints[MAX_POINT_PATH_LENGTH * VERTEX_SIZE];
     uint32 pointCount = 0;
     dtStatus dtResult = DT_FAILURE;
-    if (m_useStraightPath)
+    std::vector<float> cachedPoints;
+    bool const cached = cacheQuery && cacheQuery->cache->FindPoints(cacheQuery->key, cacheQuery->generation, startPoint, endPoint,
+                                                                    m_useStraightPath, m_pointPathLimit, cachedPoints);
+    if (cached)
+    {
+        pointCount = cachedPoints.size() / VERTEX_SIZE;
+        std::copy(cachedPoints.begin(), cachedPoints.end(), pathPoints);
+        dtResult = DT_SUCCESS;
+    }
+    else if (m_useStraightPath)
     {
         dtResult = m_navMeshQuery->findStraightPath(
                        startPoint,         // start position
@@ -431,6 +511,9 @@ void PathInfo::BuildPointPath(float const* startPoint, float const* endPoint, fl
         return;
     }
 
+    if (cacheQuery && !cached)
+        cacheQuery->cache->StorePoints(cacheQuery->key, cacheQuery->generation, startPoint, endPoint, m_useStraightPath, m_pointPathLimit, pathPoints, pointCount);
+
     m_pathPoints.resize(pointCount);
     for (uint32 i = 0; i < pointCount; ++i)
         m_pathPoints[i] = Vector3(pathPoints[i * VERTEX_SIZE + 2], pathPoints[i * VERTEX_SIZE], pathPoints[i * VERTEX_SIZE + 1]);
@@ -457,7 +540,7 @@ void PathInfo::BuildPointPath(float const* startPoint, float const* endPoint, fl
 
         
         m_type |= PATHFIND_DEST_FORCED;
-        if (m_sourceUnit->CanFly())
+        if (m_source.canFly)
             m_type |= PATHFIND_FLYPATH;
     }
 
@@ -476,7 +559,7 @@ void PathInfo::BuildShortcut()
     m_pathPoints[1] = getActualEndPosition();
 
     m_type = PATHFIND_SHORTCUT;
-    if (m_sourceUnit->CanFly())
+    if (m_source.canFly)
         m_type |= PATHFIND_FLYPATH | PATHFIND_NORMAL;
 }
 
@@ -492,16 +575,18 @@ void PathInfo::BuildUnderwaterPath()
     m_pathPoints[1] = getActualEndPosition();
 
     GridMapLiquidData liquidData;
-    uint32 liquidStatus = m_sourceUnit->GetTerrain()->getLiquidStatus(getActualEndPosition().x, getActualEndPosition().y, getActualEndPosition().z, MAP_ALL_LIQUIDS, &liquidData);
+    uint32 liquidStatus = m_source.terrain->getLiquidStatus(getActualEndPosition().x, getActualEndPosition().y, getActualEndPosition().z, MAP_ALL_LIQUIDS, &liquidData);
     // No water here ...
     if (liquidStatus == LIQUID_MAP_NO_WATER)
     {
         m_type = PATHFIND_SHORTCUT;
-        if (m_sourceUnit->CanWalk())
+        if (m_source.canWalk)
         {
             // Find real height
             m_type |= PATHFIND_NORMAL;
-            m_sourceUnit->UpdateGroundPositionZ(m_pathPoints[1].x, m_pathPoints[1].y, m_pathPoints[1].z);
+            float const groundZ = m_source.map->GetHeight(m_pathPoints[1].x, m_pathPoints[1].y, m_pathPoints[1].z, true);
+            if (groundZ > INVALID_HEIGHT)
+                m_pathPoints[1].z = groundZ + 0.05f;        // as WorldObject::UpdateGroundPositionZ
         }
         else
         {
@@ -513,7 +598,7 @@ void PathInfo::BuildUnderwaterPath()
     m_type = PATHFIND_BLANK;
     if (m_pathPoints[1].z > liquidData.level)
     {
-        if (!m_sourceUnit->CanFly())
+        if (!m_source.canFly)
         {
             m_pathPoints[1].z = liquidData.level;
             if (m_pathPoints[1].z > (liquidData.level + 2))
@@ -592,10 +677,10 @@ bool PathInfo::BuildPathWithoutMMaps(Vector3 const& start, Vector3 const& dest)
     clear();
     float stepSize = 5.0f;
     float totalDistance = Geometry::GetDistance3D(start, dest);
-    if (totalDistance <= stepSize || m_sourceUnit->CanFly() || 
-        (m_sourceUnit->CanSwim() &&
-         m_sourceUnit->CanSwimAtPosition(start) &&
-         m_sourceUnit->CanSwimAtPosition(dest)))
+    if (totalDistance <= stepSize || m_source.canFly || 
+        (m_source.canSwim &&
+         CanSwimAtPosition(start) &&
+         CanSwimAtPosition(dest)))
     {
         m_pathPoints.resize(2);
         m_pathPoints[0] = start;
@@ -611,7 +696,8 @@ bool PathInfo::BuildPathWithoutMMaps(Vector3 const& start, Vector3 const& dest)
     
     maxSteps *= 2;
 
-    bool ok = BuildPathStep(dest, start, m_sourceUnit->FindMap(), m_pathPoints, checkedPositions, stepSize, maxSteps, m_sourceUnit->GetAngle(dest.x, dest.y));
+    bool ok = BuildPathStep(dest, start, m_source.map, m_pathPoints, checkedPositions, stepSize, maxSteps,
+                            Geometry::GetAngle(dest.x, dest.y, m_source.position.x, m_source.position.y));
     m_pathPoints.push_back(dest);
     return ok;
 }
@@ -621,12 +707,12 @@ void PathInfo::createFilter()
     unsigned short includeFlags = 0x0;
     unsigned short excludeFlags = 0x0;
 
-    if (m_sourceUnit->CanWalk())
+    if (m_source.canWalk)
         includeFlags |= NAV_GROUND;          // walk
 
-    if (m_sourceUnit->CanSwim())
+    if (m_source.canSwim)
     {
-        if (m_sourceUnit->GetTypeId() == TYPEID_PLAYER)
+        if (m_source.isPlayer)
             includeFlags |= NAV_WATER;
         else // creatures don't take environmental damage
             includeFlags |= (NAV_WATER | NAV_MAGMA | NAV_SLIME);
@@ -654,6 +740,12 @@ void PathInfo::FillTargetAllowedFlags(Unit* target)
         m_targetAllowedFlags |= NAV_STEEP_SLOPES;
 }
 
+bool PathInfo::CanSwimAtPosition(Vector3 const& p) const
+{
+    // as Unit::CanSwimAtPosition
+    return m_source.terrain->IsSwimmable(p.x, p.y, p.z, m_source.minSwimDepth);
+}
+
 bool PathInfo::HaveTiles(Vector3 const& p) const
 {
     if (m_transport)
@@ -894,7 +986,7 @@ dtStatus PathInfo::findSmoothPath(float const* startPos, float const* endPos,
         npolys = fixupShortcuts(polys, npolys, m_navMeshQuery);
 
         if (dtStatusFailed(m_navMeshQuery->getPolyHeight(polys[0], result, &result[1])))
-            sLog.Out(LOG_BASIC, LOG_LVL_DEBUG, "Cannot find height at position X: %f Y: %f Z: %f for %s", result[2], result[0], result[1], m_sourceUnit->GetName());
+            sLog.Out(LOG_BASIC, LOG_LVL_DEBUG, "Cannot find height at position X: %f Y: %f Z: %f for %u", result[2], result[0], result[1], m_source.guidLow);
         result[1] += 0.5f;
         dtVcopy(iterPos, result);
 
@@ -24,12 +24,15 @@
 #include "../recastnavigation/Detour/Include/DetourNavMesh.h"
 #include "../recastnavigation/Detour/Include/DetourNavMeshQuery.h"
 #include "MoveSplineInitArgs.h"
+#include "MapPathCache.h"
 
 
 using Movement::Vector3;
 using Movement::PointsArray;
 
 class Unit;
+class Map;
+class TerrainInfo;
 class GenericTransport;
 struct GridMapLiquidData;
 
@@ -56,6 +59,32 @@ enum PathType
     PATHFIND_CASTER         = 0x0100,
 };
 
+// The path cache of the map, when the path is searched on its navmesh
+struct PathCacheQuery
+{
+    MapPathCache* cache;
+    MapPathCache::Key key;
+    uint32 generation;
+};
+
+// What the path computation reads of the moving unit, copied on the map thread
+struct PathSourceInfo
+{
+    Map* map = nullptr;
+    TerrainInfo const* terrain = nullptr;
+    uint32 mapId = 0;
+    uint32 guidLow = 0;
+    Vector3 position;                                       // Safe position of the unit
+    float boundingRadius = 0.0f;
+    float minSwimDepth = 0.0f;
+    bool canFly = false;
+    bool canSwim = false;
+    bool canWalk = false;
+    bool isPlayer = false;
+    bool isFlyingCreature = false;                          // Creature::CanFly, fly paths through navmesh holes
+    bool ignorePathfinding = false;
+};
+
 class PathInfo
 {
     public:
@@ -65,6 +94,15 @@ class PathInfo
         // return value : true if new path was calculated
         bool calculate(float destX, float destY, float destZ, bool forceDest = false, bool offsets = false);
         bool calculate(Vector3 const& start, Vector3 dest, bool forceDest = false, bool offsets = false);
+        // copies the state of the unit used by calculateFromSnapshot, on the map thread
+        void SnapshotSource();
+        // same as calculate, with the unit as copied by the last SnapshotSource: does not touch the unit
+        // and can run on any thread (see PathfindingService)
+        bool calculateFromSnapshot(Vector3 const& start, Vector3 dest, bool forceDest = false, bool offsets = false);
+        // map of the unit at the last SnapshotSource
+        Map const* GetSourceMap() const { return m_source.map; }
+        // copies a path computed for another unit (see PathfindingService), ending at dest when it could reach its own
+        void AdoptPath(PathInfo const& other, Vector3 const& dest);
 
         void setUseStrightPath(bool useStraightPath) { m_useStraightPath = useStraightPath; };
         void setPathLengthLimit(float distance);
@@ -107,6 +145,7 @@ class PathInfo
         Vector3        m_actualEndPosition;  // {x, y, z} of the closest possible point to given destination
         GenericTransport*       m_transport;
         Unit const* const       m_sourceUnit;       // the unit that is moving
+        PathSourceInfo          m_source;           // copy of the unit read by the path computation
         dtNavMesh const*        m_navMesh;          // the nav mesh
         dtNavMeshQuery const*   m_navMeshQuery;     // the nav mesh query used to find the path
         uint32          m_targetAllowedFlags;
@@ -128,9 +167,10 @@ class PathInfo
 
         dtPolyRef getPolyByLocation(float const* point, float *distance, uint32 flags = 0);
         bool HaveTiles(Vector3 const& p) const;
+        bool CanSwimAtPosition(Vector3 const& p) const;
 
         void BuildPolyPath(Vector3 const& startPos, Vector3 const& endPos);
-        void BuildPointPath(float const* startPoint, float const* endPoint, float distToStartPoly, float distToEndPoly);
+        void BuildPointPath(float const* startPoint, float const* endPoint, float distToStartPoly, float distToEndPoly, PathCacheQuery const* cacheQuery = nullptr);
         void BuildShortcut();
         void BuildUnderwaterPath();
         bool BuildPathWithoutMMaps(Vector3 const& start, Vector3 const& dest); // build path using only maps following terrain (no vmap or mmap)
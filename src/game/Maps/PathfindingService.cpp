@@ -0,0 +1,312 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "PathfindingService.h"
+#include "Unit.h"
+#include "Policies/SingletonImp.h"
+
+#include <algorithm>
+#include <cmath>
+
+INSTANTIATE_SINGLETON_1(PathfindingService);
+
+// Requests from and to the same cells of this size share their path
+static float const PATH_SHARE_GRID = 2.0f;
+
+enum PathRequestFlags
+{
+    PATH_REQUEST_FLAG_FORCE_DEST        = 0x01,
+    PATH_REQUEST_FLAG_CAN_FLY           = 0x02,
+    PATH_REQUEST_FLAG_CAN_SWIM          = 0x04,
+    PATH_REQUEST_FLAG_CAN_WALK          = 0x08,
+    PATH_REQUEST_FLAG_PLAYER            = 0x10,
+    PATH_REQUEST_FLAG_IGNORE_PATHFINDING = 0x20,
+};
+
+static uint64 ElapsedMicroseconds(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+{
+    return uint64(std::chrono::duration_cast<std::chrono::microseconds>(to - from).count());
+}
+
+bool PathRequest::Key::operator==(Key const& other) const
+{
+    return mapId == other.mapId && instanceId == other.instanceId && flags == other.flags &&
+           std::equal(cells, cells + 6, other.cells);
+}
+
+size_t PathRequest::KeyHash::operator()(Key const& key) const
+{
+    // FNV-1a over the map, the cells and the flags
+    uint64 hash = 14695981039346656037ULL;
+    auto mix = [&hash](uint32 value)
+    {
+        hash ^= value;
+        hash *= 1099511628211ULL;
+    };
+    mix(key.mapId);
+    mix(key.instanceId);
+    for (int32 cell : key.cells)
+        mix(uint32(cell));
+    mix(key.flags);
+    return size_t(hash ^ (hash >> 32));
+}
+
+PathRequest::PathRequest(Unit const* owner, Vector3 const& start, Vector3 const& dest, bool forceDest, Key const& key) :
+    m_owner(owner), m_path(owner), m_start(start), m_dest(dest), m_forceDest(forceDest), m_key(key),
+    m_state(PATH_REQUEST_QUEUED), m_submitTime(std::chrono::steady_clock::now())
+{
+}
+
+void PathRequestHandle::Release()
+{
+    if (!m_request)
+        return;
+
+    sPathfindingService.Release(m_request, m_request->GetOwner() == m_owner);
+    m_request.reset();
+    m_owner = nullptr;
+}
+
+void PathfindingService::Start(uint32 threads)
+{
+    if (!threads || IsEnabled())
+        return;
+
+    m_stop = false;
+    m_running.resize(threads);
+    m_statsStart = std::chrono::steady_clock::now();
+    for (uint32 i = 0; i < threads; ++i)
+        m_threads.emplace_back(&PathfindingService::Work, this, i);
+}
+
+void PathfindingService::Stop()
+{
+    if (!IsEnabled())
+        return;
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_stop = true;
+        for (auto const& request : m_queue)
+        {
+            request->m_state = PATH_REQUEST_CANCELED;
+            ++m_stats.canceled;
+        }
+        m_queue.clear();
+        m_shared.clear();
+    }
+    m_queueCondition.notify_all();
+
+    for (auto& thread : m_threads)
+        thread.join();
+    m_threads.clear();
+    m_running.clear();
+}
+
+void PathfindingService::Submit(PathRequestHandle& handle, Unit const* owner, Vector3 const& dest, bool forceDest)
+{
+    handle.Release();
+
+    float x, y, z;
+    owner->GetSafePosition(x, y, z);
+    Vector3 const start(x, y, z);
+
+    PathRequest::Key key;
+    key.mapId = owner->GetMapId();
+    key.instanceId = owner->GetInstanceId();
+    key.cells[0] = int32(std::floor(start.x / PATH_SHARE_GRID));
+    key.cells[1] = int32(std::floor(start.y / PATH_SHARE_GRID));
+    key.cells[2] = int32(std::floor(start.z / PATH_SHARE_GRID));
+    key.cells[3] = int32(std::floor(dest.x / PATH_SHARE_GRID));
+    key.cells[4] = int32(std::floor(dest.y / PATH_SHARE_GRID));
+    key.cells[5] = int32(std::floor(dest.z / PATH_SHARE_GRID));
+    key.flags = 0;
+    if (forceDest)
+        key.flags |= PATH_REQUEST_FLAG_FORCE_DEST;
+    if (owner->CanFly())
+        key.flags |= PATH_REQUEST_FLAG_CAN_FLY;
+    if (owner->CanSwim())
+        key.flags |= PATH_REQUEST_FLAG_CAN_SWIM;
+    if (owner->CanWalk())
+        key.flags |= PATH_REQUEST_FLAG_CAN_WALK;
+    if (owner->IsPlayer())
+        key.flags |= PATH_REQUEST_FLAG_PLAYER;
+    if (owner->HasUnitState(UNIT_STAT_IGNORE_PATHFINDING))
+        key.flags |= PATH_REQUEST_FLAG_IGNORE_PATHFINDING;
+
+    handle.m_owner = owner;
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    ++m_stats.submitted;
+
+    auto itr = m_shared.find(key);
+    if (itr != m_shared.end())
+    {
+        ++m_stats.deduplicated;
+        handle.m_request = itr->second;
+        return;
+    }
+
+    // The unit is copied here, the worker does not touch it
+    handle.m_request = std::shared_ptr<PathRequest>(new PathRequest(owner, start, dest, forceDest, key));
+    m_shared.emplace(key, handle.m_request);
+    m_queue.push_back(handle.m_request);
+    m_stats.maxQueueSize = std::max(m_stats.maxQueueSize, uint32(m_queue.size()));
+    m_queueCondition.notify_one();
+}
+
+void PathfindingService::Release(std::shared_ptr<PathRequest> const& request, bool owner)
+{
+    // Units sharing the request of another one do not use it past this point
+    if (!owner)
+        return;
+
+    std::unique_lock<std::mutex> guard(m_lock);
+    Cancel(guard, request);
+}
+
+void PathfindingService::Cancel(std::unique_lock<std::mutex>& guard, std::shared_ptr<PathRequest> const& request)
+{
+    switch (request->GetState())
+    {
+        case PATH_REQUEST_QUEUED:
+        {
+            request->m_state = PATH_REQUEST_CANCELED;
+            m_queue.erase(std::find(m_queue.begin(), m_queue.end(), request));
+            auto itr = m_shared.find(request->m_key);
+            if (itr != m_shared.end() && itr->second == request)
+                m_shared.erase(itr);
+            ++m_stats.canceled;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void PathfindingService::CancelRequests(Unit const* owner)
+{
+    if (!IsEnabled())
+        return;
+
+    std::unique_lock<std::mutex> guard(m_lock);
+    for (auto itr = m_queue.begin(); itr != m_queue.end();)
+    {
+        std::shared_ptr<PathRequest> const request = *itr;
+        if (request->m_owner == owner)
+        {
+            request->m_state = PATH_REQUEST_CANCELED;
+            itr = m_queue.erase(itr);
+            auto shared = m_shared.find(request->m_key);
+            if (shared != m_shared.end() && shared->second == request)
+                m_shared.erase(shared);
+            ++m_stats.canceled;
+        }
+        else
+            ++itr;
+    }
+}
+
+void PathfindingService::CancelMapRequests(Map const* map)
+{
+    if (!IsEnabled())
+        return;
+
+    std::unique_lock<std::mutex> guard(m_lock);
+    for (auto itr = m_queue.begin(); itr != m_queue.end();)
+    {
+        std::shared_ptr<PathRequest> const request = *itr;
+        if (request->m_path.GetSourceMap() == map)
+        {
+            request->m_state = PATH_REQUEST_CANCELED;
+            itr = m_queue.erase(itr);
+            auto shared = m_shared.find(request->m_key);
+            if (shared != m_shared.end() && shared->second == request)
+                m_shared.erase(shared);
+            ++m_stats.canceled;
+        }
+        else
+            ++itr;
+    }
+
+    m_doneCondition.wait(guard, [this, map]()
+    {
+        return std::none_of(m_running.begin(), m_running.end(), [map](std::shared_ptr<PathRequest> const& request)
+        {
+            return request && request->m_path.GetSourceMap() == map;
+        });
+    });
+}
+
+void PathfindingService::Work(uint32 index)
+{
+    for (;;)
+    {
+        std::shared_ptr<PathRequest> request;
+        {
+            std::unique_lock<std::mutex> guard(m_lock);
+            m_queueCondition.wait(guard, [this]() { return m_stop || !m_queue.empty(); });
+            if (m_stop)
+                return;
+
+            request = m_queue.front();
+            m_queue.pop_front();
+            request->m_state = PATH_REQUEST_RUNNING;
+            m_running[index] = request;
+
+            ++m_stats.started;
+            uint64 const queueTime = ElapsedMicroseconds(request->m_submitTime, std::chrono::steady_clock::now());
+            m_stats.totalQueueTime += queueTime;
+            m_stats.maxQueueTime = std::max(m_stats.maxQueueTime, queueTime);
+        }
+
+        // Detour queries of this thread use its own dtNavMeshQuery, see MMapManager::GetNavMeshQuery
+        std::chrono::steady_clock::time_point const startTime = std::chrono::steady_clock::now();
+        request->m_path.calculateFromSnapshot(request->m_start, request->m_dest, request->m_forceDest);
+        uint64 const computeTime = ElapsedMicroseconds(startTime, std::chrono::steady_clock::now());
+
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            request->m_state = PATH_REQUEST_DONE;
+            m_running[index].reset();
+            auto itr = m_shared.find(request->m_key);
+            if (itr != m_shared.end() && itr->second == request)
+                m_shared.erase(itr);
+
+            ++m_stats.completed;
+            m_stats.totalComputeTime += computeTime;
+            m_stats.maxComputeTime = std::max(m_stats.maxComputeTime, computeTime);
+        }
+        m_doneCondition.notify_all();
+    }
+}
+
+PathfindingService::Stats PathfindingService::GetStats() const
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    Stats stats = m_stats;
+    stats.queueSize = m_queue.size();
+    stats.threads = m_threads.size();
+    stats.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_statsStart).count();
+    return stats;
+}
+
+void PathfindingService::ResetStats()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_stats = Stats();
+    m_statsStart = std::chrono::steady_clock::now();
+}
@@ -0,0 +1,193 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_PATHFINDINGSERVICE_H
+#define MANGOS_PATHFINDINGSERVICE_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+#include "PathFinder.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class Unit;
+class Map;
+
+enum PathRequestState : uint8
+{
+    PATH_REQUEST_QUEUED     = 0,
+    PATH_REQUEST_RUNNING    = 1,
+    PATH_REQUEST_DONE       = 2,
+    PATH_REQUEST_CANCELED   = 3,
+};
+
+/**
+ * @brief A path computed by the pathfinding workers for a unit.
+ * The path is computed with the movement capabilities of the unit that submitted
+ * the request first, other units asking for the same path share the request.
+ * The workers only read the copy of the unit made at submit (PathInfo::SnapshotSource).
+ */
+class PathRequest
+{
+    public:
+        PathRequestState GetState() const { return PathRequestState(m_state.load()); }
+        bool IsDone() const { return GetState() == PATH_REQUEST_DONE; }
+        bool IsCanceled() const { return GetState() == PATH_REQUEST_CANCELED; }
+
+        Unit const* GetOwner() const { return m_owner; }
+        // Only valid once the request is done
+        PathInfo const& GetPath() const { return m_path; }
+
+    private:
+        friend class PathfindingService;
+
+        struct Key
+        {
+            uint32 mapId;
+            uint32 instanceId;
+            int32 cells[6];                                 // Quantized start and destination
+            uint32 flags;                                   // Force destination, movement capabilities of the unit
+
+            bool operator==(Key const& other) const;
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(Key const& key) const;
+        };
+
+        PathRequest(Unit const* owner, Vector3 const& start, Vector3 const& dest, bool forceDest, Key const& key);
+
+        Unit const* m_owner;
+        PathInfo m_path;
+        Vector3 m_start;
+        Vector3 m_dest;
+        bool m_forceDest;
+        Key m_key;
+        std::atomic<uint8> m_state;
+        std::chrono::steady_clock::time_point m_submitTime;
+};
+
+/**
+ * @brief The request of a movement generator, released with the generator.
+ * Releasing the request submitted for the unit cancels it when it is still
+ * queued, a running request is left to its worker and dropped once done.
+ */
+class PathRequestHandle
+{
+    public:
+        PathRequestHandle() : m_owner(nullptr) {}
+        ~PathRequestHandle() { Release(); }
+
+        PathRequestHandle(PathRequestHandle const&) = delete;
+        PathRequestHandle& operator=(PathRequestHandle const&) = delete;
+
+        bool IsSet() const { return m_request != nullptr; }
+        PathRequest const* operator->() const { return m_request.get(); }
+
+        void Release();
+
+    private:
+        friend class PathfindingService;
+
+        std::shared_ptr<PathRequest> m_request;
+        Unit const* m_owner;
+};
+
+/**
+ * @brief Computes the paths of the chase and follow movement generators on
+ * dedicated threads (Pathfinding.AsyncThreads), each with its own navmesh query.
+ * A generator submits its request and keeps moving on its current spline, the
+ * path is used by its next update once done.
+ * Requests of units with the same movement capabilities from the same cell
+ * (PATH_SHARE_GRID yards) to the same cell are computed once: units chasing the
+ * same target from a pack share the path, each one ending at its own destination.
+ * The requests of a unit are canceled when it leaves its map.
+ */
+class PathfindingService
+{
+    public:
+        struct Stats
+        {
+            uint64 submitted = 0;
+            uint64 deduplicated = 0;                        // Requests sharing a queued or running request
+            uint64 started = 0;
+            uint64 completed = 0;
+            uint64 canceled = 0;
+            uint64 totalQueueTime = 0;                      // Microseconds between submit and start
+            uint64 maxQueueTime = 0;
+            uint64 totalComputeTime = 0;                    // Microseconds
+            uint64 maxComputeTime = 0;
+            uint32 queueSize = 0;
+            uint32 maxQueueSize = 0;
+            uint32 threads = 0;
+            double elapsedSeconds = 0.0;                    // Since start or reset
+        };
+
+        PathfindingService() : m_stop(false) {}
+        ~PathfindingService() { Stop(); }
+
+        void Start(uint32 threads);
+        void Stop();
+        bool IsEnabled() const { return !m_threads.empty(); }
+
+        /**
+         * @brief Submit queues the path of the unit from its current position to dest,
+         * or shares a request of another unit for the same path.
+         */
+        void Submit(PathRequestHandle& handle, Unit const* owner, Vector3 const& dest, bool forceDest);
+
+        // Cancels the queued requests of the unit, the running ones end on their own
+        void CancelRequests(Unit const* owner);
+        // Cancels the queued requests on the map and waits for the running ones: the workers use the map
+        void CancelMapRequests(Map const* map);
+
+        Stats GetStats() const;
+        void ResetStats();
+
+    private:
+        friend class PathRequestHandle;
+
+        typedef std::unordered_map<PathRequest::Key, std::shared_ptr<PathRequest>, PathRequest::KeyHash> SharedRequestMap;
+
+        void Release(std::shared_ptr<PathRequest> const& request, bool owner);
+        void Cancel(std::unique_lock<std::mutex>& guard, std::shared_ptr<PathRequest> const& request);
+        void Work(uint32 index);
+
+        mutable std::mutex m_lock;
+        std::condition_variable m_queueCondition;
+        std::condition_variable m_doneCondition;
+        std::deque<std::shared_ptr<PathRequest>> m_queue;
+        std::vector<std::shared_ptr<PathRequest>> m_running;    // By worker
+        SharedRequestMap m_shared;                              // Queued and running requests
+        std::vector<std::thread> m_threads;
+        bool m_stop;
+
+        Stats m_stats;
+        std::chrono::steady_clock::time_point m_statsStart;
+};
+
+#define sPathfindingService MaNGOS::Singleton<PathfindingService>::Instance()
+
+#endif
@@ -1014,9 +1014,11 @@ bool Map::ScriptCommand_ModifyThreat(ScriptInfo const& script, WorldObject* sour
 
     if (script.modThreat.target == SO_MODIFYTHREAT_ALL_ATTACKERS)
     {
-        ThreatList const& threatList = pSource->GetThreatManager().getThreatList();
-        for (const auto i : threatList)
-            if (Unit* Temp = pSource->GetMap()->GetUnit(i->getUnitGuid()))
+        // modifyThreatPercent can remove references from the threat list
+        std::vector<ObjectGuid> guids;
+        pSource->FillGuidsListFromThreatList(guids);
+        for (const auto& guid : guids)
+            if (Unit* Temp = pSource->GetMap()->GetUnit(guid))
                 pSource->GetThreatManager().modifyThreatPercent(Temp, script.x);
     }
     else
@@ -134,9 +134,29 @@ void TargetedMovementGeneratorMedium<T, D>::_setTargetLocation(T &owner)
 
     // allow pets following their master to cheat while generating paths
     bool petFollowing = (isPet && owner.HasUnitState(UNIT_STAT_FOLLOW));
-    Movement::MoveSplineInit init(owner, "TargetedMovementGenerator");
     path.SetTransport(transport);
-    path.calculate(x, y, z, petFollowing);
+    if (!transport && sPathfindingService.IsEnabled())
+    {
+        if (m_pathRequest.IsSet() && m_pathRequest->IsCanceled())
+            m_pathRequest.Release();
+
+        // keep moving on the current spline until the workers computed the path
+        if (!m_pathRequest.IsSet())
+            sPathfindingService.Submit(m_pathRequest, &owner, Vector3(x, y, z), petFollowing);
+        if (!m_pathRequest->IsDone())
+        {
+            m_bRecalculateTravel = true;
+            owner.GetMotionMaster()->SetNeedAsyncUpdate();
+            return;
+        }
+
+        path.AdoptPath(m_pathRequest->GetPath(), Vector3(x, y, z));
+        m_pathRequest.Release();
+    }
+    else
+        path.calculate(x, y, z, petFollowing);
+
+    Movement::MoveSplineInit init(owner, "TargetedMovementGenerator");
 
     PathType pathType = path.getPathType();
     m_bReachable = pathType & (PATHFIND_NORMAL | PATHFIND_DEST_FORCED);
@@ -22,6 +22,7 @@
 #include "MovementGenerator.h"
 #include "FollowerReference.h"
 #include "PathFinder.h"
+#include "PathfindingService.h"
 #include "Unit.h"
 
 class TargetedMovementGeneratorBase
@@ -75,6 +76,8 @@ class TargetedMovementGeneratorMedium
         float m_fTargetLastY;
         float m_fTargetLastZ;
         bool  m_bTargetOnTransport;
+
+        PathRequestHandle m_pathRequest;                    // Path computed by the pathfinding workers
 };
 
 template<class T>
@@ -327,6 +327,7 @@ void ObjectAccessor::RemoveObject(MasterPlayer* player)
 
 template <class T> typename HashMapHolder<T>::MapType HashMapHolder<T>::m_objectMap;
 template <class T> std::shared_timed_mutex HashMapHolder<T>::i_lock;
+template <class T> typename HashMapHolder<T>::IndexType HashMapHolder<T>::m_index;
 
 // Global definitions for the hashmap storage
 
@@ -26,6 +26,7 @@
 #include "Platform/Define.h"
 #include "Policies/Singleton.h"
 #include "Policies/ThreadingModel.h"
+#include "Multithreading/ShardedReadMap.h"
 #include "GridDefines.h"
 #include "Object.h"
 #include "Player.h"
@@ -51,23 +52,28 @@ class HashMapHolder
         typedef std::shared_lock<LockType> ReadGuard;
         typedef std::unique_lock<LockType> WriteGuard;
 
+        typedef ShardedReadMap<ObjectGuid, T*> IndexType;
+
         static void Insert(T* o)
         {
             WriteGuard guard(i_lock);
             m_objectMap[o->GetObjectGuid()] = o;
+            m_index.Insert(o->GetObjectGuid(), o);
         }
 
         static void Remove(T* o)
         {
             WriteGuard guard(i_lock);
             m_objectMap.erase(o->GetObjectGuid());
+            m_index.Erase(o->GetObjectGuid());
         }
 
+        // Lock free, does not contend with the writers nor with the iterations under GetLock()
         static T* Find(ObjectGuid guid)
         {
-            ReadGuard guard(i_lock);
-            typename MapType::iterator itr = m_objectMap.find(guid);
-            return (itr != m_objectMap.end()) ? itr->second : nullptr;
+            T* object = nullptr;
+            m_index.Find(guid, object);
+            return object;
         }
 
         static MapType& GetContainer() { return m_objectMap; }
@@ -80,7 +86,8 @@ class HashMapHolder
         HashMapHolder() {}
 
         static LockType i_lock;
-        static MapType  m_objectMap;
+        static MapType  m_objectMap;                        // Iterated under i_lock
+        static IndexType m_index;                           // Same content, for the lookups
 };
 
 class ObjectAccessor : public MaNGOS::Singleton<ObjectAccessor, MaNGOS::ClassLevelLockable<ObjectAccessor, std::mutex> >
@@ -1161,6 +1161,8 @@ struct SQLCreatureLoader : public SQLStorageLoaderBase<SQLCreatureLoader, SQLSto
     {
         dst = D(sScriptMgr.GetScriptId(src));
     }
+
+    uint64 GetSnapshotSalt() const { return sScriptMgr.GetScriptNamesHash(); }
 };
 
 void ObjectMgr::LoadCreatureTemplates()
@@ -6312,6 +6314,8 @@ struct SQLMapLoader : public SQLStorageLoaderBase<SQLMapLoader, SQLStorage>
     {
         dst = D(sScriptMgr.GetScriptId(src));
     }
+
+    uint64 GetSnapshotSalt() const { return sScriptMgr.GetScriptNamesHash(); }
 };
 
 void ObjectMgr::LoadMapTemplate()
@@ -6384,6 +6388,8 @@ struct SQLWorldLoader : public SQLStorageLoaderBase<SQLWorldLoader, SQLStorage>
     {
         dst = D(sScriptMgr.GetScriptId(src));
     }
+
+    uint64 GetSnapshotSalt() const { return sScriptMgr.GetScriptNamesHash(); }
 };
 
 void ObjectMgr::LoadNPCText()
@@ -7581,6 +7587,8 @@ struct SQLGameObjectLoader : public SQLStorageLoaderBase<SQLGameObjectLoader, SQ
     {
         dst = D(sScriptMgr.GetScriptId(src));
     }
+
+    uint64 GetSnapshotSalt() const { return sScriptMgr.GetScriptNamesHash(); }
 };
 
 inline void CheckGOLockId(GameObjectInfo const* goInfo, uint32 dataN, uint32 N)
@@ -11457,6 +11465,33 @@ void ObjectMgr::LoadAreaTemplate()
             sAreaFlagByMapId.insert(AreaFlagByMapId::value_type(itr->MapId, itr->ExploreFlag));
 }
 
+// Loads every SQLStorage the way the server does, used by mangosd --build-snapshots
+void ObjectMgr::BuildStorageSnapshots()
+{
+    uint32 const patch = sWorld.GetWowPatch();
+
+    SQLCreatureLoader creatureLoader;
+    creatureLoader.LoadProgressive(sCreatureStorage, patch);
+    sCreatureDataAddonStorage.LoadProgressive(patch);
+    sCreatureDisplayInfoAddonStorage.LoadProgressive(SUPPORTED_CLIENT_BUILD, "build");
+    sCreatureSpellDataStorage.LoadProgressive(SUPPORTED_CLIENT_BUILD, "build");
+    sEquipmentStorage.LoadProgressive(patch, "patch", true);
+
+    SQLGameObjectLoader gameObjectLoader;
+    gameObjectLoader.LoadProgressive(sGOStorage, patch);
+    sGameObjectDisplayInfoAddonStorage.Load();
+
+    SQLMapLoader mapLoader;
+    mapLoader.LoadProgressive(sMapStorage, patch);
+    sAreaStorage.Load();
+
+    SQLWorldLoader conditionLoader;
+    conditionLoader.Load(sConditionStorage);
+
+    sPageTextStore.Load();
+    sMailTemplateStorage.Load();
+}
+
 void ObjectMgr::LoadAreaLocales()
 {
     m_AreaLocaleMap.clear();
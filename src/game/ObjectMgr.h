@@ -860,6 +860,7 @@ class ObjectMgr
         void LoadMailTemplate();
         void LoadConditions();
         void LoadAreaTemplate();
+        void BuildStorageSnapshots();
         void LoadAreaLocales();
 
         void LoadNPCText();
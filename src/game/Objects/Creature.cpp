@@ -257,7 +257,7 @@ void Creature::AddToWorld()
 
 #ifdef ENABLE_ELUNA
     if (!inWorld)
-        sEluna->OnAddToWorld(this);
+        GetEluna()->OnAddToWorld(this);
 #endif /* ENABLE_ELUNA */
 
 }
@@ -267,7 +267,7 @@ void Creature::RemoveFromWorld()
 
 #ifdef ENABLE_ELUNA
     if (IsInWorld())
-        sEluna->OnRemoveFromWorld(this);
+        GetEluna()->OnRemoveFromWorld(this);
 #endif /* ENABLE_ELUNA */
 
     // Remove the creature from the accessor
@@ -149,7 +149,7 @@ void GameObject::AddToWorld()
         m_procsUpdateTimer = sWorld.getConfig(CONFIG_UINT32_SPELL_PROC_DELAY) - (WorldTimer::getMSTime() % sWorld.getConfig(CONFIG_UINT32_SPELL_PROC_DELAY));
 #ifdef ENABLE_ELUNA
     if (!inWorld)
-        sEluna->OnAddToWorld(this);
+        GetEluna()->OnAddToWorld(this);
 #endif /* ENABLE_ELUNA */  
 }
 
@@ -165,7 +165,7 @@ void GameObject::RemoveFromWorld()
     if (IsInWorld())
     {
 #ifdef ENABLE_ELUNA
-        sEluna->OnRemoveFromWorld(this);
+        GetEluna()->OnRemoveFromWorld(this);
 #endif /* ENABLE_ELUNA */
         if (AI())
             AI()->OnRemoveFromWorld();
@@ -279,7 +279,7 @@ bool GameObject::Create(uint32 guidlow, uint32 name_id, Map* map, float x, float
 	
 	// Used by Eluna
 #ifdef ENABLE_ELUNA
-    sEluna->OnSpawn(this);
+    GetEluna()->OnSpawn(this);
 #endif /* ENABLE_ELUNA */    
 
 
@@ -362,7 +362,7 @@ void GameObject::Update(uint32 update_diff, uint32 /*p_time*/)
 
     // Used by Eluna
 #ifdef ENABLE_ELUNA
-    sEluna->UpdateAI(this, update_diff);
+    GetEluna()->UpdateAI(this, update_diff);
 #endif /* ENABLE_ELUNA */
 
     switch (m_lootState)
@@ -2284,7 +2284,7 @@ void GameObject::SetLootState(LootState state)
 {
     m_lootState = state;
 #ifdef ENABLE_ELUNA
-    sEluna->OnLootStateChanged(this, state);
+    GetEluna()->OnLootStateChanged(this, state);
 #endif /* ENABLE_ELUNA */
     UpdateCollisionState();
 }
@@ -2294,7 +2294,7 @@ void GameObject::SetGoState(GOState state)
     //SetByteValue(GAMEOBJECT_BYTES_1, 0, state); // 3.3.5
     SetUInt32Value(GAMEOBJECT_STATE, state);
 #ifdef ENABLE_ELUNA
-    sEluna->OnGameObjectStateChanged(this, state);
+    GetEluna()->OnGameObjectStateChanged(this, state);
 #endif /* ENABLE_ELUNA */
     UpdateCollisionState();
 }
@@ -2393,6 +2393,8 @@ void GameObject::UpdateCollisionState()
         return;
 
     bool enabled = GetGoType() == GAMEOBJECT_TYPE_CHEST ? getLootState() == GO_READY : GetGoState() == GO_STATE_READY;
+    if (m_model->isEnabled() != enabled)
+        GetMap()->InvalidateDynamicQueries();
     m_model->enable(enabled);
 }
 
@@ -256,7 +256,7 @@ void Item::UpdateDuration(Player* owner, uint32 diff)
     {
         // Used by Eluna
 #ifdef ENABLE_ELUNA
-        sEluna->OnExpire(owner, GetProto());
+        owner->GetEluna()->OnExpire(owner, GetProto());
 #endif /* ENABLE_ELUNA */
         owner->DestroyItem(GetBagSlot(), GetSlot(), true);
         return;
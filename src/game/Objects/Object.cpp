@@ -399,6 +399,88 @@ void Object::BuildValuesUpdateBlockForPlayer(UpdateData& data, Player* target) c
         BuildValuesUpdateBlockForPlayer(data, updateMask, target);
 }
 
+void Object::BuildValuesUpdateBlockForPlayer(UpdateData& data, Player* target, ValuesUpdateCache& cache) const
+{
+    uint16 const* flags = nullptr;
+    uint16 visibleFlag = GetUpdateFieldFlagsForTarget(target, flags);
+    ASSERT(flags);
+
+    // Gamemasters see some values differently (UNIT_FIELD_FLAGS)
+    uint32 const key = uint32(visibleFlag) | (target->IsGameMaster() ? 0x10000 : 0);
+
+    ValuesUpdateCache::iterator itr = std::find_if(cache.begin(), cache.end(), [key](ValuesUpdateAudience const& audience) { return audience.key == key; });
+    if (itr == cache.end())
+    {
+        cache.push_back(ValuesUpdateAudience());
+        itr = cache.end() - 1;
+        itr->key = key;
+        itr->mask.SetCount(m_valuesCount);
+        _SetUpdateBits(itr->mask, flags, visibleFlag);
+        itr->targetDependent = itr->mask.HasData() && HasTargetDependentValues(itr->mask);
+
+        if (itr->mask.HasData() && !itr->targetDependent)
+        {
+            itr->block.reserve(500);
+            itr->block << uint8(UPDATETYPE_VALUES);
+#if SUPPORTED_CLIENT_BUILD > CLIENT_BUILD_1_8_4
+            itr->block << GetPackGUID();
+#else
+            itr->block << GetGUID();
+#endif
+            BuildValuesUpdate(UPDATETYPE_VALUES, &itr->block, &itr->mask, target);
+        }
+    }
+
+    if (!itr->mask.HasData())
+        return;
+
+    if (itr->targetDependent)
+    {
+        // BuildValuesUpdate may add bits to the mask
+        UpdateMask updateMask(itr->mask);
+        BuildValuesUpdateBlockForPlayer(data, updateMask, target);
+    }
+    else
+        data.AddUpdateBlock(itr->block);
+}
+
+// Values serialized differently depending on the observer (see BuildValuesUpdate)
+bool Object::HasTargetDependentValues(UpdateMask const& updateMask) const
+{
+    switch (GetTypeId())
+    {
+        case TYPEID_GAMEOBJECT:
+            // Dynamic flags are always sent and depend on the quests of the observer
+            return !static_cast<GameObject const*>(this)->IsTransport();
+        case TYPEID_CORPSE:
+            return updateMask.GetBit(CORPSE_FIELD_DYNAMIC_FLAGS);
+        case TYPEID_UNIT:
+        case TYPEID_PLAYER:
+        {
+            if (updateMask.GetBit(UNIT_DYNAMIC_FLAGS))
+                return true;
+
+            if (updateMask.GetBit(UNIT_NPC_FLAGS) && GetTypeId() == TYPEID_UNIT &&
+                (m_uint32Values[UNIT_NPC_FLAGS] & (UNIT_NPC_FLAG_TRAINER | UNIT_NPC_FLAG_STABLEMASTER | UNIT_NPC_FLAG_FLIGHTMASTER)))
+                return true;
+
+            if (updateMask.GetBit(UNIT_FIELD_FACTIONTEMPLATE) && static_cast<Unit const*>(this)->GetCharmerOrOwnerPlayerOrPlayerItself())
+                return true;
+
+            if (GetTypeId() == TYPEID_PLAYER && updateMask.GetBit(PLAYER_FLAGS) && (m_uint32Values[PLAYER_FLAGS] & PLAYER_FLAGS_FFA_PVP))
+                return true;
+
+            if (!sWorld.getConfig(CONFIG_BOOL_OBJECT_HEALTH_VALUE_SHOW) &&
+                (updateMask.GetBit(UNIT_FIELD_HEALTH) || updateMask.GetBit(UNIT_FIELD_MAXHEALTH)))
+                return true;
+
+            return false;
+        }
+        default:
+            return false;
+    }
+}
+
 void Object::BuildValuesUpdateBlockForPlayerWithFlags(UpdateData& data, Player* target, UpdateFieldFlags flags, bool includingEmpty) const
 {
     UpdateMask updateMask;
@@ -1052,6 +1134,11 @@ void Object::_SetUpdateBits(UpdateMask& updateMask, Player* target) const
     uint16 visibleFlag = GetUpdateFieldFlagsForTarget(target, flags);
     ASSERT(flags);
 
+    _SetUpdateBits(updateMask, flags, visibleFlag);
+}
+
+void Object::_SetUpdateBits(UpdateMask& updateMask, uint16 const* flags, uint16 visibleFlag) const
+{
     for (uint16 index = 0; index < m_valuesCount; ++index)
     {
         if ((m_uint32Values_mirror[index] != m_uint32Values[index]) && (flags[index] & visibleFlag))
@@ -1306,7 +1393,7 @@ bool Object::PrintIndexError(uint32 index, bool set) const
     return false;
 }
 
-void Object::BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players)
+void Object::BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players, ValuesUpdateCache* cache)
 {
     UpdateDataMapType::iterator iter = update_players.find(pl);
 
@@ -1317,7 +1404,10 @@ void Object::BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_play
         iter = p.first;
     }
 
-    BuildValuesUpdateBlockForPlayer(iter->second, iter->first);
+    if (cache)
+        BuildValuesUpdateBlockForPlayer(iter->second, iter->first, *cache);
+    else
+        BuildValuesUpdateBlockForPlayer(iter->second, iter->first);
 }
 
 void Object::AddToClientUpdateList()
@@ -2225,8 +2315,7 @@ void WorldObject::SetMap(Map* map)
 
     #ifdef ENABLE_ELUNA
     delete elunaEvents;
-    // On multithread replace this with a pointer to map's Eluna pointer stored in a map
-    elunaEvents = new ElunaEventProcessor(&Eluna::GEluna, this);
+    elunaEvents = new ElunaEventProcessor(map->GetElunaPtr(), this);
     #endif
 
     // Order is important, must be done after m_currMap is set
@@ -2239,6 +2328,13 @@ Map* WorldObject::GetMap() const
     return m_currMap;
 }
 
+#ifdef ENABLE_ELUNA
+Eluna* WorldObject::GetEluna() const
+{
+    return m_currMap ? m_currMap->GetEluna() : sEluna;
+}
+#endif /* ENABLE_ELUNA */
+
 void WorldObject::ResetMap()
 {
     #ifdef ENABLE_ELUNA
@@ -2428,7 +2524,7 @@ Creature* WorldObject::SummonCreature(uint32 id, float x, float y, float z, floa
 
 #ifdef ENABLE_ELUNA
     if (Unit* summoner = ToUnit())
-        sEluna->OnSummoned(pCreature, summoner);
+        GetEluna()->OnSummoned(pCreature, summoner);
 #endif /* ENABLE_ELUNA */
 
     // Creature Linking, Initial load is handled like respawn
@@ -2781,6 +2877,7 @@ struct WorldObjectChangeAccumulator
 {
     UpdateDataMapType &i_updateDatas;
     WorldObject &i_object;
+    ValuesUpdateCache i_audiences;
     WorldObjectChangeAccumulator(WorldObject &obj, UpdateDataMapType &d) : i_updateDatas(d), i_object(obj)
     {
         // send self fields changes in another way, otherwise
@@ -2795,7 +2892,7 @@ struct WorldObjectChangeAccumulator
         {
             Player* owner = iter.getSource()->GetOwner();
             if (owner != &i_object && owner->IsInVisibleList_Unsafe(&i_object))
-                i_object.BuildUpdateDataForPlayer(owner, i_updateDatas);
+                i_object.BuildUpdateDataForPlayer(owner, i_updateDatas, &i_audiences);
         }
     }
 
@@ -27,6 +27,7 @@
 #include "ByteBuffer.h"
 #include "UpdateFields.h"
 #include "UpdateData.h"
+#include "UpdateMask.h"
 #include "ObjectGuid.h"
 #include "SharedDefines.h"
 #include "ObjectDefines.h"
@@ -47,7 +48,6 @@ class Unit;
 class GameObject;
 class SpellCaster;
 class Map;
-class UpdateMask;
 class InstanceData;
 class TerrainInfo;
 class ZoneScript;
@@ -56,10 +56,22 @@ struct FactionEntry;
 struct FactionTemplateEntry;
 #ifdef ENABLE_ELUNA
 class ElunaEventProcessor;
+class Eluna;
 #endif /* ENABLE_ELUNA */
 
 typedef std::unordered_map<Player*, UpdateData> UpdateDataMapType;
 
+// Values update built once per audience (fields visible to the observer + gamemaster state)
+// during a single BuildUpdateData call, and reused for every observer of that audience.
+struct ValuesUpdateAudience
+{
+    uint32 key;
+    UpdateMask mask;
+    ByteBuffer block;                                       // empty when the mask has target dependent fields
+    bool targetDependent;
+};
+typedef std::vector<ValuesUpdateAudience> ValuesUpdateCache;
+
 //use this class to measure time between world update ticks
 //essential for units updating their spells after cells become active
 class WorldUpdateCounter
@@ -368,6 +380,7 @@ class Object
         void ExecuteDelayedActions();
 
         void BuildValuesUpdateBlockForPlayer(UpdateData& data, Player* target) const;
+        void BuildValuesUpdateBlockForPlayer(UpdateData& data, Player* target, ValuesUpdateCache& cache) const;
         void BuildValuesUpdateBlockForPlayerWithFlags(UpdateData& data, Player* target, UpdateFieldFlags flags, bool includingEmpty = false) const;
         void BuildValuesUpdateBlockForPlayer(UpdateData& data, UpdateMask& updateMask, Player* target) const;
         void BuildOutOfRangeUpdateBlock(UpdateData& data) const;
@@ -375,7 +388,7 @@ class Object
 
         void BuildMovementUpdate(ByteBuffer* data, uint8 updateFlags) const;
         void BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* updateMask, Player* target) const;
-        void BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players);
+        void BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players, ValuesUpdateCache* cache = nullptr);
 
         void SendOutOfRangeUpdateToPlayer(Player* player);
 
@@ -614,6 +627,8 @@ class Object
         uint16 GetUpdateFieldFlagsForTarget(Player const* target, uint16 const*& flags) const;
         void _SetCreateBits(UpdateMask& updateMask, Player* target) const;
         void _SetUpdateBits(UpdateMask& updateMask, Player* target) const;
+        void _SetUpdateBits(UpdateMask& updateMask, uint16 const* flags, uint16 visibleFlag) const;
+        bool HasTargetDependentValues(UpdateMask const& updateMask) const;
         void _LoadIntoDataField(std::string const& data, uint32 startOffset, uint32 count);
 
         uint16 m_objectType;
@@ -1004,6 +1019,8 @@ class WorldObject : public Object
 		
 #ifdef ENABLE_ELUNA
 		ElunaEventProcessor* elunaEvents;
+        // Lua state of the current map, the world state when not in a map
+        Eluna* GetEluna() const;
 #endif /* ENABLE_ELUNA */  
     protected:
         explicit WorldObject();
@@ -22,6 +22,7 @@
 #include <unordered_map>
 #include <cmath>
 #include <sstream>
+#include <atomic>
 
 #include "Player.h"
 #include "Bag.h"
@@ -79,6 +80,7 @@
 #include "PlayerBroadcaster.h"
 #include "CharacterDatabaseCache.h"
 #include "GameEventMgr.h"
+#include "PlayerSaveScheduler.h"
 #include "world/scourge_invasion.h"
 #include "world/world_event_wareffort.h"
 
@@ -144,6 +146,11 @@ enum CharacterFlags
 
 static uint32 copseReclaimDelay[MAX_DEATH_COUNT] = { 30, 60, 120 };
 
+// Totals of Player::SaveToDB, see Player::GetSaveStats
+static std::atomic<uint64> s_saveCount(0);
+static std::atomic<uint64> s_saveStatements(0);
+static std::atomic<uint64> s_saveBytes(0);
+
 //== MirrorTimer ===============================================
 
 MirrorTimer::Status MirrorTimer::FetchStatus()
@@ -600,6 +607,10 @@ Player::Player(WorldSession* session) : Unit(),
     // randomize first save time in range [CONFIG_UINT32_INTERVAL_SAVE] around [CONFIG_UINT32_INTERVAL_SAVE]
     // this must help in case next save after mass player load after server startup
     m_nextSave = urand(m_nextSave / 2, m_nextSave * 3 / 2);
+    m_aurasSaved = false;
+    m_cooldownsSaved = false;
+    m_lastSaveStatements = 0;
+    m_lastSaveBytes = 0;
 
     ClearResurrectRequestData();
 
@@ -1653,9 +1664,13 @@ void Player::Update(uint32 update_diff, uint32 p_time)
     {
         if (update_diff >= m_nextSave)
         {
-            // m_nextSave reseted in SaveToDB call
-            SaveToDB();
-            sLog.Out(LOG_BASIC, LOG_LVL_DETAIL, "Player '%s' (GUID: %u) saved", GetName(), GetGUIDLow());
+            // Autosaves are spread and rate limited by the save scheduler, logout still saves
+            if (sPlayerSaveScheduler.RequestSave(this))
+            {
+                // m_nextSave reseted in SaveToDB call
+                SaveToDB();
+                sLog.Out(LOG_BASIC, LOG_LVL_DETAIL, "Player '%s' (GUID: %u) saved", GetName(), GetGUIDLow());
+            }
         }
         else
             m_nextSave -= update_diff;
@@ -3573,7 +3588,7 @@ void Player::GiveLevel(uint32 level)
 
 #ifdef ENABLE_ELUNA
     int oldLevel = GetLevel();
-    sEluna->OnLevelChanged(this, oldLevel);
+    GetEluna()->OnLevelChanged(this, oldLevel);
 #endif
 }
 
@@ -4369,14 +4384,12 @@ void Player::_LoadSpellCooldowns(QueryResult* result)
 
 void Player::_SaveSpellCooldowns()
 {
+    static SqlStatementID deleteSpellCooldowns;
     static SqlStatementID deleteSpellCooldown;
-
-    // delete all old cooldown
-    SqlStatement stmt = CharacterDatabase.CreateStatement(deleteSpellCooldown, "DELETE FROM `character_spell_cooldown` WHERE `guid` = ?");
-    stmt.PExecute(GetGUIDLow());
-
     static SqlStatementID insertSpellCooldown;
+    static SqlStatementID updateSpellCooldown;
 
+    std::map<uint32, SavedCooldown> cooldowns;
     for (auto& cdItr : m_cooldownMap)
     {
         auto& cdData = cdItr.second;
@@ -4386,18 +4399,69 @@ void Player::_SaveSpellCooldowns()
             TimePoint cTime = TimePoint::min();
             cdData->GetSpellCDExpireTime(sTime);
             cdData->GetCatCDExpireTime(cTime);
-            uint64 spellExpireTime = uint64(Clock::to_time_t(sTime));
-            uint64 catExpireTime = uint64(Clock::to_time_t(cTime));
 
-            stmt = CharacterDatabase.CreateStatement(insertSpellCooldown, "INSERT INTO `character_spell_cooldown` (`guid`, `spell`, `spell_expire_time`, `category`, `category_expire_time`, `item_id`) VALUES( ?, ?, ?, ?, ?, ?)");
+            SavedCooldown& cooldown = cooldowns[cdData->GetSpellId()];
+            cooldown.spellExpireTime = uint64(Clock::to_time_t(sTime));
+            cooldown.category = cdData->GetCategory();
+            cooldown.categoryExpireTime = uint64(Clock::to_time_t(cTime));
+            cooldown.itemId = cdData->GetItemId();
+        }
+    }
+
+    // The rows loaded at login are unknown, replace all of them once
+    if (!m_cooldownsSaved)
+    {
+        SqlStatement stmt = CharacterDatabase.CreateStatement(deleteSpellCooldowns, "DELETE FROM `character_spell_cooldown` WHERE `guid` = ?");
+        stmt.PExecute(GetGUIDLow());
+        m_savedCooldowns.clear();
+        m_cooldownsSaved = true;
+    }
+
+    for (auto itr = m_savedCooldowns.begin(); itr != m_savedCooldowns.end();)
+    {
+        if (cooldowns.find(itr->first) != cooldowns.end())
+        {
+            ++itr;
+            continue;
+        }
+
+        SqlStatement stmt = CharacterDatabase.CreateStatement(deleteSpellCooldown, "DELETE FROM `character_spell_cooldown` WHERE `guid` = ? AND `spell` = ?");
+        stmt.PExecute(GetGUIDLow(), itr->first);
+        itr = m_savedCooldowns.erase(itr);
+    }
+
+    for (auto const& itr : cooldowns)
+    {
+        SavedCooldown const& cooldown = itr.second;
+        auto saved = m_savedCooldowns.find(itr.first);
+        if (saved != m_savedCooldowns.end())
+        {
+            if (saved->second.spellExpireTime == cooldown.spellExpireTime && saved->second.category == cooldown.category &&
+                saved->second.categoryExpireTime == cooldown.categoryExpireTime && saved->second.itemId == cooldown.itemId)
+                continue;
+
+            SqlStatement stmt = CharacterDatabase.CreateStatement(updateSpellCooldown, "UPDATE `character_spell_cooldown` SET `spell_expire_time` = ?, `category` = ?, `category_expire_time` = ?, `item_id` = ? WHERE `guid` = ? AND `spell` = ?");
+            stmt.addUInt64(cooldown.spellExpireTime);
+            stmt.addUInt32(cooldown.category);
+            stmt.addUInt64(cooldown.categoryExpireTime);
+            stmt.addUInt32(cooldown.itemId);
+            stmt.addUInt32(GetGUIDLow());
+            stmt.addUInt32(itr.first);
+            stmt.Execute();
+        }
+        else
+        {
+            SqlStatement stmt = CharacterDatabase.CreateStatement(insertSpellCooldown, "INSERT INTO `character_spell_cooldown` (`guid`, `spell`, `spell_expire_time`, `category`, `category_expire_time`, `item_id`) VALUES( ?, ?, ?, ?, ?, ?)");
             stmt.addUInt32(GetGUIDLow());
-            stmt.addUInt32(cdData->GetSpellId());
-            stmt.addUInt64(spellExpireTime);
-            stmt.addUInt32(cdData->GetCategory());
-            stmt.addUInt64(catExpireTime);
-            stmt.addUInt32(cdData->GetItemId());
+            stmt.addUInt32(itr.first);
+            stmt.addUInt64(cooldown.spellExpireTime);
+            stmt.addUInt32(cooldown.category);
+            stmt.addUInt64(cooldown.categoryExpireTime);
+            stmt.addUInt32(cooldown.itemId);
             stmt.Execute();
         }
+
+        m_savedCooldowns[itr.first] = cooldown;
     }
 }
 
@@ -14521,7 +14585,7 @@ void Player::LogModifyMoney(int32 d, char const* type, ObjectGuid fromGuid, uint
 #ifdef ENABLE_ELUNA
 void Player::ModifyMoney(int32 d)
 {
-    sEluna->OnMoneyChanged(this, d);
+    GetEluna()->OnMoneyChanged(this, d);
 
     if (d < 0)
         SetMoney(GetMoney() > uint32(-d) ? GetMoney() + d : 0);
@@ -16642,6 +16706,7 @@ void Player::SaveToDB(bool online, bool force)
     // we should assure this: ASSERT((m_nextSave != sWorld.getConfig(CONFIG_UINT32_INTERVAL_SAVE)));
     // delay auto save at any saves (manual, in code, or autosave)
     m_nextSave = sWorld.getConfig(CONFIG_UINT32_INTERVAL_SAVE);
+    sPlayerSaveScheduler.Cancel(GetGUIDLow());
 
     // Do not save bots
     if (IsSavingDisabled())
@@ -16657,6 +16722,8 @@ void Player::SaveToDB(bool online, bool force)
     //DEBUG_FILTER_LOG(LOG_FILTER_PLAYER_STATS, "The value of player %s at save: ", m_name.c_str());
     //outDebugStatsValues();
 
+    SqlWriteCounter writeCounter;
+
     CharacterDatabase.BeginTransaction(GetGUIDLow());
 
     m_honorMgr.Update();
@@ -16839,6 +16906,47 @@ void Player::SaveToDB(bool online, bool force)
         data->uiLevel = GetLevel();
         data->uiZoneId = GetCachedZoneId();
     }
+
+    m_lastSaveStatements = writeCounter.GetStatements();
+    m_lastSaveBytes = writeCounter.GetBytes();
+    ++s_saveCount;
+    s_saveStatements += m_lastSaveStatements;
+    s_saveBytes += m_lastSaveBytes;
+}
+
+uint32 Player::GetUnsavedChangeCount() const
+{
+    uint32 count = m_itemUpdateQueue.size();
+
+    for (const auto& quest : mQuestStatus)
+        if (quest.second.uState != QUEST_UNCHANGED)
+            ++count;
+
+    for (const auto& skill : mSkillStatus)
+        if (skill.second.uState != SKILL_UNCHANGED)
+            ++count;
+
+    for (const auto& spell : m_spells)
+        if (spell.second.state != PLAYERSPELL_UNCHANGED)
+            ++count;
+
+    return count;
+}
+
+Player::SaveStats Player::GetSaveStats()
+{
+    SaveStats stats;
+    stats.saves = s_saveCount.load();
+    stats.statements = s_saveStatements.load();
+    stats.bytes = s_saveBytes.load();
+    return stats;
+}
+
+void Player::ResetSaveStats()
+{
+    s_saveCount = 0;
+    s_saveStatements = 0;
+    s_saveBytes = 0;
 }
 
 // fast save function for item/money cheating preventing - save only inventory and money state
@@ -16875,48 +16983,110 @@ void Player::SaveGoldToDB()
     stmt.PExecute(GetMoney(), GetGUIDLow());
 }
 
+static bool IsSameAuraRow(AuraSaveStruct const& a, AuraSaveStruct const& b)
+{
+    if (a.stacks != b.stacks || a.charges != b.charges || a.maxDuration != b.maxDuration || a.duration != b.duration || a.effIndexMask != b.effIndexMask)
+        return false;
+
+    for (uint8 i = 0; i < MAX_EFFECT_INDEX; ++i)
+        if (a.damage[i] != b.damage[i] || a.periodicTime[i] != b.periodicTime[i])
+            return false;
+
+    return true;
+}
+
 void Player::_SaveAuras()
 {
     static SqlStatementID deleteAuras ;
+    static SqlStatementID deleteAura ;
     static SqlStatementID insertAuras ;
+    static SqlStatementID updateAura ;
 
-    SqlStatement stmt = CharacterDatabase.CreateStatement(deleteAuras, "DELETE FROM `character_aura` WHERE `guid` = ?");
-    stmt.PExecute(GetGUIDLow());
+    std::map<SavedAuraKey, AuraSaveStruct> auras;
+    AuraSaveStruct s;
+    for (const auto& auraHolder : GetSpellAuraHolderMap())
+    {
+        if (SaveAura(auraHolder.second, s))
+            auras[SavedAuraKey(s.casterGuid.GetRawValue(), s.itemLowGuid, s.spellId)] = s;
+    }
 
-    SpellAuraHolderMap const& auraHolders = GetSpellAuraHolderMap();
+    // The rows loaded at login are unknown, replace all of them once
+    if (!m_aurasSaved)
+    {
+        SqlStatement stmt = CharacterDatabase.CreateStatement(deleteAuras, "DELETE FROM `character_aura` WHERE `guid` = ?");
+        stmt.PExecute(GetGUIDLow());
+        m_savedAuras.clear();
+        m_aurasSaved = true;
+    }
 
-    if (auraHolders.empty())
-        return;
+    for (auto itr = m_savedAuras.begin(); itr != m_savedAuras.end();)
+    {
+        if (auras.find(itr->first) != auras.end())
+        {
+            ++itr;
+            continue;
+        }
 
-    stmt = CharacterDatabase.CreateStatement(insertAuras, "INSERT INTO `character_aura` (`guid`, `caster_guid`, `item_guid`, `spell`, `stacks`, `charges`, "
-            "`base_points0`, `base_points1`, `base_points2`, `periodic_time0`, `periodic_time1`, `periodic_time2`, `max_duration`, `duration`, `effect_index_mask`) "
-            "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+        SqlStatement stmt = CharacterDatabase.CreateStatement(deleteAura, "DELETE FROM `character_aura` WHERE `guid` = ? AND `caster_guid` = ? AND `item_guid` = ? AND `spell` = ?");
+        stmt.PExecute(GetGUIDLow(), std::get<0>(itr->first), std::get<1>(itr->first), std::get<2>(itr->first));
+        itr = m_savedAuras.erase(itr);
+    }
 
-    AuraSaveStruct s;
-    for (const auto& auraHolder : auraHolders)
+    for (const auto& aura : auras)
     {
-        SpellAuraHolder* holder = auraHolder.second;
+        AuraSaveStruct const& row = aura.second;
+        auto saved = m_savedAuras.find(aura.first);
+        if (saved != m_savedAuras.end())
+        {
+            if (IsSameAuraRow(saved->second, row))
+                continue;
 
-        if (!SaveAura(holder, s))
-            continue;
+            SqlStatement stmt = CharacterDatabase.CreateStatement(updateAura, "UPDATE `character_aura` SET `stacks` = ?, `charges` = ?, "
+                    "`base_points0` = ?, `base_points1` = ?, `base_points2` = ?, `periodic_time0` = ?, `periodic_time1` = ?, `periodic_time2` = ?, "
+                    "`max_duration` = ?, `duration` = ?, `effect_index_mask` = ? WHERE `guid` = ? AND `caster_guid` = ? AND `item_guid` = ? AND `spell` = ?");
+            stmt.addUInt32(row.stacks);
+            stmt.addUInt8(row.charges);
 
-        stmt.addUInt32(GetGUIDLow());
-        stmt.addUInt64(s.casterGuid.GetRawValue());
-        stmt.addUInt32(s.itemLowGuid);
-        stmt.addUInt32(s.spellId);
-        stmt.addUInt32(s.stacks);
-        stmt.addUInt8(s.charges);
+            for (float i : row.damage)
+                stmt.addFloat(i);
+
+            for (uint32 i : row.periodicTime)
+                stmt.addUInt32(i);
 
-        for (float i : s.damage)
-            stmt.addFloat(i);
+            stmt.addInt32(row.maxDuration);
+            stmt.addInt32(row.duration);
+            stmt.addInt8(row.effIndexMask);
+            stmt.addUInt32(GetGUIDLow());
+            stmt.addUInt64(row.casterGuid.GetRawValue());
+            stmt.addUInt32(row.itemLowGuid);
+            stmt.addUInt32(row.spellId);
+            stmt.Execute();
+        }
+        else
+        {
+            SqlStatement stmt = CharacterDatabase.CreateStatement(insertAuras, "INSERT INTO `character_aura` (`guid`, `caster_guid`, `item_guid`, `spell`, `stacks`, `charges`, "
+                    "`base_points0`, `base_points1`, `base_points2`, `periodic_time0`, `periodic_time1`, `periodic_time2`, `max_duration`, `duration`, `effect_index_mask`) "
+                    "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+            stmt.addUInt32(GetGUIDLow());
+            stmt.addUInt64(row.casterGuid.GetRawValue());
+            stmt.addUInt32(row.itemLowGuid);
+            stmt.addUInt32(row.spellId);
+            stmt.addUInt32(row.stacks);
+            stmt.addUInt8(row.charges);
 
-        for (uint32 i : s.periodicTime)
-            stmt.addUInt32(i);
+            for (float i : row.damage)
+                stmt.addFloat(i);
 
-        stmt.addInt32(s.maxDuration);
-        stmt.addInt32(s.duration);
-        stmt.addInt8(s.effIndexMask);
-        stmt.Execute();
+            for (uint32 i : row.periodicTime)
+                stmt.addUInt32(i);
+
+            stmt.addInt32(row.maxDuration);
+            stmt.addInt32(row.duration);
+            stmt.addInt8(row.effIndexMask);
+            stmt.Execute();
+        }
+
+        m_savedAuras[aura.first] = row;
     }
 }
 
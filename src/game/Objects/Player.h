@@ -35,10 +35,12 @@
 #include "GameObjectDefines.h"
 #include "SpellMgr.h"
 #include "HonorMgr.h"
+#include "CharacterDatabaseCache.h"
 
 #include <string>
 #include <vector>
 #include <functional>
+#include <tuple>
 
 struct Mail;
 struct ItemPrototype;
@@ -1446,7 +1448,40 @@ class Player final: public Unit
         void _SaveStats();
         uint32 m_nextSave;
         bool m_saveDisabled; // used for temporary bots and faction change
+
+        // Rows of character_aura and character_spell_cooldown written by the last save, the
+        // following saves only write the rows that changed. The first save replaces all the
+        // rows, the ones loaded at login are not tracked.
+        typedef std::tuple<uint64, uint32, uint32> SavedAuraKey;    // caster guid, item guid, spell
+        struct SavedCooldown
+        {
+            uint64 spellExpireTime;
+            uint32 category;
+            uint64 categoryExpireTime;
+            uint32 itemId;
+        };
+        std::map<SavedAuraKey, AuraSaveStruct> m_savedAuras;
+        std::map<uint32, SavedCooldown> m_savedCooldowns;
+        bool m_aurasSaved;
+        bool m_cooldownsSaved;
+
+        uint32 m_lastSaveStatements;
+        uint64 m_lastSaveBytes;
     public:
+        // Writes of the SaveToDB calls of all players since the start or the last reset
+        struct SaveStats
+        {
+            uint64 saves;
+            uint64 statements;
+            uint64 bytes;
+        };
+        static SaveStats GetSaveStats();
+        static void ResetSaveStats();
+        uint32 GetLastSaveStatements() const { return m_lastSaveStatements; }
+        // Inventory, quest, skill and spell changes the next save will write, orders the autosaves
+        uint32 GetUnsavedChangeCount() const;
+        uint64 GetLastSaveBytes() const { return m_lastSaveBytes; }
+
         // Saves a new character directly in the database, without creating a Player object in memory.
         static bool SaveNewPlayer(WorldSession* session, uint32 guidlow, std::string const& name, uint8 raceId, uint8 classId, uint8 gender, uint8 skin, uint8 face, uint8 hairStyle, uint8 hairColor, uint8 facialHair);
         void SaveToDB(bool online = true, bool force = false);
@@ -101,7 +101,7 @@ void Totem::Summon(Unit* owner)
         ((Creature*)owner)->AI()->JustSummoned((Creature*)this);
 
 #ifdef ENABLE_ELUNA
-    sEluna->OnSummoned(this, owner);
+    GetEluna()->OnSummoned(this, owner);
 #endif /* ENABLE_ELUNA */
 
 
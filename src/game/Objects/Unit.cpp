@@ -56,6 +56,7 @@
 #include "Anticheat.h"
 #include "InstanceStatistics.h"
 #include "MovementPacketSender.h"
+#include "PathfindingService.h"
 
 #ifdef ENABLE_ELUNA
 #include "LuaEngine.h"
@@ -64,6 +65,10 @@
 
 #include <math.h>
 #include <stdarg.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 //#define DEBUG_DEBUFF_LIMIT
 
@@ -1066,15 +1071,15 @@ void Unit::Kill(Unit* pVictim, SpellEntry const* spellProto, bool durabilityLoss
     {
         if( pPlayerTap != pPlayerVictim )
         {
-            sEluna->OnPVPKill(pPlayerTap, pPlayerVictim);
+            pPlayerTap->GetEluna()->OnPVPKill(pPlayerTap, pPlayerVictim);
         }
         else
         {
-            sEluna->OnKillSelf(pPlayerVictim);
+            pPlayerVictim->GetEluna()->OnKillSelf(pPlayerVictim);
         }
     }else if(pCreatureVictim && pPlayerTap)
     {
-        sEluna->OnCreatureKill(pPlayerTap, pCreatureVictim);
+        pPlayerTap->GetEluna()->OnCreatureKill(pPlayerTap, pCreatureVictim);
     }
 #endif /* ENABLE_ELUNA */
 
@@ -1187,7 +1192,7 @@ void Unit::Kill(Unit* pVictim, SpellEntry const* spellProto, bool durabilityLoss
 #ifdef ENABLE_ELUNA
         if (Creature* killer = ToCreature())
             {
-            sEluna->OnPlayerKilledByCreature(killer, pPlayerVictim);
+            pPlayerVictim->GetEluna()->OnPlayerKilledByCreature(killer, pPlayerVictim);
             }
 #endif /* ENABLE_ELUNA */
         }
@@ -2945,10 +2950,19 @@ namespace Movement
 }
 
 bool Unit::ExtrapolateMovement(MovementInfo const& mi, uint32 diffMs, float &x, float &y, float &z, float &outOrientation) const
+{
+    if (!movespline->Finalized() || !IsMovedByPlayer())
+        return false;
+
+    return ExtrapolateMovement(GetMap(), mi, diffMs, GetSpeedForMovementInfo(mi), GetSpeed(MOVE_TURN_RATE), m_jumpInitialSpeed, x, y, z, outOrientation);
+}
+
+bool Unit::ExtrapolateMovement(Map const* map, MovementInfo const& mi, uint32 diffMs, float speed, float turnRate, float jumpInitialSpeed,
+                               float &x, float &y, float &z, float &outOrientation)
 {
     // Not currently handled cases.
     if ((mi.moveFlags & (MOVEFLAG_PITCH_UP | MOVEFLAG_PITCH_DOWN | MOVEFLAG_FALLINGFAR | MOVEFLAG_ONTRANSPORT)) ||
-        !movespline->Finalized() || (mi.ctime == 0) || !IsMovedByPlayer())
+        (mi.ctime == 0))
         return false;
 
     x = mi.pos.x;
@@ -2960,8 +2974,6 @@ bool Unit::ExtrapolateMovement(MovementInfo const& mi, uint32 diffMs, float &x,
     if (mi.moveFlags & MOVEFLAG_ROOT)
         return true;
 
-    float speed = GetSpeedForMovementInfo(mi);
-
     if (mi.moveFlags & MOVEFLAG_BACKWARD)
         o += M_PI_F;
     else if (mi.moveFlags & MOVEFLAG_STRAFE_LEFT)
@@ -2989,14 +3001,14 @@ bool Unit::ExtrapolateMovement(MovementInfo const& mi, uint32 diffMs, float &x,
             return false;
         x += mi.jump.cosAngle * mi.jump.xyspeed * diffT;
         y += mi.jump.sinAngle * mi.jump.xyspeed * diffT;
-        z -= Movement::computeFallElevation(diffT, mi.moveFlags & MOVEFLAG_SAFE_FALL, -m_jumpInitialSpeed);
+        z -= Movement::computeFallElevation(diffT, mi.moveFlags & MOVEFLAG_SAFE_FALL, -jumpInitialSpeed);
     }
     else if (mi.moveFlags & (MOVEFLAG_TURN_LEFT | MOVEFLAG_TURN_RIGHT))
     {
         if (mi.moveFlags & MOVEFLAG_MASK_MOVING)
         {
             // Every 2 sec
-            float T = 0.75f * (GetSpeed(MOVE_TURN_RATE)) * (diffMs / 1000.0f);
+            float T = 0.75f * (turnRate) * (diffMs / 1000.0f);
             float R = 1.295f * speed / M_PI * cos(mi.s_pitch);
             z += diffMs * speed / 1000.0f * sin(mi.s_pitch);
             // Find the center of the circle we are moving on
@@ -3019,7 +3031,7 @@ bool Unit::ExtrapolateMovement(MovementInfo const& mi, uint32 diffMs, float &x,
         }
         else
         {
-            float diffO = GetSpeed(MOVE_TURN_RATE) * diffMs / 1000.0f;
+            float diffO = turnRate * diffMs / 1000.0f;
             if (mi.moveFlags & MOVEFLAG_TURN_LEFT)
                 outOrientation += diffO;
             else
@@ -3041,9 +3053,9 @@ bool Unit::ExtrapolateMovement(MovementInfo const& mi, uint32 diffMs, float &x,
         return false;
 
     if (!(mi.moveFlags & (MOVEFLAG_JUMPING | MOVEFLAG_FALLINGFAR | MOVEFLAG_SWIMMING)))
-        z = GetMap()->GetHeight(x, y, z);
+        z = map->GetHeight(x, y, z);
 
-    return GetMap()->isInLineOfSight(mi.pos.x, mi.pos.y, mi.pos.z + 0.5f, x, y, z + 0.5f);
+    return map->isInLineOfSight(mi.pos.x, mi.pos.y, mi.pos.z + 0.5f, x, y, z + 0.5f);
 }
 
 void Unit::DeMorph()
@@ -3330,6 +3342,7 @@ bool Unit::AddSpellAuraHolder(SpellAuraHolder* holder)
     }
     // add aura, register in lists and arrays
     m_spellAuraHolders.insert(SpellAuraHolderMap::value_type(holder->GetId(), holder));
+    AddToProcIndex(holder);
 
     for (uint8 i = 0; i < MAX_EFFECT_INDEX; ++i)
         if (Aura* aur = holder->GetAuraByEffectIndex(SpellEffectIndex(i)))
@@ -3901,6 +3914,7 @@ void Unit::RemoveSpellAuraHolder(SpellAuraHolder* holder, AuraRemoveMode mode)
         if (itr->second == holder)
         {
             m_spellAuraHolders.erase(itr);
+            RemoveFromProcIndex(holder);
             foundInMap = true;
             break;
         }
@@ -5944,7 +5958,7 @@ void Unit::SetInCombatState(uint32 combatTimer, Unit* pEnemy)
     // Used by Eluna
 #ifdef ENABLE_ELUNA
     if (GetTypeId() == TYPEID_PLAYER)
-        sEluna->OnPlayerEnterCombat(ToPlayer(), pEnemy);
+        GetEluna()->OnPlayerEnterCombat(ToPlayer(), pEnemy);
 #endif /* ENABLE_ELUNA */
 
 }
@@ -6094,7 +6108,7 @@ void Unit::ClearInCombat()
 	// Used by Eluna
 #ifdef ENABLE_ELUNA
     if (GetTypeId() == TYPEID_PLAYER)
-        sEluna->OnPlayerLeaveCombat(ToPlayer());
+        GetEluna()->OnPlayerLeaveCombat(ToPlayer());
 #endif /* ENABLE_ELUNA */
     }
 }
@@ -8165,6 +8179,8 @@ void Unit::RemoveFromWorld()
         FindMap()->RemoveRelocatedUnit(this);
         m_needUpdateVisibility = false;
     }
+    // Its queued paths are no longer needed
+    sPathfindingService.CancelRequests(this);
     Object::RemoveFromWorld();
 }
 
@@ -8772,17 +8788,140 @@ void Unit::ProcSkillsAndReactives(bool isVictim, Unit* pTarget, uint32 procFlag,
     }
 }
 
-void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* pTarget, ProcSystemArguments const& data, ProcTriggeredList& triggeredList, ProcessProcsAuraType processAurasType)
+namespace
 {
-    // Fill triggeredList list
-    for (const auto& itr : GetSpellAuraHolderMap())
+    // Counters of one map update thread, only written by it. The padding keeps the
+    // counters of two threads out of a same cache line whatever the address from new.
+    struct ProcIndexCounters
     {
-        // Can not proc on self.
-        if (data.procSpell && data.procSpell->Id == itr.first)
-            continue;
+        char padBefore[64];
+        std::atomic<uint64> passes{0};
+        std::atomic<uint64> holders{0};
+        std::atomic<uint64> visited{0};
+        std::atomic<uint64> fired{0};
+        char padAfter[64];
+    };
 
-        // skip deleted auras (possible at recursive triggered call
-        if (itr.second->IsDeleted())
+    std::mutex s_procIndexLock;
+    std::vector<std::unique_ptr<ProcIndexCounters>> s_procIndexCounters;   // Of all the threads, kept when they end
+    Unit::ProcIndexStats s_procIndexBaseline = {};                          // Sums at the last reset
+    thread_local ProcIndexCounters* t_procIndexCounters = nullptr;
+
+    ProcIndexCounters& GetThreadProcIndexCounters()
+    {
+        if (!t_procIndexCounters)
+        {
+            std::lock_guard<std::mutex> guard(s_procIndexLock);
+            s_procIndexCounters.emplace_back(new ProcIndexCounters());
+            t_procIndexCounters = s_procIndexCounters.back().get();
+        }
+        return *t_procIndexCounters;
+    }
+
+    void AddProcIndexCount(std::atomic<uint64>& counter, uint64 value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    Unit::ProcIndexStats SumProcIndexCounters()
+    {
+        Unit::ProcIndexStats stats = {};
+        for (auto const& counters : s_procIndexCounters)
+        {
+            stats.passes += counters->passes.load(std::memory_order_relaxed);
+            stats.holders += counters->holders.load(std::memory_order_relaxed);
+            stats.visited += counters->visited.load(std::memory_order_relaxed);
+            stats.fired += counters->fired.load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+}
+
+Unit::ProcIndexStats Unit::GetProcIndexStats()
+{
+    std::lock_guard<std::mutex> guard(s_procIndexLock);
+    ProcIndexStats stats = SumProcIndexCounters();
+    stats.passes -= s_procIndexBaseline.passes;
+    stats.holders -= s_procIndexBaseline.holders;
+    stats.visited -= s_procIndexBaseline.visited;
+    stats.fired -= s_procIndexBaseline.fired;
+    return stats;
+}
+
+void Unit::ResetProcIndexStats()
+{
+    // The counters belong to their threads, they are not cleared
+    std::lock_guard<std::mutex> guard(s_procIndexLock);
+    s_procIndexBaseline = SumProcIndexCounters();
+}
+
+void Unit::AddToProcIndex(SpellAuraHolder* holder)
+{
+    uint32 const procFlags = GetProcIndexFlags(holder->GetSpellProto());
+    if (!procFlags)
+        return;
+
+    ProcIndexEntry entry;
+    entry.holder = holder;
+    entry.spellId = holder->GetId();
+    entry.procFlags = procFlags;
+    entry.instant = holder->GetSpellProto()->HasAttribute(SPELL_ATTR_EX3_INSTANT_TARGET_PROCS);
+
+    // After the holders of the same spell, as in m_spellAuraHolders
+    auto itr = std::upper_bound(m_procIndex.begin(), m_procIndex.end(), entry.spellId, [](uint32 spellId, ProcIndexEntry const& other)
+    {
+        return spellId < other.spellId;
+    });
+    m_procIndex.insert(itr, entry);
+    m_procIndexFlags |= procFlags;
+}
+
+void Unit::RemoveFromProcIndex(SpellAuraHolder* holder)
+{
+    auto itr = std::find_if(m_procIndex.begin(), m_procIndex.end(), [holder](ProcIndexEntry const& entry)
+    {
+        return entry.holder == holder;
+    });
+    if (itr == m_procIndex.end())
+        return;
+
+    m_procIndex.erase(itr);
+    m_procIndexFlags = 0;
+    for (auto const& entry : m_procIndex)
+        m_procIndexFlags |= entry.procFlags;
+}
+
+void Unit::RebuildProcIndex()
+{
+    m_procIndex.clear();
+    m_procIndexFlags = 0;
+    m_procIndexGeneration = sSpellMgr.GetProcEventGeneration();
+    for (auto const& itr : m_spellAuraHolders)
+        AddToProcIndex(itr.second);
+}
+
+void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* pTarget, ProcSystemArguments const& data, ProcTriggeredList& triggeredList, ProcessProcsAuraType processAurasType)
+{
+    // The proc flags of the holders come from spell_proc_event
+    if (m_procIndexGeneration != sSpellMgr.GetProcEventGeneration())
+        RebuildProcIndex();
+
+    uint32 procFlag = isVictim ? data.procFlagsVictim : data.procFlagsAttacker;
+
+    ProcIndexCounters& counters = GetThreadProcIndexCounters();
+    AddProcIndexCount(counters.passes, 1);
+    AddProcIndexCount(counters.holders, m_spellAuraHolders.size());
+    if (!(m_procIndexFlags & procFlag))
+        return;
+
+    uint64 visited = 0;
+    uint64 fired = 0;
+
+    // Fill triggeredList list. The holders not indexed for this proc flag fail IsTriggeredAtSpellProcEvent.
+    for (size_t i = 0; i < m_procIndex.size(); ++i)
+    {
+        ProcIndexEntry const entry = m_procIndex[i];
+        if (!(entry.procFlags & procFlag))
             continue;
 
         // These spell auras should proc instantly (not delayed by batching).
@@ -8793,36 +8932,47 @@ void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* pTarget, ProcSystemArgumen
             {
                 case PROC_PROCESS_INSTANT:
                 {
-                    if (!itr.second->GetSpellProto()->HasAttribute(SPELL_ATTR_EX3_INSTANT_TARGET_PROCS))
+                    if (!entry.instant)
                         continue;
                     break;
                 }
                 case PROC_PROCESS_DELAYED:
                 {
-                    if (itr.second->GetSpellProto()->HasAttribute(SPELL_ATTR_EX3_INSTANT_TARGET_PROCS))
+                    if (entry.instant)
                         continue;
                     break;
                 }
             }
         }
 
+        SpellAuraHolder* holder = entry.holder;
+        ++visited;
+
+        // Can not proc on self.
+        if (data.procSpell && data.procSpell->Id == entry.spellId)
+            continue;
+
+        // skip deleted auras (possible at recursive triggered call
+        if (holder->IsDeleted())
+            continue;
+
         // don't reroll chance for each target in this case
-        if (itr.second->GetSpellProto()->HasAttribute(SPELL_ATTR_EX2_PROC_COOLDOWN_ON_FAILURE) &&
-           !IsSpellReady(itr.second->GetId()))
+        if (holder->GetSpellProto()->HasAttribute(SPELL_ATTR_EX2_PROC_COOLDOWN_ON_FAILURE) &&
+           !IsSpellReady(holder->GetId()))
             continue;
 
         // prevent delayed procs from removing auras applied after the proc happened
         // fixes Frostbite being removed by the Frostbolt that applied it
-        if (isVictim && itr.second->GetAuraApplyTime() >= data.procTime && pTarget->GetObjectGuid() == itr.second->GetCasterGuid())
+        if (isVictim && holder->GetAuraApplyTime() >= data.procTime && pTarget->GetObjectGuid() == holder->GetCasterGuid())
             continue;
 
         // Aura that applies a modifier with charges. Gere? otherwise.
         bool hasmodifier = false;
         for (int i = 0; i < 3; ++i)
         {
-            if (itr.second->GetAuraByEffectIndex(SpellEffectIndex(i)))
+            if (holder->GetAuraByEffectIndex(SpellEffectIndex(i)))
             {
-                if (SpellModifier* auraMod = itr.second->GetAuraByEffectIndex(SpellEffectIndex(i))->GetSpellModifier())
+                if (SpellModifier* auraMod = holder->GetAuraByEffectIndex(SpellEffectIndex(i))->GetSpellModifier())
                 {
                     if (auraMod->charges > 0 || (std::find(data.appliedSpellModifiers.begin(), data.appliedSpellModifiers.end(), auraMod) != data.appliedSpellModifiers.end()))
                     {
@@ -8835,8 +8985,6 @@ void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* pTarget, ProcSystemArgumen
         if (hasmodifier)
             continue;
 
-        uint32 procFlag = isVictim ? data.procFlagsVictim : data.procFlagsAttacker;
-
         SpellProcEventEntry const* spellProcEvent = nullptr;
         // http://blue.cardplace.com/cache/wow-paladin/1069149.htm
         // "Charges will not generate off auto attacks or npc attacks by trying"
@@ -8844,23 +8992,27 @@ void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* pTarget, ProcSystemArgumen
         // "abilities such as Sinister Strike, Hamstring, Auto-shot, Aimed shot,"
         // "etc will generate a charge if you're sitting."
 #if SUPPORTED_CLIENT_BUILD > CLIENT_BUILD_1_7_1
-        auto result = IsTriggeredAtSpellProcEvent(pTarget, itr.second, data.procSpell, procFlag, isVictim && !data.procSpell && !data.pVictim->IsStandingUp() ? data.procExtra & ~PROC_EX_CRITICAL_HIT : data.procExtra, data.attType, isVictim, spellProcEvent, data.isSpellTriggeredByAuraOrItem);
+        auto result = IsTriggeredAtSpellProcEvent(pTarget, holder, data.procSpell, procFlag, isVictim && !data.procSpell && !data.pVictim->IsStandingUp() ? data.procExtra & ~PROC_EX_CRITICAL_HIT : data.procExtra, data.attType, isVictim, spellProcEvent, data.isSpellTriggeredByAuraOrItem);
 #else
-        auto result = IsTriggeredAtSpellProcEvent(pTarget, itr.second, data.procSpell, procFlag, data.procExtra, data.attType, isVictim, spellProcEvent, data.isSpellTriggeredByAuraOrItem);
+        auto result = IsTriggeredAtSpellProcEvent(pTarget, holder, data.procSpell, procFlag, data.procExtra, data.attType, isVictim, spellProcEvent, data.isSpellTriggeredByAuraOrItem);
 #endif
         if (result != SPELL_PROC_TRIGGER_OK)
         {
             if (result == SPELL_PROC_TRIGGER_ROLL_FAILED &&
-                itr.second->GetSpellProto()->HasAttribute(SPELL_ATTR_EX2_PROC_COOLDOWN_ON_FAILURE) &&
+                holder->GetSpellProto()->HasAttribute(SPELL_ATTR_EX2_PROC_COOLDOWN_ON_FAILURE) &&
                 spellProcEvent && spellProcEvent->cooldown)
-                AddCooldown(*itr.second->GetSpellProto(), nullptr, false, spellProcEvent->cooldown);
+                AddCooldown(*holder->GetSpellProto(), nullptr, false, spellProcEvent->cooldown);
 
             continue;
         }
 
-        itr.second->SetInUse(true);                        // prevent holder deletion
-        triggeredList.push_back(ProcTriggeredData(spellProcEvent, itr.second, pTarget, procFlag));
+        holder->SetInUse(true);                        // prevent holder deletion
+        triggeredList.push_back(ProcTriggeredData(spellProcEvent, holder, pTarget, procFlag));
+        ++fired;
     }
+
+    AddProcIndexCount(counters.visited, visited);
+    AddProcIndexCount(counters.fired, fired);
 }
 
 Player* Unit::GetSpellModOwner() const
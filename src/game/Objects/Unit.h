@@ -645,6 +645,18 @@ class Unit : public SpellCaster
     protected:
         SpellAuraHolderMap m_spellAuraHolders;
         SpellAuraHolderMap::iterator m_spellAuraHoldersUpdateIterator; // != end() in Unit::m_spellAuraHolders update and point to next element
+
+        // Holders that can proc, in the order of m_spellAuraHolders, see ProcDamageAndSpellFor
+        struct ProcIndexEntry
+        {
+            SpellAuraHolder* holder;
+            uint32 spellId;
+            uint32 procFlags;                                  // All flags for the hard-coded proc checks
+            bool instant;                                      // SPELL_ATTR_EX3_INSTANT_TARGET_PROCS
+        };
+        std::vector<ProcIndexEntry> m_procIndex;
+        uint32 m_procIndexFlags = 0;                           // Union of the flags of m_procIndex
+        uint32 m_procIndexGeneration = 0;                      // SpellMgr::GetProcEventGeneration at build
         AuraList m_deletedAuras;                                       // auras removed while in ApplyModifier and waiting deleted
         SpellAuraHolderList m_deletedHolders;
         SingleCastSpellTargetMap m_singleCastSpellTargets;  // casted by unit single per-caster auras
@@ -790,6 +802,16 @@ class Unit : public SpellCaster
 
         SpellAuraHolderMap      & GetSpellAuraHolderMap() { return m_spellAuraHolders; }
         SpellAuraHolderMap const& GetSpellAuraHolderMap() const { return m_spellAuraHolders; }
+
+        struct ProcIndexStats
+        {
+            uint64 passes;                                     // ProcDamageAndSpellFor calls
+            uint64 holders;                                    // Holders of the units at these calls
+            uint64 visited;                                    // Holders checked with the proc index
+            uint64 fired;                                      // Holders added to the triggered list
+        };
+        static ProcIndexStats GetProcIndexStats();
+        static void ResetProcIndexStats();
         void DelaySpellAuraHolder(uint32 spellId, int32 delaytime, ObjectGuid casterGuid);
         AuraList const& GetAurasByType(AuraType type) const { return m_modAuras[type]; }
 
@@ -858,6 +880,11 @@ class Unit : public SpellCaster
         void HandleTriggers(Unit* pVictim, uint32 procExtra, uint32 amount, SpellEntry const* procSpell, ProcTriggeredList const& procTriggered);
 
         SpellProcEventTriggerCheck IsTriggeredAtSpellProcEvent(Unit* pVictim, SpellAuraHolder* holder, SpellEntry const* procSpell, uint32 procFlag, uint32 procExtra, WeaponAttackType attType, bool isVictim, SpellProcEventEntry const*& spellProcEvent, bool isSpellTriggeredByAuraOrItem) const;
+        // Proc flags the aura can pass IsTriggeredAtSpellProcEvent with, 0 if it never procs
+        static uint32 GetProcIndexFlags(SpellEntry const* spellProto);
+        void AddToProcIndex(SpellAuraHolder* holder);
+        void RemoveFromProcIndex(SpellAuraHolder* holder);
+        void RebuildProcIndex();
         // only to be used in proc handlers - basepoints is expected to be a MAX_EFFECT_INDEX sized array
         SpellAuraProcResult TriggerProccedSpell(Unit* target, int32* basepoints, uint32 triggeredSpellId, Item* castItem, Aura* triggeredByAura, uint32 cooldown, ObjectGuid originalCaster = ObjectGuid(), SpellEntry const* triggeredByParent = nullptr);
         SpellAuraProcResult TriggerProccedSpell(Unit* target, int32* basepoints, SpellEntry const* spellInfo, Item* castItem, Aura* triggeredByAura, uint32 cooldown, ObjectGuid originalCaster = ObjectGuid(), SpellEntry const* triggeredByParent = nullptr);
@@ -1377,6 +1404,9 @@ class Unit : public SpellCaster
         void PropagateSpeedChange() { GetMotionMaster()->PropagateSpeedChange(); }
         float GetSpeedForMovementInfo(MovementInfo const& movementInfo) const;
         bool ExtrapolateMovement(MovementInfo const& mi, uint32 diffMs, float &x, float &y, float &z, float &o) const;
+        // Without the unit: its speeds are given, for the asynchronous anticheat checks
+        static bool ExtrapolateMovement(Map const* map, MovementInfo const& mi, uint32 diffMs, float speed, float turnRate, float jumpInitialSpeed,
+                                        float &x, float &y, float &z, float &o);
         void SetJumpInitialSpeed(float speed) { m_jumpInitialSpeed = speed; }
         float GetJumpInitialSpeed() const { return m_jumpInitialSpeed; }
 
@@ -29,6 +29,9 @@
 #include "ObjectGuid.h"
 #include <zlib.h>
 
+#include <chrono>
+#include <cstring>
+
 #define MAX_UNCOMPRESSED_PACKET_SIZE 0x8000 // 32ko
 
 UpdateData::UpdateData()
@@ -52,74 +55,221 @@ void UpdateData::AddOutOfRangeGUID(ObjectGuid const& guid)
 
 void UpdateData::AddUpdateBlock(ByteBuffer const& block)
 {
-    if (m_datas.empty())
-        m_datas.push_back(UpdatePacket());
-    std::list<UpdatePacket>::iterator it = m_datas.end();
-    --it;
-    if (it->data.wpos() > MAX_UNCOMPRESSED_PACKET_SIZE)
+    if (m_datas.empty() || m_datas.back().size > MAX_UNCOMPRESSED_PACKET_SIZE)
+        m_datas.emplace_back(m_buffer.wpos());
+
+    m_buffer.append(block);
+    m_datas.back().size += block.wpos();
+    ++m_datas.back().blockCount;
+}
+
+namespace
+{
+    // Deflate stream of the thread, reset between packets instead of allocated each time
+    struct DeflateContext
+    {
+        z_stream stream;
+        int level = -1;                                     // -1 while not initialized
+
+        ~DeflateContext()
+        {
+            if (level >= 0)
+                deflateEnd(&stream);
+        }
+
+        bool Prepare(int wantedLevel)
+        {
+            if (level == wantedLevel)
+                return deflateReset(&stream) == Z_OK;
+
+            if (level >= 0)
+                deflateEnd(&stream);
+
+            level = -1;
+            memset(&stream, 0, sizeof(stream));
+            int z_res = deflateInit(&stream, wantedLevel);
+            if (z_res != Z_OK)
+            {
+                sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "Can't compress update packet (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
+                return false;
+            }
+
+            level = wantedLevel;
+            return true;
+        }
+
+        void Invalidate()
+        {
+            if (level >= 0)
+                deflateEnd(&stream);
+            level = -1;
+        }
+    };
+
+    // Last compressed payloads of the thread, only for payloads large enough to be worth the comparison
+    struct CompressedPayloadCache
+    {
+        static size_t const MIN_PAYLOAD_SIZE = 1024;
+        static uint32 const ENTRY_COUNT = 8;
+
+        struct Entry
+        {
+            uint64 hash = 0;
+            int level = -1;
+            uint32 lastUse = 0;
+            std::vector<uint8> input;
+            std::vector<uint8> output;
+        };
+
+        Entry entries[ENTRY_COUNT];
+        uint32 useCounter = 0;
+
+        Entry* Find(uint64 hash, int level, uint8 const* head, size_t headSize, uint8 const* body, size_t bodySize)
+        {
+            for (auto& entry : entries)
+            {
+                if (entry.hash != hash || entry.level != level || entry.input.size() != headSize + bodySize)
+                    continue;
+
+                if (memcmp(entry.input.data(), head, headSize) != 0 || (bodySize && memcmp(entry.input.data() + headSize, body, bodySize) != 0))
+                    continue;
+
+                entry.lastUse = ++useCounter;
+                return &entry;
+            }
+            return nullptr;
+        }
+
+        void Store(uint64 hash, int level, uint8 const* head, size_t headSize, uint8 const* body, size_t bodySize, uint8 const* output, size_t outputSize)
+        {
+            Entry* oldest = &entries[0];
+            for (auto& entry : entries)
+                if (entry.lastUse < oldest->lastUse)
+                    oldest = &entry;
+
+            oldest->hash = hash;
+            oldest->level = level;
+            oldest->lastUse = ++useCounter;
+            oldest->input.assign(head, head + headSize);
+            oldest->input.insert(oldest->input.end(), body, body + bodySize);
+            oldest->output.assign(output, output + outputSize);
+        }
+    };
+
+    thread_local DeflateContext t_deflate;
+    thread_local CompressedPayloadCache t_payloadCache;
+    thread_local PacketCompressor::Stats t_compressorStats;
+
+    uint64 HashPayload(uint8 const* data, size_t size, uint64 hash)
     {
-        m_datas.push_back(UpdatePacket());
-        it = m_datas.end();
-        --it;
+        size_t i = 0;
+        for (; i + sizeof(uint64) <= size; i += sizeof(uint64))
+        {
+            uint64 word;
+            memcpy(&word, data + i, sizeof(word));
+            hash = (hash ^ word) * 0x100000001B3ULL;
+            hash ^= hash >> 29;
+        }
+        for (; i < size; ++i)
+            hash = (hash ^ data[i]) * 0x100000001B3ULL;
+        return hash;
+    }
+
+    bool Deflate(z_stream& stream, uint8 const* src, size_t size, int flush)
+    {
+        stream.next_in = const_cast<Bytef*>(src);
+        stream.avail_in = (uInt)size;
+
+        int z_res = deflate(&stream, flush);
+        if (flush == Z_FINISH)
+        {
+            if (z_res != Z_STREAM_END)
+            {
+                sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "Can't compress update packet (zlib: deflate should report Z_STREAM_END instead %i (%s)", z_res, zError(z_res));
+                return false;
+            }
+            return true;
+        }
+
+        if (z_res != Z_OK)
+        {
+            sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "Can't compress update packet (zlib: deflate) Error code: %i (%s)", z_res, zError(z_res));
+            return false;
+        }
+
+        if (stream.avail_in != 0)
+        {
+            sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "Can't compress update packet (zlib: deflate not greedy)");
+            return false;
+        }
+        return true;
     }
-    it->data.append(block);
-    ++it->blockCount;
 }
 
 void PacketCompressor::Compress(void* dst, uint32* dst_size, void* src, int src_size)
 {
-    z_stream c_stream;
+    Compress(dst, dst_size, static_cast<uint8 const*>(src), src_size, nullptr, 0);
+}
 
-    c_stream.zalloc = (alloc_func)0;
-    c_stream.zfree = (free_func)0;
-    c_stream.opaque = (voidpf)0;
+void PacketCompressor::Compress(void* dst, uint32* dst_size, uint8 const* head, size_t headSize, uint8 const* body, size_t bodySize)
+{
+    std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
 
     // default Z_BEST_SPEED (1)
-    int z_res = deflateInit(&c_stream, sWorld.getConfig(CONFIG_UINT32_COMPRESSION));
-    if (z_res != Z_OK)
-    {
-        sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "Can't compress update packet (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
-        *dst_size = 0;
-        return;
-    }
+    int const level = sWorld.getConfig(CONFIG_UINT32_COMPRESSION);
+    size_t const inputSize = headSize + bodySize;
 
-    c_stream.next_out = (Bytef*)dst;
-    c_stream.avail_out = *dst_size;
-    c_stream.next_in = (Bytef*)src;
-    c_stream.avail_in = (uInt)src_size;
+    ++t_compressorStats.calls;
+    t_compressorStats.inBytes += inputSize;
 
-    z_res = deflate(&c_stream, Z_NO_FLUSH);
-    if (z_res != Z_OK)
+    uint64 hash = 0;
+    if (inputSize >= CompressedPayloadCache::MIN_PAYLOAD_SIZE)
     {
-        sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "Can't compress update packet (zlib: deflate) Error code: %i (%s)", z_res, zError(z_res));
-        *dst_size = 0;
-        return;
+        hash = HashPayload(body, bodySize, HashPayload(head, headSize, 14695981039346656037ULL));
+        if (CompressedPayloadCache::Entry const* entry = t_payloadCache.Find(hash, level, head, headSize, body, bodySize))
+        {
+            if (entry->output.size() <= *dst_size)
+            {
+                memcpy(dst, entry->output.data(), entry->output.size());
+                *dst_size = entry->output.size();
+                ++t_compressorStats.cacheHits;
+                t_compressorStats.outBytes += *dst_size;
+                t_compressorStats.us += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+                return;
+            }
+        }
     }
 
-    if (c_stream.avail_in != 0)
+    if (!t_deflate.Prepare(level))
     {
-        sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "Can't compress update packet (zlib: deflate not greedy)");
+        t_deflate.Invalidate();
         *dst_size = 0;
         return;
     }
 
-    z_res = deflate(&c_stream, Z_FINISH);
-    if (z_res != Z_STREAM_END)
-    {
-        sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "Can't compress update packet (zlib: deflate should report Z_STREAM_END instead %i (%s)", z_res, zError(z_res));
-        *dst_size = 0;
-        return;
-    }
+    z_stream& stream = t_deflate.stream;
+    stream.next_out = (Bytef*)dst;
+    stream.avail_out = *dst_size;
 
-    z_res = deflateEnd(&c_stream);
-    if (z_res != Z_OK)
+    if ((headSize && !Deflate(stream, head, headSize, Z_NO_FLUSH)) || !Deflate(stream, body, bodySize, Z_FINISH))
     {
-        sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "Can't compress update packet (zlib: deflateEnd) Error code: %i (%s)", z_res, zError(z_res));
+        t_deflate.Invalidate();
         *dst_size = 0;
         return;
     }
 
-    *dst_size = c_stream.total_out;
+    *dst_size = stream.total_out;
+
+    if (inputSize >= CompressedPayloadCache::MIN_PAYLOAD_SIZE)
+        t_payloadCache.Store(hash, level, head, headSize, body, bodySize, static_cast<uint8 const*>(dst), *dst_size);
+
+    t_compressorStats.outBytes += *dst_size;
+    t_compressorStats.us += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+PacketCompressor::Stats const& PacketCompressor::GetThreadStats()
+{
+    return t_compressorStats;
 }
 
 bool UpdateData::BuildPacket(WorldPacket* packet, bool hasTransport)
@@ -133,30 +283,31 @@ bool UpdateData::BuildPacket(WorldPacket* packet, UpdatePacket const* updPacket,
 {
     MANGOS_ASSERT(packet->empty());                         // shouldn't happen
 
-    ByteBuffer buf(4 + 1 + (m_outOfRangeGUIDs.empty() ? 0 : 1 + 4 + 9 * m_outOfRangeGUIDs.size()) + (updPacket ? updPacket->data.wpos() : 0));
+    // Header and out of range guids, the blocks are compressed directly from m_buffer
+    ByteBuffer head(4 + 1 + (m_outOfRangeGUIDs.empty() ? 0 : 1 + 4 + 9 * m_outOfRangeGUIDs.size()));
 
     uint32 blockCount = updPacket ? updPacket->blockCount : 0;
-    buf << (uint32)(!m_outOfRangeGUIDs.empty() ? blockCount + 1 : blockCount);
-    buf << (uint8)(hasTransport ? 1 : 0);
+    head << (uint32)(!m_outOfRangeGUIDs.empty() ? blockCount + 1 : blockCount);
+    head << (uint8)(hasTransport ? 1 : 0);
 
     if (!m_outOfRangeGUIDs.empty())
     {
-        buf << (uint8) UPDATETYPE_OUT_OF_RANGE_OBJECTS;
-        buf << (uint32) m_outOfRangeGUIDs.size();
+        head << (uint8) UPDATETYPE_OUT_OF_RANGE_OBJECTS;
+        head << (uint32) m_outOfRangeGUIDs.size();
 
 #if SUPPORTED_CLIENT_BUILD > CLIENT_BUILD_1_8_4
         for (const auto& guid : m_outOfRangeGUIDs)
-            buf << guid.WriteAsPacked();
+            head << guid.WriteAsPacked();
 #else
         for (const auto& guid : m_outOfRangeGUIDs)
-            buf << guid;
+            head << guid;
 #endif
     }
 
-    if (updPacket)
-        buf.append(updPacket->data);
+    size_t const bodySize = updPacket ? updPacket->size : 0;
+    uint8 const* body = bodySize ? m_buffer.contents() + updPacket->offset : nullptr;
 
-    size_t pSize = buf.wpos();                              // use real used data size
+    size_t pSize = head.wpos() + bodySize;                  // use real used data size
 
     if (pSize > 100)                                       // compress large packets
     {
@@ -167,7 +318,7 @@ bool UpdateData::BuildPacket(WorldPacket* packet, UpdatePacket const* updPacket,
         packet->resize(destsize + sizeof(uint32));
 
         packet->put<uint32>(0, pSize);
-        PacketCompressor::Compress(const_cast<uint8*>(packet->contents()) + sizeof(uint32), &destsize, (void*)buf.contents(), pSize);
+        PacketCompressor::Compress(const_cast<uint8*>(packet->contents()) + sizeof(uint32), &destsize, head.contents(), head.wpos(), body, bodySize);
         if (destsize == 0)
             return false;
 
@@ -176,7 +327,9 @@ bool UpdateData::BuildPacket(WorldPacket* packet, UpdatePacket const* updPacket,
     }
     else                                                    // send small packets without compression
     {
-        packet->append(buf);
+        packet->append(head);
+        if (bodySize)
+            packet->append(body, bodySize);
         packet->SetOpcode(SMSG_UPDATE_OBJECT);
     }
 
@@ -204,6 +357,7 @@ void UpdateData::Send(WorldSession* session, bool hasTransport)
 
 void UpdateData::Clear()
 {
+    m_buffer.clear();
     m_datas.clear();
     m_outOfRangeGUIDs.clear();
 }
@@ -25,6 +25,8 @@
 #include "ByteBuffer.h"
 #include "ObjectGuid.h"
 
+#include <vector>
+
 class WorldPacket;
 class WorldSession;
 class WorldObject;
@@ -56,18 +58,39 @@ enum ObjectUpdateFlags
 #endif
 };
 
+// Range of the blocks of one packet in UpdateData::m_buffer
 class UpdatePacket
 {
     public:
-        UpdatePacket() : blockCount(0) {}
-        ByteBuffer data;
+        explicit UpdatePacket(size_t offset) : offset(offset), size(0), blockCount(0) {}
+        size_t offset;
+        size_t size;
         uint32 blockCount;
 };
 
+/**
+ * @brief Deflates the update packets with a zlib stream kept by each thread.
+ * Identical large payloads compressed in a row by a thread (the same objects
+ * created for many players) are served from a small per-thread cache.
+ */
 class PacketCompressor
 {
     public:
+        struct Stats
+        {
+            uint64 calls = 0;
+            uint64 cacheHits = 0;
+            uint64 inBytes = 0;
+            uint64 outBytes = 0;
+            uint64 us = 0;
+        };
+
         static void Compress(void* dst, uint32* dst_size, void* src, int src_size);
+        // Compresses head followed by body, dst_size is set to 0 on error
+        static void Compress(void* dst, uint32* dst_size, uint8 const* head, size_t headSize, uint8 const* body, size_t bodySize);
+
+        // Totals of the calling thread since it started
+        static Stats const& GetThreadStats();
 };
 
 class UpdateData
@@ -89,7 +112,8 @@ class UpdateData
 
     protected:
         ObjectGuidSet m_outOfRangeGUIDs;
-        std::list<UpdatePacket> m_datas;
+        ByteBuffer m_buffer;                                // Blocks of every packet, contiguous
+        std::vector<UpdatePacket> m_datas;
 };
 
 class MovementData
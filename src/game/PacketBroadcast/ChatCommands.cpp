@@ -2,6 +2,10 @@
 #include "MovementBroadcaster.h"
 #include "PlayerBroadcaster.h"
 #include "World.h"
+#include "WorldSocket.h"
+#include "WorldSession.h"
+
+#include <algorithm>
 
 bool ChatHandler::HandlePBCastStatsCommand(char*)
 {
@@ -13,6 +17,45 @@ bool ChatHandler::HandlePBCastStatsCommand(char*)
             i, stats[i].update_time, stats[i].num_packets);
     PSendSysMessage("Created %u broadcasters | Deleted %u",
         PlayerBroadcaster::num_bcaster_created, PlayerBroadcaster::num_bcaster_deleted);
+    PSendSysMessage("Socket payload: " UI64FMTD " bytes copied | " UI64FMTD " bytes shared",
+        WorldSocket::GetBytesCopied(), WorldSocket::GetBytesShared());
+    PSendSysMessage("Socket output: " UI64FMTD " bytes sent | " UI64FMTD " send calls",
+        WorldSocket::GetBytesSent(), WorldSocket::GetSendCalls());
+    return true;
+}
+
+bool ChatHandler::HandlePBCastSocketsCommand(char* args)
+{
+    uint32 count = 10;
+    ExtractOptUInt32(&args, count, 10);
+
+    struct SocketStats
+    {
+        uint32 accountId;
+        std::string address;
+        size_t queuedBytes;
+        uint32 sendCalls;
+    };
+
+    std::vector<SocketStats> sockets;
+    for (auto const& itr : sWorld.GetAllSessions())
+    {
+        WorldSocket* socket = itr.second->GetSocket();
+        if (!socket)
+            continue;
+
+        sockets.push_back({ itr.first, itr.second->GetRemoteAddress(), socket->GetOutQueuedBytes(), socket->GetSendCallsPerSecond() });
+    }
+
+    std::sort(sockets.begin(), sockets.end(), [](SocketStats const& a, SocketStats const& b)
+    {
+        return a.queuedBytes > b.queuedBytes || (a.queuedBytes == b.queuedBytes && a.sendCalls > b.sendCalls);
+    });
+
+    PSendSysMessage("Sockets: %u | Send calls: " UI64FMTD, uint32(sockets.size()), WorldSocket::GetSendCalls());
+    for (uint32 i = 0; i < std::min(count, uint32(sockets.size())); ++i)
+        PSendSysMessage("Account %u (%s): %u bytes queued | %u send calls/s",
+            sockets[i].accountId, sockets[i].address.c_str(), uint32(sockets[i].queuedBytes), sockets[i].sendCalls);
     return true;
 }
 
@@ -49,7 +49,7 @@ void PlayerBroadcaster::ClearListeners()
     m_listeners.clear();
 }
 
-void PlayerBroadcaster::SendPacket(WorldPacket const& packet)
+void PlayerBroadcaster::SendPacket(SharedWorldPacket const& packet)
 {
     if (m_socket)
         m_socket->SendPacket(packet);
@@ -86,7 +86,7 @@ void PlayerBroadcaster::ProcessQueue(uint32& num_packets)
 void PlayerBroadcaster::QueuePacket(WorldPacket packet, bool self, ObjectGuid except)
 {
     BroadcastData data;
-    data.packet = std::move(packet);
+    data.packet = std::make_shared<WorldPacket const>(std::move(packet));
     data.sendToSelf = self;
     data.except = except;
 
@@ -98,7 +98,7 @@ void PlayerBroadcaster::QueuePacket(WorldPacket packet, bool self, ObjectGuid ex
     if (m_queue.size() >= MAX_QUEUE_SIZE)
     {
         BroadcastData& last_in_queue = m_queue[m_queue.size() - 1];
-        if (CanSkipPacket(last_in_queue.packet.GetOpcode()) && CanSkipPacket(packet.GetOpcode()))
+        if (CanSkipPacket(last_in_queue.packet->GetOpcode()) && CanSkipPacket(data.packet->GetOpcode()))
         {
             m_queue[m_queue.size() - 1] = std::move(data);
             guard.unlock();
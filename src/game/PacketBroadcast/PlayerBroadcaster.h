@@ -16,7 +16,7 @@ class PlayerBroadcaster final
 {
     struct BroadcastData
     {
-        WorldPacket packet;
+        SharedWorldPacket packet;                           // sent to every listener without copy
         bool sendToSelf;
         ObjectGuid except;
     };
@@ -32,7 +32,7 @@ class PlayerBroadcaster final
     std::mutex m_queue_lock;
 
     void ProcessQueue(uint32& num_packets);
-    void SendPacket(WorldPacket const& packet);
+    void SendPacket(SharedWorldPacket const& packet);
 
     static inline bool CanSkipPacket(uint32 opcode)
     {
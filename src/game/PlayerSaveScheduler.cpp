@@ -0,0 +1,145 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "PlayerSaveScheduler.h"
+#include "Player.h"
+#include "World.h"
+#include "Database/DatabaseEnv.h"
+#include "Policies/SingletonImp.h"
+
+#include <algorithm>
+#include <vector>
+
+INSTANTIATE_SINGLETON_1(PlayerSaveScheduler);
+
+// Granted slots not used by then belong to players that left the world
+static uint32 const GRANT_EXPIRY_TIME = 60 * IN_MILLISECONDS;
+// Statements assumed per save until the first saves are measured
+static double const DEFAULT_STATEMENTS_PER_SAVE = 20.0;
+
+bool PlayerSaveScheduler::RequestSave(Player* player)
+{
+    uint32 const guidLow = player->GetGUIDLow();
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        auto granted = m_granted.find(guidLow);
+        if (granted != m_granted.end())
+        {
+            m_granted.erase(granted);
+            return true;
+        }
+
+        if (m_pending.find(guidLow) != m_pending.end())
+            return false;
+    }
+
+    // Counted out of the lock, once per request
+    Request request;
+    request.changes = player->GetUnsavedChangeCount();
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    request.time = m_time;
+    m_pending.emplace(guidLow, request);
+    return false;
+}
+
+void PlayerSaveScheduler::Cancel(uint32 guidLow)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_pending.erase(guidLow);
+    m_granted.erase(guidLow);
+}
+
+void PlayerSaveScheduler::Update(uint32 diff)
+{
+    uint32 const interval = sWorld.getConfig(CONFIG_UINT32_INTERVAL_SAVE);
+    uint32 const players = std::max(sWorld.GetActiveSessionCount(), 1u);
+    uint32 const maxPerTick = sWorld.getConfig(CONFIG_UINT32_PLAYER_SAVE_MAX_PER_TICK);
+    uint32 const queueLimit = sWorld.getConfig(CONFIG_UINT32_DB_BACKPRESSURE_QUEUE_SIZE);
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_time += diff;
+
+    for (auto itr = m_granted.begin(); itr != m_granted.end();)
+    {
+        if (m_time - itr->second > GRANT_EXPIRY_TIME)
+        {
+            ++m_stats.expired;
+            itr = m_granted.erase(itr);
+        }
+        else
+            ++itr;
+    }
+
+    m_stats.lastTickGranted = 0;
+    m_stats.backlog = m_pending.size();
+    m_stats.maxBacklog = std::max(m_stats.maxBacklog, m_stats.backlog);
+
+    // Twice the average rate, so that a backlog drains while new requests keep coming
+    m_budget += interval ? 2.0 * players * diff / interval : double(m_pending.size());
+    m_budget = std::min(m_budget, std::max(double(m_pending.size()), 1.0));
+
+    uint32 slots = std::min(uint32(m_budget), uint32(m_pending.size()));
+    if (maxPerTick)
+        slots = std::min(slots, maxPerTick);
+
+    // Keep the character database queue under half of the backpressure limit
+    if (queueLimit && slots)
+    {
+        Player::SaveStats const saveStats = Player::GetSaveStats();
+        double const statementsPerSave = saveStats.saves ? std::max(double(saveStats.statements) / saveStats.saves, 1.0) : DEFAULT_STATEMENTS_PER_SAVE;
+        int64 const room = int64(queueLimit / 2) - CharacterDatabase.GetAsyncQueueSize();
+        slots = room > 0 ? std::min(slots, uint32(room / statementsPerSave)) : 0;
+    }
+
+    if (!slots)
+        return;
+
+    // Most unsaved changes first, then the oldest requests
+    std::vector<std::pair<uint32, Request>> requests(m_pending.begin(), m_pending.end());
+    std::partial_sort(requests.begin(), requests.begin() + slots, requests.end(),
+        [](std::pair<uint32, Request> const& a, std::pair<uint32, Request> const& b)
+        {
+            if (a.second.changes != b.second.changes)
+                return a.second.changes > b.second.changes;
+            return a.second.time < b.second.time;
+        });
+
+    for (uint32 i = 0; i < slots; ++i)
+    {
+        m_pending.erase(requests[i].first);
+        m_granted[requests[i].first] = m_time;
+    }
+
+    m_budget -= slots;
+    m_stats.lastTickGranted = slots;
+    m_stats.maxTickGranted = std::max(m_stats.maxTickGranted, slots);
+    m_stats.granted += slots;
+}
+
+PlayerSaveScheduler::Stats PlayerSaveScheduler::GetStats() const
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    Stats stats = m_stats;
+    stats.backlog = m_pending.size();
+    return stats;
+}
+
+void PlayerSaveScheduler::ResetStats()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_stats = Stats();
+}
@@ -0,0 +1,87 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PLAYER_SAVE_SCHEDULER_H
+#define PLAYER_SAVE_SCHEDULER_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+
+#include <mutex>
+#include <unordered_map>
+
+class Player;
+
+/**
+ * @brief Spreads the player autosaves over the save interval.
+ * A player whose save timer expired asks for a save slot from its map update,
+ * the world update then grants slots at twice the average rate of
+ * (online players / PlayerSave.Interval), so a burst of due saves (restart, mass
+ * login) drains over a few minutes instead of hitting the character database in
+ * the same ticks. Slots are also limited by PlayerSave.MaxPerTick and by the room
+ * left in the character database queue before half of Database.BackpressureQueueSize,
+ * counted with the measured statements per save. Players with the most unsaved
+ * changes get their slot first.
+ * Logout and explicit saves are not scheduled.
+ */
+class PlayerSaveScheduler
+{
+    public:
+        struct Stats
+        {
+            uint32 backlog = 0;                             // players waiting for a slot
+            uint32 maxBacklog = 0;
+            uint32 lastTickGranted = 0;
+            uint32 maxTickGranted = 0;
+            uint64 granted = 0;
+            uint64 expired = 0;                             // slots never used by their player
+        };
+
+        PlayerSaveScheduler() : m_budget(0.0), m_time(0) {}
+
+        /**
+         * @brief RequestSave returns true when the player got a save slot and should save now.
+         * Otherwise the player is queued, with the number of its unsaved changes as priority.
+         */
+        bool RequestSave(Player* player);
+
+        // Forgets the player, called by every save
+        void Cancel(uint32 guidLow);
+
+        // Grants the save slots of this tick, from the world update
+        void Update(uint32 diff);
+
+        Stats GetStats() const;
+        void ResetStats();
+
+    private:
+        struct Request
+        {
+            uint32 changes;
+            uint64 time;
+        };
+
+        mutable std::mutex m_lock;
+        std::unordered_map<uint32, Request> m_pending;      // By player low guid
+        std::unordered_map<uint32, uint64> m_granted;       // Player low guid, time of the grant
+        double m_budget;                                    // Slots not granted yet, fractional
+        uint64 m_time;                                      // Milliseconds of world updates
+        Stats m_stats;
+};
+
+#define sPlayerSaveScheduler MaNGOS::Singleton<PlayerSaveScheduler>::Instance()
+
+#endif
@@ -21,6 +21,7 @@
 #include "Policies/SingletonImp.h"
 #include "Log.h"
 #include "ProgressBar.h"
+#include "Database/SQLStorageSnapshot.h"
 #include "ObjectMgr.h"
 #include "WaypointManager.h"
 #include "World.h"
@@ -1792,6 +1793,14 @@ uint32 ScriptMgr::GetScriptId(char const* name) const
     return uint32(itr - m_scriptNames.begin());
 }
 
+uint64 ScriptMgr::GetScriptNamesHash() const
+{
+    uint64 hash = SQLStorageSnapshot::Hash(nullptr, 0);
+    for (auto const& name : m_scriptNames)
+        hash = SQLStorageSnapshot::Hash(name, hash);
+    return hash;
+}
+
 uint32 ScriptMgr::GetAreaTriggerScriptId(uint32 triggerId) const
 {
     AreaTriggerScriptMap::const_iterator itr = m_AreaTriggerScripts.find(triggerId);
@@ -1817,7 +1826,7 @@ CreatureAI* ScriptMgr::GetCreatureAI(Creature* pCreature)
     if (!pTempScript || !pTempScript->GetAI)
     {
 #ifdef ENABLE_ELUNA
-        if (CreatureAI* luaAI = sEluna->GetAI(pCreature))
+        if (CreatureAI* luaAI = pCreature->GetEluna()->GetAI(pCreature))
             return luaAI;
 #endif /* ENABLE_ELUNA */
         return nullptr;
@@ -1853,7 +1862,7 @@ bool ScriptMgr::OnGossipHello(Player* pPlayer, Creature* pCreature)
     if (!pTempScript || !pTempScript->pGossipHello)
     {
 #ifdef ENABLE_ELUNA
-        if (sEluna->OnGossipHello(pPlayer, pCreature))
+        if (pCreature->GetEluna()->OnGossipHello(pPlayer, pCreature))
             return true;
 #endif /* ENABLE_ELUNA */
         return false;
@@ -1870,7 +1879,7 @@ bool ScriptMgr::OnGossipHello(Player* pPlayer, GameObject* pGameObject)
     if (!pTempScript || !pTempScript->pGOGossipHello)
     {
 #ifdef ENABLE_ELUNA
-        if (sEluna->OnGossipHello(pPlayer, pGameObject))
+        if (pGameObject->GetEluna()->OnGossipHello(pPlayer, pGameObject))
             return true;
 #endif /* ENABLE_ELUNA */
         return false;
@@ -1907,12 +1916,12 @@ bool ScriptMgr::OnGossipSelect(Player* pPlayer, Creature* pCreature, uint32 send
 #ifdef ENABLE_ELUNA
     if (code)
     {
-        if (sEluna->OnGossipSelectCode(pPlayer, pCreature, sender, action, code))
+        if (pCreature->GetEluna()->OnGossipSelectCode(pPlayer, pCreature, sender, action, code))
             return true;
     }
     else
     {
-        if (sEluna->OnGossipSelect(pPlayer, pCreature, sender, action))
+        if (pCreature->GetEluna()->OnGossipSelect(pPlayer, pCreature, sender, action))
             return true;
     }
 #endif /* ENABLE_ELUNA */
@@ -1945,12 +1954,12 @@ bool ScriptMgr::OnGossipSelect(Player* pPlayer, GameObject* pGameObject, uint32
 #ifdef ENABLE_ELUNA
     if (code)
     {
-        if (sEluna->OnGossipSelectCode(pPlayer, pGameObject, sender, action, code))
+        if (pGameObject->GetEluna()->OnGossipSelectCode(pPlayer, pGameObject, sender, action, code))
             return true;
     }
     else
     {
-        if (sEluna->OnGossipSelect(pPlayer, pGameObject, sender, action))
+        if (pGameObject->GetEluna()->OnGossipSelect(pPlayer, pGameObject, sender, action))
             return true;
     }
 #endif /* ENABLE_ELUNA */
@@ -1964,7 +1973,7 @@ bool ScriptMgr::OnQuestAccept(Player* pPlayer, Creature* pCreature, Quest const*
     if (!pTempScript || !pTempScript->pQuestAcceptNPC)
     {
 #ifdef ENABLE_ELUNA
-        if (sEluna->OnQuestAccept(pPlayer, pCreature, pQuest))
+        if (pCreature->GetEluna()->OnQuestAccept(pPlayer, pCreature, pQuest))
             return true;
 #endif /* ENABLE_ELUNA */
         return false;
@@ -1981,7 +1990,7 @@ bool ScriptMgr::OnQuestAccept(Player* pPlayer, GameObject* pGameObject, Quest co
     if (!pTempScript || !pTempScript->pGOQuestAccept)
     {
 #ifdef ENABLE_ELUNA
-        if (sEluna->OnQuestAccept(pPlayer, pGameObject, pQuest))
+        if (pGameObject->GetEluna()->OnQuestAccept(pPlayer, pGameObject, pQuest))
             return true;
 #endif /* ENABLE_ELUNA */
         return false;
@@ -2022,7 +2031,7 @@ uint32 ScriptMgr::GetDialogStatus(Player* pPlayer, Creature* pCreature)
     if (!pTempScript || !pTempScript->pNPCDialogStatus)
     {
 #ifdef ENABLE_ELUNA
-        sEluna->GetDialogStatus(pPlayer, pCreature);
+        pCreature->GetEluna()->GetDialogStatus(pPlayer, pCreature);
 #endif /* ENABLE_ELUNA */
         return DIALOG_STATUS_UNDEFINED;
     }
@@ -2039,7 +2048,7 @@ uint32 ScriptMgr::GetDialogStatus(Player* pPlayer, GameObject* pGameObject)
     if (!pTempScript || !pTempScript->pGODialogStatus)
     {
 #ifdef ENABLE_ELUNA
-        sEluna->GetDialogStatus(pPlayer, pGameObject);
+        pGameObject->GetEluna()->GetDialogStatus(pPlayer, pGameObject);
 #endif /* ENABLE_ELUNA */
         return DIALOG_STATUS_UNDEFINED;
     }
@@ -2066,7 +2075,7 @@ bool ScriptMgr::OnGameObjectUse(Player* pPlayer, GameObject* pGameObject)
     if (!pTempScript || !pTempScript->pGOHello)
     {
 #ifdef ENABLE_ELUNA
-        if (sEluna->OnGameObjectUse(pPlayer, pGameObject))
+        if (pGameObject->GetEluna()->OnGameObjectUse(pPlayer, pGameObject))
             return true;
 #endif /* ENABLE_ELUNA */
         return false;
@@ -2083,7 +2092,7 @@ bool ScriptMgr::OnAreaTrigger(Player* pPlayer, AreaTriggerEntry const* atEntry)
     if (!pTempScript || !pTempScript->pAreaTrigger)
     {
 #ifdef ENABLE_ELUNA
-        if (sEluna->OnAreaTrigger(pPlayer, atEntry))
+        if (pPlayer->GetEluna()->OnAreaTrigger(pPlayer, atEntry))
             return true;
 #endif /* ENABLE_ELUNA */
         return false;
@@ -2120,7 +2129,7 @@ bool ScriptMgr::OnEffectDummy(WorldObject* pCaster, uint32 spellId, SpellEffectI
     if (!pTempScript || !pTempScript->pEffectDummyGameObj)
     {
 #ifdef ENABLE_ELUNA
-        if (sEluna->OnDummyEffect(pCaster, spellId, effIndex, pTarget))
+        if (pCaster->GetEluna()->OnDummyEffect(pCaster, spellId, effIndex, pTarget))
             return true;
 #endif /* ENABLE_ELUNA */
         return false;
@@ -206,6 +206,7 @@ class ScriptMgr
         char const* GetScriptName(uint32 id) const { return id < m_scriptNames.size() ? m_scriptNames[id].c_str() : ""; }
         uint32 GetScriptId(char const* name) const;
         uint32 GetScriptIdsCount() const { return m_scriptNames.size(); }
+        uint64 GetScriptNamesHash() const;                  // Script ids stored in the SQLStorage snapshots depend on the names
         
         void Initialize();
         void LoadDatabase();
@@ -74,3 +74,69 @@ void SniffFile::WritePacket(WorldPacket const& packet, bool isClientPacket, time
     if (packet.size())
         fwrite(packet.contents(), sizeof(uint8), packet.size(), m_file);
 }
+
+SniffFileReader::SniffFileReader(char const* fileName)
+{
+    m_file = fopen(fileName, "rb");
+}
+
+SniffFileReader::~SniffFileReader()
+{
+    if (m_file)
+        fclose(m_file);
+}
+
+bool SniffFileReader::ReadHeader(uint16& gameBuild)
+{
+    char magic[3];
+    uint16 sniffVersion;
+    uint8 unused[40];
+    if (fread(magic, 1, 3, m_file) != 3 || memcmp(magic, "PKT", 3) != 0)
+        return false;
+    if (fread(&sniffVersion, sizeof(uint16), 1, m_file) != 1 || sniffVersion != 0x201)
+        return false;
+    if (fread(&gameBuild, sizeof(uint16), 1, m_file) != 1)
+        return false;
+    return fread(unused, 1, 40, m_file) == 40;
+}
+
+bool SniffFileReader::ReadPacket(WorldPacket& packet, bool& isClientPacket, uint32& unixTime)
+{
+    uint8 direction;
+    uint32 msTime;
+    uint32 packetSize;
+    if (fread(&direction, 1, 1, m_file) != 1 ||
+        fread(&unixTime, sizeof(uint32), 1, m_file) != 1 ||
+        fread(&msTime, sizeof(uint32), 1, m_file) != 1 ||
+        fread(&packetSize, sizeof(uint32), 1, m_file) != 1)
+        return false;
+
+    isClientPacket = direction == 0x00;
+
+    uint16 opcode;
+    if (isClientPacket)
+    {
+        uint32 clientOpcode;
+        if (packetSize < sizeof(uint32) || fread(&clientOpcode, sizeof(uint32), 1, m_file) != 1)
+            return false;
+        opcode = clientOpcode;
+        packetSize -= sizeof(uint32);
+    }
+    else
+    {
+        if (packetSize < sizeof(uint16) || fread(&opcode, sizeof(uint16), 1, m_file) != 1)
+            return false;
+        packetSize -= sizeof(uint16);
+    }
+
+    packet.Initialize(opcode, packetSize);
+    if (packetSize)
+    {
+        std::vector<uint8> data(packetSize);
+        if (fread(data.data(), 1, packetSize, m_file) != packetSize)
+            return false;
+        packet.append(data);
+    }
+    packet.FillPacketTime(msTime);
+    return true;
+}
@@ -58,4 +58,21 @@ private:
     FILE* m_file;
 };
 
+// Reads back the files written by SniffFile, for the packet replay tool
+class SniffFileReader
+{
+public:
+    explicit SniffFileReader(char const* fileName);
+    ~SniffFileReader();
+
+    bool IsOpen() const { return m_file != nullptr; }
+
+    // False when the file does not start with a header written by SniffFile::WriteHeader
+    bool ReadHeader(uint16& gameBuild);
+    // Packet time is the ms time of the record, false at the end of the file or on a truncated record
+    bool ReadPacket(WorldPacket& packet, bool& isClientPacket, uint32& unixTime);
+private:
+    FILE* m_file;
+};
+
 #endif
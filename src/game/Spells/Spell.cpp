@@ -660,6 +660,7 @@ void Spell::FillTargetMap()
                 break;
         }
 
+        PrefetchTargetsLOS(tmpUnitMap, SpellEffectIndex(i));
         for (UnitList::iterator itr = tmpUnitMap.begin(); itr != tmpUnitMap.end();)
         {
             if (!CheckTarget(*itr, SpellEffectIndex(i)))
@@ -670,6 +671,7 @@ void Spell::FillTargetMap()
             else
                 ++itr;
         }
+        m_prefetchedTargetsLOS.clear();
 
         for (const auto iunit : tmpUnitMap)
             AddUnitTarget(iunit, SpellEffectIndex(i));
@@ -3884,7 +3886,7 @@ void Spell::cast(bool skipCheck)
     // Used by Eluna
 #ifdef ENABLE_ELUNA
     if (m_caster->GetTypeId() == TYPEID_PLAYER)
-        sEluna->OnSpellCast(m_caster->ToPlayer(), this, skipCheck);
+        m_caster->GetEluna()->OnSpellCast(m_caster->ToPlayer(), this, skipCheck);
 #endif /* ENABLE_ELUNA */
 
     FillTargetMap();
@@ -8158,6 +8160,63 @@ CurrentSpellTypes Spell::GetCurrentContainer() const
         return (CURRENT_GENERIC_SPELL);
 }
 
+// Same segments as the normal case of CheckTarget, from the target to the casting object
+void Spell::PrefetchTargetsLOS(UnitList const& targets, SpellEffectIndex eff)
+{
+    // Below that, the batch does not save anything
+    if (targets.size() < 4)
+        return;
+
+    switch (m_spellInfo->Effect[eff])
+    {
+        case SPELL_EFFECT_SUMMON_PLAYER:
+        case SPELL_EFFECT_DUMMY:
+        case SPELL_EFFECT_RESURRECT:
+        case SPELL_EFFECT_RESURRECT_NEW:
+            return;
+    }
+
+    if (m_spellInfo->HasAttribute(SPELL_ATTR_EX2_IGNORE_LINE_OF_SIGHT) || IsIgnoreLosTarget(m_spellInfo->EffectImplicitTargetA[eff]) ||
+        m_spellInfo->EffectChainTarget[eff] != 0)
+        return;
+
+    SpellCaster* caster = GetCastingObject();
+    if (!caster || !caster->IsInWorld())
+        return;
+
+    float casterX, casterY, casterZ;
+    caster->GetPosition(casterX, casterY, casterZ);
+    casterZ += caster->IsUnit() ? caster->ToUnit()->GetCollisionHeight() : 2.f;
+
+    std::vector<Unit const*> units;
+    std::vector<VMAP::LineOfSightQuery> queries;
+    units.reserve(targets.size());
+    queries.reserve(targets.size());
+    for (Unit const* target : targets)
+    {
+        // Other cases are left to IsWithinLOSInMap
+        if (target == m_caster || !target->IsInWorld() || !target->IsInMap(caster) || target->IsWithinDist(caster, 0.0f))
+            continue;
+
+        VMAP::LineOfSightQuery query;
+        target->GetPosition(query.x1, query.y1, query.z1);
+        query.z1 += target->GetCollisionHeight();
+        query.x2 = casterX;
+        query.y2 = casterY;
+        query.z2 = casterZ;
+        query.result = true;
+        queries.push_back(query);
+        units.push_back(target);
+    }
+
+    if (queries.empty())
+        return;
+
+    caster->GetMap()->isInLineOfSight(queries.data(), queries.size());
+    for (uint32 i = 0; i < queries.size(); ++i)
+        m_prefetchedTargetsLOS[units[i]] = queries[i].result;
+}
+
 bool Spell::CheckTarget(Unit* target, SpellEffectIndex eff)
 {
     if (m_casterUnit && target != m_casterUnit && m_spellInfo->IsPositiveSpell())
@@ -8250,8 +8309,12 @@ bool Spell::CheckTarget(Unit* target, SpellEffectIndex eff)
             if (target != m_caster && !IsIgnoreLosTarget(m_spellInfo->EffectImplicitTargetA[eff]) &&
                (m_spellInfo->EffectChainTarget[eff] == 0 || target == m_targets.getUnitTarget()))
                 if (SpellCaster* caster = GetCastingObject())
-                    if (!(m_spellInfo->AttributesEx2 & SPELL_ATTR_EX2_IGNORE_LINE_OF_SIGHT) && !target->IsWithinLOSInMap(caster))
-                        return false;
+                    if (!(m_spellInfo->AttributesEx2 & SPELL_ATTR_EX2_IGNORE_LINE_OF_SIGHT))
+                    {
+                        auto prefetched = m_prefetchedTargetsLOS.find(target);
+                        if (prefetched != m_prefetchedTargetsLOS.end() ? !prefetched->second : !target->IsWithinLOSInMap(caster))
+                            return false;
+                    }
             break;
     }
 
@@ -383,6 +383,7 @@ class Spell
         template<typename T> WorldObject* FindCorpseUsing();
 
         bool CheckTarget(Unit* target, SpellEffectIndex eff);
+        void PrefetchTargetsLOS(UnitList const& targets, SpellEffectIndex eff);
         bool CanAutoCast(Unit* target);
 
         static void SendCastResult(Player* caster, SpellEntry const* spellInfo, SpellCastResult result);
@@ -620,6 +621,9 @@ class Spell
         GOTargetList   m_UniqueGOTargetInfo;
         ItemTargetList m_UniqueItemInfo;
 
+        // Line of sight of the area targets of the effect being checked, tested as one batch
+        std::unordered_map<Unit const*, bool> m_prefetchedTargetsLOS;
+
         void AddUnitTarget(Unit* target, SpellEffectIndex effIndex);
         void CheckAtDelay(TargetInfo* pInf);
         void AddUnitTarget(ObjectGuid unitGuid, SpellEffectIndex effIndex);
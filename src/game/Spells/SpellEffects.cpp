@@ -3100,10 +3100,10 @@ void Spell::EffectSummon(SpellEffectIndex effIdx)
     AddExecuteLogInfo(effIdx, ExecuteLogInfo(spawnCreature->GetObjectGuid()));
 #ifdef ENABLE_ELUNA
     if (Unit* summoner = m_caster->ToUnit())
-        sEluna->OnSummoned(spawnCreature, summoner);
+        spawnCreature->GetEluna()->OnSummoned(spawnCreature, summoner);
     else if (m_originalCaster)
         if (Unit* summoner = m_originalCaster->ToUnit())
-            sEluna->OnSummoned(spawnCreature, summoner);
+            spawnCreature->GetEluna()->OnSummoned(spawnCreature, summoner);
 #endif /* ENABLE_ELUNA */
 }
 
@@ -3490,7 +3490,7 @@ void Spell::EffectSummonWild(SpellEffectIndex effIdx)
 #ifdef ENABLE_ELUNA
             if (m_originalCaster)
                 if (Unit* summoner = m_originalCaster->ToUnit())
-                    sEluna->OnSummoned(summon, summoner);
+                    summon->GetEluna()->OnSummoned(summon, summoner);
 #endif /* ENABLE_ELUNA */
 
 
@@ -3686,10 +3686,10 @@ void Spell::EffectSummonGuardian(SpellEffectIndex effIdx)
 
 #ifdef ENABLE_ELUNA
         if (Unit* summoner = m_caster->ToUnit())
-            sEluna->OnSummoned(spawnCreature, summoner);
+            spawnCreature->GetEluna()->OnSummoned(spawnCreature, summoner);
         if (m_originalCaster)
             if (Unit* summoner = m_originalCaster->ToUnit())
-                sEluna->OnSummoned(spawnCreature, summoner);
+                spawnCreature->GetEluna()->OnSummoned(spawnCreature, summoner);
 #endif /* ENABLE_ELUNA */
 
         if (count == 0)
@@ -3718,7 +3718,7 @@ void Spell::EffectSummonPossessed(SpellEffectIndex effIdx)
 
 #ifdef ENABLE_ELUNA
     if (Unit* summoner = m_originalCaster->ToUnit())
-        sEluna->OnSummoned(pMinion, summoner);
+        pMinion->GetEluna()->OnSummoned(pMinion, summoner);
 #endif /* ENABLE_ELUNA */
 }
 
@@ -5667,7 +5667,7 @@ void Spell::EffectDuel(SpellEffectIndex effIdx)
 
     // Used by Eluna
 #ifdef ENABLE_ELUNA
-    sEluna->OnDuelRequest(target, caster);
+    target->GetEluna()->OnDuelRequest(target, caster);
 #endif /* ENABLE_ELUNA */
 }
 
@@ -6396,10 +6396,10 @@ void Spell::EffectSummonCritter(SpellEffectIndex effIdx)
 
 #ifdef ENABLE_ELUNA
     if (Unit* summoner = m_caster->ToUnit())
-        sEluna->OnSummoned(critter, summoner);
+        critter->GetEluna()->OnSummoned(critter, summoner);
     if (m_originalCaster)
         if (Unit* summoner = m_originalCaster->ToUnit())
-            sEluna->OnSummoned(critter, summoner);
+            critter->GetEluna()->OnSummoned(critter, summoner);
 #endif /* ENABLE_ELUNA */
 }
 
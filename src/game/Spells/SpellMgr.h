@@ -32,6 +32,7 @@
 #include "SQLStorages.h"
 #include "SpellEntry.h"
 
+#include <atomic>
 #include <map>
 #include <memory>
 
@@ -461,6 +462,9 @@ class SpellMgr
             return nullptr;
         }
 
+        // Changes with each (re)load of the proc events, for the proc index of the units
+        uint32 GetProcEventGeneration() const { return m_procEventGeneration; }
+
         // Spell procs from item enchants
         float GetItemEnchantProcChance(uint32 spellid) const
         {
@@ -733,6 +737,7 @@ class SpellMgr
         SpellElixirMap     mSpellElixirs;
         SpellThreatMap     mSpellThreatMap;
         SpellProcEventMap  mSpellProcEventMap;
+        std::atomic<uint32> m_procEventGeneration{0};
         SpellProcItemEnchantMap mSpellProcItemEnchantMap;
         SpellEnchantChargesMap mSpellEnchantChargesMap;
         SkillLineAbilityMap mSkillLineAbilityMapBySpellId;
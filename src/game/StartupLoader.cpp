@@ -0,0 +1,149 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "StartupLoader.h"
+#include "Multithreading/TaskScheduler.h"
+#include "ProgressBar.h"
+#include "Log.h"
+#include "Errors.h"
+
+#include <algorithm>
+
+StartupLoader::LoaderId StartupLoader::Add(char const* name, std::function<void()> function, std::initializer_list<LoaderId> dependencies)
+{
+    LoaderId const id = m_loaders.size();
+
+    m_loaders.emplace_back(new Loader());
+    Loader& loader = *m_loaders.back();
+    loader.name = name;
+    loader.function = std::move(function);
+
+    for (LoaderId dependency : dependencies)
+    {
+        MANGOS_ASSERT(dependency < id);
+        loader.dependencies.push_back(dependency);
+        m_loaders[dependency]->dependents.push_back(id);
+    }
+
+    return id;
+}
+
+void StartupLoader::Execute(Loader& loader)
+{
+    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading %s...", loader.name.c_str());
+
+    Clock::time_point const start = Clock::now();
+    loader.function();
+    Clock::time_point const end = Clock::now();
+
+    loader.startMs = uint32(std::chrono::duration_cast<std::chrono::milliseconds>(start - m_start).count());
+    loader.durationMs = uint32(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+}
+
+void StartupLoader::Schedule(TaskGroup& group, LoaderId id)
+{
+    group.Run([this, &group, id]()
+    {
+        Execute(*m_loaders[id]);
+
+        for (LoaderId dependent : m_loaders[id]->dependents)
+            if (--m_loaders[dependent]->remaining == 0)
+                Schedule(group, dependent);
+    });
+}
+
+void StartupLoader::Run(bool parallel)
+{
+    m_start = Clock::now();
+
+    if (!parallel || !sTaskScheduler.IsRunning())
+    {
+        for (auto const& loader : m_loaders)
+            Execute(*loader);
+    }
+    else
+    {
+        sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Running %u %s loaders on %u threads", uint32(m_loaders.size()), m_name.c_str(), sTaskScheduler.GetWorkerCount());
+
+        // Progress bars of concurrent loaders would overwrite each other
+        bool const showProgressBars = BarGoLink::GetOutputState();
+        BarGoLink::SetOutputState(false);
+
+        for (auto const& loader : m_loaders)
+            loader->remaining = loader->dependencies.size();
+
+        {
+            TaskGroup group;
+            for (LoaderId id = 0; id < m_loaders.size(); ++id)
+                if (m_loaders[id]->dependencies.empty())
+                    Schedule(group, id);
+            group.Wait();
+        }
+
+        BarGoLink::SetOutputState(showProgressBars);
+    }
+
+    m_durationMs = uint32(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - m_start).count());
+}
+
+void StartupLoader::LogReport() const
+{
+    // Longest chain of dependencies ending at each loader, with the measured durations
+    std::vector<uint32> pathMs(m_loaders.size(), 0);
+    std::vector<int32> pathPrevious(m_loaders.size(), -1);
+    uint32 totalMs = 0;
+    LoaderId last = 0;
+    for (LoaderId id = 0; id < m_loaders.size(); ++id)
+    {
+        Loader const& loader = *m_loaders[id];
+        for (LoaderId dependency : loader.dependencies)
+        {
+            if (pathMs[dependency] >= pathMs[id])
+            {
+                pathMs[id] = pathMs[dependency];
+                pathPrevious[id] = int32(dependency);
+            }
+        }
+        pathMs[id] += loader.durationMs;
+        totalMs += loader.durationMs;
+
+        if (pathMs[id] > pathMs[last])
+            last = id;
+    }
+
+    std::vector<LoaderId> byDuration(m_loaders.size());
+    for (LoaderId id = 0; id < m_loaders.size(); ++id)
+        byDuration[id] = id;
+    std::stable_sort(byDuration.begin(), byDuration.end(), [this](LoaderId a, LoaderId b) { return m_loaders[a]->durationMs > m_loaders[b]->durationMs; });
+
+    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "");
+    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, ">> %s loaded in %u ms (%u ms of loaders)", m_name.c_str(), m_durationMs, totalMs);
+    for (LoaderId id : byDuration)
+    {
+        Loader const& loader = *m_loaders[id];
+        sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "   %-40s %6u ms (started at %u ms)", loader.name.c_str(), loader.durationMs, loader.startMs);
+    }
+
+    if (m_loaders.empty())
+        return;
+
+    std::string path;
+    for (int32 id = int32(last); id >= 0; id = pathPrevious[id])
+        path = m_loaders[id]->name + (path.empty() ? "" : " -> ") + path;
+
+    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, ">> Critical path (%u ms): %s", pathMs[last], path.c_str());
+    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "");
+}
@@ -0,0 +1,88 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_STARTUPLOADER_H
+#define MANGOS_STARTUPLOADER_H
+
+#include "Common.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+class TaskGroup;
+
+/**
+ * @brief Dependency graph of startup loaders (ObjectMgr::Load*, SpellMgr::Load* ...).
+ * In parallel mode every loader whose dependencies are done runs on the task
+ * scheduler, so independent tables are fetched at the same time on the sync
+ * connections of the database (see WorldDatabase.Connections).
+ * Loaders must only declare dependencies on previously added loaders, the
+ * insertion order is then the order used when running sequentially.
+ */
+class StartupLoader
+{
+    public:
+        typedef uint32 LoaderId;
+
+        explicit StartupLoader(char const* name) : m_name(name), m_durationMs(0) {}
+
+        StartupLoader(StartupLoader const&) = delete;
+        StartupLoader& operator=(StartupLoader const&) = delete;
+
+        /**
+         * @brief Add registers a loader. The name is logged as "Loading <name>..." when it starts.
+         */
+        LoaderId Add(char const* name, std::function<void()> function, std::initializer_list<LoaderId> dependencies = {});
+
+        /**
+         * @brief Run executes every loader, concurrently when parallel is set and the task scheduler is running.
+         */
+        void Run(bool parallel);
+
+        /**
+         * @brief LogReport prints the duration of each loader and the critical path of the graph.
+         */
+        void LogReport() const;
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        struct Loader
+        {
+            std::string name;
+            std::function<void()> function;
+            std::vector<LoaderId> dependencies;
+            std::vector<LoaderId> dependents;
+            std::atomic<uint32> remaining{0};
+            uint32 startMs = 0;                             // Relative to the start of Run
+            uint32 durationMs = 0;
+        };
+
+        void Execute(Loader& loader);
+        void Schedule(TaskGroup& group, LoaderId id);
+
+        std::string m_name;
+        std::vector<std::unique_ptr<Loader>> m_loaders;
+        Clock::time_point m_start;
+        uint32 m_durationMs;
+};
+
+#endif
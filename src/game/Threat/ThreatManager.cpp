@@ -209,6 +209,30 @@ void ThreatContainer::clearReferences()
         delete(*i);
     }
     iThreatList.clear();
+    iGuids.clear();
+}
+
+//============================================================
+
+void ThreatContainer::addReference(HostileReference* pHostileReference)
+{
+    iThreatList.push_back(pHostileReference);
+    iGuids.push_back(pHostileReference->getUnitGuid());
+}
+
+//============================================================
+
+void ThreatContainer::remove(HostileReference* pRef)
+{
+    for (size_t i = 0; i < iThreatList.size(); ++i)
+    {
+        if (iThreatList[i] == pRef)
+        {
+            iThreatList.erase(iThreatList.begin() + i);
+            iGuids.erase(iGuids.begin() + i);
+            return;
+        }
+    }
 }
 
 //============================================================
@@ -218,18 +242,12 @@ HostileReference* ThreatContainer::getReferenceByTarget(Unit* pVictim)
     if (!pVictim)
         return nullptr;
 
-    HostileReference* result = nullptr;
     ObjectGuid guid = pVictim->GetObjectGuid();
-    for (const auto i : iThreatList)
-    {
-        if (i->getUnitGuid() == guid)
-        {
-            result = i;
-            break;
-        }
-    }
+    for (size_t i = 0; i < iGuids.size(); ++i)
+        if (iGuids[i] == guid)
+            return iThreatList[i];
 
-    return result;
+    return nullptr;
 }
 
 //============================================================
@@ -264,19 +282,33 @@ void ThreatContainer::modifyThreatPercent(Unit* pVictim, int32 pPercent)
 
 //============================================================
 
-bool HostileReferenceSortPredicate(HostileReference const* lhs, HostileReference const* rhs)
-{
-    // std::list::sort ordering predicate must be: (Pred(x,y)&&Pred(y,x))==false
-    return lhs->getThreat() > rhs->getThreat();             // reverse sorting
-}
-
-//============================================================
 // Check if the list is dirty and sort if necessary
+// Between two updates only a few threats change, so the list is nearly sorted
+// and an insertion sort only moves the changed references (stable, like the
+// previous std::list::sort)
 
 void ThreatContainer::update()
 {
     if (iDirty && iThreatList.size() > 1)
-        iThreatList.sort(HostileReferenceSortPredicate);
+    {
+        for (size_t i = 1; i < iThreatList.size(); ++i)
+        {
+            HostileReference* ref = iThreatList[i];
+            float const threat = ref->getThreat();
+            if (iThreatList[i - 1]->getThreat() >= threat)
+                continue;
+
+            ObjectGuid const guid = iGuids[i];
+            size_t j = i;
+            for (; j > 0 && iThreatList[j - 1]->getThreat() < threat; --j)
+            {
+                iThreatList[j] = iThreatList[j - 1];
+                iGuids[j] = iGuids[j - 1];
+            }
+            iThreatList[j] = ref;
+            iGuids[j] = guid;
+        }
+    }
     iDirty = false;
 }
 
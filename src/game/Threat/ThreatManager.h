@@ -28,7 +28,7 @@
 #include "UnitEvents.h"
 #include "ObjectGuid.h"
 #include "SpellDefines.h"
-#include <list>
+#include <vector>
 
 //==============================================================
 
@@ -136,17 +136,20 @@ class HostileReference : public Reference<Unit, ThreatManager>
 //==============================================================
 class ThreatManager;
 
-typedef std::list<HostileReference*> ThreatList;
+// Contiguous, sorted by decreasing threat after ThreatContainer::update().
+// Do not add, remove or modify threat while iterating it: copy the guids first.
+typedef std::vector<HostileReference*> ThreatList;
 
 class ThreatContainer
 {
     ThreatList iThreatList;
+    std::vector<ObjectGuid> iGuids;                         // iGuids[i] is the guid of iThreatList[i], scanned by the lookups without dereferencing each reference
     bool iDirty;
 protected:
     friend class ThreatManager;
 
-    void remove(HostileReference* pRef) { iThreatList.remove(pRef); }
-    void addReference(HostileReference* pHostileReference) { iThreatList.push_back(pHostileReference); }
+    void remove(HostileReference* pRef);
+    void addReference(HostileReference* pHostileReference);
     void clearReferences();
     // Sort the list if necessary
     void update();
@@ -231,6 +231,7 @@ inline bool SpellCanTrigger(SpellEntry const* spellProto, SpellEntry const* proc
     return (procSpell && procSpell->SpellFamilyName == spellProto->SpellFamilyName && procSpell->SpellFamilyFlags & spellProto->EffectItemType[eff_idx]);
 }
 
+// Hard-coded cases returning SPELL_PROC_TRIGGER_OK need an entry in Unit::GetProcIndexFlags
 SpellProcEventTriggerCheck Unit::IsTriggeredAtSpellProcEvent(Unit* pVictim, SpellAuraHolder* holder, SpellEntry const* procSpell, uint32 procFlag, uint32 procExtra, WeaponAttackType attType, bool isVictim, SpellProcEventEntry const*& spellProcEvent, bool isSpellTriggeredByAuraOrItem) const
 {
     SpellEntry const* spellProto = holder->GetSpellProto();
@@ -502,6 +503,31 @@ SpellProcEventTriggerCheck Unit::IsTriggeredAtSpellProcEvent(Unit* pVictim, Spel
     return SPELL_PROC_TRIGGER_ROLL_FAILED;
 }
 
+uint32 Unit::GetProcIndexFlags(SpellEntry const* spellProto)
+{
+    // The hard-coded cases of IsTriggeredAtSpellProcEvent may proc before the proc flags are checked
+    switch (spellProto->Id)
+    {
+        case 6346:                                          // Fear Ward
+        case 12292:                                         // Sweeping Strikes
+        case 18765:
+        case 16864:                                         // Omen of Clarity
+        case 24658:                                         // Unstable Power
+        case 25906:                                         // Spell Blasting
+            return 0xFFFFFFFF;
+    }
+    if (spellProto->SpellIconID == 1820 || spellProto->SpellIconID == 1799 ||   // Eye for an Eye
+       (spellProto->SpellIconID == 79 && (spellProto->SpellFamilyName == SPELLFAMILY_PALADIN || spellProto->SpellFamilyName == SPELLFAMILY_PRIEST)) ||
+        spellProto->EffectApplyAuraName[0] == SPELL_AURA_ADD_TARGET_TRIGGER)
+        return 0xFFFFFFFF;
+
+    SpellProcEventEntry const* spellProcEvent = sSpellMgr.GetSpellProcEvent(spellProto->Id);
+    if (spellProcEvent && spellProcEvent->procFlags)
+        return spellProcEvent->procFlags;
+
+    return spellProto->procFlags;
+}
+
 SpellAuraProcResult Unit::TriggerProccedSpell(Unit* target, int32* basepoints, uint32 triggeredSpellId, Item* castItem, Aura* triggeredByAura, uint32 cooldown, ObjectGuid originalCaster, SpellEntry const* triggeredByParent)
 {
     SpellEntry const* triggerEntry = sSpellMgr.GetSpellEntry(triggeredSpellId);
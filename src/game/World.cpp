@@ -77,10 +77,16 @@
 #include "HonorMgr.h"
 #include "Anticheat/Anticheat.h"
 #include "ThreadPool.h"
+#include "Multithreading/TaskScheduler.h"
+#include "MapTickProfiler.h"
+#include "StartupLoader.h"
+#include "Database/SQLStorageSnapshot.h"
 #include "AuraRemovalMgr.h"
 #include "InstanceStatistics.h"
 #include "GuardMgr.h"
 #include "TransportMgr.h"
+#include "PlayerSaveScheduler.h"
+#include "PathfindingService.h"
 
 #include <chrono>
 #ifdef ENABLE_ELUNA
@@ -555,6 +561,7 @@ void World::LoadConfigSettings(bool reload)
     setConfig(CONFIG_BOOL_GRID_UNLOAD, "GridUnload", true);
     setConfig(CONFIG_BOOL_CLEANUP_TERRAIN, "CleanupTerrain", true);
     setConfigPos(CONFIG_UINT32_INTERVAL_SAVE, "PlayerSave.Interval", 15 * MINUTE * IN_MILLISECONDS);
+    setConfig(CONFIG_UINT32_PLAYER_SAVE_MAX_PER_TICK, "PlayerSave.MaxPerTick", 0);
     setConfigMinMax(CONFIG_UINT32_MIN_LEVEL_STAT_SAVE, "PlayerSave.Stats.MinLevel", 0, 0, MAX_LEVEL);
     setConfig(CONFIG_BOOL_STATS_SAVE_ONLY_ON_LOGOUT, "PlayerSave.Stats.SaveOnlyOnLogout", true);
 
@@ -719,6 +726,9 @@ void World::LoadConfigSettings(bool reload)
     setConfig(CONFIG_BOOL_QUEST_IGNORE_RAID, "Quests.IgnoreRaid", false);
 
     setConfig(CONFIG_BOOL_DETECT_POS_COLLISION, "DetectPosCollision", true);
+    setConfig(CONFIG_UINT32_MAP_QUERY_CACHE_SIZE, "Map.QueryCache.Size", 8192);
+    setConfigMinMax(CONFIG_FLOAT_MAP_QUERY_CACHE_GRID, "Map.QueryCache.Grid", 0.1f, 0.01f, 2.0f);
+    setConfig(CONFIG_UINT32_MAP_PATH_CACHE_SIZE, "Map.PathCache.Size", 1024);
 
     setConfig(CONFIG_BOOL_SILENTLY_GM_JOIN_TO_CHANNEL, "Channel.SilentlyGMJoin", false);
     setConfig(CONFIG_BOOL_STRICT_LATIN_IN_GENERAL_CHANNELS, "Channel.StrictLatinInGeneral", false);
@@ -910,6 +920,8 @@ void World::LoadConfigSettings(bool reload)
         sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Using DataDir %s", m_dataPath.c_str());
     }
 
+    SQLStorageSnapshot::SetDirectory(sConfig.GetStringDefault("SnapshotDir", ""));
+
     setConfig(CONFIG_BOOL_VMAP_INDOOR_CHECK, "vmap.enableIndoorCheck", true);
     bool enableLOS = sConfig.GetBoolDefault("vmap.enableLOS", false);
     bool enableHeight = sConfig.GetBoolDefault("vmap.enableHeight", false);
@@ -926,6 +938,7 @@ void World::LoadConfigSettings(bool reload)
     sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "WORLD: VMap data directory is: %svmaps", m_dataPath.c_str());
     setConfig(CONFIG_BOOL_MMAP_ENABLED, "mmap.enabled", true);
     sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "WORLD: mmap pathfinding %sabled", getConfig(CONFIG_BOOL_MMAP_ENABLED) ? "en" : "dis");
+    setConfigMinMax(CONFIG_UINT32_PATHFINDING_ASYNC_THREADS, "Pathfinding.AsyncThreads", 0, 0, 64);
     setConfig(CONFIG_BOOL_ELUNA_ENABLED, "Eluna.Enabled", true);
 #ifdef ENABLE_ELUNA
     if (reload)
@@ -952,6 +965,8 @@ void World::LoadConfigSettings(bool reload)
     setConfig(CONFIG_UINT32_MAPUPDATE_MIN_VISIBILITY_DISTANCE, "MapUpdate.MinVisibilityDistance", 0);
     setConfig(CONFIG_BOOL_CONTINENTS_INSTANCIATE, "Continents.Instanciate", false);
     setConfig(CONFIG_UINT32_CONTINENTS_MOTIONUPDATE_THREADS, "Continents.MotionUpdate.Threads", 0);
+    setConfigMinMax(CONFIG_UINT32_TASK_SCHEDULER_THREADS, "TaskScheduler.Threads", 0, 0, 256);
+    setConfig(CONFIG_BOOL_PARALLEL_LOADING, "World.ParallelLoading", true);
     setConfig(CONFIG_BOOL_TERRAIN_PRELOAD_CONTINENTS, "Terrain.Preload.Continents", 1);
     setConfig(CONFIG_BOOL_TERRAIN_PRELOAD_INSTANCES, "Terrain.Preload.Instances", 1);
 
@@ -994,6 +1009,12 @@ void World::LoadConfigSettings(bool reload)
     setConfig(CONFIG_UINT32_PERFLOG_SLOW_MAP_PACKETS, "PerformanceLog.SlowMapPackets", 60);
     setConfig(CONFIG_UINT32_PERFLOG_SLOW_SESSIONS_UPDATE, "PerformanceLog.SlowSessionsUpdate", 0);
     setConfig(CONFIG_UINT32_PERFLOG_SLOW_PACKET_BCAST, "PerformanceLog.SlowPacketBroadcast", 0);
+    setConfig(CONFIG_UINT32_DB_BACKPRESSURE_QUEUE_SIZE, "Database.BackpressureQueueSize", 5000);
+    setConfig(CONFIG_BOOL_TICK_PROFILER_ENABLED, "TickProfiler.Enable", true);
+    setConfig(CONFIG_UINT32_TICK_PROFILER_DUMP_INTERVAL, "TickProfiler.DumpInterval", 0);
+    sMapTickProfiler.SetEnabled(getConfig(CONFIG_BOOL_TICK_PROFILER_ENABLED));
+    sMapTickProfiler.SetDumpFile(sConfig.GetStringDefault("TickProfiler.DumpFile", "TickProfile.log"));
+    m_timers[WUPDATE_TICK_PROFILE].SetInterval(getConfig(CONFIG_UINT32_TICK_PROFILER_DUMP_INTERVAL) * IN_MILLISECONDS);
     setConfig(CONFIG_UINT32_LOG_MONEY_TRADES_TRESHOLD, "LogMoneyTreshold", 10000);
 
     setConfig(CONFIG_FLOAT_DYN_RESPAWN_CHECK_RANGE, "DynamicRespawn.Range", -1.0f);
@@ -1087,6 +1108,8 @@ void World::LoadConfigSettings(bool reload)
     setConfig(CONFIG_BOOL_AC_MOVEMENT_LOG_DATA, "Anticheat.LogData", false);
     setConfig(CONFIG_UINT32_AC_MOVEMENT_PACKET_LOG_SIZE, "Anticheat.PacketLogSize", 100);
     setConfig(CONFIG_INT32_AC_ANTICHEAT_MAX_ALLOWED_DESYNC, "Anticheat.MaxAllowedDesync", 0);
+    setConfig(CONFIG_BOOL_AC_MOVEMENT_ASYNC_CHECKS, "Anticheat.AsyncChecks", true);
+    setConfigMinMax(CONFIG_UINT32_AC_MOVEMENT_ASYNC_TASK_SIZE, "Anticheat.AsyncChecks.TaskSize", 32, 1, 4096);
     setConfig(CONFIG_BOOL_AC_MOVEMENT_CHEAT_REVERSE_TIME_ENABLED, "Anticheat.ReverseTime.Enable", true);
     setConfig(CONFIG_UINT32_AC_MOVEMENT_CHEAT_REVERSE_TIME_THRESHOLD, "Anticheat.ReverseTime.Threshold", 1);
     setConfig(CONFIG_UINT32_AC_MOVEMENT_CHEAT_REVERSE_TIME_PENALTY, "Anticheat.ReverseTime.Penalty", CHEAT_ACTION_LOG | CHEAT_ACTION_REPORT_GMS | CHEAT_ACTION_KICK);
@@ -1270,6 +1293,28 @@ char const* World::GetPatchName() const
     return "Invalid Patch!";
 }
 
+// Offline mode of mangosd: rebuild the snapshots of every SQLStorage table
+bool World::BuildStorageSnapshots()
+{
+    LoadConfigSettings();
+
+    if (!SQLStorageSnapshot::IsEnabled())
+    {
+        sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "SnapshotDir is not set in the configuration file, no snapshot to build.");
+        return false;
+    }
+
+    // Some templates store script ids
+    sScriptMgr.LoadScriptNames();
+
+    SQLStorageSnapshot::SetRebuild(true);
+    sObjectMgr.BuildStorageSnapshots();
+    SQLStorageSnapshot::SetRebuild(false);
+
+    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Snapshots written in %s", sConfig.GetStringDefault("SnapshotDir", "").c_str());
+    return true;
+}
+
 // Initialize the World
 void World::SetInitialWorldSettings()
 {
@@ -1282,6 +1327,12 @@ void World::SetInitialWorldSettings()
     // Initialize config settings
     LoadConfigSettings();
 
+    // Worker threads shared by all the map update phases
+    sTaskScheduler.Start(getConfig(CONFIG_UINT32_TASK_SCHEDULER_THREADS));
+
+    // Chase and follow paths computed out of the map updates
+    sPathfindingService.Start(getConfig(CONFIG_UINT32_PATHFINDING_ASYNC_THREADS));
+
     // Check the existence of the map files for all races start areas.
     if (!MapManager::ExistMapAndVMap(0, -6240.32f, 331.033f) ||
             !MapManager::ExistMapAndVMap(0, -8949.95f, -132.493f) ||
@@ -1411,90 +1462,52 @@ void World::SetInitialWorldSettings()
     Eluna::Initialize();
 #endif
 
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Broadcast Texts...");
-    sObjectMgr.LoadBroadcastTexts();
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Page Texts...");
-    sObjectMgr.LoadPageTexts();
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Game Object Templates...");     // must be after LoadPageTexts
-    std::set<uint32> transportDisplayIds = sObjectMgr.LoadGameobjectInfo();
-    MMAP::MMapFactory::createOrGetMMapManager()->loadAllGameObjectModels(transportDisplayIds);
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Transport templates...");
-    sTransportMgr.LoadTransportTemplates();
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Spell Chain Data...");
-    sSpellMgr.LoadSpellChains();
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Spell Elixir types...");
-    sSpellMgr.LoadSpellElixirs();
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Spell Learn Skills...");
-    sSpellMgr.LoadSpellLearnSkills();                       // must be after LoadSpellChains
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Spell Learn Spells...");
-    sSpellMgr.LoadSpellLearnSpells();
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Spell Proc Event conditions...");
-    sSpellMgr.LoadSpellProcEvents();
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Spell Proc Item Enchant...");
-    sSpellMgr.LoadSpellProcItemEnchant();                   // must be after LoadSpellChains
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Aggro Spells Definitions...");
-    sSpellMgr.LoadSpellThreats();
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Spell Enchant Charges...");
-    sSpellMgr.LoadSpellEnchantCharges();
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading NPC Texts...");
-    sObjectMgr.LoadNPCText();
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Item Random Enchantments Table...");
-    LoadRandomEnchantmentsTable();
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Items...");                     // must be after LoadRandomEnchantmentsTable and LoadPageTexts
-    sObjectMgr.LoadItemPrototypes();
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Item Texts...");
-    sObjectMgr.LoadItemTexts();
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Creature Display Info Addon...");
-    sObjectMgr.LoadCreatureDisplayInfoAddon();
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Equipment templates...");
-    sObjectMgr.LoadEquipmentTemplates();
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Creature spells...");
-    sObjectMgr.LoadCreatureSpells();
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Creature class level stats...");
-    sObjectMgr.LoadCreatureClassLevelStats();
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Creature templates...");
-    sObjectMgr.LoadCreatureTemplates();
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading SpellsScriptTarget...");
-    sSpellMgr.LoadSpellScriptTarget();                      // must be after LoadCreatureTemplates and LoadGameobjectInfo
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading ItemRequiredTarget...");
-    sObjectMgr.LoadItemRequiredTarget();
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Reputation Reward Rates...");
-    sObjectMgr.LoadReputationRewardRate();
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Creature Reputation OnKill Data...");
-    sObjectMgr.LoadReputationOnKill();
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Reputation Spillover Data...");
-    sObjectMgr.LoadReputationSpilloverTemplate();
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Points Of Interest Data...");
-    sObjectMgr.LoadPointsOfInterest();
-
-    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Pet Create Spells...");
-    sObjectMgr.LoadPetCreateSpells();
+    // Template tables only depend on each other through the edges below, they are loaded
+    // concurrently on the WorldDatabase sync connections when World.ParallelLoading is set.
+    StartupLoader templateLoader("world templates");
+
+    StartupLoader::LoaderId broadcastTexts = templateLoader.Add("Broadcast Texts", []() { sObjectMgr.LoadBroadcastTexts(); });
+    StartupLoader::LoaderId pageTexts = templateLoader.Add("Page Texts", []() { sObjectMgr.LoadPageTexts(); });
+    StartupLoader::LoaderId gameObjectInfo = templateLoader.Add("Game Object Templates", []()
+    {
+        std::set<uint32> transportDisplayIds = sObjectMgr.LoadGameobjectInfo();
+        MMAP::MMapFactory::createOrGetMMapManager()->loadAllGameObjectModels(transportDisplayIds);
+    }, { pageTexts });
+    templateLoader.Add("Transport templates", []() { sTransportMgr.LoadTransportTemplates(); }, { gameObjectInfo });
+
+    StartupLoader::LoaderId spellChains = templateLoader.Add("Spell Chain Data", []() { sSpellMgr.LoadSpellChains(); });
+    templateLoader.Add("Spell Elixir types", []() { sSpellMgr.LoadSpellElixirs(); });
+    templateLoader.Add("Spell Learn Skills", []() { sSpellMgr.LoadSpellLearnSkills(); }, { spellChains });
+    templateLoader.Add("Spell Learn Spells", []() { sSpellMgr.LoadSpellLearnSpells(); });
+    templateLoader.Add("Spell Proc Event conditions", []() { sSpellMgr.LoadSpellProcEvents(); }, { spellChains });  // rank helper needs the chains
+    templateLoader.Add("Spell Proc Item Enchant", []() { sSpellMgr.LoadSpellProcItemEnchant(); }, { spellChains });
+    templateLoader.Add("Aggro Spells Definitions", []() { sSpellMgr.LoadSpellThreats(); });
+    templateLoader.Add("Spell Enchant Charges", []() { sSpellMgr.LoadSpellEnchantCharges(); });
+
+    templateLoader.Add("NPC Texts", []() { sObjectMgr.LoadNPCText(); }, { broadcastTexts });
+
+    StartupLoader::LoaderId randomEnchantments = templateLoader.Add("Item Random Enchantments Table", []() { LoadRandomEnchantmentsTable(); });
+    StartupLoader::LoaderId items = templateLoader.Add("Items", []() { sObjectMgr.LoadItemPrototypes(); }, { randomEnchantments, pageTexts });
+    templateLoader.Add("Item Texts", []() { sObjectMgr.LoadItemTexts(); });
+
+    StartupLoader::LoaderId displayInfoAddon = templateLoader.Add("Creature Display Info Addon", []() { sObjectMgr.LoadCreatureDisplayInfoAddon(); });
+    StartupLoader::LoaderId equipment = templateLoader.Add("Equipment templates", []() { sObjectMgr.LoadEquipmentTemplates(); }, { items });
+    StartupLoader::LoaderId creatureSpells = templateLoader.Add("Creature spells", []() { sObjectMgr.LoadCreatureSpells(); });
+    StartupLoader::LoaderId classLevelStats = templateLoader.Add("Creature class level stats", []() { sObjectMgr.LoadCreatureClassLevelStats(); });
+    StartupLoader::LoaderId creatureTemplates = templateLoader.Add("Creature templates", []() { sObjectMgr.LoadCreatureTemplates(); },
+        { displayInfoAddon, equipment, creatureSpells, classLevelStats });
+
+    StartupLoader::LoaderId spellScriptTargets = templateLoader.Add("SpellsScriptTarget", []() { sSpellMgr.LoadSpellScriptTarget(); }, { creatureTemplates, gameObjectInfo });
+    templateLoader.Add("ItemRequiredTarget", []() { sObjectMgr.LoadItemRequiredTarget(); }, { items, creatureTemplates, spellScriptTargets });
+
+    templateLoader.Add("Reputation Reward Rates", []() { sObjectMgr.LoadReputationRewardRate(); });
+    templateLoader.Add("Creature Reputation OnKill Data", []() { sObjectMgr.LoadReputationOnKill(); }, { creatureTemplates });
+    templateLoader.Add("Reputation Spillover Data", []() { sObjectMgr.LoadReputationSpilloverTemplate(); });
+    templateLoader.Add("Points Of Interest Data", []() { sObjectMgr.LoadPointsOfInterest(); });
+    templateLoader.Add("Pet Create Spells", []() { sObjectMgr.LoadPetCreateSpells(); }, { creatureTemplates });
+
+    templateLoader.Run(getConfig(CONFIG_BOOL_PARALLEL_LOADING));
+    templateLoader.LogReport();
 
     sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loading Creature Data...");
     sObjectMgr.LoadCreatures();
@@ -1765,6 +1778,9 @@ void World::SetInitialWorldSettings()
     // Update groups with offline leader after delay in seconds
     m_timers[WUPDATE_GROUPS].SetInterval(IN_MILLISECONDS);
 
+    // Periodic dump of the map tick profile
+    m_timers[WUPDATE_TICK_PROFILE].SetInterval(getConfig(CONFIG_UINT32_TICK_PROFILER_DUMP_INTERVAL) * IN_MILLISECONDS);
+
     // Initialize static helper structures
     AIRegistry::Initialize();
 
@@ -2040,6 +2056,9 @@ void World::Update(uint32 diff)
     if (getConfig(CONFIG_UINT32_PERFLOG_SLOW_ASYNC_QUERIES) && asyncQueriesTime > getConfig(CONFIG_UINT32_PERFLOG_SLOW_ASYNC_QUERIES))
         sLog.Out(LOG_PERFORMANCE, LOG_LVL_MINIMAL, "Update async queries: %ums", asyncQueriesTime);
 
+    UpdateDatabaseBackpressure();
+    sPlayerSaveScheduler.Update(diff);
+
     // Erase old corpses
     if (m_timers[WUPDATE_CORPSES].Passed())
     {
@@ -2048,6 +2067,14 @@ void World::Update(uint32 diff)
         sObjectAccessor.RemoveOldCorpses();
     }
 
+    // Dump the map tick profile
+    if (m_timers[WUPDATE_TICK_PROFILE].Passed())
+    {
+        m_timers[WUPDATE_TICK_PROFILE].Reset();
+        if (getConfig(CONFIG_UINT32_TICK_PROFILER_DUMP_INTERVAL) && getConfig(CONFIG_BOOL_TICK_PROFILER_ENABLED))
+            sMapTickProfiler.DumpToFile();
+    }
+
     // Process Game events when necessary
     if (m_timers[WUPDATE_EVENTS].Passed())
     {
@@ -2688,6 +2715,27 @@ void World::SendServerMessage(ServerMessageType type, char const* text, Player*
         SendGlobalMessage(&data);
 }
 
+void World::UpdateDatabaseBackpressure()
+{
+    uint32 const limit = getConfig(CONFIG_UINT32_DB_BACKPRESSURE_QUEUE_SIZE);
+    int64 const queued = CharacterDatabase.GetAsyncQueueSize();
+
+    // Release the pressure only once half of the backlog is written, to avoid flapping
+    bool backpressure = m_characterDbBackpressure;
+    if (!limit)
+        backpressure = false;
+    else if (queued > limit)
+        backpressure = true;
+    else if (queued < limit / 2)
+        backpressure = false;
+
+    if (backpressure != m_characterDbBackpressure)
+        sLog.Out(LOG_PERFORMANCE, LOG_LVL_MINIMAL, "Character database: %s backpressure, " SI64FMTD " pending asynchronous operations",
+            backpressure ? "entering" : "leaving", queued);
+
+    m_characterDbBackpressure = backpressure;
+}
+
 void World::UpdateSessions(uint32 diff)
 {
     // Update player limit if needed
@@ -2695,7 +2743,8 @@ void World::UpdateSessions(uint32 diff)
     if (hardPlayerLimit)
         m_playerLimit = std::min(hardPlayerLimit, m_playerLimit);
     uint32 loggedInSessions = uint32(m_sessions.size() - m_QueuedSessions.size());
-    if (m_playerLimit >= 0 && static_cast <int32> (loggedInSessions) < hardPlayerLimit)
+    // Queued players loading their characters would make a flooded character database worse
+    if (m_playerLimit >= 0 && static_cast <int32> (loggedInSessions) < hardPlayerLimit && !m_characterDbBackpressure)
         if (uint32 acceptNow = getConfig(CONFIG_UINT32_LOGIN_PER_TICK))
         {
             m_playerLimit = std::min(m_playerLimit + acceptNow, loggedInSessions + acceptNow);
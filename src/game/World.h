@@ -86,7 +86,8 @@ enum WorldTimers
     WUPDATE_EVENTS      = 3,
     WUPDATE_SAVE_VAR    = 4,
     WUPDATE_GROUPS      = 5,
-    WUPDATE_COUNT       = 6
+    WUPDATE_TICK_PROFILE = 6,
+    WUPDATE_COUNT       = 7
 };
 
 // Configuration elements
@@ -152,6 +153,8 @@ enum eConfigUInt32Values
     CONFIG_UINT32_PBCAST_DIFF_LOWER_VISIBILITY_DISTANCE,
     CONFIG_UINT32_MAPUPDATE_MIN_GRID_ACTIVATION_DISTANCE,
     CONFIG_UINT32_CONTINENTS_MOTIONUPDATE_THREADS,
+    CONFIG_UINT32_TASK_SCHEDULER_THREADS,
+    CONFIG_UINT32_PATHFINDING_ASYNC_THREADS,
     CONFIG_UINT32_PERFLOG_SLOW_WORLD_UPDATE,
     CONFIG_UINT32_PERFLOG_SLOW_MAP_UPDATE,
     CONFIG_UINT32_PERFLOG_SLOW_MAPSYSTEM_UPDATE,
@@ -161,6 +164,8 @@ enum eConfigUInt32Values
     CONFIG_UINT32_PERFLOG_SLOW_PACKET,
     CONFIG_UINT32_PERFLOG_SLOW_MAP_PACKETS,
     CONFIG_UINT32_PERFLOG_SLOW_PACKET_BCAST,
+    CONFIG_UINT32_TICK_PROFILER_DUMP_INTERVAL,
+    CONFIG_UINT32_DB_BACKPRESSURE_QUEUE_SIZE,
     CONFIG_UINT32_ASYNC_QUERIES_TICK_TIMEOUT,
     CONFIG_UINT32_LOGIN_PER_TICK,
     CONFIG_UINT32_ANTICRASH_REARM_TIMER,
@@ -175,6 +180,9 @@ enum eConfigUInt32Values
     CONFIG_UINT32_MAP_VISIBILITYUPDATE_THREADS,
     CONFIG_UINT32_MAP_VISIBILITYUPDATE_TIMEOUT,
     CONFIG_UINT32_INTERVAL_SAVE,
+    CONFIG_UINT32_PLAYER_SAVE_MAX_PER_TICK,
+    CONFIG_UINT32_MAP_QUERY_CACHE_SIZE,
+    CONFIG_UINT32_MAP_PATH_CACHE_SIZE,
     CONFIG_UINT32_INTERVAL_GRIDCLEAN,
     CONFIG_UINT32_INTERVAL_MAPUPDATE,
     CONFIG_UINT32_INTERVAL_CHANGEWEATHER,
@@ -268,6 +276,7 @@ enum eConfigUInt32Values
     CONFIG_UINT32_ACCOUNT_CONCURRENT_AUCTION_LIMIT,
     CONFIG_UINT32_BANLIST_RELOAD_TIMER,
     CONFIG_UINT32_AC_MOVEMENT_PACKET_LOG_SIZE,
+    CONFIG_UINT32_AC_MOVEMENT_ASYNC_TASK_SIZE,
     CONFIG_UINT32_AC_MOVEMENT_BAN_DURATION,
     CONFIG_UINT32_AC_MOVEMENT_CHEAT_REVERSE_TIME_THRESHOLD,
     CONFIG_UINT32_AC_MOVEMENT_CHEAT_REVERSE_TIME_PENALTY,
@@ -433,6 +442,7 @@ enum eConfigFloatValues
     CONFIG_FLOAT_RATE_CORPSE_DECAY_LOOTED,
     CONFIG_FLOAT_RATE_INSTANCE_RESET_TIME,
     CONFIG_FLOAT_RATE_TARGET_POS_RECALCULATION_RANGE,
+    CONFIG_FLOAT_MAP_QUERY_CACHE_GRID,
     CONFIG_FLOAT_RATE_DURABILITY_LOSS_DAMAGE,
     CONFIG_FLOAT_LISTEN_RANGE_SAY,
     CONFIG_FLOAT_LISTEN_RANGE_YELL,
@@ -551,6 +561,7 @@ enum eConfigBoolValues
     CONFIG_BOOL_AC_MOVEMENT_PLAYERS_ONLY,
     CONFIG_BOOL_AC_MOVEMENT_NOTIFY_CHEATERS,
     CONFIG_BOOL_AC_MOVEMENT_LOG_DATA,
+    CONFIG_BOOL_AC_MOVEMENT_ASYNC_CHECKS,
     CONFIG_BOOL_AC_MOVEMENT_CHEAT_REVERSE_TIME_ENABLED,
     CONFIG_BOOL_AC_MOVEMENT_CHEAT_NULL_TIME_ENABLED,
     CONFIG_BOOL_AC_MOVEMENT_CHEAT_SKIPPED_HEARTBEATS_ENABLED,
@@ -606,6 +617,8 @@ enum eConfigBoolValues
     CONFIG_BOOL_GM_CHEAT_GOD,
     CONFIG_BOOL_LFG_MATCHMAKING,
     CONFIG_BOOL_LIMIT_PLAY_TIME,
+    CONFIG_BOOL_TICK_PROFILER_ENABLED,
+    CONFIG_BOOL_PARALLEL_LOADING,
     CONFIG_BOOL_VALUE_COUNT
 };
 
@@ -802,6 +815,7 @@ class World
 
         void SetInitialWorldSettings();
         void LoadConfigSettings(bool reload = false);
+        bool BuildStorageSnapshots();
 
         void SendWorldText(int32 string_id, ...);
         void SendBroadcastTextToWorld(uint32 textId);
@@ -829,6 +843,9 @@ class World
 
         void UpdateSessions(uint32 diff);
 
+        // The character database can't keep up with the writes: delay what can wait (autosaves, queued logins)
+        bool IsCharacterDatabaseBackpressured() const { return m_characterDbBackpressure; }
+
         // Get a server configuration element (see #eConfigFloatValues)
         void setConfig(eConfigFloatValues index,float value) { m_configFloatValues[index]=value; }
         // Get a server configuration element (see #eConfigFloatValues)
@@ -974,6 +991,9 @@ class World
 
         uint32 m_MaintenanceTimeChecker = 0;
 
+        void UpdateDatabaseBackpressure();
+        bool m_characterDbBackpressure = false;
+
         time_t m_startTime;
         time_t m_gameTime;
         uint32 m_gameDay;
@@ -29,6 +29,12 @@
 #include <vector>
 #include <algorithm>
 
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
 #define MAX_STACK_SIZE 64
 
 using G3D::Vector3;
@@ -62,6 +68,61 @@ struct AABound
     Vector3 lo, hi;
 };
 
+/**
+ * Lane operations of the ray packets traced by BIH::intersectRaysAny: 8 rays with
+ * AVX, 4 with SSE2, 4 in plain loops otherwise. The comparisons are negated
+ * (not less, not greater) to handle NaN like the scalar traversal.
+ */
+namespace BIHPacket
+{
+#if defined(__AVX__)
+    uint32 const SIZE = 8;
+    typedef __m256 Float;
+
+    inline Float Load(float const* p) { return _mm256_load_ps(p); }
+    inline void Store(float* p, Float v) { _mm256_store_ps(p, v); }
+    inline Float Set(float f) { return _mm256_set1_ps(f); }
+    inline Float Sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+    inline Float Mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+    inline Float Min(Float a, Float b) { return _mm256_min_ps(a, b); }
+    inline Float Max(Float a, Float b) { return _mm256_max_ps(a, b); }
+    inline uint32 NotLess(Float a, Float b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_NLT_UQ)); }
+    inline uint32 NotGreater(Float a, Float b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_NGT_UQ)); }
+#elif defined(__SSE2__) || defined(_M_X64)
+    uint32 const SIZE = 4;
+    typedef __m128 Float;
+
+    inline Float Load(float const* p) { return _mm_load_ps(p); }
+    inline void Store(float* p, Float v) { _mm_store_ps(p, v); }
+    inline Float Set(float f) { return _mm_set1_ps(f); }
+    inline Float Sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+    inline Float Mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+    inline Float Min(Float a, Float b) { return _mm_min_ps(a, b); }
+    inline Float Max(Float a, Float b) { return _mm_max_ps(a, b); }
+    inline uint32 NotLess(Float a, Float b) { return _mm_movemask_ps(_mm_cmpnlt_ps(a, b)); }
+    inline uint32 NotGreater(Float a, Float b) { return _mm_movemask_ps(_mm_cmpngt_ps(a, b)); }
+#else
+    uint32 const SIZE = 4;
+    struct Float { float v[SIZE]; };
+
+    inline Float Load(float const* p) { Float r; for (uint32 i = 0; i < SIZE; ++i) r.v[i] = p[i]; return r; }
+    inline void Store(float* p, Float v) { for (uint32 i = 0; i < SIZE; ++i) p[i] = v.v[i]; }
+    inline Float Set(float f) { Float r; for (uint32 i = 0; i < SIZE; ++i) r.v[i] = f; return r; }
+    inline Float Sub(Float a, Float b) { for (uint32 i = 0; i < SIZE; ++i) a.v[i] -= b.v[i]; return a; }
+    inline Float Mul(Float a, Float b) { for (uint32 i = 0; i < SIZE; ++i) a.v[i] *= b.v[i]; return a; }
+    inline Float Min(Float a, Float b) { for (uint32 i = 0; i < SIZE; ++i) a.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return a; }
+    inline Float Max(Float a, Float b) { for (uint32 i = 0; i < SIZE; ++i) a.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; return a; }
+    inline uint32 NotLess(Float a, Float b) { uint32 m = 0; for (uint32 i = 0; i < SIZE; ++i) m |= uint32(!(a.v[i] < b.v[i])) << i; return m; }
+    inline uint32 NotGreater(Float a, Float b) { uint32 m = 0; for (uint32 i = 0; i < SIZE; ++i) m |= uint32(!(a.v[i] > b.v[i])) << i; return m; }
+#endif
+
+    // Index of the octant of a direction, rays of a packet share it
+    inline uint32 Octant(Vector3 const& dir)
+    {
+        return (floatToRawIntBits(dir.x) >> 31) | (floatToRawIntBits(dir.y) >> 31) << 1 | (floatToRawIntBits(dir.z) >> 31) << 2;
+    }
+}
+
 /** Bounding Interval Hierarchy Class.
     Building and Ray-Intersection functions based on BIH from
     Sunflow, a Java Raytracer, released under MIT/X11 License
@@ -122,34 +183,12 @@ class BIH
         template<typename RayCallback>
         void intersectRay(Ray const& r, RayCallback& intersectCallback, float& maxDist, bool stopAtFirst = false, bool ignoreM2Model = false) const
         {
-            float intervalMin = -1.f;
-            float intervalMax = -1.f;
+            float intervalMin, intervalMax;
+            if (!clipRay(r, maxDist, intervalMin, intervalMax))
+                return;
             Vector3 const& org = r.origin();
             Vector3 const& dir = r.direction();
             Vector3 const& invDir = r.invDirection();
-            for (int i = 0; i < 3; ++i)
-            {
-                if (G3D::fuzzyNe(dir[i], 0.0f))
-                {
-                    float t1 = (bounds.low()[i]  - org[i]) * invDir[i];
-                    float t2 = (bounds.high()[i] - org[i]) * invDir[i];
-                    if (t1 > t2)
-                        std::swap(t1, t2);
-                    if (t1 > intervalMin)
-                        intervalMin = t1;
-                    if (t2 < intervalMax || intervalMax < 0.f)
-                        intervalMax = t2;
-                    // intervalMax can only become smaller for other axis,
-                    //  and intervalMin only larger respectively, so stop early
-                    if (intervalMax <= 0 || intervalMin >= maxDist)
-                        return;
-                }
-            }
-
-            if (intervalMin > intervalMax)
-                return;
-            intervalMin = std::max(intervalMin, 0.f);
-            intervalMax = std::min(intervalMax, maxDist);
 
             uint32 offsetFront[3];
             uint32 offsetBack[3];
@@ -262,6 +301,45 @@ class BIH
             }
         }
 
+        /**
+         * Tests many rays for a hit closer than their maxDist, like intersectRay with stopAtFirst.
+         * hits[i] is set when rays[i] hits an object. Rays with the same direction signs are
+         * traced together BIHPacket::SIZE at a time: the node tests of a packet are done with
+         * SIMD, the callback is still called per ray and object. Rays from one origin to many
+         * targets (area spells) are coherent enough to share most of the traversal.
+         */
+        template<typename RayCallback>
+        void intersectRaysAny(Ray const* rays, float const* maxDist, uint32 count, bool* hits, RayCallback& intersectCallback, bool ignoreM2Model = false) const
+        {
+            std::vector<uint8> octants(count);
+            for (uint32 i = 0; i < count; ++i)
+            {
+                hits[i] = false;
+                octants[i] = BIHPacket::Octant(rays[i].direction());
+            }
+
+            RayPacket packet;
+            for (uint32 octant = 0; octant < 8; ++octant)
+            {
+                packet.count = 0;
+                for (uint32 i = 0; i < count; ++i)
+                {
+                    if (octants[i] != octant)
+                        continue;
+
+                    packet.index[packet.count++] = i;
+                    if (packet.count == BIHPacket::SIZE)
+                    {
+                        intersectPacket(packet, rays, maxDist, hits, intersectCallback, ignoreM2Model);
+                        packet.count = 0;
+                    }
+                }
+
+                if (packet.count)
+                    intersectPacket(packet, rays, maxDist, hits, intersectCallback, ignoreM2Model);
+            }
+        }
+
         template<typename IsectCallback>
         void intersectPoint(Vector3 const& p, IsectCallback& intersectCallback) const
         {
@@ -352,6 +430,213 @@ class BIH
         std::vector<uint32> objects;
         AABox bounds;
 
+        struct RayPacket
+        {
+            uint32 count;
+            uint32 index[BIHPacket::SIZE];                  // In the rays of intersectRaysAny
+        };
+
+        struct alignas(32) PacketStackNode
+        {
+            float tnear[BIHPacket::SIZE];
+            float tfar[BIHPacket::SIZE];
+            uint32 node;
+            uint32 mask;                                    // Rays entering the node
+        };
+
+        // Clips the ray to the tree bounds, returns false when the ray misses them
+        bool clipRay(Ray const& r, float maxDist, float& intervalMin, float& intervalMax) const
+        {
+            intervalMin = -1.f;
+            intervalMax = -1.f;
+            Vector3 const& org = r.origin();
+            Vector3 const& dir = r.direction();
+            Vector3 const& invDir = r.invDirection();
+            for (int i = 0; i < 3; ++i)
+            {
+                if (G3D::fuzzyNe(dir[i], 0.0f))
+                {
+                    float t1 = (bounds.low()[i]  - org[i]) * invDir[i];
+                    float t2 = (bounds.high()[i] - org[i]) * invDir[i];
+                    if (t1 > t2)
+                        std::swap(t1, t2);
+                    if (t1 > intervalMin)
+                        intervalMin = t1;
+                    if (t2 < intervalMax || intervalMax < 0.f)
+                        intervalMax = t2;
+                    // intervalMax can only become smaller for other axis,
+                    //  and intervalMin only larger respectively, so stop early
+                    if (intervalMax <= 0 || intervalMin >= maxDist)
+                        return false;
+                }
+            }
+
+            if (intervalMin > intervalMax)
+                return false;
+            intervalMin = std::max(intervalMin, 0.f);
+            intervalMax = std::min(intervalMax, maxDist);
+            return true;
+        }
+
+        // Same traversal as intersectRay, with one interval per ray and a mask of the rays in the current node
+        template<typename RayCallback>
+        void intersectPacket(RayPacket const& packet, Ray const* rays, float const* maxDist, bool* hits, RayCallback& intersectCallback, bool ignoreM2Model) const
+        {
+            using namespace BIHPacket;
+
+            alignas(32) float org[3][SIZE];
+            alignas(32) float invDir[3][SIZE];
+            alignas(32) float dist[SIZE];
+            alignas(32) float tmin[SIZE];
+            alignas(32) float tmax[SIZE];
+
+            uint32 active = 0;
+            for (uint32 i = 0; i < SIZE; ++i)
+            {
+                // Unused lanes stay out of the masks
+                Ray const& r = rays[packet.index[i < packet.count ? i : 0]];
+                dist[i] = maxDist[packet.index[i < packet.count ? i : 0]];
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    org[axis][i] = r.origin()[axis];
+                    invDir[axis][i] = r.invDirection()[axis];
+                }
+
+                tmin[i] = tmax[i] = 0.f;
+                if (i < packet.count && clipRay(r, dist[i], tmin[i], tmax[i]))
+                    active |= 1 << i;
+            }
+
+            if (!active)
+                return;
+
+            // Direction signs are the same for all the rays of the packet
+            Vector3 const& dir = rays[packet.index[0]].direction();
+            uint32 offsetFront[3];
+            uint32 offsetBack[3];
+            uint32 offsetFront3[3];
+            uint32 offsetBack3[3];
+            for (int i = 0; i < 3; ++i)
+            {
+                offsetFront[i] = floatToRawIntBits(dir[i]) >> 31;
+                offsetBack[i] = offsetFront[i] ^ 1;
+                offsetFront3[i] = offsetFront[i] * 3;
+                offsetBack3[i] = offsetBack[i] * 3;
+                ++offsetFront[i];
+                ++offsetBack[i];
+            }
+
+            Float const orgV[3] = { Load(org[0]), Load(org[1]), Load(org[2]) };
+            Float const invDirV[3] = { Load(invDir[0]), Load(invDir[1]), Load(invDir[2]) };
+            Float intervalMin = Load(tmin);
+            Float intervalMax = Load(tmax);
+            uint32 done = 0;
+
+            PacketStackNode stack[MAX_STACK_SIZE];
+            int stackPos = 0;
+            int node = 0;
+
+            while (true)
+            {
+                while (true)
+                {
+                    uint32 tn = tree[node];
+                    uint32 axis = (tn & (3 << 30)) >> 30;
+                    bool const BVH2 = (tn & (1 << 29)) != 0;
+                    int offset = tn & ~(7 << 29);
+                    if (!BVH2)
+                    {
+                        if (axis < 3)
+                        {
+                            Float tf = Mul(Sub(Set(intBitsToFloat(tree[node + offsetFront[axis]])), orgV[axis]), invDirV[axis]);
+                            Float tb = Mul(Sub(Set(intBitsToFloat(tree[node + offsetBack[axis]])), orgV[axis]), invDirV[axis]);
+                            uint32 const front = active & NotLess(tf, intervalMin);
+                            uint32 const back = active & NotGreater(tb, intervalMax);
+                            // all rays pass between clip zones
+                            if (!front && !back)
+                                break;
+                            int const backNode = offset + offsetBack3[axis];
+                            // rays pass through far node only
+                            if (!front)
+                            {
+                                node = backNode;
+                                active = back;
+                                intervalMin = Max(tb, intervalMin);
+                                continue;
+                            }
+                            node = offset + offsetFront3[axis];
+                            // some rays pass through the far node too
+                            if (back)
+                            {
+                                if (stackPos == MAX_STACK_SIZE)
+                                    return;
+                                Store(stack[stackPos].tnear, Max(tb, intervalMin));
+                                Store(stack[stackPos].tfar, intervalMax);
+                                stack[stackPos].node = backNode;
+                                stack[stackPos].mask = back;
+                                ++stackPos;
+                            }
+                            active = front;
+                            intervalMax = Min(tf, intervalMax);
+                            continue;
+                        }
+                        else
+                        {
+                            // leaf - test the objects for each ray still in the node
+                            int n = tree[node + 1];
+                            for (uint32 i = 0; i < SIZE; ++i)
+                            {
+                                if (!(active & (1 << i)))
+                                    continue;
+                                Ray const& r = rays[packet.index[i]];
+                                for (int k = 0; k < n; ++k)
+                                {
+                                    if (intersectCallback(r, objects[offset + k], dist[i], true, ignoreM2Model))
+                                    {
+                                        hits[packet.index[i]] = true;
+                                        done |= 1 << i;
+                                        break;
+                                    }
+                                }
+                            }
+                            break;
+                        }
+                    }
+                    else
+                    {
+                        if (axis > 2)
+                            return; // should not happen
+                        Float tf = Mul(Sub(Set(intBitsToFloat(tree[node + offsetFront[axis]])), orgV[axis]), invDirV[axis]);
+                        Float tb = Mul(Sub(Set(intBitsToFloat(tree[node + offsetBack[axis]])), orgV[axis]), invDirV[axis]);
+                        node = offset;
+                        intervalMin = Max(tf, intervalMin);
+                        intervalMax = Min(tb, intervalMax);
+                        active &= NotGreater(intervalMin, intervalMax);
+                        if (!active)
+                            break;
+                        continue;
+                    }
+                } // traversal loop
+                do
+                {
+                    // stack is empty?
+                    if (stackPos == 0)
+                        return;
+                    // move back up the stack, without the rays that hit or are already out of range
+                    --stackPos;
+                    Float tnear = Load(stack[stackPos].tnear);
+                    active = stack[stackPos].mask & ~done & NotLess(Load(dist), tnear);
+                    if (!active)
+                        continue;
+                    node = stack[stackPos].node;
+                    intervalMin = tnear;
+                    intervalMax = Load(stack[stackPos].tfar);
+                    break;
+                }
+                while (true);
+            }
+        }
+
         struct buildData
         {
             uint32* indices;
@@ -60,6 +60,7 @@ class GameObjectModel
         /** Enables\disables collision. */
         void disable() { collision_enabled = false;}
         void enable(bool enabled) { collision_enabled = enabled;}
+        bool isEnabled() const { return collision_enabled; }
 
         bool intersectRay(G3D::Ray const& ray, float& MaxDist, bool StopAtFirstHit, bool ignoreM2Model) const;
 
@@ -26,6 +26,7 @@
 #include <sstream>
 #include <iomanip>
 #include <limits>
+#include <memory>
 
 using G3D::Vector3;
 
@@ -217,6 +218,39 @@ namespace VMAP
         G3D::Ray ray = G3D::Ray::fromOriginAndDirection(pos1, (pos2 - pos1) / maxDist);
         return !getIntersectionTime(ray, maxDist, true, ignoreM2Model);
     }
+
+    void StaticMapTree::isInLineOfSight(Vector3 const* positions, uint32 count, bool* results, bool ignoreM2Model) const
+    {
+        std::vector<G3D::Ray> rays;
+        std::vector<float> maxDist;
+        std::vector<uint32> indexes;
+        rays.reserve(count);
+        maxDist.reserve(count);
+        indexes.reserve(count);
+        for (uint32 i = 0; i < count; ++i)
+        {
+            Vector3 const& pos1 = positions[i * 2];
+            Vector3 const& pos2 = positions[i * 2 + 1];
+            results[i] = true;
+            float dist = (pos2 - pos1).magnitude();
+            MANGOS_ASSERT(dist < std::numeric_limits<float>::max());
+            // same spot, or NaN values which can cause BIH intersection to enter infinite loop
+            if (dist < 1e-10f)
+                continue;
+            rays.push_back(G3D::Ray::fromOriginAndDirection(pos1, (pos2 - pos1) / dist));
+            maxDist.push_back(dist);
+            indexes.push_back(i);
+        }
+
+        if (rays.empty())
+            return;
+
+        std::unique_ptr<bool[]> hits(new bool[rays.size()]);
+        MapRayCallback intersectionCallBack(iTreeValues);
+        iTree.intersectRaysAny(rays.data(), maxDist.data(), rays.size(), hits.get(), intersectionCallBack, ignoreM2Model);
+        for (uint32 i = 0; i < indexes.size(); ++i)
+            results[indexes[i]] = !hits[i];
+    }
     //=========================================================
     /**
     When moving from pos1 to pos2 check if we hit an object. Return true and the position if we hit one
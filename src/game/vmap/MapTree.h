@@ -76,6 +76,8 @@ namespace VMAP
             ~StaticMapTree();
 
             bool isInLineOfSight(G3D::Vector3 const& pos1, G3D::Vector3 const& pos2, bool ignoreM2Model) const;
+            // Segments are pairs of positions (start, end), traced as ray packets
+            void isInLineOfSight(G3D::Vector3 const* positions, uint32 count, bool* results, bool ignoreM2Model) const;
             ModelInstance* FindCollisionModel(G3D::Vector3 const& pos1, G3D::Vector3 const& pos2);
             bool getObjectHitPos(G3D::Vector3 const& pos1, G3D::Vector3 const& pos2, G3D::Vector3& pResultHitPos, float pModifyDist) const;
             float getHeight(G3D::Vector3 const& pPos, float maxSearchDist) const;
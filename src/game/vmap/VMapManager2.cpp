@@ -151,6 +151,30 @@ namespace VMAP
         }
         return result;
     }
+
+    void VMapManager2::isInLineOfSight(unsigned int pMapId, LineOfSightQuery* queries, uint32 count, bool ignoreM2Model)
+    {
+        InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(pMapId);
+        if (!isLineOfSightCalcEnabled() || instanceTree == iInstanceMapTrees.end())
+        {
+            for (uint32 i = 0; i < count; ++i)
+                queries[i].result = true;
+            return;
+        }
+
+        std::vector<Vector3> positions(count * 2);
+        for (uint32 i = 0; i < count; ++i)
+        {
+            positions[i * 2] = convertPositionToInternalRep(queries[i].x1, queries[i].y1, queries[i].z1);
+            positions[i * 2 + 1] = convertPositionToInternalRep(queries[i].x2, queries[i].y2, queries[i].z2);
+        }
+
+        std::unique_ptr<bool[]> results(new bool[count]);
+        instanceTree->second->isInLineOfSight(positions.data(), count, results.get(), ignoreM2Model);
+        for (uint32 i = 0; i < count; ++i)
+            queries[i].result = results[i];
+    }
+
     ModelInstance* VMapManager2::FindCollisionModel(unsigned int mapId, float x0, float y0, float z0, float x1, float y1, float z1)
     {
         if (!isLineOfSightCalcEnabled()) return nullptr;
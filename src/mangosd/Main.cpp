@@ -65,6 +65,7 @@ void usage(const char *prog)
     sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Usage: \n %s [<options>]\n"
         "    -v, --version            print version and exist\n\r"
         "    -c config_file           use config_file as configuration file\n\r"
+        "    -b, --build-snapshots    build the world template snapshots (SnapshotDir) and exit\n\r"
         #ifdef WIN32
         "    Running as service functions:\n\r"
         "    -s run                   run as service\n\r"
@@ -87,12 +88,14 @@ extern int main(int argc, char **argv)
     char const* cfg_file = _MANGOSD_CONFIG;
 
 
-    char const *options = ":c:s:";
+    char const *options = ":c:s:b";
 
     ACE_Get_Opt cmd_opts(argc, argv, options);
     cmd_opts.long_option("version", 'v');
+    cmd_opts.long_option("build-snapshots", 'b');
 
     char serviceDaemonMode = '\0';
+    bool buildSnapshots = false;
 
     int option;
     while ((option = cmd_opts()) != EOF)
@@ -105,6 +108,9 @@ extern int main(int argc, char **argv)
             case 'v':
                 printf("Core revision: %s\n", _FULLVERSION);
                 return 0;
+            case 'b':
+                buildSnapshots = true;
+                break;
             case 's':
             {
                 const char *mode = cmd_opts.opt_arg();
@@ -213,6 +219,9 @@ extern int main(int argc, char **argv)
     // Set progress bars show mode
     BarGoLink::SetOutputState(sConfig.GetBoolDefault("ShowProgressBars", true));
 
+    if (buildSnapshots)
+        return sMaster.BuildSnapshots();
+
     // and run the 'Master'
     // TODO: Why do we need this 'Master'? Can't all of this be in the Main as for Realmd?
     return sMaster.Run();
@@ -349,6 +349,7 @@ int Master::Run()
     sWorldSocketMgr->SetThreads(sConfig.GetIntDefault("Network.Threads", 1) + 1);
     sWorldSocketMgr->SetInterval(sConfig.GetIntDefault("Network.Interval", 10));
     sWorldSocketMgr->SetTcpNodelay(sConfig.GetBoolDefault("Network.TcpNodelay", true));
+    sWorldSocketMgr->SetReusePort(sConfig.GetBoolDefault("Network.ReusePort", false));
 
     if (sWorldSocketMgr->StartNetwork(wsport, bind_ip) == -1)
     {
@@ -519,6 +520,23 @@ bool StartDB(std::string name, DatabaseType& database, const char **migrations)
 
     return database.CheckRequiredMigrations(migrations);
 }
+
+// Offline build of the SQLStorage snapshots, only needs the world database
+int Master::BuildSnapshots()
+{
+    if (!StartDB("World", WorldDatabase, MIGRATIONS_WORLD))
+    {
+        WorldDatabase.HaltDelayThread();
+        Log::WaitBeforeContinueIfNeed();
+        return 1;
+    }
+
+    bool const built = sWorld.BuildStorageSnapshots();
+
+    WorldDatabase.StopServer();
+    return built ? 0 : 1;
+}
+
 // Initialize connection to the databases
 bool Master::_StartDB()
 {
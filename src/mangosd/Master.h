@@ -36,6 +36,7 @@ class Master
         Master();
         ~Master();
         int Run();
+        int BuildSnapshots();
         static volatile uint32  m_masterLoopCounter;
         static volatile bool    m_handleSigvSignals;
         static void SigvSignalHandler();
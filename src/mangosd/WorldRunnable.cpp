@@ -34,6 +34,8 @@
 #include "Master.h"
 
 #include "Database/DatabaseEnv.h"
+#include "Multithreading/TaskScheduler.h"
+#include "PathfindingService.h"
 
 // Target server framerate is 1000/WORLD_SLEEP_CONST
 #ifdef ENABLE_ELUNA
@@ -134,6 +136,9 @@ void WorldRunnable::operator()()
     sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Unloading all maps...");
     sMapMgr.UnloadAll();                                    // unload all grids (including locked in memory)
 
+    sPathfindingService.Stop();                             // units are gone with the maps
+    sTaskScheduler.Stop();                                  // no more map updates, release the workers
+
 #ifdef ENABLE_ELUNA
     // Eluna must be unloaded after Maps, since ~Map calls sEluna->OnDestroy,
     //   and must be unloaded before the DB, since it can access the DB.
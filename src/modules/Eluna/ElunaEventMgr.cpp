@@ -28,11 +28,11 @@ ElunaEventProcessor::~ElunaEventProcessor()
 {
     // can be called from multiple threads
     {
-        LOCK_ELUNA;
+        Eluna::Guard guard(*E ? (*E)->GetStateLock() : Eluna::GetLock());
         RemoveEvents_internal();
     }
 
-    if (obj && Eluna::IsInitialized())
+    if (obj && Eluna::IsInitialized() && *E)
     {
         EventMgr::Guard guard((*E)->eventMgr->GetLock());
         (*E)->eventMgr->processors.erase(this);
@@ -116,7 +116,7 @@ void ElunaEventProcessor::AddEvent(int funcRef, uint32 min, uint32 max, uint32 r
 void ElunaEventProcessor::RemoveEvent(LuaEvent* luaEvent)
 {
     // Unreference if should and if Eluna was not yet uninitialized and if the lua state still exists
-    if (luaEvent->state != LUAEVENT_STATE_ERASE && Eluna::IsInitialized() && (*E)->HasLuaState())
+    if (luaEvent->state != LUAEVENT_STATE_ERASE && Eluna::IsInitialized() && *E && (*E)->HasLuaState())
     {
         // Free lua function ref
         luaL_unref((*E)->L, LUA_REGISTRYINDEX, luaEvent->funcRef);
@@ -77,6 +77,8 @@ public:
     // set the event to be removed when executing
     void SetState(int eventId, LuaEventState state);
     void AddEvent(int funcRef, uint32 min, uint32 max, uint32 repeats);
+    // State the events run in, the one of the map of the object
+    Eluna* GetEluna() const { return *E; }
     EventMap eventMap;
 
 private:
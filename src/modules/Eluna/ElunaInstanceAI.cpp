@@ -11,21 +11,23 @@
 
 void ElunaInstanceAI::Initialize()
 {
-    LOCK_ELUNA;
+    Eluna* E = Eluna::GetMapEluna(instance);
+    LOCK_ELUNA_STATE(E);
 
-    ASSERT(!sEluna->HasInstanceData(instance));
+    ASSERT(!E->HasInstanceData(instance));
 
     // Create a new table for instance data.
-    lua_State* L = sEluna->L;
+    lua_State* L = E->L;
     lua_newtable(L);
-    sEluna->CreateInstanceData(instance);
+    E->CreateInstanceData(instance);
 
-    sEluna->OnInitialize(this);
+    E->OnInitialize(this);
 }
 
 void ElunaInstanceAI::Load(const char* data)
 {
-    LOCK_ELUNA;
+    Eluna* E = Eluna::GetMapEluna(instance);
+    LOCK_ELUNA_STATE(E);
 
     // If we get passed NULL (i.e. `Reload` was called) then use
     //   the last known save data (or maybe just an empty string).
@@ -40,21 +42,21 @@ void ElunaInstanceAI::Load(const char* data)
 
     if (data[0] == '\0')
     {
-        ASSERT(!sEluna->HasInstanceData(instance));
+        ASSERT(!E->HasInstanceData(instance));
 
         // Create a new table for instance data.
-        lua_State* L = sEluna->L;
+        lua_State* L = E->L;
         lua_newtable(L);
-        sEluna->CreateInstanceData(instance);
+        E->CreateInstanceData(instance);
 
-        sEluna->OnLoad(this);
+        E->OnLoad(this);
         // Stack: (empty)
         return;
     }
 
     size_t decodedLength;
     const unsigned char* decodedData = ElunaUtil::DecodeData(data, &decodedLength);
-    lua_State* L = sEluna->L;
+    lua_State* L = E->L;
 
     if (decodedData)
     {
@@ -71,9 +73,9 @@ void ElunaInstanceAI::Load(const char* data)
             // Only use the data if it's a table.
             if (lua_istable(L, -1))
             {
-                sEluna->CreateInstanceData(instance);
+                E->CreateInstanceData(instance);
                 // Stack: (empty)
-                sEluna->OnLoad(this);
+                E->OnLoad(this);
                 // WARNING! lastSaveData might be different after `OnLoad` if the Lua code saved data.
             }
             else
@@ -109,8 +111,9 @@ const char* ElunaInstanceAI::Save() const
 const char* ElunaInstanceAI::Save()
 #endif
 {
-    LOCK_ELUNA;
-    lua_State* L = sEluna->L;
+    Eluna* E = Eluna::GetMapEluna(instance);
+    LOCK_ELUNA_STATE(E);
+    lua_State* L = E->L;
     // Stack: (empty)
 
     /*
@@ -123,7 +126,7 @@ const char* ElunaInstanceAI::Save()
     ElunaInstanceAI* self = const_cast<ElunaInstanceAI*>(this);
 
     lua_pushcfunction(L, mar_encode);
-    sEluna->PushInstanceData(L, self, false);
+    E->PushInstanceData(L, self, false);
     // Stack: mar_encode, instance_data
 
     if (lua_pcall(L, 1, 1, 0) != 0)
@@ -150,11 +153,12 @@ uint32 ElunaInstanceAI::GetData(uint32 key) const
 uint32 ElunaInstanceAI::GetData(uint32 key)
 #endif
 {
-    LOCK_ELUNA;
-    lua_State* L = sEluna->L;
+    Eluna* E = Eluna::GetMapEluna(instance);
+    LOCK_ELUNA_STATE(E);
+    lua_State* L = E->L;
     // Stack: (empty)
 
-    sEluna->PushInstanceData(L, const_cast<ElunaInstanceAI*>(this), false);
+    E->PushInstanceData(L, const_cast<ElunaInstanceAI*>(this), false);
     // Stack: instance_data
 
     Eluna::Push(L, key);
@@ -172,11 +176,12 @@ uint32 ElunaInstanceAI::GetData(uint32 key)
 
 void ElunaInstanceAI::SetData(uint32 key, uint32 value)
 {
-    LOCK_ELUNA;
-    lua_State* L = sEluna->L;
+    Eluna* E = Eluna::GetMapEluna(instance);
+    LOCK_ELUNA_STATE(E);
+    lua_State* L = E->L;
     // Stack: (empty)
 
-    sEluna->PushInstanceData(L, this, false);
+    E->PushInstanceData(L, this, false);
     // Stack: instance_data
 
     Eluna::Push(L, key);
@@ -195,11 +200,12 @@ uint64 ElunaInstanceAI::GetData64(uint32 key) const
 uint64 ElunaInstanceAI::GetData64(uint32 key)
 #endif
 {
-    LOCK_ELUNA;
-    lua_State* L = sEluna->L;
+    Eluna* E = Eluna::GetMapEluna(instance);
+    LOCK_ELUNA_STATE(E);
+    lua_State* L = E->L;
     // Stack: (empty)
 
-    sEluna->PushInstanceData(L, const_cast<ElunaInstanceAI*>(this), false);
+    E->PushInstanceData(L, const_cast<ElunaInstanceAI*>(this), false);
     // Stack: instance_data
 
     Eluna::Push(L, key);
@@ -217,11 +223,12 @@ uint64 ElunaInstanceAI::GetData64(uint32 key)
 
 void ElunaInstanceAI::SetData64(uint32 key, uint64 value)
 {
-    LOCK_ELUNA;
-    lua_State* L = sEluna->L;
+    Eluna* E = Eluna::GetMapEluna(instance);
+    LOCK_ELUNA_STATE(E);
+    lua_State* L = E->L;
     // Stack: (empty)
 
-    sEluna->PushInstanceData(L, this, false);
+    E->PushInstanceData(L, this, false);
     // Stack: instance_data
 
     Eluna::Push(L, key);
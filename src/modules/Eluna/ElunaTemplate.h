@@ -57,8 +57,10 @@ public:
 class ElunaObject
 {
 public:
+    typedef void* (*CopyFunction)(void const* obj);
+
     template<typename T>
-    ElunaObject(T * obj, bool manageMemory);
+    ElunaObject(Eluna* E, T * obj, bool manageMemory);
 
     ~ElunaObject()
     {
@@ -67,11 +69,13 @@ public:
     // Get wrapped object pointer
     void* GetObj() const { return object; }
     // Returns whether the object is valid or not
-    bool IsValid() const { return !callstackid || callstackid == sEluna->GetCallstackId(); }
+    bool IsValid() const { return !callstackid || callstackid == E->GetCallstackId(); }
     // Returns whether the object can be invalidated or not
     bool CanInvalidate() const { return _invalidate; }
     // Returns pointer to the wrapped object's type name
     const char* GetTypeName() const { return type_name; }
+    // Returns whether the object is borrowed from the caller of a hook
+    bool IsBorrowed() const { return copy != NULL; }
 
     // Sets the object pointer that is wrapped
     void SetObj(void* obj)
@@ -86,7 +90,7 @@ public:
         ASSERT(!valid || (valid && object));
         if (valid)
             if (CanInvalidate())
-                callstackid = sEluna->GetCallstackId();
+                callstackid = E->GetCallstackId();
             else
                 callstackid = 0;
         else
@@ -95,8 +99,28 @@ public:
     // Sets whether the pointer will be invalidated at end of calls
     void SetValidation(bool invalidate)
     {
+        // Keeping a borrowed object requires a copy of it
+        if (!invalidate && IsBorrowed())
+            Materialize();
         _invalidate = invalidate;
     }
+    // Marks the object as borrowed: invalidated at the end of the call, never deleted by Lua
+    void Borrow(CopyFunction copyFunction)
+    {
+        copy = copyFunction;
+        _invalidate = true;
+        SetValid(true);
+    }
+    // Replaces a borrowed object with a copy owned by Lua
+    void Materialize()
+    {
+        if (!IsBorrowed())
+            return;
+        object = copy(object);
+        copy = NULL;
+        _invalidate = false;
+        SetValid(true);
+    }
     // Invalidates the pointer if it should be invalidated
     void Invalidate()
     {
@@ -105,10 +129,12 @@ public:
     }
 
 private:
+    Eluna* E;   // State the object was pushed to, call stacks are counted per state
     uint64 callstackid;
     bool _invalidate;
     void* object;
     const char* type_name;
+    CopyFunction copy;  // Set while the object is borrowed
 };
 
 template<typename T>
@@ -267,7 +293,7 @@ public:
             lua_pushnil(L);
             return 1;
         }
-        *ptrHold = new ElunaObject(const_cast<T*>(obj), manageMemory);
+        *ptrHold = new ElunaObject(Eluna::GetEluna(L), const_cast<T*>(obj), manageMemory);
 
         // Set metatable for it
         lua_pushstring(L, tname);
@@ -283,6 +309,22 @@ public:
         return 1;
     }
 
+    /*
+     * Pushes an object of a garbage collected type without copying it: the object
+     * stays owned by the caller and is invalidated at the end of the call. It is
+     * copied when a script changes it (see ElunaObject::Materialize) or keeps it
+     * with SetInvalidation(false).
+     */
+    static int PushBorrowed(lua_State* L, T* obj)
+    {
+        ASSERT(manageMemory);
+        Push(L, obj);
+
+        if (ElunaObject** ptrHold = static_cast<ElunaObject**>(lua_touserdata(L, -1)))
+            (*ptrHold)->Borrow(&CopyObject);
+        return 1;
+    }
+
     static T* Check(lua_State* L, int narg, bool error = true)
     {
         ElunaObject* elunaObj = Eluna::CHECKTYPE(L, narg, tname, error);
@@ -341,12 +383,17 @@ public:
 
     // Metamethods ("virtual")
 
+    static void* CopyObject(void const* obj)
+    {
+        return new T(*static_cast<T const*>(obj));
+    }
+
     // Remember special cases like ElunaTemplate<Vehicle>::CollectGarbage
     static int CollectGarbage(lua_State* L)
     {
         // Get object pointer (and check type, no error)
         ElunaObject* obj = Eluna::CHECKOBJ<ElunaObject>(L, 1, false);
-        if (obj && manageMemory)
+        if (obj && manageMemory && !obj->IsBorrowed())
             delete static_cast<T*>(obj->GetObj());
         delete obj;
         return 0;
@@ -377,7 +424,7 @@ public:
 };
 
 template<typename T>
-ElunaObject::ElunaObject(T * obj, bool manageMemory) : callstackid(1), _invalidate(!manageMemory), object(obj), type_name(ElunaTemplate<T>::tname)
+ElunaObject::ElunaObject(Eluna* E, T * obj, bool manageMemory) : E(E), callstackid(1), _invalidate(!manageMemory), object(obj), type_name(ElunaTemplate<T>::tname), copy(NULL)
 {
     SetValid(true);
 }
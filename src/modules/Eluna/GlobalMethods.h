@@ -38,6 +38,54 @@ namespace LuaGlobalFunctions
         return 1;
     }
 
+    /**
+     * Returns the map ID of the Lua state running the script, -1 for the world state.
+     *
+     * Map states exist only when `Eluna.PerMapStates` is enabled: every map then runs its
+     * own copy of the scripts, and the world state only handles the hooks not bound to a map.
+     *
+     * @return int32 mapId
+     */
+    int GetStateMapId(lua_State* L)
+    {
+        Map* map = Eluna::GetEluna(L)->GetBoundMap();
+        Eluna::Push(L, map ? int32(map->GetId()) : -1);
+        return 1;
+    }
+
+    /**
+     * Returns the instance ID of the Lua state running the script, 0 for the world state.
+     *
+     * @return uint32 instanceId
+     */
+    int GetStateInstanceId(lua_State* L)
+    {
+        Map* map = Eluna::GetEluna(L)->GetBoundMap();
+        Eluna::Push(L, map ? map->GetInstanceId() : 0);
+        return 1;
+    }
+
+    /**
+     * Sends a message to the Lua state of a map, or to the world state when `mapId` is -1.
+     *
+     * States do not share any Lua value, the message is a string the scripts serialize themselves.
+     * It is delivered by ELUNA_EVENT_ON_STATE_MESSAGE on the next update of the receiving state.
+     *
+     * @param int32 mapId : map ID of the receiving state, -1 for the world state
+     * @param uint32 instanceId : instance ID of the receiving state, 0 for continents
+     * @param string message
+     * @return bool posted : false if the receiving state does not exist
+     */
+    int PostStateMessage(lua_State* L)
+    {
+        int32 mapId = Eluna::CHECKVAL<int32>(L, 1);
+        uint32 instanceId = Eluna::CHECKVAL<uint32>(L, 2);
+        std::string message = Eluna::CHECKVAL<std::string>(L, 3);
+
+        Eluna::Push(L, Eluna::PostStateMessage(Eluna::GetEluna(L), mapId, instanceId, message));
+        return 1;
+    }
+
     /**
      * Returns emulator's name.
      *
@@ -626,6 +674,9 @@ namespace LuaGlobalFunctions
      *
      *         GAME_EVENT_START                        =     34,       // (event, gameeventid)
      *         GAME_EVENT_STOP                         =     35,       // (event, gameeventid)
+
+     *         // Eluna
+     *         ELUNA_EVENT_ON_STATE_MESSAGE            =     36,       // (event, senderMapId, senderInstanceId, message) - senderMapId is -1 for the world state, see PostStateMessage
      *     };
      *
      * @proto cancel = (event, function)
@@ -155,6 +155,9 @@ namespace Hooks
         GAME_EVENT_START                        =     34,       // (event, gameeventid)
         GAME_EVENT_STOP                         =     35,       // (event, gameeventid)
 
+        // Eluna
+        ELUNA_EVENT_ON_STATE_MESSAGE            =     36,       // (event, senderMapId, senderInstanceId, message) - senderMapId is -1 for the world state, see PostStateMessage
+
         SERVER_EVENT_COUNT
     };
 
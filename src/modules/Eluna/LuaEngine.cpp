@@ -58,6 +58,11 @@ Eluna* Eluna::GEluna = NULL;
 bool Eluna::reload = false;
 bool Eluna::initialized = false;
 Eluna::LockType Eluna::lock;
+bool Eluna::perMapStates = false;
+std::mutex Eluna::statesLock;
+Eluna::MapStateMap Eluna::mapStates;
+ElunaLock::Counters Eluna::retiredLockCounters;
+std::atomic<uint32> Eluna::scriptGeneration(0);
 
 extern void RegisterFunctions(Eluna* E);
 
@@ -74,6 +79,8 @@ void Eluna::Initialize()
 
     LoadScriptPaths();
 
+    perMapStates = eConfigMgr->GetBoolDefault("Eluna.PerMapStates", false);
+
     // Must be before creating GEluna
     // This is checked on Eluna creation
     initialized = true;
@@ -90,16 +97,30 @@ void Eluna::Uninitialize()
     delete GEluna;
     GEluna = NULL;
 
+    {
+        std::lock_guard<std::mutex> guard(statesLock);
+        if (!mapStates.empty())
+            ELUNA_LOG_ERROR("[Eluna]: %u map states still exist on shutdown", uint32(mapStates.size()));
+    }
+
     lua_scripts.clear();
     lua_extensions.clear();
 
     initialized = false;
 }
 
+static bool ScriptPathComparator(const LuaScript& first, const LuaScript& second)
+{
+    return first.filepath < second.filepath;
+}
+
 void Eluna::LoadScriptPaths()
 {
     uint32 oldMSTime = ElunaUtil::GetCurrTime();
 
+    // Map states may be reading the lists to reload
+    std::lock_guard<std::mutex> guard(statesLock);
+
     lua_scripts.clear();
     lua_extensions.clear();
 
@@ -116,6 +137,9 @@ void Eluna::LoadScriptPaths()
     if (!lua_requirepath.empty())
         lua_requirepath.erase(lua_requirepath.end() - 1);
 
+    lua_extensions.sort(ScriptPathComparator);
+    lua_scripts.sort(ScriptPathComparator);
+
     ELUNA_LOG_DEBUG("[Eluna]: Loaded %u scripts in %u ms", uint32(lua_scripts.size() + lua_extensions.size()), ElunaUtil::GetTimeDiff(oldMSTime));
 }
 
@@ -141,10 +165,13 @@ void Eluna::_ReloadEluna()
     // Run scripts from laoded paths
     sEluna->RunScripts();
 
+    // Map states reload on their next update
+    ++scriptGeneration;
+
     reload = false;
 }
 
-Eluna::Eluna() :
+Eluna::Eluna(Map* map) :
 event_level(0),
 push_counter(0),
 enabled(false),
@@ -170,17 +197,18 @@ PlayerGossipBindings(NULL),
 MapEventBindings(NULL),
 InstanceEventBindings(NULL),
 
-CreatureUniqueBindings(NULL)
+CreatureUniqueBindings(NULL),
+
+boundMap(map),
+self(this),
+loadedGeneration(scriptGeneration.load())
 {
     ASSERT(IsInitialized());
 
     OpenLua();
 
-    // Replace this with map insert if making multithread version
-
     // Set event manager. Must be after setting sEluna
-    // on multithread have a map of state pointers and here insert this pointer to the map and then save a pointer of that pointer to the EventMgr
-    eventMgr = new EventMgr(&Eluna::GEluna);
+    eventMgr = new EventMgr(map ? &self : &Eluna::GEluna);
 }
 
 Eluna::~Eluna()
@@ -193,11 +221,127 @@ Eluna::~Eluna()
     eventMgr = NULL;
 }
 
+Eluna* Eluna::CreateMapState(Map* map)
+{
+    if (!IsInitialized() || !perMapStates)
+        return NULL;
+
+    Eluna* E;
+    {
+        // Registering the Lua types sets the static type names, one state at a time
+        static std::mutex createLock;
+        std::lock_guard<std::mutex> guard(createLock);
+        E = new Eluna(map);
+        E->RunScripts();
+    }
+
+    std::lock_guard<std::mutex> guard(statesLock);
+    mapStates[uint64(map->GetId()) << 32 | map->GetInstanceId()] = E;
+    return E;
+}
+
+void Eluna::DestroyMapState(Eluna* E)
+{
+    if (!E)
+        return;
+
+    {
+        // Once unregistered, no message can be posted to the state anymore
+        std::lock_guard<std::mutex> guard(statesLock);
+        mapStates.erase(uint64(E->boundMap->GetId()) << 32 | E->boundMap->GetInstanceId());
+        retiredLockCounters += E->stateLock.GetCounters();
+    }
+
+    delete E;
+}
+
+Eluna* Eluna::GetMapEluna(Map const* map)
+{
+    return map->GetEluna();
+}
+
+bool Eluna::PostStateMessage(Eluna const* sender, int32 mapId, uint32 instanceId, std::string const& message)
+{
+    StateMessage stateMessage;
+    stateMessage.senderMapId = sender->boundMap ? int32(sender->boundMap->GetId()) : -1;
+    stateMessage.senderInstanceId = sender->boundMap ? sender->boundMap->GetInstanceId() : 0;
+    stateMessage.message = message;
+
+    std::lock_guard<std::mutex> guard(statesLock);
+    Eluna* target = GEluna;
+    if (mapId >= 0)
+    {
+        MapStateMap::const_iterator itr = mapStates.find(uint64(mapId) << 32 | instanceId);
+        target = itr != mapStates.end() ? itr->second : NULL;
+    }
+
+    if (!target)
+        return false;
+
+    std::lock_guard<std::mutex> mailboxGuard(target->mailboxLock);
+    target->mailbox.push_back(std::move(stateMessage));
+    return true;
+}
+
+void Eluna::ProcessStateMessages()
+{
+    std::vector<StateMessage> messages;
+    {
+        std::lock_guard<std::mutex> guard(mailboxLock);
+        if (mailbox.empty())
+            return;
+        messages.swap(mailbox);
+    }
+
+    for (StateMessage const& message : messages)
+        OnStateMessage(message);
+}
+
+void Eluna::UpdateMapState(uint32 diff)
+{
+    uint32 const generation = scriptGeneration.load();
+    if (generation != loadedGeneration)
+    {
+        LOCK_ELUNA_STATE(this);
+        eventMgr->SetStates(LUAEVENT_STATE_ERASE);
+        CloseLua();
+        OpenLua();
+        RunScripts();
+        loadedGeneration = generation;
+    }
+
+    eventMgr->globalProcessor->Update(diff);
+    ProcessStateMessages();
+}
+
+void Eluna::GetLockCounters(ElunaLock::Counters& world, ElunaLock::Counters& maps, uint32& mapStateCount)
+{
+    world = lock.GetCounters();
+
+    std::lock_guard<std::mutex> guard(statesLock);
+    maps = retiredLockCounters;
+    for (MapStateMap::const_iterator itr = mapStates.begin(); itr != mapStates.end(); ++itr)
+        maps += itr->second->stateLock.GetCounters();
+    mapStateCount = mapStates.size();
+}
+
+void Eluna::ResetLockCounters()
+{
+    lock.ResetCounters();
+
+    std::lock_guard<std::mutex> guard(statesLock);
+    retiredLockCounters = ElunaLock::Counters();
+    for (MapStateMap::const_iterator itr = mapStates.begin(); itr != mapStates.end(); ++itr)
+        itr->second->stateLock.ResetCounters();
+}
+
 void Eluna::CloseLua()
 {
     OnLuaStateClose();
 
     DestroyBindStores();
+    packetReceiveFilter.Reset();
+    packetSendFilter.Reset();
 
     // Must close lua state after deleting stores and mgr
     if (L)
@@ -233,8 +377,13 @@ void Eluna::OpenLua()
     RegisterFunctions(this);
 
     // Set lua require folder paths (scripts folder structure)
+    std::string requirePath;
+    {
+        std::lock_guard<std::mutex> guard(statesLock);
+        requirePath = lua_requirepath;
+    }
     lua_getglobal(L, "package");
-    lua_pushstring(L, lua_requirepath.c_str());
+    lua_pushstring(L, requirePath.c_str());
     lua_setfield(L, -2, "path");
     lua_pushstring(L, ""); // erase cpath
     lua_setfield(L, -2, "cpath");
@@ -433,25 +582,22 @@ void Eluna::GetScripts(std::string path)
 #endif
 }
 
-static bool ScriptPathComparator(const LuaScript& first, const LuaScript& second)
-{
-    return first.filepath < second.filepath;
-}
-
 void Eluna::RunScripts()
 {
-    LOCK_ELUNA;
+    LOCK_ELUNA_STATE(this);
     if (!IsEnabled())
         return;
 
     uint32 oldMSTime = ElunaUtil::GetCurrTime();
     uint32 count = 0;
 
+    // Lists are sorted by LoadScriptPaths
     ScriptList scripts;
-    lua_extensions.sort(ScriptPathComparator);
-    lua_scripts.sort(ScriptPathComparator);
-    scripts.insert(scripts.end(), lua_extensions.begin(), lua_extensions.end());
-    scripts.insert(scripts.end(), lua_scripts.begin(), lua_scripts.end());
+    {
+        std::lock_guard<std::mutex> guard(statesLock);
+        scripts.insert(scripts.end(), lua_extensions.begin(), lua_extensions.end());
+        scripts.insert(scripts.end(), lua_scripts.begin(), lua_scripts.end());
+    }
 
     std::unordered_map<std::string, std::string> loaded; // filename, path
 
@@ -511,7 +657,14 @@ void Eluna::RunScripts()
     }
     // Stack: package, modules
     lua_pop(L, 2);
-    ELUNA_LOG_INFO("[Eluna]: Executed %u Lua scripts in %u ms", count, ElunaUtil::GetTimeDiff(oldMSTime));
+    if (boundMap)
+    {
+        ELUNA_LOG_DEBUG("[Eluna]: Executed %u Lua scripts for map %u (instance %u) in %u ms", count, boundMap->GetId(), boundMap->GetInstanceId(), ElunaUtil::GetTimeDiff(oldMSTime));
+    }
+    else
+    {
+        ELUNA_LOG_INFO("[Eluna]: Executed %u Lua scripts in %u ms", count, ElunaUtil::GetTimeDiff(oldMSTime));
+    }
 
     OnLuaStateOpen();
 }
@@ -943,6 +1096,10 @@ int Eluna::Register(lua_State* L, uint8 regtype, uint32 entry, uint64 guid, uint
             {
                 auto key = EventKey<Hooks::ServerEvents>((Hooks::ServerEvents)event_id);
                 bindingID = ServerEventBindings->Insert(key, functionRef, shots);
+                if (event_id == Hooks::SERVER_EVENT_ON_PACKET_RECEIVE)
+                    packetReceiveFilter.SetAll();
+                else if (event_id == Hooks::SERVER_EVENT_ON_PACKET_SEND)
+                    packetSendFilter.SetAll();
                 createCancelCallback(L, bindingID, ServerEventBindings);
                 return 1; // Stack: callback
             }
@@ -1010,6 +1167,10 @@ int Eluna::Register(lua_State* L, uint8 regtype, uint32 entry, uint64 guid, uint
 
                 auto key = EntryKey<Hooks::PacketEvents>((Hooks::PacketEvents)event_id, entry);
                 bindingID = PacketEventBindings->Insert(key, functionRef, shots);
+                if (event_id == Hooks::PACKET_EVENT_ON_PACKET_RECEIVE)
+                    packetReceiveFilter.Set(entry);
+                else if (event_id == Hooks::PACKET_EVENT_ON_PACKET_SEND)
+                    packetSendFilter.Set(entry);
                 createCancelCallback(L, bindingID, PacketEventBindings);
                 return 1; // Stack: callback
             }
@@ -1298,7 +1459,7 @@ void Eluna::CreateInstanceData(Map const* map)
  */
 void Eluna::FreeInstanceId(uint32 instanceId)
 {
-    LOCK_ELUNA;
+    LOCK_ELUNA_STATE(this);
 
     if (!IsEnabled())
         return;
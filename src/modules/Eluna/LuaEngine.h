@@ -19,9 +19,14 @@
 #include "Weather.h"
 #include "World.h"
 #include "Hooks.h"
+#include "Opcodes.h"
 #include "ElunaUtility.h"
+#include <atomic>
+#include <chrono>
 #include <mutex>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 extern "C"
 {
@@ -116,23 +121,163 @@ struct LuaScript
 
 #define ELUNA_STATE_PTR     "Eluna State Ptr"
 #define LOCK_ELUNA Eluna::Guard __guard(Eluna::GetLock())
+// Locks the state E only, the world state when map states are disabled
+#define LOCK_ELUNA_STATE(E) Eluna::Guard __guard((E)->GetStateLock())
+
+/*
+ * Recursive mutex of a Lua state, counting how often and how long the
+ * threads had to wait for it.
+ */
+class ElunaLock
+{
+public:
+    struct Counters
+    {
+        Counters() : acquisitions(0), contended(0), waitUs(0) { }
+
+        uint64 acquisitions;
+        uint64 contended;   // Acquisitions that had to wait for another thread
+        uint64 waitUs;      // Total time spent waiting
+
+        Counters& operator+=(Counters const& other)
+        {
+            acquisitions += other.acquisitions;
+            contended += other.contended;
+            waitUs += other.waitUs;
+            return *this;
+        }
+    };
+
+    ElunaLock() : acquisitions(0), contended(0), waitUs(0) { }
+
+    ElunaLock(ElunaLock const&) = delete;
+    ElunaLock& operator=(ElunaLock const&) = delete;
+
+    void lock()
+    {
+        if (!mutex.try_lock())
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            mutex.lock();
+            contended.fetch_add(1, std::memory_order_relaxed);
+            waitUs.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+        }
+        acquisitions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool try_lock()
+    {
+        if (!mutex.try_lock())
+            return false;
+        acquisitions.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void unlock() { mutex.unlock(); }
+
+    Counters GetCounters() const
+    {
+        Counters counters;
+        counters.acquisitions = acquisitions.load(std::memory_order_relaxed);
+        counters.contended = contended.load(std::memory_order_relaxed);
+        counters.waitUs = waitUs.load(std::memory_order_relaxed);
+        return counters;
+    }
+
+    void ResetCounters()
+    {
+        acquisitions.store(0, std::memory_order_relaxed);
+        contended.store(0, std::memory_order_relaxed);
+        waitUs.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::recursive_mutex mutex;
+    std::atomic<uint64> acquisitions;
+    std::atomic<uint64> contended;
+    std::atomic<uint64> waitUs;
+};
 
 #ifndef TRINITY
 #define TC_GAME_API
 #endif
+/*
+ * Opcodes with a packet hook binding, tested before taking any lock so an
+ * unbound opcode costs one bit test. Bits are set on registration and only
+ * cleared when the Lua state closes: an expired or cleared binding keeps its
+ * bit, which only costs the regular binding lookup.
+ */
+class ElunaOpcodeFilter
+{
+public:
+    ElunaOpcodeFilter() { Reset(); }
+
+    ElunaOpcodeFilter(ElunaOpcodeFilter const&) = delete;
+    ElunaOpcodeFilter& operator=(ElunaOpcodeFilter const&) = delete;
+
+    void Set(uint32 opcode)
+    {
+        if (opcode < WORD_COUNT * 64)
+            words[opcode / 64].fetch_or(uint64(1) << (opcode % 64), std::memory_order_relaxed);
+    }
+
+    // Bindings of the server packet events see every opcode
+    void SetAll() { all.store(true, std::memory_order_relaxed); }
+
+    bool Test(uint32 opcode) const
+    {
+        if (all.load(std::memory_order_relaxed))
+            return true;
+        return opcode < WORD_COUNT * 64 && (words[opcode / 64].load(std::memory_order_relaxed) >> (opcode % 64)) & 1;
+    }
+
+    void Reset()
+    {
+        all.store(false, std::memory_order_relaxed);
+        for (uint32 i = 0; i < WORD_COUNT; ++i)
+            words[i].store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static uint32 const WORD_COUNT = (NUM_MSG_TYPES + 63) / 64;
+
+    std::atomic<bool> all;
+    std::atomic<uint64> words[WORD_COUNT];
+};
+
 class TC_GAME_API Eluna
 {
 public:
     typedef std::list<LuaScript> ScriptList;
 
-    typedef std::recursive_mutex LockType;
+    typedef ElunaLock LockType;
     typedef std::lock_guard<LockType> Guard;
 
+    // Message posted by PostStateMessage, delivered on the next update of the receiving state
+    struct StateMessage
+    {
+        int32 senderMapId;      // -1 for the world state
+        uint32 senderInstanceId;
+        std::string message;
+    };
+
 private:
+    typedef std::unordered_map<uint64, Eluna*> MapStateMap;
+
     static bool reload;
     static bool initialized;
     static LockType lock;
 
+    // Eluna.PerMapStates: every map runs its own copy of the scripts in its own state,
+    // the world state (GEluna) only handles the hooks that are not bound to a map
+    static bool perMapStates;
+    // Guards mapStates, retiredLockCounters and the script lists while map states read them
+    static std::mutex statesLock;
+    static MapStateMap mapStates;                       // By map id << 32 | instance id
+    static ElunaLock::Counters retiredLockCounters;     // Counters of the destroyed map states
+    // Incremented by each reload of the world state, map states reload when they see a new value
+    static std::atomic<uint32> scriptGeneration;
+
     // Lua script locations
     static ScriptList lua_scripts;
     static ScriptList lua_extensions;
@@ -161,7 +306,21 @@ private:
     // Map from map ID -> Lua table ref
     std::unordered_map<uint32, int> continentDataRefs;
 
-    Eluna();
+    // Map owning this state, NULL for the world state
+    Map* boundMap;
+    // Pointer handed to the EventMgr of a map state, which has no global pointer
+    Eluna* self;
+    // Lock of a map state, the world state uses the static lock
+    LockType stateLock;
+    uint32 loadedGeneration;
+
+    std::mutex mailboxLock;
+    std::vector<StateMessage> mailbox;
+
+    ElunaOpcodeFilter packetReceiveFilter;
+    ElunaOpcodeFilter packetSendFilter;
+
+    explicit Eluna(Map* map = NULL);
     ~Eluna();
 
     // Prevent copy
@@ -225,6 +384,17 @@ private:
     void Push(const char* value)                { Push(L, value); ++push_counter; }
     template<typename T>
     void Push(T const* ptr)                     { Push(L, ptr); ++push_counter; }
+    // Pushes an object owned by the caller, valid until the hook returns unless a script copies it.
+    // Objects are only invalidated when the outermost hook ends, nested hooks push a copy.
+    template<typename T>
+    void PushBorrowed(T* ptr)
+    {
+        if (event_level)
+            Push(L, new T(*ptr));
+        else
+            ElunaTemplate<T>::PushBorrowed(L, ptr);
+        ++push_counter;
+    }
 
 public:
     static Eluna* GEluna;
@@ -258,6 +428,34 @@ public:
     static void ReloadEluna() { LOCK_ELUNA; reload = true; }
     static LockType& GetLock() { return lock; };
     static bool IsInitialized() { return initialized; }
+    static bool IsPerMapStates() { return perMapStates; }
+
+    /*
+     * Creates the state of `map` when Eluna.PerMapStates is enabled, returns NULL otherwise.
+     * The state must be destroyed with DestroyMapState once the map is unloaded.
+     */
+    static Eluna* CreateMapState(Map* map);
+    static void DestroyMapState(Eluna* E);
+    // Returns the state running the scripts of `map`, never NULL
+    static Eluna* GetMapEluna(Map const* map);
+
+    /*
+     * Queues `message` for the state of the given map, or for the world state when `mapId` is negative.
+     * Returns false when the receiving state does not exist.
+     */
+    static bool PostStateMessage(Eluna const* sender, int32 mapId, uint32 instanceId, std::string const& message);
+
+    /*
+     * Counters of the world lock, and the sum of the map state locks (including destroyed states).
+     */
+    static void GetLockCounters(ElunaLock::Counters& world, ElunaLock::Counters& maps, uint32& mapStateCount);
+    static void ResetLockCounters();
+
+    LockType& GetStateLock() { return boundMap ? stateLock : lock; }
+    Map* GetBoundMap() const { return boundMap; }
+    // Called by the owning map every update, before the map hooks
+    void UpdateMapState(uint32 diff);
+    void ProcessStateMessages();
     // Never returns nullptr
     static Eluna* GetEluna(lua_State* L)
     {
@@ -356,6 +554,7 @@ public:
     InventoryResult OnCanUseItem(const Player* pPlayer, uint32 itemEntry);
     void OnLuaStateClose();
     void OnLuaStateOpen();
+    void OnStateMessage(StateMessage const& message);
     bool OnAddonMessage(Player* sender, uint32 type, std::string& msg, Player* receiver, Guild* guild, Group* group, Channel* channel);
 
     /* Item */
@@ -77,6 +77,8 @@ luaL_Reg GlobalMethods[] =
     // Getters
     { "GetLuaEngine", &LuaGlobalFunctions::GetLuaEngine },
     { "GetCoreName", &LuaGlobalFunctions::GetCoreName },
+    { "GetStateMapId", &LuaGlobalFunctions::GetStateMapId },
+    { "GetStateInstanceId", &LuaGlobalFunctions::GetStateInstanceId },
     { "GetCoreVersion", &LuaGlobalFunctions::GetCoreVersion },
     { "GetCoreExpansion", &LuaGlobalFunctions::GetCoreExpansion },
     { "GetQuest", &LuaGlobalFunctions::GetQuest },
@@ -120,6 +122,7 @@ luaL_Reg GlobalMethods[] =
     // Other
     { "ReloadEluna", &LuaGlobalFunctions::ReloadEluna },
     { "SendWorldMessage", &LuaGlobalFunctions::SendWorldMessage },
+    { "PostStateMessage", &LuaGlobalFunctions::PostStateMessage },
     { "WorldDBQuery", &LuaGlobalFunctions::WorldDBQuery },
     { "WorldDBExecute", &LuaGlobalFunctions::WorldDBExecute },
     { "CharDBQuery", &LuaGlobalFunctions::CharDBQuery },
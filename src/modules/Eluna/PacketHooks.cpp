@@ -19,7 +19,7 @@ using namespace Hooks;
     auto key = EventKey<ServerEvents>(EVENT);\
     if (!ServerEventBindings->HasBindingsFor(key))\
         return;\
-    LOCK_ELUNA
+    LOCK_ELUNA_STATE(this)
 
 #define START_HOOK_PACKET(EVENT, OPCODE) \
     if (!IsEnabled())\
@@ -27,10 +27,13 @@ using namespace Hooks;
     auto key = EntryKey<PacketEvents>(EVENT, OPCODE);\
     if (!PacketEventBindings->HasBindingsFor(key))\
         return;\
-    LOCK_ELUNA
+    LOCK_ELUNA_STATE(this)
 
 bool Eluna::OnPacketSend(WorldSession* session, const WorldPacket& packet)
 {
+    if (!IsEnabled() || !packetSendFilter.Test(packet.GetOpcode()))
+        return true;
+
     bool result = true;
     Player* player = NULL;
     if (session)
@@ -42,7 +45,8 @@ bool Eluna::OnPacketSend(WorldSession* session, const WorldPacket& packet)
 void Eluna::OnPacketSendAny(Player* player, const WorldPacket& packet, bool& result)
 {
     START_HOOK_SERVER(SERVER_EVENT_ON_PACKET_SEND);
-    Push(new WorldPacket(packet));
+    size_t const rpos = packet.rpos();
+    PushBorrowed(const_cast<WorldPacket*>(&packet));
     Push(player);
     int n = SetupStack(ServerEventBindings, key, 2);
 
@@ -57,12 +61,14 @@ void Eluna::OnPacketSendAny(Player* player, const WorldPacket& packet, bool& res
     }
 
     CleanUpStack(2);
+    const_cast<WorldPacket&>(packet).rpos(rpos);
 }
 
 void Eluna::OnPacketSendOne(Player* player, const WorldPacket& packet, bool& result)
 {
     START_HOOK_PACKET(PACKET_EVENT_ON_PACKET_SEND, packet.GetOpcode());
-    Push(new WorldPacket(packet));
+    size_t const rpos = packet.rpos();
+    PushBorrowed(const_cast<WorldPacket*>(&packet));
     Push(player);
     int n = SetupStack(PacketEventBindings, key, 2);
 
@@ -77,10 +83,14 @@ void Eluna::OnPacketSendOne(Player* player, const WorldPacket& packet, bool& res
     }
 
     CleanUpStack(2);
+    const_cast<WorldPacket&>(packet).rpos(rpos);
 }
 
 bool Eluna::OnPacketReceive(WorldSession* session, WorldPacket& packet)
 {
+    if (!IsEnabled() || !packetReceiveFilter.Test(packet.GetOpcode()))
+        return true;
+
     bool result = true;
     Player* player = NULL;
     if (session)
@@ -93,7 +103,8 @@ bool Eluna::OnPacketReceive(WorldSession* session, WorldPacket& packet)
 void Eluna::OnPacketReceiveAny(Player* player, WorldPacket& packet, bool& result)
 {
     START_HOOK_SERVER(SERVER_EVENT_ON_PACKET_RECEIVE);
-    Push(new WorldPacket(packet));
+    size_t rpos = packet.rpos();
+    PushBorrowed(&packet);
     Push(player);
     int n = SetupStack(ServerEventBindings, key, 2);
 
@@ -107,23 +118,30 @@ void Eluna::OnPacketReceiveAny(Player* player, WorldPacket& packet, bool& result
         if (lua_isuserdata(L, r + 1))
             if (WorldPacket* data = CHECKOBJ<WorldPacket>(L, r + 1, false))
             {
-                #ifdef VMANGOS
-                packet = std::move(*data);
-                #else
-                packet = *data;
-                #endif
+                // Returning the borrowed packet itself leaves it unchanged
+                if (data != &packet)
+                {
+                    #ifdef VMANGOS
+                    packet = std::move(*data);
+                    #else
+                    packet = *data;
+                    #endif
+                    rpos = packet.rpos();
+                }
             }
 
         lua_pop(L, 2);
     }
 
     CleanUpStack(2);
+    packet.rpos(rpos);
 }
 
 void Eluna::OnPacketReceiveOne(Player* player, WorldPacket& packet, bool& result)
 {
-    START_HOOK_PACKET(PACKET_EVENT_ON_PACKET_SEND, packet.GetOpcode());
-    Push(new WorldPacket(packet));
+    START_HOOK_PACKET(PACKET_EVENT_ON_PACKET_RECEIVE, packet.GetOpcode());
+    size_t rpos = packet.rpos();
+    PushBorrowed(&packet);
     Push(player);
     int n = SetupStack(PacketEventBindings, key, 2);
 
@@ -137,15 +155,21 @@ void Eluna::OnPacketReceiveOne(Player* player, WorldPacket& packet, bool& result
         if (lua_isuserdata(L, r + 1))
             if (WorldPacket* data = CHECKOBJ<WorldPacket>(L, r + 1, false))
             {
-                #ifdef VMANGOS
-                packet = std::move(*data);
-                #else
-                packet = *data;
-                #endif
+                // Returning the borrowed packet itself leaves it unchanged
+                if (data != &packet)
+                {
+                    #ifdef VMANGOS
+                    packet = std::move(*data);
+                    #else
+                    packet = *data;
+                    #endif
+                    rpos = packet.rpos();
+                }
             }
 
         lua_pop(L, 2);
     }
 
     CleanUpStack(2);
+    packet.rpos(rpos);
 }
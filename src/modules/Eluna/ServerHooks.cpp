@@ -20,7 +20,7 @@ using namespace Hooks;
     auto key = EventKey<ServerEvents>(EVENT);\
     if (!ServerEventBindings->HasBindingsFor(key))\
         return;\
-    LOCK_ELUNA
+    LOCK_ELUNA_STATE(this)
 
 #define START_HOOK_WITH_RETVAL(EVENT, RETVAL) \
     if (!IsEnabled())\
@@ -28,7 +28,7 @@ using namespace Hooks;
     auto key = EventKey<ServerEvents>(EVENT);\
     if (!ServerEventBindings->HasBindingsFor(key))\
         return RETVAL;\
-    LOCK_ELUNA
+    LOCK_ELUNA_STATE(this)
 
 bool Eluna::OnAddonMessage(Player* sender, uint32 type, std::string& msg, Player* receiver, Guild* guild, Group* group, Channel* channel)
 {
@@ -66,7 +66,7 @@ bool Eluna::OnAddonMessage(Player* sender, uint32 type, std::string& msg, Player
 
 void Eluna::OnTimedEvent(int funcRef, uint32 delay, uint32 calls, WorldObject* obj)
 {
-    LOCK_ELUNA;
+    LOCK_ELUNA_STATE(this);
     ASSERT(!event_level);
 
     // Get function
@@ -299,12 +299,22 @@ void Eluna::OnWorldUpdate(uint32 diff)
     }
 
     eventMgr->globalProcessor->Update(diff);
+    ProcessStateMessages();
 
     START_HOOK(WORLD_EVENT_ON_UPDATE);
     Push(diff);
     CallAllFunctions(ServerEventBindings, key);
 }
 
+void Eluna::OnStateMessage(StateMessage const& message)
+{
+    START_HOOK(ELUNA_EVENT_ON_STATE_MESSAGE);
+    Push(message.senderMapId);
+    Push(message.senderInstanceId);
+    Push(message.message);
+    CallAllFunctions(ServerEventBindings, key);
+}
+
 void Eluna::OnStartup()
 {
     START_HOOK(WORLD_EVENT_ON_STARTUP);
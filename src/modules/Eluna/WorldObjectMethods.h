@@ -861,6 +861,10 @@ namespace LuaWorldObject
         if (min > max)
             return luaL_argerror(L, 3, "min is bigger than max delay");
 
+        // The events of an object run in the state of its map (Eluna.PerMapStates), the function must live there
+        if (!obj->elunaEvents || Eluna::GetEluna(L) != obj->elunaEvents->GetEluna())
+            return luaL_error(L, "RegisterEvent: the object belongs to the Lua state of another map");
+
         lua_pushvalue(L, 2);
         int functionRef = luaL_ref(L, LUA_REGISTRYINDEX);
         if (functionRef != LUA_REFNIL && functionRef != LUA_NOREF)
@@ -879,6 +883,9 @@ namespace LuaWorldObject
     int RemoveEventById(lua_State* L, WorldObject* obj)
     {
         int eventId = Eluna::CHECKVAL<int>(L, 2);
+        // Event ids are references of the state that registered them
+        if (!obj->elunaEvents || Eluna::GetEluna(L) != obj->elunaEvents->GetEluna())
+            return luaL_error(L, "RemoveEventById: the object belongs to the Lua state of another map");
         obj->elunaEvents->SetState(eventId, LUAEVENT_STATE_ABORT);
         return 0;
     }
@@ -7,6 +7,17 @@
 #ifndef WORLDPACKETMETHODS_H
 #define WORLDPACKETMETHODS_H
 
+// Packets of the packet hooks are borrowed from the core, the first change is made on a copy
+static WorldPacket* GetWritablePacket(lua_State* L, WorldPacket* packet)
+{
+    ElunaObject* obj = Eluna::CHECKOBJ<ElunaObject>(L, 1);
+    if (!obj->IsBorrowed())
+        return packet;
+
+    obj->Materialize();
+    return static_cast<WorldPacket*>(obj->GetObj());
+}
+
 /***
  * A packet used to pass messages between the server and a client.
  *
@@ -49,6 +60,7 @@ namespace LuaPacket
      */
     int SetOpcode(lua_State* L, WorldPacket* packet)
     {
+        packet = GetWritablePacket(L, packet);
         uint32 opcode = Eluna::CHECKVAL<uint32>(L, 2);
         if (opcode >= NUM_MSG_TYPES)
             return luaL_argerror(L, 2, "valid opcode expected");
@@ -193,6 +205,7 @@ namespace LuaPacket
      */
     int WriteGUID(lua_State* L, WorldPacket* packet)
     {
+        packet = GetWritablePacket(L, packet);
         uint64 guid = Eluna::CHECKVAL<uint64>(L, 2);
         (*packet) << guid;
         return 0;
@@ -205,6 +218,7 @@ namespace LuaPacket
      */
     int WriteString(lua_State* L, WorldPacket* packet)
     {
+        packet = GetWritablePacket(L, packet);
         std::string _val = Eluna::CHECKVAL<std::string>(L, 2);
         (*packet) << _val;
         return 0;
@@ -217,6 +231,7 @@ namespace LuaPacket
      */
     int WriteByte(lua_State* L, WorldPacket* packet)
     {
+        packet = GetWritablePacket(L, packet);
         int8 byte = Eluna::CHECKVAL<int8>(L, 2);
         (*packet) << byte;
         return 0;
@@ -229,6 +244,7 @@ namespace LuaPacket
      */
     int WriteUByte(lua_State* L, WorldPacket* packet)
     {
+        packet = GetWritablePacket(L, packet);
         uint8 byte = Eluna::CHECKVAL<uint8>(L, 2);
         (*packet) << byte;
         return 0;
@@ -241,6 +257,7 @@ namespace LuaPacket
      */
     int WriteShort(lua_State* L, WorldPacket* packet)
     {
+        packet = GetWritablePacket(L, packet);
         int16 _short = Eluna::CHECKVAL<int16>(L, 2);
         (*packet) << _short;
         return 0;
@@ -253,6 +270,7 @@ namespace LuaPacket
      */
     int WriteUShort(lua_State* L, WorldPacket* packet)
     {
+        packet = GetWritablePacket(L, packet);
         uint16 _ushort = Eluna::CHECKVAL<uint16>(L, 2);
         (*packet) << _ushort;
         return 0;
@@ -265,6 +283,7 @@ namespace LuaPacket
      */
     int WriteLong(lua_State* L, WorldPacket* packet)
     {
+        packet = GetWritablePacket(L, packet);
         int32 _long = Eluna::CHECKVAL<int32>(L, 2);
         (*packet) << _long;
         return 0;
@@ -277,6 +296,7 @@ namespace LuaPacket
      */
     int WriteULong(lua_State* L, WorldPacket* packet)
     {
+        packet = GetWritablePacket(L, packet);
         uint32 _ulong = Eluna::CHECKVAL<uint32>(L, 2);
         (*packet) << _ulong;
         return 0;
@@ -289,6 +309,7 @@ namespace LuaPacket
      */
     int WriteFloat(lua_State* L, WorldPacket* packet)
     {
+        packet = GetWritablePacket(L, packet);
         float _val = Eluna::CHECKVAL<float>(L, 2);
         (*packet) << _val;
         return 0;
@@ -301,6 +322,7 @@ namespace LuaPacket
      */
     int WriteDouble(lua_State* L, WorldPacket* packet)
     {
+        packet = GetWritablePacket(L, packet);
         double _val = Eluna::CHECKVAL<double>(L, 2);
         (*packet) << _val;
         return 0;
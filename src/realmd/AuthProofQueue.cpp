@@ -0,0 +1,118 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** \file
+    \ingroup realmd
+*/
+
+#include "AuthProofQueue.h"
+#include "AuthSocket.h"
+#include "Log.h"
+#include "ThreadPool.h"
+
+#include <chrono>
+
+AuthProofQueue::AuthProofQueue()
+{
+}
+
+AuthProofQueue::~AuthProofQueue()
+{
+    Stop();
+}
+
+AuthProofQueue& sAuthProofQueue
+{
+    static AuthProofQueue proofQueue;
+    return proofQueue;
+}
+
+void AuthProofQueue::Initialize(uint32 threads)
+{
+    if (!threads || IsEnabled())
+        return;
+
+    m_pool.reset(new ThreadPool(threads));
+    m_pool->start();
+    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Logon proofs computed by %u worker threads", threads);
+}
+
+void AuthProofQueue::Stop()
+{
+    if (m_done.valid())
+        m_done.wait();
+    m_done = std::future<void>();
+
+    m_pool.reset();
+    m_queued.clear();
+    m_running.clear();
+}
+
+void AuthProofQueue::Add(LogonProofJob const& job)
+{
+    m_queued.push_back(job);
+}
+
+void AuthProofQueue::Run(LogonProofJob& job)
+{
+    job.validKey = job.srp.CalculateSessionKey(job.A, sizeof(job.A));
+    if (!job.validKey)
+        return;
+
+    job.srp.HashSessionKey();
+    job.srp.CalculateProof(job.login);
+    // SRP6::Proof returns false when the proofs match
+    job.proofMatches = !job.srp.Proof(job.M1, sizeof(job.M1));
+}
+
+void AuthProofQueue::Update()
+{
+    if (!IsEnabled())
+        return;
+
+    if (m_done.valid())
+    {
+        if (m_done.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return;
+
+        m_done.get();
+        for (LogonProofJob const& job : m_running)
+            AuthSocket::OnLogonProofComputed(job);
+        m_running.clear();
+    }
+
+    if (m_queued.empty())
+        return;
+
+    m_running.swap(m_queued);
+
+    ThreadPool::workload_t workload;
+    workload.reserve(m_running.size());
+    for (LogonProofJob& job : m_running)
+        workload.emplace_back([&job]() { Run(job); });
+
+    m_done = m_pool->processWorkload(std::move(workload));
+    if (m_done.valid())
+        return;
+
+    // The pool did not take the workload
+    for (LogonProofJob& job : m_running)
+    {
+        Run(job);
+        AuthSocket::OnLogonProofComputed(job);
+    }
+    m_running.clear();
+}
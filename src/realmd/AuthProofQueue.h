@@ -0,0 +1,85 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// \addtogroup realmd
+// @{
+// \file
+
+#ifndef _AUTHPROOFQUEUE_H
+#define _AUTHPROOFQUEUE_H
+
+#include "Common.h"
+#include "SRP6/SRP6.h"
+
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// SRP6 computation of a logon proof, on a copy of the SRP6 state of the socket
+struct LogonProofJob
+{
+    uint32 socketId;
+    SRP6 srp;
+    uint8 A[32];                                            // Client public ephemeral
+    uint8 M1[20];                                           // Client proof
+    std::string login;
+
+    bool validKey = false;                                  // Results, A passed the SRP6 safeguards
+    bool proofMatches = false;
+};
+
+/**
+ * @brief Runs the modular exponentiations of the logon proofs (session key and
+ * proof of the client) on worker threads, off the network thread
+ * (ProofWorkerThreads).
+ * The proofs received during a loop of the network thread are processed as one
+ * workload of the pool while the reactor goes on, and the next loop hands the
+ * results back to their sockets, found again by id.
+ */
+class AuthProofQueue
+{
+    public:
+        static AuthProofQueue& Instance();
+
+        AuthProofQueue();
+        ~AuthProofQueue();
+
+        // threads 0 keeps the proofs on the network thread
+        void Initialize(uint32 threads);
+        void Stop();
+
+        bool IsEnabled() const { return m_pool != nullptr; }
+
+        void Add(LogonProofJob const& job);
+        // Called by the network thread, applies the finished proofs and starts the queued ones
+        void Update();
+
+        static void Run(LogonProofJob& job);
+
+    private:
+        std::unique_ptr<ThreadPool> m_pool;
+        std::vector<LogonProofJob> m_queued;
+        std::vector<LogonProofJob> m_running;               // Owned by the pool until m_done is ready
+        std::future<void> m_done;
+};
+
+#define sAuthProofQueue AuthProofQueue::Instance()
+
+#endif
+// @}
@@ -27,11 +27,13 @@
 #include "Auth/Hmac.h"
 #include "Auth/base32.h"
 #include "Database/DatabaseEnv.h"
+#include "Database/DatabaseImpl.h"
 #include "Config/Config.h"
 #include "Log.h"
 #include "RealmList.h"
 #include "AuthSocket.h"
 #include "AuthCodes.h"
+#include "AuthProofQueue.h"
 #include "PatchHandler.h"
 #include "Util.h"
 
@@ -183,11 +185,69 @@ typedef struct AuthHandler
 
 std::array<uint8, 16> VersionChallenge = { { 0xBA, 0xA3, 0x1E, 0x99, 0xA0, 0x0B, 0x21, 0x57, 0xFC, 0x37, 0x3F, 0xB3, 0x69, 0xCD, 0xD2, 0xF1 } };
 
+// Queries of the logon challenge holder
+enum LogonChallengeQuery
+{
+    LOGON_CHALLENGE_ACCOUNT,
+    LOGON_CHALLENGE_ACCOUNT_BAN,
+    LOGON_CHALLENGE_ACCOUNT_ACCESS,
+    LOGON_CHALLENGE_IP_BAN,                                 // Only without the IP ban cache
+
+    LOGON_CHALLENGE_QUERY_COUNT
+};
+
+// Queries of the wrong password holder, run in this order on the same connection
+enum WrongPasswordQuery
+{
+    WRONG_PASSWORD_INCREMENT,
+    WRONG_PASSWORD_ACCOUNT,
+
+    WRONG_PASSWORD_QUERY_COUNT
+};
+
+class WrongPasswordQueryHolder : public SqlQueryHolder
+{
+    public:
+        WrongPasswordQueryHolder(uint32 socketId, std::string const& login, std::string const& address)
+            : SqlQueryHolder(socketId), m_login(login), m_address(address) {}
+
+        std::string const& GetLogin() const { return m_login; }
+        std::string const& GetAddress() const { return m_address; }
+
+    private:
+        std::string m_login;
+        std::string m_address;
+};
+
+std::unordered_map<uint32, AuthSocket*> AuthSocket::s_sockets;
+uint32 AuthSocket::s_nextSocketId = 0;
+
 // Close patch file descriptor before leaving
 AuthSocket::~AuthSocket()
 {
     if(m_patch != ACE_INVALID_HANDLE)
         ACE_OS::close(m_patch);
+
+    if (m_socketId)
+        s_sockets.erase(m_socketId);
+}
+
+AuthSocket* AuthSocket::FindSocket(uint32 socketId)
+{
+    auto itr = s_sockets.find(socketId);
+    return itr != s_sockets.end() ? itr->second : nullptr;
+}
+
+void AuthSocket::ResumeRead(bool handled)
+{
+    if (!handled)
+    {
+        sLog.Out(LOG_BASIC, LOG_LVL_DEBUG, "[Auth] Deferred command handler failed for '%s'", get_remote_address().c_str());
+        close_connection();
+        return;
+    }
+
+    process_input();
 }
 
 AccountTypes AuthSocket::GetSecurityOn(uint32 realmId) const
@@ -201,6 +261,11 @@ AccountTypes AuthSocket::GetSecurityOn(uint32 realmId) const
 // Accept the connection and set the s random value for SRP6
 void AuthSocket::OnAccept()
 {
+    if (!++s_nextSocketId)
+        ++s_nextSocketId;
+    m_socketId = s_nextSocketId;
+    s_sockets[m_socketId] = this;
+
     sLog.Out(LOG_BASIC, LOG_LVL_BASIC, "Accepting connection from '%s'", get_remote_address().c_str());
 }
 
@@ -221,7 +286,8 @@ void AuthSocket::OnRead()
     };
 
     uint8 _cmd;
-    while (1)
+    // A handler waiting for a result leaves the next commands in the buffer, ResumeRead handles them
+    while (!m_pending)
     {
         if(!recv_soft((char *)&_cmd, 1))
             return;
@@ -343,8 +409,6 @@ bool AuthSocket::_HandleLogonChallenge()
     EndianConvert(ch->timezone_bias);
     EndianConvert(ch->ip);
 
-    ByteBuffer pkt;
-
     m_login = (const char*)ch->I;
     m_build = ch->build;
 
@@ -356,6 +420,10 @@ bool AuthSocket::_HandleLogonChallenge()
     std::reverse(ch->platform, ch->platform + 3);
     memcpy(&m_platform, ch->platform, sizeof(m_platform));
 
+    m_localizationName.resize(4);
+    for(int i = 0; i < 4; ++i)
+        m_localizationName[i] = ch->country[4-i-1];
+
     // Normalize account name
     // utf8ToUpperOnlyLatin(m_login); -- client already send account in expected form
 
@@ -364,184 +432,218 @@ bool AuthSocket::_HandleLogonChallenge()
     m_safelogin = m_login;
     LoginDatabase.escape_string(m_safelogin);
 
+    // Verify that this IP is not in the ip_banned table
+    if (sLoginCache.IsIpBanCacheEnabled() && sLoginCache.IsIpBanned(get_remote_address(), time(nullptr)))
+    {
+        ByteBuffer pkt;
+        pkt << (uint8) CMD_AUTH_LOGON_CHALLENGE;
+        pkt << (uint8) 0x00;
+        pkt << (uint8) WOW_FAIL_DB_BUSY;
+        sLog.Out(LOG_BASIC, LOG_LVL_BASIC, "[AuthChallenge] Banned ip '%s' tries to login with account '%s'!", get_remote_address().c_str(), m_login.c_str());
+        send((char const*)pkt.contents(), pkt.size());
+        return true;
+    }
+
+    // Get the account details, bans and security levels, the reply is sent once the delay thread read them
+    // No SQL injection (escaped user name)
+    SqlQueryHolder* holder = new SqlQueryHolder(m_socketId);
+    holder->SetSize(LOGON_CHALLENGE_QUERY_COUNT);
+    //                                                               0     1         2          3    4    5           6              7              8       9
+    holder->SetPQuery(LOGON_CHALLENGE_ACCOUNT, "SELECT `id`, `locked`, `last_ip`, `v`, `s`, `security`, `email_verif`, `geolock_pin`, `email`, UNIX_TIMESTAMP(`joindate`) FROM `account` WHERE `username` = '%s'", m_safelogin.c_str());
+    holder->SetPQuery(LOGON_CHALLENGE_ACCOUNT_BAN, "SELECT `account_banned`.`bandate`, `account_banned`.`unbandate` FROM `account_banned` JOIN `account` ON `account`.`id` = `account_banned`.`id` WHERE "
+        "`account`.`username` = '%s' AND `account_banned`.`active` = 1 AND (`account_banned`.`unbandate` > UNIX_TIMESTAMP() OR `account_banned`.`unbandate` = `account_banned`.`bandate`) LIMIT 1", m_safelogin.c_str());
+    holder->SetPQuery(LOGON_CHALLENGE_ACCOUNT_ACCESS, "SELECT `account_access`.`gmlevel`, `account_access`.`RealmID` FROM `account_access` JOIN `account` ON `account`.`id` = `account_access`.`id` WHERE `account`.`username` = '%s'",
+        m_safelogin.c_str());
+    if (!sLoginCache.IsIpBanCacheEnabled())
+    {
+        // No SQL injection possible (paste the IP address as passed by the socket)
+        std::string address = get_remote_address();
+        LoginDatabase.escape_string(address);
+        holder->SetPQuery(LOGON_CHALLENGE_IP_BAN, "SELECT `unbandate` FROM `ip_banned` WHERE "
+        //    permanent                    still banned
+            "(`unbandate` = `bandate` OR `unbandate` > UNIX_TIMESTAMP()) AND `ip` = '%s'", address.c_str());
+    }
+
+    if (!LoginDatabase.DelayQueryHolderUnsafe(&AuthSocket::LogonChallengeCallback, holder, m_socketId))
+    {
+        delete holder;
+        return false;
+    }
+
+    m_pending = true;
+    return true;
+}
+
+void AuthSocket::LogonChallengeCallback(QueryResult* /*dummy*/, SqlQueryHolder* holder, uint32 socketId)
+{
+    if (AuthSocket* socket = FindSocket(socketId))
+    {
+        socket->m_pending = false;
+        bool const handled = socket->HandleLogonChallengeResult(holder);
+        socket->ResumeRead(handled);
+    }
+
+    holder->DeleteAllResults();
+    delete holder;
+}
+
+bool AuthSocket::HandleLogonChallengeResult(SqlQueryHolder* holder)
+{
+    ByteBuffer pkt;
     pkt << (uint8) CMD_AUTH_LOGON_CHALLENGE;
     pkt << (uint8) 0x00;
 
-    // Verify that this IP is not in the ip_banned table
-    // No SQL injection possible (paste the IP address as passed by the socket)
-    std::string address = get_remote_address();
-    LoginDatabase.escape_string(address);
-    QueryResult *result = LoginDatabase.PQuery("SELECT `unbandate` FROM `ip_banned` WHERE "
-    //    permanent                    still banned
-        "(`unbandate` = `bandate` OR `unbandate` > UNIX_TIMESTAMP()) AND `ip` = '%s'", address.c_str());
-    if (result)
+    if (holder->GetResult(LOGON_CHALLENGE_IP_BAN))
     {
         pkt << (uint8)WOW_FAIL_DB_BUSY;
         sLog.Out(LOG_BASIC, LOG_LVL_BASIC, "[AuthChallenge] Banned ip '%s' tries to login with account '%s'!", get_remote_address().c_str(), m_login.c_str());
-        delete result;
     }
-    else
+    else if (QueryResult* result = holder->GetResult(LOGON_CHALLENGE_ACCOUNT))
     {
-        // Get the account details from the account table
-        // No SQL injection (escaped user name)
-        //                                     0     1         2          3    4    5           6              7              8       9
-        result = LoginDatabase.PQuery("SELECT `id`, `locked`, `last_ip`, `v`, `s`, `security`, `email_verif`, `geolock_pin`, `email`, UNIX_TIMESTAMP(`joindate`) FROM `account` WHERE `username` = '%s'",m_safelogin.c_str ());
-        if (result)
+        Field* fields = result->Fetch();
+
+        // Prevent login if the user's email address has not been verified
+        bool requireVerification = sConfig.GetBoolDefault("ReqEmailVerification", false);
+        int32 requireEmailSince = sConfig.GetIntDefault("ReqEmailSince", 0);
+        bool verified = (*result)[6].GetBool();
+
+        // Prevent login if the user's join date is bigger than the timestamp in configuration
+        if (requireEmailSince > 0)
         {
-            Field* fields = result->Fetch();
+            uint32 t = (*result)[9].GetUInt32();
+            requireVerification = requireVerification && (t >= uint32(requireEmailSince));
+        }
 
-            // Prevent login if the user's email address has not been verified
-            bool requireVerification = sConfig.GetBoolDefault("ReqEmailVerification", false);
-            int32 requireEmailSince = sConfig.GetIntDefault("ReqEmailSince", 0);
-            bool verified = (*result)[6].GetBool();
-            
-            // Prevent login if the user's join date is bigger than the timestamp in configuration
-            if (requireEmailSince > 0)
-            {
-                uint32 t = (*result)[9].GetUInt32();
-                requireVerification = requireVerification && (t >= uint32(requireEmailSince));
-            }
+        if (requireVerification && !verified)
+        {
+            sLog.Out(LOG_BASIC, LOG_LVL_BASIC, "[AuthChallenge] Account '%s' using IP '%s 'email address requires email verification - rejecting login", m_login.c_str(), get_remote_address().c_str());
+            pkt << (uint8)WOW_FAIL_UNKNOWN_ACCOUNT;
+            send((char const*)pkt.contents(), pkt.size());
+            return true;
+        }
 
-            if (requireVerification && !verified)
-            {
-                sLog.Out(LOG_BASIC, LOG_LVL_BASIC, "[AuthChallenge] Account '%s' using IP '%s 'email address requires email verification - rejecting login", m_login.c_str(), get_remote_address().c_str());
-                pkt << (uint8)WOW_FAIL_UNKNOWN_ACCOUNT;
-                send((char const*)pkt.contents(), pkt.size());
-                return true;
-            }
+        // If the IP is 'locked', check that the player comes indeed from the correct IP address
+        bool locked = false;
+        m_lockFlags = (LockFlag)(*result)[1].GetUInt32();
+        m_securityInfo = (*result)[5].GetCppString();
+        m_lastIP = fields[2].GetString();
+        m_geoUnlockPIN = fields[7].GetUInt32();
+        m_email = fields[8].GetCppString();
 
-            // If the IP is 'locked', check that the player comes indeed from the correct IP address
-            bool locked = false;
-            m_lockFlags = (LockFlag)(*result)[1].GetUInt32();
-            m_securityInfo = (*result)[5].GetCppString();
-            m_lastIP = fields[2].GetString();
-            m_geoUnlockPIN = fields[7].GetUInt32();
-            m_email = fields[8].GetCppString();
+        if (m_lockFlags & IP_LOCK)
+        {
+            sLog.Out(LOG_BASIC, LOG_LVL_DEBUG, "[AuthChallenge] Account '%s' is locked to IP - '%s'", m_login.c_str(), m_lastIP.c_str());
+            sLog.Out(LOG_BASIC, LOG_LVL_DEBUG, "[AuthChallenge] Player address is '%s'", get_remote_address().c_str());
 
-            if (m_lockFlags & IP_LOCK)
+            if (m_lastIP != get_remote_address())
             {
-                sLog.Out(LOG_BASIC, LOG_LVL_DEBUG, "[AuthChallenge] Account '%s' is locked to IP - '%s'", m_login.c_str(), m_lastIP.c_str());
-                sLog.Out(LOG_BASIC, LOG_LVL_DEBUG, "[AuthChallenge] Player address is '%s'", get_remote_address().c_str());
-
-                if (m_lastIP != get_remote_address())
-                {
-                    sLog.Out(LOG_BASIC, LOG_LVL_DEBUG, "[AuthChallenge] Account IP differs");
+                sLog.Out(LOG_BASIC, LOG_LVL_DEBUG, "[AuthChallenge] Account IP differs");
 
-                    // account is IP locked and the player does not have 2FA enabled
-                    if (((m_lockFlags & TOTP) != TOTP && (m_lockFlags & FIXED_PIN) != FIXED_PIN))
-                        pkt << (uint8) WOW_FAIL_SUSPENDED;
+                // account is IP locked and the player does not have 2FA enabled
+                if (((m_lockFlags & TOTP) != TOTP && (m_lockFlags & FIXED_PIN) != FIXED_PIN))
+                    pkt << (uint8) WOW_FAIL_SUSPENDED;
 
-                    locked = true;
-                }
-                else
-                {
-                    sLog.Out(LOG_BASIC, LOG_LVL_DEBUG, "[AuthChallenge] Account IP matches");
-                }
+                locked = true;
             }
             else
             {
-                sLog.Out(LOG_BASIC, LOG_LVL_DEBUG, "[AuthChallenge] Account '%s' is not locked to ip", m_login.c_str());
+                sLog.Out(LOG_BASIC, LOG_LVL_DEBUG, "[AuthChallenge] Account IP matches");
             }
+        }
+        else
+        {
+            sLog.Out(LOG_BASIC, LOG_LVL_DEBUG, "[AuthChallenge] Account '%s' is not locked to ip", m_login.c_str());
+        }
 
-            std::string databaseV = fields[3].GetCppString();
-            std::string databaseS = fields[4].GetCppString();
-            bool broken = false;
+        std::string databaseV = fields[3].GetCppString();
+        std::string databaseS = fields[4].GetCppString();
+        bool broken = false;
 
-            if (!srp.SetVerifier(databaseV.c_str()) || !srp.SetSalt(databaseS.c_str()))
-            {
-                pkt << (uint8)WOW_FAIL_FAIL_NOACCESS;
-                sLog.Out(LOG_BASIC, LOG_LVL_BASIC, "[AuthChallenge] Broken v/s values in database for account %s!", m_login.c_str());
-                broken = true;
-            }
+        if (!srp.SetVerifier(databaseV.c_str()) || !srp.SetSalt(databaseS.c_str()))
+        {
+            pkt << (uint8)WOW_FAIL_FAIL_NOACCESS;
+            sLog.Out(LOG_BASIC, LOG_LVL_BASIC, "[AuthChallenge] Broken v/s values in database for account %s!", m_login.c_str());
+            broken = true;
+        }
 
-            if ((!locked || (locked && (m_lockFlags & FIXED_PIN || m_lockFlags & TOTP))) && !broken)
+        if ((!locked || (locked && (m_lockFlags & FIXED_PIN || m_lockFlags & TOTP))) && !broken)
+        {
+            uint32 account_id = fields[0].GetUInt32();
+            // If the account is banned, reject the logon attempt
+            if (QueryResult* banresult = holder->GetResult(LOGON_CHALLENGE_ACCOUNT_BAN))
             {
-                uint32 account_id = fields[0].GetUInt32();
-                // If the account is banned, reject the logon attempt
-                QueryResult *banresult = LoginDatabase.PQuery("SELECT `bandate`, `unbandate` FROM `account_banned` WHERE "
-                    "`id` = %u AND `active` = 1 AND (`unbandate` > UNIX_TIMESTAMP() OR `unbandate` = `bandate`) LIMIT 1", account_id);
-                if (banresult)
+                if((*banresult)[0].GetUInt64() == (*banresult)[1].GetUInt64())
                 {
-                    if((*banresult)[0].GetUInt64() == (*banresult)[1].GetUInt64())
-                    {
-                        pkt << (uint8) WOW_FAIL_BANNED;
-                        sLog.Out(LOG_BASIC, LOG_LVL_BASIC, "[AuthChallenge] Banned account '%s' using IP '%s' tries to login!",m_login.c_str (), get_remote_address().c_str());
-                    }
-                    else
-                    {
-                        pkt << (uint8) WOW_FAIL_SUSPENDED;
-                        sLog.Out(LOG_BASIC, LOG_LVL_BASIC, "[AuthChallenge] Temporarily banned account '%s' using IP '%s' tries to login!",m_login.c_str (), get_remote_address().c_str());
-                    }
-
-                    delete banresult;
+                    pkt << (uint8) WOW_FAIL_BANNED;
+                    sLog.Out(LOG_BASIC, LOG_LVL_BASIC, "[AuthChallenge] Banned account '%s' using IP '%s' tries to login!",m_login.c_str (), get_remote_address().c_str());
                 }
                 else
                 {
-                    sLog.Out(LOG_BASIC, LOG_LVL_DEBUG, "database authentication values: v='%s' s='%s'", databaseV.c_str(), databaseS.c_str());
-
-                    BigNumber s;
-                    s.SetHexStr(databaseS.c_str());
+                    pkt << (uint8) WOW_FAIL_SUSPENDED;
+                    sLog.Out(LOG_BASIC, LOG_LVL_BASIC, "[AuthChallenge] Temporarily banned account '%s' using IP '%s' tries to login!",m_login.c_str (), get_remote_address().c_str());
+                }
+            }
+            else
+            {
+                sLog.Out(LOG_BASIC, LOG_LVL_DEBUG, "database authentication values: v='%s' s='%s'", databaseV.c_str(), databaseS.c_str());
 
-                    srp.CalculateHostPublicEphemeral();
+                BigNumber s;
+                s.SetHexStr(databaseS.c_str());
 
-                    // Fill the response packet with the result
-                    pkt << uint8(WOW_SUCCESS);
+                srp.CalculateHostPublicEphemeral();
 
-                    // B may be calculated < 32B so we force minimal length to 32B
-                    pkt.append(srp.GetHostPublicEphemeral().AsByteArray(32).data(), 32); // 32 bytes
-                    pkt << uint8(1);
-                    pkt.append(srp.GetGeneratorModulo().AsByteArray().data(), 1);
-                    pkt << uint8(32);
-                    pkt.append(srp.GetPrime().AsByteArray(32).data(), 32);
-                    pkt.append(s.AsByteArray());        // 32 bytes
-                    pkt.append(VersionChallenge.data(), VersionChallenge.size());
+                // Fill the response packet with the result
+                pkt << uint8(WOW_SUCCESS);
 
-                    // figure out whether we need to display the PIN grid
-                    m_promptPin = locked; // always prompt if the account is IP locked & 2FA is enabled
+                // B may be calculated < 32B so we force minimal length to 32B
+                pkt.append(srp.GetHostPublicEphemeral().AsByteArray(32).data(), 32); // 32 bytes
+                pkt << uint8(1);
+                pkt.append(srp.GetGeneratorModulo().AsByteArray().data(), 1);
+                pkt << uint8(32);
+                pkt.append(srp.GetPrime().AsByteArray(32).data(), 32);
+                pkt.append(s.AsByteArray());        // 32 bytes
+                pkt.append(VersionChallenge.data(), VersionChallenge.size());
 
-                    if ((!locked && ((m_lockFlags & ALWAYS_ENFORCE) == ALWAYS_ENFORCE)) || m_geoUnlockPIN)
-                    {
-                        m_promptPin = true; // prompt if the lock hasn't been triggered but ALWAYS_ENFORCE is set
-                    }
+                // figure out whether we need to display the PIN grid
+                m_promptPin = locked; // always prompt if the account is IP locked & 2FA is enabled
 
-                    if (m_promptPin)
-                    {
-                        sLog.Out(LOG_BASIC, LOG_LVL_BASIC, "[AuthChallenge] Account '%s' using IP '%s' requires PIN authentication", m_login.c_str(), get_remote_address().c_str());
+                if ((!locked && ((m_lockFlags & ALWAYS_ENFORCE) == ALWAYS_ENFORCE)) || m_geoUnlockPIN)
+                {
+                    m_promptPin = true; // prompt if the lock hasn't been triggered but ALWAYS_ENFORCE is set
+                }
 
-                        uint32 gridSeedPkt = m_gridSeed = static_cast<uint32>(rand32());
-                        EndianConvert(gridSeedPkt);
-                        m_serverSecuritySalt.SetRand(16 * 8); // 16 bytes random
+                if (m_promptPin)
+                {
+                    sLog.Out(LOG_BASIC, LOG_LVL_BASIC, "[AuthChallenge] Account '%s' using IP '%s' requires PIN authentication", m_login.c_str(), get_remote_address().c_str());
 
-                        pkt << uint8(1); // securityFlags, only '1' is available in classic (PIN input)
-                        pkt << gridSeedPkt;
-                        pkt.append(m_serverSecuritySalt.AsByteArray(16).data(), 16);
-                    }
-                    else
-                    {
-                        if (m_build >= 5428)        // version 1.11.0 or later
-                            pkt << uint8(0);
-                    }
+                    uint32 gridSeedPkt = m_gridSeed = static_cast<uint32>(rand32());
+                    EndianConvert(gridSeedPkt);
+                    m_serverSecuritySalt.SetRand(16 * 8); // 16 bytes random
 
-                    m_localizationName.resize(4);
-                    for(int i = 0; i < 4; ++i)
-                        m_localizationName[i] = ch->country[4-i-1];
+                    pkt << uint8(1); // securityFlags, only '1' is available in classic (PIN input)
+                    pkt << gridSeedPkt;
+                    pkt.append(m_serverSecuritySalt.AsByteArray(16).data(), 16);
+                }
+                else
+                {
+                    if (m_build >= 5428)        // version 1.11.0 or later
+                        pkt << uint8(0);
+                }
 
-                    LoadAccountSecurityLevels(account_id);
-                    sLog.Out(LOG_BASIC, LOG_LVL_BASIC, "[AuthChallenge] Account '%s' using IP '%s' is using '%c%c%c%c' locale (%u)", m_login.c_str (), get_remote_address().c_str(), ch->country[3], ch->country[2], ch->country[1], ch->country[0], GetLocaleByName(m_localizationName));
+                LoadAccountSecurityLevels(holder->GetResult(LOGON_CHALLENGE_ACCOUNT_ACCESS));
+                sLog.Out(LOG_BASIC, LOG_LVL_BASIC, "[AuthChallenge] Account '%s' using IP '%s' is using '%s' locale (%u)", m_login.c_str (), get_remote_address().c_str(), m_localizationName.c_str(), GetLocaleByName(m_localizationName));
 
-                    m_accountId = account_id;
+                m_accountId = account_id;
 
-                    // All good, await client's proof
-                    m_status = STATUS_LOGON_PROOF;
-                }
+                // All good, await client's proof
+                m_status = STATUS_LOGON_PROOF;
             }
-            delete result;
-        }
-        else                                                // no account
-        {
-            pkt<< (uint8) WOW_FAIL_UNKNOWN_ACCOUNT;
         }
     }
+    else                                                    // no account
+    {
+        pkt<< (uint8) WOW_FAIL_UNKNOWN_ACCOUNT;
+    }
     send((char const*)pkt.contents(), pkt.size());
     return true;
 }
@@ -644,24 +746,60 @@ bool AuthSocket::_HandleLogonProof()
     }
     // </ul>
 
+    // Kept for the checks done once the proof is computed
+    memcpy(m_versionProof, lp.crc_hash, sizeof(m_versionProof));
+    m_pinReceived = lp.securityFlags != 0;
+    if (m_pinReceived)
+        m_pinData = pinData;
+
     // Continue the SRP6 calculation based on data received from the client
-    if (!srp.CalculateSessionKey(lp.A, 32))
+    LogonProofJob job;
+    job.socketId = m_socketId;
+    job.srp = srp;
+    memcpy(job.A, lp.A, sizeof(job.A));
+    memcpy(job.M1, lp.M1, sizeof(job.M1));
+    job.login = m_login;
+
+    if (sAuthProofQueue.IsEnabled())
+    {
+        sAuthProofQueue.Add(job);
+        m_pending = true;
+        return true;
+    }
+
+    AuthProofQueue::Run(job);
+    return HandleLogonProofResult(job);
+}
+
+void AuthSocket::OnLogonProofComputed(LogonProofJob const& job)
+{
+    AuthSocket* socket = FindSocket(job.socketId);
+    if (!socket)
+        return;
+
+    socket->m_pending = false;
+    bool const handled = socket->HandleLogonProofResult(job);
+    socket->ResumeRead(handled);
+}
+
+bool AuthSocket::HandleLogonProofResult(LogonProofJob const& job)
+{
+    if (!job.validKey)
         return false;
 
-    srp.HashSessionKey();
-    srp.CalculateProof(m_login);
+    srp = job.srp;
 
     // Check PIN data is correct
     bool pinResult = true;
 
-    if (m_promptPin && !lp.securityFlags)
+    if (m_promptPin && !m_pinReceived)
         pinResult = false; // expected PIN data but did not receive it
 
-    if (m_promptPin && lp.securityFlags)
+    if (m_promptPin && m_pinReceived)
     {
         if ((m_lockFlags & FIXED_PIN) == FIXED_PIN)
         {
-            pinResult = VerifyPinData(std::stoi(m_securityInfo), pinData);
+            pinResult = VerifyPinData(std::stoi(m_securityInfo), m_pinData);
             sLog.Out(LOG_BASIC, LOG_LVL_BASIC, "[AuthChallenge] Account '%s' using IP '%s' PIN result: %u", m_login.c_str(), get_remote_address().c_str(), pinResult);
         }
         else if ((m_lockFlags & TOTP) == TOTP)
@@ -673,13 +811,13 @@ bool AuthSocket::_HandleLogonProof()
                 if (pin == uint32(-1))
                     break;
 
-                if ((pinResult = VerifyPinData(pin, pinData)))
+                if ((pinResult = VerifyPinData(pin, m_pinData)))
                     break;
             }
         }
         else if (m_geoUnlockPIN)
         {
-            pinResult = VerifyPinData(m_geoUnlockPIN, pinData);
+            pinResult = VerifyPinData(m_geoUnlockPIN, m_pinData);
         }
         else
         {
@@ -689,9 +827,9 @@ bool AuthSocket::_HandleLogonProof()
     }
 
     // Check if SRP6 results match (password is correct), else send an error
-    if (!srp.Proof(lp.M1, 20) && pinResult)
+    if (job.proofMatches && pinResult)
     {
-        if (!VerifyVersion(lp.A, sizeof(lp.A), lp.crc_hash, false))
+        if (!VerifyVersion(job.A, sizeof(job.A), m_versionProof, false))
         {
             sLog.Out(LOG_BASIC, LOG_LVL_BASIC, "[AuthChallenge] Account %s tried to login with modified client!", m_login.c_str());
             char data[2] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_VERSION_INVALID };
@@ -759,21 +897,20 @@ bool AuthSocket::_HandleLogonProof()
         sLog.Out(LOG_BASIC, LOG_LVL_BASIC, "[AuthChallenge] Account '%s' using IP '%s' successfully authenticated", m_login.c_str(), get_remote_address().c_str());
 
         // Update the sessionkey, last_ip, last login time and reset number of failed logins in the account table for this account
+        // The proof is sent once the session key is written, mangosd reads it when the client connects
         // No SQL injection (escaped user name) and IP address as received by socket
         const char* K_hex = srp.GetStrongSessionKey().AsHexStr();
         const char *os = reinterpret_cast<char *>(&m_os); // no injection as there are only two possible values
         const char *platform = reinterpret_cast<char *>(&m_platform); // no injection as there are only two possible values
-        auto result = LoginDatabase.PQuery("UPDATE `account` SET `sessionkey` = '%s', `last_ip` = '%s', `last_login` = NOW(), `locale` = '%u', `failed_logins` = 0, `os` = '%s', `platform` = '%s' WHERE `username` = '%s'",
+        bool const queued = LoginDatabase.AsyncPQueryUnsafe(&AuthSocket::LogonProofSessionCallback, m_socketId,
+            "UPDATE `account` SET `sessionkey` = '%s', `last_ip` = '%s', `last_login` = NOW(), `locale` = '%u', `failed_logins` = 0, `os` = '%s', `platform` = '%s' WHERE `username` = '%s'",
             K_hex, get_remote_address().c_str(), GetLocaleByName(m_localizationName), os, platform, m_safelogin.c_str() );
-        delete result;
         OPENSSL_free((void*)K_hex);
 
-        // Finish SRP6 and send the final result to the client
-        Sha1Hash sha;
-        srp.Finalize(sha);
+        if (!queued)
+            return false;
 
-        SendProof(sha);
-        m_status = STATUS_AUTHED;
+        m_pending = true;
     }
     else
     {
@@ -793,43 +930,87 @@ bool AuthSocket::_HandleLogonProof()
         uint32 MaxWrongPassCount = sConfig.GetIntDefault("WrongPass.MaxCount", 0);
         if(MaxWrongPassCount > 0)
         {
-            //Increment number of failed logins by one and if it reaches the limit temporarily ban that account or IP
-            LoginDatabase.PExecute("UPDATE `account` SET `failed_logins` = `failed_logins` + 1 WHERE `username` = '%s'",m_safelogin.c_str());
+            // Counted, then read back on the same connection and checked against the limit in the callback:
+            // parallel wrong passwords of the account each see their own increment
+            WrongPasswordQueryHolder* holder = new WrongPasswordQueryHolder(m_socketId, m_login, get_remote_address());
+            holder->SetSize(WRONG_PASSWORD_QUERY_COUNT);
+            holder->SetPQuery(WRONG_PASSWORD_INCREMENT, "UPDATE `account` SET `failed_logins` = `failed_logins` + 1 WHERE `username` = '%s'", m_safelogin.c_str());
+            holder->SetPQuery(WRONG_PASSWORD_ACCOUNT, "SELECT `id`, `failed_logins` FROM `account` WHERE `username` = '%s'", m_safelogin.c_str());
+            if (!LoginDatabase.DelayQueryHolderUnsafe(&AuthSocket::WrongPasswordCallback, static_cast<SqlQueryHolder*>(holder), m_socketId))
+                delete holder;
+        }
+    }
+    return true;
+}
 
-            if(QueryResult *loginfail = LoginDatabase.PQuery("SELECT `id`, `failed_logins` FROM `account` WHERE `username` = '%s'", m_safelogin.c_str()))
-            {
-                Field* fields = loginfail->Fetch();
-                uint32 failed_logins = fields[1].GetUInt32();
+void AuthSocket::LogonProofSessionCallback(QueryResult* result, uint32 socketId)
+{
+    delete result;
 
-                if( failed_logins >= MaxWrongPassCount )
-                {
-                    uint32 WrongPassBanTime = sConfig.GetIntDefault("WrongPass.BanTime", 600);
-                    bool WrongPassBanType = sConfig.GetBoolDefault("WrongPass.BanType", false);
+    AuthSocket* socket = FindSocket(socketId);
+    if (!socket)
+        return;
 
-                    if(WrongPassBanType)
-                    {
-                        uint32 acc_id = fields[0].GetUInt32();
-                        LoginDatabase.PExecute("INSERT INTO `account_banned` (`id`, `bandate`, `unbandate`, `bannedby`, `banreason`, `active`, `realm`) "
-                            "VALUES ('%u',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban',1,1)",
-                            acc_id, WrongPassBanTime);
-                        sLog.Out(LOG_BASIC, LOG_LVL_BASIC, "[AuthChallenge] Account '%s' using  IP '%s' got banned for '%u' seconds because it failed to authenticate '%u' times",
-                            m_login.c_str(), get_remote_address().c_str(), WrongPassBanTime, failed_logins);
-                    }
-                    else
-                    {
-                        std::string current_ip = get_remote_address();
-                        LoginDatabase.escape_string(current_ip);
-                        LoginDatabase.PExecute("INSERT INTO `ip_banned` VALUES ('%s',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban')",
-                            current_ip.c_str(), WrongPassBanTime);
-                        sLog.Out(LOG_BASIC, LOG_LVL_BASIC, "[AuthChallenge] IP '%s' got banned for '%u' seconds because account '%s' failed to authenticate '%u' times",
-                            current_ip.c_str(), WrongPassBanTime, m_login.c_str(), failed_logins);
-                    }
-                }
-                delete loginfail;
-            }
-        }
+    // Finish SRP6 and send the final result to the client
+    Sha1Hash sha;
+    socket->srp.Finalize(sha);
+
+    socket->SendProof(sha);
+    socket->m_status = STATUS_AUTHED;
+    socket->m_pending = false;
+    socket->ResumeRead(true);
+}
+
+void AuthSocket::WrongPasswordCallback(QueryResult* /*dummy*/, SqlQueryHolder* queryHolder, uint32 /*socketId*/)
+{
+    WrongPasswordQueryHolder* holder = static_cast<WrongPasswordQueryHolder*>(queryHolder);
+    std::string const login = holder->GetLogin();
+    std::string const address = holder->GetAddress();
+
+    // The number of failed logins, incremented by this one: if it reaches the limit temporarily ban that account or IP
+    QueryResult* result = holder->GetResult(WRONG_PASSWORD_ACCOUNT);
+    bool const found = result != nullptr;
+    uint32 acc_id = 0;
+    uint32 failed_logins = 0;
+    if (found)
+    {
+        Field* fields = result->Fetch();
+        acc_id = fields[0].GetUInt32();
+        failed_logins = fields[1].GetUInt32();
+    }
+    holder->DeleteAllResults();
+    delete holder;
+
+    if (!found)
+        return;
+
+    uint32 MaxWrongPassCount = sConfig.GetIntDefault("WrongPass.MaxCount", 0);
+    if (!MaxWrongPassCount || failed_logins < MaxWrongPassCount)
+        return;
+
+    uint32 WrongPassBanTime = sConfig.GetIntDefault("WrongPass.BanTime", 600);
+    bool WrongPassBanType = sConfig.GetBoolDefault("WrongPass.BanType", false);
+
+    if(WrongPassBanType)
+    {
+        LoginDatabase.PExecute("INSERT INTO `account_banned` (`id`, `bandate`, `unbandate`, `bannedby`, `banreason`, `active`, `realm`) "
+            "VALUES ('%u',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban',1,1)",
+            acc_id, WrongPassBanTime);
+        sLog.Out(LOG_BASIC, LOG_LVL_BASIC, "[AuthChallenge] Account '%s' using  IP '%s' got banned for '%u' seconds because it failed to authenticate '%u' times",
+            login.c_str(), address.c_str(), WrongPassBanTime, failed_logins);
+    }
+    else
+    {
+        // Applies at once, without waiting for the next reload of the IP bans
+        sLoginCache.AddIpBan(address, WrongPassBanTime ? uint32(time(nullptr)) + WrongPassBanTime : 0);
+
+        std::string current_ip = address;
+        LoginDatabase.escape_string(current_ip);
+        LoginDatabase.PExecute("INSERT INTO `ip_banned` VALUES ('%s',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban')",
+            current_ip.c_str(), WrongPassBanTime);
+        sLog.Out(LOG_BASIC, LOG_LVL_BASIC, "[AuthChallenge] IP '%s' got banned for '%u' seconds because account '%s' failed to authenticate '%u' times",
+            current_ip.c_str(), WrongPassBanTime, login.c_str(), failed_logins);
     }
-    return true;
 }
 
 // Reconnect Challenge command handler
@@ -880,20 +1061,38 @@ bool AuthSocket::_HandleReconnectChallenge()
     m_safelogin = m_login;
     LoginDatabase.escape_string(m_safelogin);
 
-    QueryResult *result = LoginDatabase.PQuery ("SELECT `sessionkey`, `id` FROM `account` WHERE `username` = '%s'", m_safelogin.c_str ());
+    if (!LoginDatabase.AsyncPQueryUnsafe(&AuthSocket::ReconnectChallengeCallback, m_socketId,
+        "SELECT `sessionkey`, `id` FROM `account` WHERE `username` = '%s'", m_safelogin.c_str()))
+        return false;
+
+    m_pending = true;
+    return true;
+}
+
+void AuthSocket::ReconnectChallengeCallback(QueryResult* result, uint32 socketId)
+{
+    if (AuthSocket* socket = FindSocket(socketId))
+    {
+        socket->m_pending = false;
+        bool const handled = socket->HandleReconnectChallengeResult(result);
+        socket->ResumeRead(handled);
+    }
 
+    delete result;
+}
+
+bool AuthSocket::HandleReconnectChallengeResult(QueryResult* result)
+{
     // Stop if the account is not found
     if (!result)
     {
         sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "[ERROR] user %s tried to login and we cannot find his session key in the database.", m_login.c_str());
-        close_connection();
         return false;
     }
 
     Field* fields = result->Fetch ();
     srp.SetStrongSessionKey(fields[0].GetString());
     m_accountId = fields[1].GetUInt32();
-    delete result;
 
     // All good, await client's proof
     m_status = STATUS_RECON_PROOF;
@@ -991,9 +1190,53 @@ bool AuthSocket::_HandleRealmList()
     // Update realm list if need
     sRealmList.UpdateIfNeed();
 
+    RealmCharacterCounts characterCounts;
+    if (sLoginCache.FindRealmCharacters(m_accountId, now, characterCounts))
+    {
+        SendRealmList(characterCounts);
+        return true;
+    }
+
+    // Characters of the account on every realm at once
+    // No SQL injection. id of account is controlled by the database.
+    if (!LoginDatabase.AsyncPQueryUnsafe(&AuthSocket::RealmListCallback, m_socketId, m_accountId,
+        "SELECT `realmid`, `numchars` FROM `realmcharacters` WHERE `acctid` = '%u'", m_accountId))
+        return false;
+
+    m_pending = true;
+    return true;
+}
+
+void AuthSocket::RealmListCallback(QueryResult* result, uint32 socketId, uint32 accountId)
+{
+    RealmCharacterCounts characterCounts;
+    if (result)
+    {
+        do
+        {
+            Field* fields = result->Fetch();
+            characterCounts[fields[0].GetUInt32()] = fields[1].GetUInt8();
+        } while (result->NextRow());
+
+        delete result;
+    }
+
+    sLoginCache.StoreRealmCharacters(accountId, time(nullptr), characterCounts);
+
+    AuthSocket* socket = FindSocket(socketId);
+    if (!socket)
+        return;
+
+    socket->m_pending = false;
+    socket->SendRealmList(characterCounts);
+    socket->ResumeRead(true);
+}
+
+void AuthSocket::SendRealmList(RealmCharacterCounts const& characterCounts)
+{
     // Circle through realms in the RealmList and construct the return packet (including # of user characters in each realm)
     ByteBuffer pkt;
-    LoadRealmlist(pkt);
+    LoadRealmlist(pkt, characterCounts);
 
     ByteBuffer hdr;
     hdr << (uint8) CMD_REALM_LIST;
@@ -1001,11 +1244,9 @@ bool AuthSocket::_HandleRealmList()
     hdr.append(pkt);
 
     send((char const*)hdr.contents(), hdr.size());
-
-    return true;
 }
 
-void AuthSocket::LoadRealmlist(ByteBuffer &pkt)
+void AuthSocket::LoadRealmlist(ByteBuffer &pkt, RealmCharacterCounts const& characterCounts)
 {
     if (m_build < 6299)        // before version 2.0.3 (exclusive)
     {
@@ -1014,18 +1255,8 @@ void AuthSocket::LoadRealmlist(ByteBuffer &pkt)
 
         for (RealmList::RealmMap::const_iterator i = sRealmList.begin(); i != sRealmList.end(); ++i)
         {
-            uint8 AmountOfCharacters;
-
-            // No SQL injection. id of realm is controlled by the database.
-            QueryResult *result = LoginDatabase.PQuery("SELECT `numchars` FROM `realmcharacters` WHERE `realmid` = '%d' AND `acctid`='%u'", i->second.m_ID, m_accountId);
-            if (result)
-            {
-                Field *fields = result->Fetch();
-                AmountOfCharacters = fields[0].GetUInt8();
-                delete result;
-            }
-            else
-                AmountOfCharacters = 0;
+            RealmCharacterCounts::const_iterator characters = characterCounts.find(i->second.m_ID);
+            uint8 AmountOfCharacters = characters != characterCounts.end() ? characters->second : 0;
 
             bool ok_build = std::find(i->second.realmbuilds.begin(), i->second.realmbuilds.end(), m_build) != i->second.realmbuilds.end();
 
@@ -1067,18 +1298,8 @@ void AuthSocket::LoadRealmlist(ByteBuffer &pkt)
 
         for (RealmList::RealmMap::const_iterator i = sRealmList.begin(); i != sRealmList.end(); ++i)
         {
-            uint8 AmountOfCharacters;
-
-            // No SQL injection. id of realm is controlled by the database.
-            QueryResult *result = LoginDatabase.PQuery("SELECT `numchars` FROM `realmcharacters` WHERE `realmid` = '%d' AND `acctid`='%u'", i->second.m_ID, m_accountId);
-            if (result)
-            {
-                Field *fields = result->Fetch();
-                AmountOfCharacters = fields[0].GetUInt8();
-                delete result;
-            }
-            else
-                AmountOfCharacters = 0;
+            RealmCharacterCounts::const_iterator characters = characterCounts.find(i->second.m_ID);
+            uint8 AmountOfCharacters = characters != characterCounts.end() ? characters->second : 0;
 
             bool ok_build = std::find(i->second.realmbuilds.begin(), i->second.realmbuilds.end(), m_build) != i->second.realmbuilds.end();
 
@@ -1298,10 +1519,8 @@ void AuthSocket::InitPatch()
     }
 }
 
-void AuthSocket::LoadAccountSecurityLevels(uint32 accountId)
+void AuthSocket::LoadAccountSecurityLevels(QueryResult* result)
 {
-    QueryResult* result = LoginDatabase.PQuery("SELECT `gmlevel`, `RealmID` FROM `account_access` WHERE `id` = %u",
-        accountId);
     if (!result)
         return;
 
@@ -1315,8 +1534,6 @@ void AuthSocket::LoadAccountSecurityLevels(uint32 accountId)
         else
             m_accountSecurityOnRealm[realmId] = security;
     } while (result->NextRow());
-
-    delete result;
 }
 
 bool AuthSocket::GeographicalLockCheck()
@@ -33,6 +33,13 @@
 #include "ByteBuffer.h"
 
 #include "BufferedSocket.h"
+#include "LoginCache.h"
+
+#include <unordered_map>
+
+class QueryResult;
+class SqlQueryHolder;
+struct LogonProofJob;
 
 struct PINData
 {
@@ -63,7 +70,7 @@ class AuthSocket: public BufferedSocket
         void OnAccept();
         void OnRead();
         void SendProof(Sha1Hash sha);
-        void LoadRealmlist(ByteBuffer &pkt);
+        void LoadRealmlist(ByteBuffer &pkt, RealmCharacterCounts const& characterCounts);
         bool VerifyPinData(uint32 pin, const PINData& clientData);
         uint32 GenerateTotpPin(const std::string& secret, int interval);
 
@@ -78,6 +85,9 @@ class AuthSocket: public BufferedSocket
         bool _HandleXferCancel();
         bool _HandleXferAccept();
 
+        // Results of the requests the handlers defer, run by the network thread
+        static void OnLogonProofComputed(LogonProofJob const& job);
+
     private:
         enum eStatus
         {
@@ -91,11 +101,38 @@ class AuthSocket: public BufferedSocket
 
         bool VerifyVersion(uint8 const* a, int32 aLength, uint8 const* versionProof, bool isReconnect);
 
+        // The sockets waiting for a result are found again by id, they may be closed before it comes
+        static AuthSocket* FindSocket(uint32 socketId);
+        // Ends the wait of a handler: handles the commands received meanwhile, or closes the connection
+        void ResumeRead(bool handled);
+
+        static void LogonChallengeCallback(QueryResult* /*dummy*/, SqlQueryHolder* holder, uint32 socketId);
+        static void LogonProofSessionCallback(QueryResult* result, uint32 socketId);
+        static void WrongPasswordCallback(QueryResult* /*dummy*/, SqlQueryHolder* holder, uint32 socketId);
+        static void ReconnectChallengeCallback(QueryResult* result, uint32 socketId);
+        static void RealmListCallback(QueryResult* result, uint32 socketId, uint32 accountId);
+
+        bool HandleLogonChallengeResult(SqlQueryHolder* holder);
+        bool HandleLogonProofResult(LogonProofJob const& job);
+        bool HandleReconnectChallengeResult(QueryResult* result);
+        void SendRealmList(RealmCharacterCounts const& characterCounts);
+
+        static std::unordered_map<uint32, AuthSocket*> s_sockets;
+        static uint32 s_nextSocketId;
+
+        uint32 m_socketId = 0;
+        bool m_pending = false;                             // A handler waits for the database or the proof workers
+
         SRP6 srp;
         BigNumber m_reconnectProof;
 
         bool m_promptPin = false;
 
+        // Logon proof data checked once the SRP6 proof is computed
+        uint8 m_versionProof[20] = { };
+        bool m_pinReceived = false;
+        PINData m_pinData = { };
+
         eStatus m_status = STATUS_CHALLENGE;
 
         std::string m_login;
@@ -126,7 +163,7 @@ class AuthSocket: public BufferedSocket
         uint16 m_build = 0;
 
         AccountTypes GetSecurityOn(uint32 realmId) const;
-        void LoadAccountSecurityLevels(uint32 accountId);
+        void LoadAccountSecurityLevels(QueryResult* result);
         bool GeographicalLockCheck();
 
         AccountTypes m_accountDefaultSecurityLevel = SEC_PLAYER;
@@ -248,6 +248,13 @@ bool BufferedSocket::send(const char *buf, size_t len)
     return n == space ? 1 : 0;
 }
 
+void BufferedSocket::process_input(void)
+{
+    this->OnRead();
+
+    this->input_buffer_.crunch();
+}
+
 /*virtual*/ int BufferedSocket::handle_close(ACE_HANDLE /*h*/, ACE_Reactor_Mask /*m*/)
 {
     this->OnClose();
@@ -61,6 +61,9 @@ class BufferedSocket: public ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH>
 
         void close_connection(void);
 
+        // Calls OnRead again for the data left in the input buffer, once a deferred request is answered
+        void process_input(void);
+
         virtual int handle_input(ACE_HANDLE = ACE_INVALID_HANDLE);
         virtual int handle_output(ACE_HANDLE = ACE_INVALID_HANDLE);
 
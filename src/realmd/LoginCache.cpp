@@ -0,0 +1,148 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** \file
+    \ingroup realmd
+*/
+
+#include "LoginCache.h"
+#include "Log.h"
+#include "Database/DatabaseEnv.h"
+#include "Database/DatabaseImpl.h"
+
+#include <algorithm>
+
+// Active bans only, permanent ones (unbandate = bandate) are returned with an unban date of 0
+static char const* IP_BANS_QUERY = "SELECT `ip`, IF(`unbandate` = `bandate`, 0, `unbandate`) FROM `ip_banned` "
+                                   "WHERE `unbandate` = `bandate` OR `unbandate` > UNIX_TIMESTAMP()";
+
+LoginCache::LoginCache() : m_ipBanRefreshDelay(0), m_realmCharactersTtl(0),
+    m_nextIpBanRefresh(0), m_ipBanRefreshStart(0), m_nextRealmCharactersPurge(0)
+{
+}
+
+LoginCache& sLoginCache
+{
+    static LoginCache loginCache;
+    return loginCache;
+}
+
+void LoginCache::Initialize(uint32 ipBanRefreshDelay, uint32 realmCharactersTtl)
+{
+    m_ipBanRefreshDelay = ipBanRefreshDelay;
+    m_realmCharactersTtl = realmCharactersTtl;
+
+    time_t const now = time(nullptr);
+    m_nextRealmCharactersPurge = now + m_realmCharactersTtl;
+
+    if (!IsIpBanCacheEnabled())
+        return;
+
+    m_ipBanRefreshStart = now;
+    LoadIpBans(LoginDatabase.Query(IP_BANS_QUERY));
+    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Loaded %u active IP bans, reloaded every %u seconds", uint32(m_ipBans.size()), m_ipBanRefreshDelay);
+}
+
+void LoginCache::Update(time_t now)
+{
+    if (IsIpBanCacheEnabled() && !m_ipBanRefreshStart && now >= m_nextIpBanRefresh)
+    {
+        m_ipBanRefreshStart = now;
+        if (!LoginDatabase.AsyncQueryUnsafe(this, &LoginCache::LoadIpBans, IP_BANS_QUERY))
+        {
+            m_ipBanRefreshStart = 0;
+            m_nextIpBanRefresh = now + m_ipBanRefreshDelay;
+        }
+    }
+
+    if (m_realmCharactersTtl && now >= m_nextRealmCharactersPurge)
+    {
+        for (auto itr = m_realmCharacters.begin(); itr != m_realmCharacters.end();)
+        {
+            if (itr->second.expireTime <= now)
+                itr = m_realmCharacters.erase(itr);
+            else
+                ++itr;
+        }
+        m_nextRealmCharactersPurge = now + m_realmCharactersTtl;
+    }
+}
+
+void LoginCache::LoadIpBans(QueryResult* result)
+{
+    IpBanMap bans;
+    if (result)
+    {
+        do
+        {
+            Field* fields = result->Fetch();
+            bans[fields[0].GetCppString()] = fields[1].GetUInt32();
+        } while (result->NextRow());
+
+        delete result;
+    }
+
+    // The INSERT of a ban added shortly before the refresh may not have been executed by the query
+    time_t const keepSince = m_ipBanRefreshStart - m_ipBanRefreshDelay;
+    m_localIpBans.erase(std::remove_if(m_localIpBans.begin(), m_localIpBans.end(), [keepSince](LocalIpBan const& ban)
+    {
+        return ban.added < keepSince;
+    }), m_localIpBans.end());
+    for (LocalIpBan const& ban : m_localIpBans)
+        bans[ban.ip] = ban.unbanDate;
+
+    m_ipBans.swap(bans);
+    m_nextIpBanRefresh = m_ipBanRefreshStart + m_ipBanRefreshDelay;
+    m_ipBanRefreshStart = 0;
+}
+
+bool LoginCache::IsIpBanned(std::string const& ip, time_t now) const
+{
+    auto itr = m_ipBans.find(ip);
+    if (itr == m_ipBans.end())
+        return false;
+
+    return !itr->second || itr->second > now;
+}
+
+void LoginCache::AddIpBan(std::string const& ip, uint32 unbanDate)
+{
+    if (!IsIpBanCacheEnabled())
+        return;
+
+    m_ipBans[ip] = unbanDate;
+    m_localIpBans.push_back({ ip, unbanDate, time(nullptr) });
+}
+
+bool LoginCache::FindRealmCharacters(uint32 accountId, time_t now, RealmCharacterCounts& counts) const
+{
+    auto itr = m_realmCharacters.find(accountId);
+    if (itr == m_realmCharacters.end() || itr->second.expireTime <= now)
+        return false;
+
+    counts = itr->second.counts;
+    return true;
+}
+
+void LoginCache::StoreRealmCharacters(uint32 accountId, time_t now, RealmCharacterCounts const& counts)
+{
+    if (!m_realmCharactersTtl)
+        return;
+
+    RealmCharactersEntry& entry = m_realmCharacters[accountId];
+    entry.expireTime = now + m_realmCharactersTtl;
+    entry.counts = counts;
+}
@@ -0,0 +1,101 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// \addtogroup realmd
+// @{
+// \file
+
+#ifndef _LOGINCACHE_H
+#define _LOGINCACHE_H
+
+#include "Common.h"
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class QueryResult;
+
+// Number of characters of an account on each realm, by realm id
+typedef std::map<uint32, uint8> RealmCharacterCounts;
+
+/**
+ * @brief Login database data read by every logon, kept by realmd between two
+ * short refreshes so that a reconnection storm does not turn into as many
+ * queries.
+ * The active IP bans are reloaded every IpBanCacheDelay seconds in the
+ * background, the bans realmd adds itself (WrongPass.BanType 0) apply at once.
+ * The number of characters of the accounts is kept RealmCharactersCacheTime
+ * seconds after the realm list request which read it.
+ * Only used by the network thread.
+ */
+class LoginCache
+{
+    public:
+        static LoginCache& Instance();
+
+        LoginCache();
+
+        // Loads the IP bans, synchronously
+        void Initialize(uint32 ipBanRefreshDelay, uint32 realmCharactersTtl);
+        // Starts the refresh of the IP bans when due, drops the expired character counts
+        void Update(time_t now);
+
+        // When disabled (IpBanCacheDelay = 0), the logon challenge reads the ban of its IP itself
+        bool IsIpBanCacheEnabled() const { return m_ipBanRefreshDelay != 0; }
+        bool IsIpBanned(std::string const& ip, time_t now) const;
+        // unbanDate 0 is a permanent ban
+        void AddIpBan(std::string const& ip, uint32 unbanDate);
+
+        bool FindRealmCharacters(uint32 accountId, time_t now, RealmCharacterCounts& counts) const;
+        void StoreRealmCharacters(uint32 accountId, time_t now, RealmCharacterCounts const& counts);
+
+    private:
+        typedef std::unordered_map<std::string, uint32> IpBanMap;  // Unban date by IP, 0 when permanent
+
+        struct LocalIpBan
+        {
+            std::string ip;
+            uint32 unbanDate;
+            time_t added;
+        };
+
+        struct RealmCharactersEntry
+        {
+            time_t expireTime;
+            RealmCharacterCounts counts;
+        };
+
+        void LoadIpBans(QueryResult* result);
+
+        uint32 m_ipBanRefreshDelay;
+        uint32 m_realmCharactersTtl;
+
+        IpBanMap m_ipBans;
+        // Kept over the refreshes queued before their row could be written
+        std::vector<LocalIpBan> m_localIpBans;
+        time_t m_nextIpBanRefresh;
+        time_t m_ipBanRefreshStart;                         // 0 when no refresh is running
+
+        std::unordered_map<uint32, RealmCharactersEntry> m_realmCharacters;
+        time_t m_nextRealmCharactersPurge;
+};
+
+#define sLoginCache LoginCache::Instance()
+
+#endif
+// @}
@@ -30,6 +30,8 @@
 #include "Config/Config.h"
 #include "Log.h"
 #include "AuthSocket.h"
+#include "AuthProofQueue.h"
+#include "LoginCache.h"
 #include "SystemConfig.h"
 #include "revision.h"
 #include "Util.h"
@@ -289,6 +291,9 @@ extern int main(int argc, char **argv)
     LoginDatabase.Execute("DELETE FROM `ip_banned` WHERE `unbandate`<=UNIX_TIMESTAMP() AND `unbandate`<>`bandate`");
     LoginDatabase.CommitTransaction();
 
+    sLoginCache.Initialize(sConfig.GetIntDefault("IpBanCacheDelay", 10), sConfig.GetIntDefault("RealmCharactersCacheTime", 10));
+    sAuthProofQueue.Initialize(sConfig.GetIntDefault("ProofWorkerThreads", 2));
+
     // Launch the listening network socket
     ACE_Acceptor<AuthSocket, ACE_SOCK_Acceptor> acceptor;
 
@@ -354,7 +359,7 @@ extern int main(int argc, char **argv)
     LoginDatabase.AllowAsyncTransactions();
 
     // maximum counter for next ping
-    uint32 numLoops = (sConfig.GetIntDefault( "MaxPingTime", 30 ) * (MINUTE * 1000000 / 100000));
+    uint32 numLoops = (sConfig.GetIntDefault( "MaxPingTime", 30 ) * (MINUTE * 1000000 / 10000));
     uint32 loopCounter = 0;
 
     #ifndef WIN32
@@ -364,11 +369,16 @@ extern int main(int argc, char **argv)
     while (!stopEvent)
     {
         // dont move this outside the loop, the reactor will modify it
-        ACE_Time_Value interval(0, 100000);
+        // Short, the sockets waiting for a database or proof result are answered between two loops
+        ACE_Time_Value interval(0, 10000);
 
         if (ACE_Reactor::instance()->run_reactor_event_loop(interval) == -1)
             break;
 
+        LoginDatabase.ProcessResultQueue();
+        sAuthProofQueue.Update();
+        sLoginCache.Update(time(nullptr));
+
         if( (++loopCounter) == numLoops )
         {
             loopCounter = 0;
@@ -381,6 +391,8 @@ extern int main(int argc, char **argv)
 #endif
     }
 
+    sAuthProofQueue.Stop();
+
     // Wait for the delay thread to exit
     LoginDatabase.HaltDelayThread();
 
@@ -455,7 +467,9 @@ bool StartDB()
     }
 
     sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "Database: %s", dbStringLog.c_str() );
-    if(!LoginDatabase.Initialize(dbstring.c_str()))
+    // The logon requests are read by the delay threads
+    int nWorkers = std::max(1, sConfig.GetIntDefault("LoginDatabase.WorkerThreads", 2));
+    if(!LoginDatabase.Initialize(dbstring.c_str(), 1, nWorkers))
     {
         sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "Cannot connect to database");
         return false;
@@ -1233,10 +1233,12 @@ struct boss_eranikusAI : public ScriptedAI
 
         if (!m_creature->CanReachWithMeleeAutoAttack(pTarget))
         {
-            ThreatList const& tList = m_creature->GetThreatManager().getThreatList();
-            for (const auto itr : tList)
+            // Added threat can create new references (pet owners)
+            std::vector<ObjectGuid> guids;
+            m_creature->FillGuidsListFromThreatList(guids);
+            for (const auto& guid : guids)
             {
-                if (Unit* pAttacker = m_creature->GetMap()->GetUnit(itr->getUnitGuid()))
+                if (Unit* pAttacker = m_creature->GetMap()->GetUnit(guid))
                     if (m_creature->CanReachWithMeleeAutoAttack(pAttacker))
                         m_creature->GetThreatManager().modifyThreatPercent(pAttacker, 5);
             }
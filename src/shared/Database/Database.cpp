@@ -135,6 +135,36 @@ bool SqlConnection::ExecuteStmt(int nIndex, SqlStmtParameters const& id)
     return false;
 }
 
+//////////////////////////////////////////////////////////////////////////
+namespace
+{
+    thread_local SqlWriteCounter* t_writeCounter = nullptr;
+}
+
+SqlWriteCounter::SqlWriteCounter() : m_previous(t_writeCounter), m_statements(0), m_bytes(0)
+{
+    t_writeCounter = this;
+}
+
+SqlWriteCounter::~SqlWriteCounter()
+{
+    t_writeCounter = m_previous;
+    if (m_previous)
+    {
+        m_previous->m_statements += m_statements;
+        m_previous->m_bytes += m_bytes;
+    }
+}
+
+void SqlWriteCounter::Record(size_t bytes)
+{
+    if (SqlWriteCounter* counter = t_writeCounter)
+    {
+        ++counter->m_statements;
+        counter->m_bytes += bytes;
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////
 Database::~Database()
 {
@@ -155,6 +185,10 @@ bool Database::Initialize(char const* infoString, int nConns /*= 1*/, int nWorke
 
     m_pingIntervallms = sConfig.GetIntDefault ("MaxPingTime", 30) * (MINUTE * 1000);
 
+    // Grouping of asynchronous writes in transactions (1 = every write is committed alone)
+    m_maxBatchSize = std::max(1, sConfig.GetIntDefault("Database.MaxBatchSize", 100));
+    m_maxBatchDelay = std::max(0, sConfig.GetIntDefault("Database.MaxBatchDelay", 0));
+
     //create DB connections
 
     //setup connection pool size
@@ -396,6 +430,8 @@ bool Database::Execute(char const* sql)
     if (!m_pAsyncConn)
         return false;
 
+    SqlWriteCounter::Record(strlen(sql));
+
     SqlTransaction * pTrans = m_TransStorage->get();
     if(pTrans)
     {
@@ -547,12 +583,58 @@ void Database::AddToSerialDelayQueue(SqlOperation* op)
     // TODO: Load balance, must maintain mapping of serial ID so queries are
     // executed sequentially, however
     int worker = op->GetSerialId() % m_numAsyncWorkers;
-    m_threadsBodies[worker]->addSerialOperation(op);
+    AddToSerialDelayQueue(worker, op);
+}
+
+void Database::OnOperationQueued()
+{
+    int64 queued = ++m_asyncQueued;
+    int64 peak = m_asyncPeakQueued.load();
+    while (queued > peak && !m_asyncPeakQueued.compare_exchange_weak(peak, queued));
+}
+
+void Database::OnBatchExecuted(uint32 size, uint32 us, bool replayed)
+{
+    ++m_batches;
+    m_batchedOperations += size;
+    if (replayed)
+        ++m_replayedBatches;
+
+    uint32 max = m_maxExecutedBatchSize.load();
+    while (size > max && !m_maxExecutedBatchSize.compare_exchange_weak(max, size));
+
+    m_batchFlushTime.Record(us);
+}
+
+Database::AsyncStats Database::GetAsyncStats() const
+{
+    AsyncStats stats;
+    stats.queued = std::max<int64>(0, m_asyncQueued.load());
+    stats.peakQueued = m_asyncPeakQueued.load();
+    stats.executed = m_asyncExecuted.load();
+    stats.batches = m_batches.load();
+    stats.batchedOperations = m_batchedOperations.load();
+    stats.maxBatchSize = m_maxExecutedBatchSize.load();
+    stats.replayedBatches = m_replayedBatches.load();
+    stats.flushTime = m_batchFlushTime.GetSummary();
+    return stats;
+}
+
+void Database::ResetAsyncStats()
+{
+    m_asyncPeakQueued = m_asyncQueued.load();
+    m_asyncExecuted = 0;
+    m_batches = 0;
+    m_batchedOperations = 0;
+    m_maxExecutedBatchSize = 0;
+    m_replayedBatches = 0;
+    m_batchFlushTime.Reset();
 }
 
 bool Database::HasAsyncQuery()
 {
-    bool hasQuery = !m_delayQueue->empty_unsafe();
+    // includes the writes waiting in an uncommitted batch
+    bool hasQuery = m_asyncQueued.load() > 0 || !m_delayQueue->empty_unsafe();
 
     for (uint32 i = 0; i < m_numAsyncWorkers && !hasQuery; ++i)
         hasQuery = m_threadsBodies[i]->HasAsyncQuery();
@@ -623,6 +705,11 @@ bool Database::ExecuteStmt(SqlStatementID const& id, SqlStmtParameters* params)
     if (!m_pAsyncConn)
         return false;
 
+    size_t bytes = 0;
+    for (auto const& param : params->params())
+        bytes += param.size();
+    SqlWriteCounter::Record(bytes);
+
     SqlTransaction * pTrans = m_TransStorage->get();
     if(pTrans)
     {
@@ -27,6 +27,7 @@
 #include "Policies/ThreadingModel.h"
 #include <ace/TSS_T.h>
 #include "SqlPreparedStatement.h"
+#include "LatencyHistogram.h"
 #include <memory>
 #include <thread>
 #include <atomic>
@@ -115,9 +116,49 @@ class SqlConnection
         StmtHolder m_holder;
 };
 
+/**
+ * @brief Counts the writes queued by the current thread in the enclosing scope.
+ * Bytes are the length of the plain queries plus the size of the bound
+ * parameters of the prepared statements. Nested counters of the same thread
+ * add their writes to the enclosing one when they end.
+ */
+class SqlWriteCounter
+{
+    public:
+        SqlWriteCounter();
+        ~SqlWriteCounter();
+
+        SqlWriteCounter(SqlWriteCounter const&) = delete;
+        SqlWriteCounter& operator=(SqlWriteCounter const&) = delete;
+
+        uint32 GetStatements() const { return m_statements; }
+        uint64 GetBytes() const { return m_bytes; }
+
+        // Called by Database for every write request
+        static void Record(size_t bytes);
+
+    private:
+        SqlWriteCounter* m_previous;
+        uint32 m_statements;
+        uint64 m_bytes;
+};
+
 class Database
 {
     public:
+        // Statistics of the asynchronous requests executed by the delay threads
+        struct AsyncStats
+        {
+            int64 queued = 0;                                               // operations waiting in the delay queues
+            int64 peakQueued = 0;
+            uint64 executed = 0;
+            uint64 batches = 0;                                             // flushes of pending writes, one transaction each
+            uint64 batchedOperations = 0;
+            uint32 maxBatchSize = 0;
+            uint64 replayedBatches = 0;                                     // failed batches executed again one by one
+            LatencyHistogram::Summary flushTime;                            // microseconds to execute a batch
+        };
+
         virtual ~Database();
 
         virtual bool Initialize(char const* infoString, int nConns = 1, int nWorkers = 1);
@@ -261,10 +302,10 @@ class Database
         //you should call it explicitly after your server successfully started up
         //NO ASYNC TRANSACTIONS DURING SERVER STARTUP - ONLY DURING RUNTIME!!!
         void AllowAsyncTransactions() { m_bAllowAsyncTransactions = true; }
-        inline void AddToDelayQueue(SqlOperation* op) { m_delayQueue->add(op); }
+        inline void AddToDelayQueue(SqlOperation* op) { OnOperationQueued(); m_delayQueue->add(op); }
         inline bool NextDelayedOperation(SqlOperation*& op) { return m_delayQueue->next(op); }
 
-        inline void AddToSerialDelayQueue(int workerId, SqlOperation* op) { m_threadsBodies[workerId]->addSerialOperation(op); }
+        inline void AddToSerialDelayQueue(int workerId, SqlOperation* op) { OnOperationQueued(); m_threadsBodies[workerId]->addSerialOperation(op); }
         bool NextSerialDelayedOperation(int workerId, SqlOperation*& op);
 
         bool HasAsyncQuery();
@@ -273,10 +314,25 @@ class Database
 
         // Frees data, cancels scheduled queries, closes connection
         void StopServer();
+
+        // Number of asynchronous operations not executed yet, used as a backpressure signal
+        int64 GetAsyncQueueSize() const { return m_asyncQueued.load(); }
+        AsyncStats GetAsyncStats() const;
+        void ResetAsyncStats();
+
+        // Consecutive writes are grouped in one transaction of at most this many operations ...
+        uint32 GetMaxBatchSize() const { return m_maxBatchSize; }
+        // ... kept open at most this many milliseconds
+        uint32 GetMaxBatchDelay() const { return m_maxBatchDelay; }
+
+        // Called by the delay threads
+        void OnOperationsExecuted(uint32 count) { m_asyncQueued -= count; m_asyncExecuted += count; }
+        void OnBatchExecuted(uint32 size, uint32 us, bool replayed);
     protected:
         Database() : m_nQueryConnPoolSize(1), m_delayQueue(new SqlQueue()), m_pAsyncConn(nullptr),
                      m_pResultQueue(nullptr), m_numAsyncWorkers(0),
-                     m_bAllowAsyncTransactions(false), m_iStmtIndex(-1), m_logSQL(false), m_pingIntervallms(0)
+                     m_bAllowAsyncTransactions(false), m_iStmtIndex(-1), m_maxBatchSize(1), m_maxBatchDelay(0),
+                     m_logSQL(false), m_pingIntervallms(0)
         {
             m_nQueryCounter = -1;
         }
@@ -352,6 +408,20 @@ class Database
 
         int m_iStmtIndex;
 
+        //ASYNC STATISTICS
+        void OnOperationQueued();
+
+        uint32 m_maxBatchSize;
+        uint32 m_maxBatchDelay;
+        std::atomic<int64> m_asyncQueued{0};
+        std::atomic<int64> m_asyncPeakQueued{0};
+        std::atomic<uint64> m_asyncExecuted{0};
+        std::atomic<uint64> m_batches{0};
+        std::atomic<uint64> m_batchedOperations{0};
+        std::atomic<uint32> m_maxExecutedBatchSize{0};
+        std::atomic<uint64> m_replayedBatches{0};
+        LatencyHistogram m_batchFlushTime;
+
     private:
 
         bool m_logSQL;
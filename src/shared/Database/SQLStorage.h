@@ -26,6 +26,7 @@
 class SQLStorageBase
 {
         template<class DerivedLoader, class StorageClass> friend class SQLStorageLoaderBase;
+        friend class SQLStorageSnapshot;
 
     public:
         char const* GetTableName() const { return m_tableName; }
@@ -254,6 +255,9 @@ class SQLStorageLoaderBase
         void Load(StorageClass& storage, bool error_at_empty = true);
         void LoadProgressive(StorageClass& storage, uint32 wow_patch, std::string column_name = "patch", bool error_at_empty = true);
 
+        // Loaders whose conversions depend on other data (script names ...) must include it in the snapshot key
+        uint64 GetSnapshotSalt() const { return 0; }
+
         template<class S, class D>
         void convert(uint32 field_pos, S src, D& dst);
         template<class S>
@@ -274,6 +278,9 @@ class SQLStorageLoaderBase
         void convert_str_to_str(uint32 field_pos, char* src, char*& dst);
 
     private:
+        void LoadFromDB(StorageClass& storage, bool error_at_empty);
+        void LoadProgressiveFromDB(StorageClass& storage, uint32 wow_patch, std::string const& column_name, bool error_at_empty);
+
         template<class V>
         void storeValue(V value, StorageClass& store, char* record, uint32 field_pos, uint32& offset);
         void storeValue(char const* value, StorageClass& store, char* record, uint32 field_pos, uint32& offset);
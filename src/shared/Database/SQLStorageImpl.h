@@ -22,6 +22,7 @@
 #include "ProgressBar.h"
 #include "Log.h"
 #include "DBCFileLoader.h"
+#include "SQLStorageSnapshot.h"
 
 template<class DerivedLoader, class StorageClass>
 template<class S, class D>                                  // S source-type, D destination-type
@@ -188,6 +189,19 @@ void SQLStorageLoaderBase<DerivedLoader, StorageClass>::storeValue(char const* v
 
 template<class DerivedLoader, class StorageClass>
 void SQLStorageLoaderBase<DerivedLoader, StorageClass>::Load(StorageClass& store, bool error_at_empty /*= true*/)
+{
+    uint64 const snapshotKey = SQLStorageSnapshot::ComputeKey(store, 0, "", static_cast<DerivedLoader*>(this)->GetSnapshotSalt());
+    if (snapshotKey && SQLStorageSnapshot::Read(store, snapshotKey))
+        return;
+
+    LoadFromDB(store, error_at_empty);
+
+    if (snapshotKey)
+        SQLStorageSnapshot::Write(store, snapshotKey);
+}
+
+template<class DerivedLoader, class StorageClass>
+void SQLStorageLoaderBase<DerivedLoader, StorageClass>::LoadFromDB(StorageClass& store, bool error_at_empty)
 {
     Field* fields = nullptr;
     QueryResult* result  = WorldDatabase.PQuery("SELECT MAX(%s) FROM %s", store.EntryFieldName(), store.GetTableName());
@@ -333,6 +347,19 @@ void SQLStorageLoaderBase<DerivedLoader, StorageClass>::Load(StorageClass& store
 
 template<class DerivedLoader, class StorageClass>
 void SQLStorageLoaderBase<DerivedLoader, StorageClass>::LoadProgressive(StorageClass& store, uint32 wow_patch, std::string column_name /* = "patch" */, bool error_at_empty /*= true*/)
+{
+    uint64 const snapshotKey = SQLStorageSnapshot::ComputeKey(store, wow_patch, column_name.c_str(), static_cast<DerivedLoader*>(this)->GetSnapshotSalt());
+    if (snapshotKey && SQLStorageSnapshot::Read(store, snapshotKey))
+        return;
+
+    LoadProgressiveFromDB(store, wow_patch, column_name, error_at_empty);
+
+    if (snapshotKey)
+        SQLStorageSnapshot::Write(store, snapshotKey);
+}
+
+template<class DerivedLoader, class StorageClass>
+void SQLStorageLoaderBase<DerivedLoader, StorageClass>::LoadProgressiveFromDB(StorageClass& store, uint32 wow_patch, std::string const& column_name, bool error_at_empty)
 {
     // To be used on tables that need to support patch progression. Second column must be the `patch` column.
     Field* fields = nullptr;
@@ -0,0 +1,367 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "SQLStorageSnapshot.h"
+#include "SQLStorage.h"
+#include "Database/DatabaseEnv.h"
+#include "Log.h"
+
+#include <memory>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+std::string SQLStorageSnapshot::m_directory;
+bool SQLStorageSnapshot::m_rebuild = false;
+
+static uint32 const SNAPSHOT_MAGIC   = 0x4E535153;          // "SQSN"
+static uint32 const SNAPSHOT_VERSION = 1;
+static uintptr_t const SNAPSHOT_NULL_STRING = ~uintptr_t(0);
+
+struct SnapshotHeader
+{
+    uint32 magic;
+    uint32 version;
+    uint64 key;
+    uint32 recordSize;
+    uint32 recordCount;
+    uint32 maxEntry;
+    uint32 reserved;
+    uint64 stringsSize;
+};
+
+// Read-only view of a whole snapshot file
+class SnapshotFileView
+{
+    public:
+        explicit SnapshotFileView(std::string const& fileName) : m_data(nullptr), m_size(0)
+        {
+#ifndef _WIN32
+            int fd = open(fileName.c_str(), O_RDONLY);
+            if (fd < 0)
+                return;
+
+            struct stat st;
+            if (fstat(fd, &st) == 0 && st.st_size > 0)
+            {
+                void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapping != MAP_FAILED)
+                {
+                    m_data = static_cast<char const*>(mapping);
+                    m_size = st.st_size;
+                }
+            }
+            close(fd);
+#else
+            FILE* file = fopen(fileName.c_str(), "rb");
+            if (!file)
+                return;
+
+            fseek(file, 0, SEEK_END);
+            long size = ftell(file);
+            fseek(file, 0, SEEK_SET);
+            if (size > 0)
+            {
+                m_buffer.resize(size);
+                if (fread(&m_buffer[0], 1, size, file) == size_t(size))
+                {
+                    m_data = &m_buffer[0];
+                    m_size = size;
+                }
+            }
+            fclose(file);
+#endif
+        }
+
+        ~SnapshotFileView()
+        {
+#ifndef _WIN32
+            if (m_data)
+                munmap(const_cast<char*>(m_data), m_size);
+#endif
+        }
+
+        SnapshotFileView(SnapshotFileView const&) = delete;
+        SnapshotFileView& operator=(SnapshotFileView const&) = delete;
+
+        char const* GetData() const { return m_data; }
+        size_t GetSize() const { return m_size; }
+
+    private:
+        char const* m_data;
+        size_t m_size;
+#ifdef _WIN32
+        std::vector<char> m_buffer;
+#endif
+};
+
+void SQLStorageSnapshot::SetDirectory(std::string const& directory)
+{
+    m_directory = directory;
+    if (!m_directory.empty() && m_directory.back() != '/' && m_directory.back() != '\\')
+        m_directory += '/';
+}
+
+uint64 SQLStorageSnapshot::Hash(void const* data, size_t size, uint64 hash)
+{
+    // FNV-1a
+    uint8 const* bytes = static_cast<uint8 const*>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::string SQLStorageSnapshot::GetFileName(SQLStorageBase const& storage)
+{
+    return m_directory + storage.GetTableName() + ".snapshot";
+}
+
+uint32 SQLStorageSnapshot::GetRecordLayout(SQLStorageBase const& storage, std::vector<uint32>& stringOffsets)
+{
+    uint32 offset = 0;
+    for (uint32 x = 0; x < storage.GetDstFieldCount(); ++x)
+    {
+        switch (storage.GetDstFormat(x))
+        {
+            case FT_LOGIC:
+                offset += sizeof(bool);
+                break;
+            case FT_BYTE:
+            case FT_NA_BYTE:
+                offset += sizeof(char);
+                break;
+            case FT_INT:
+            case FT_NA:
+                offset += sizeof(uint32);
+                break;
+            case FT_FLOAT:
+            case FT_NA_FLOAT:
+                offset += sizeof(float);
+                break;
+            case FT_STRING:
+            case FT_NA_POINTER:
+                stringOffsets.push_back(offset);
+                offset += sizeof(char*);
+                break;
+            case FT_64BITINT:
+                offset += sizeof(uint64);
+                break;
+            default:
+                return 0;
+        }
+    }
+    return offset;
+}
+
+uint64 SQLStorageSnapshot::ComputeKey(SQLStorageBase const& storage, uint32 patch, char const* patchColumn, uint64 salt)
+{
+    if (!IsEnabled())
+        return 0;
+
+    // Records are indexed by their first field, which must be stored as is
+    if (!storage.GetSrcFieldCount() || storage.GetSrcFormat(0) != FT_INT || storage.GetDstFormat(0) != FT_INT)
+        return 0;
+
+    std::vector<uint32> stringOffsets;
+    uint32 const recordSize = GetRecordLayout(storage, stringOffsets);
+    if (!recordSize)
+        return 0;
+
+#ifdef DO_POSTGRESQL
+    return 0;
+#else
+    std::unique_ptr<QueryResult> result(WorldDatabase.PQuery("CHECKSUM TABLE `%s`", storage.GetTableName()));
+    if (!result || result->GetFieldCount() < 2 || (*result)[1].IsNULL())
+        return 0;
+
+    uint64 const checksum = (*result)[1].GetUInt64();
+#endif
+
+    uint32 const pointerSize = sizeof(char*);
+    uint64 hash = Hash(&SNAPSHOT_VERSION, sizeof(SNAPSHOT_VERSION));
+    hash = Hash(&pointerSize, sizeof(pointerSize), hash);
+    hash = Hash(&checksum, sizeof(checksum), hash);
+    hash = Hash(&patch, sizeof(patch), hash);
+    hash = Hash(std::string(patchColumn), hash);
+    hash = Hash(std::string(storage.GetSrcFormat()), hash);
+    hash = Hash(std::string(storage.GetDstFormat()), hash);
+    hash = Hash(std::string(storage.EntryFieldName()), hash);
+    hash = Hash(&salt, sizeof(salt), hash);
+
+    // 0 means "no snapshot"
+    return hash ? hash : 1;
+}
+
+bool SQLStorageSnapshot::Read(SQLStorageBase& storage, uint64 key)
+{
+    if (m_rebuild)
+        return false;
+
+    std::vector<uint32> stringOffsets;
+    uint32 const recordSize = GetRecordLayout(storage, stringOffsets);
+    if (!recordSize)
+        return false;
+
+    SnapshotFileView file(GetFileName(storage));
+    if (!file.GetData() || file.GetSize() < sizeof(SnapshotHeader))
+        return false;
+
+    SnapshotHeader header;
+    memcpy(&header, file.GetData(), sizeof(header));
+    if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION || header.key != key)
+        return false;
+
+    uint64 const recordsSize = uint64(header.recordCount) * recordSize;
+    if (header.recordSize != recordSize || sizeof(header) + recordsSize + header.stringsSize != file.GetSize() ||
+        (header.stringsSize && file.GetData()[file.GetSize() - 1] != '\0'))
+    {
+        sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "Snapshot of %s is corrupted, loading the table from the database", storage.GetTableName());
+        return false;
+    }
+
+    char const* records = file.GetData() + sizeof(header);
+    char const* strings = records + recordsSize;
+
+    // Validate everything before touching the storage
+    for (uint32 i = 0; i < header.recordCount; ++i)
+    {
+        char const* record = records + uint64(i) * recordSize;
+
+        uint32 id;
+        memcpy(&id, record, sizeof(id));
+        bool valid = id < header.maxEntry;
+
+        for (uint32 offset : stringOffsets)
+        {
+            uintptr_t stringOffset;
+            memcpy(&stringOffset, record + offset, sizeof(stringOffset));
+            if (stringOffset != SNAPSHOT_NULL_STRING && stringOffset >= header.stringsSize)
+                valid = false;
+        }
+
+        if (!valid)
+        {
+            sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "Snapshot of %s is corrupted, loading the table from the database", storage.GetTableName());
+            return false;
+        }
+    }
+
+    storage.prepareToLoad(header.maxEntry, header.recordCount, recordSize);
+
+    for (uint32 i = 0; i < header.recordCount; ++i)
+    {
+        char const* source = records + uint64(i) * recordSize;
+
+        uint32 id;
+        memcpy(&id, source, sizeof(id));
+
+        char* record = storage.createRecord(id);
+        memcpy(record, source, recordSize);
+
+        // The storage owns its strings (freed and sometimes replaced by the game)
+        for (uint32 offset : stringOffsets)
+        {
+            uintptr_t stringOffset;
+            memcpy(&stringOffset, record + offset, sizeof(stringOffset));
+
+            char* str = nullptr;
+            if (stringOffset != SNAPSHOT_NULL_STRING)
+            {
+                size_t const length = strlen(strings + stringOffset) + 1;
+                str = new char[length];
+                memcpy(str, strings + stringOffset, length);
+            }
+            memcpy(record + offset, &str, sizeof(str));
+        }
+    }
+
+    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, ">> Loaded %u records of %s from snapshot", header.recordCount, storage.GetTableName());
+    return true;
+}
+
+void SQLStorageSnapshot::Write(SQLStorageBase const& storage, uint64 key)
+{
+    std::vector<uint32> stringOffsets;
+    uint32 const recordSize = GetRecordLayout(storage, stringOffsets);
+    if (!recordSize || recordSize != storage.GetRecordSize() || !storage.GetRecordCount())
+        return;
+
+    std::vector<char> records(storage.m_data, storage.m_data + uint64(storage.GetRecordCount()) * recordSize);
+    std::string strings;
+
+    for (uint32 i = 0; i < storage.GetRecordCount(); ++i)
+    {
+        char* record = &records[uint64(i) * recordSize];
+        for (uint32 offset : stringOffsets)
+        {
+            char const* str;
+            memcpy(&str, record + offset, sizeof(str));
+
+            uintptr_t stringOffset = SNAPSHOT_NULL_STRING;
+            if (str)
+            {
+                stringOffset = strings.size();
+                strings.append(str, strlen(str) + 1);
+            }
+            memcpy(record + offset, &stringOffset, sizeof(stringOffset));
+        }
+    }
+
+    SnapshotHeader header;
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.key = key;
+    header.recordSize = recordSize;
+    header.recordCount = storage.GetRecordCount();
+    header.maxEntry = storage.GetMaxEntry();
+    header.reserved = 0;
+    header.stringsSize = strings.size();
+
+    // Written aside then renamed, a crash never leaves a truncated snapshot behind
+    std::string const fileName = GetFileName(storage);
+    std::string const tmpFileName = fileName + ".tmp";
+
+    FILE* file = fopen(tmpFileName.c_str(), "wb");
+    if (!file)
+    {
+        sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "Unable to write the snapshot of %s in %s", storage.GetTableName(), tmpFileName.c_str());
+        return;
+    }
+
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(records.data(), records.size(), 1, file) == 1 &&
+                   (strings.empty() || fwrite(strings.data(), strings.size(), 1, file) == 1);
+    written = (fclose(file) == 0) && written;
+
+#ifdef _WIN32
+    remove(fileName.c_str());
+#endif
+    if (!written || rename(tmpFileName.c_str(), fileName.c_str()) != 0)
+    {
+        sLog.Out(LOG_BASIC, LOG_LVL_ERROR, "Unable to write the snapshot of %s in %s", storage.GetTableName(), fileName.c_str());
+        remove(tmpFileName.c_str());
+        return;
+    }
+
+    sLog.Out(LOG_BASIC, LOG_LVL_DETAIL, "Snapshot of %s written (%u records)", storage.GetTableName(), header.recordCount);
+}
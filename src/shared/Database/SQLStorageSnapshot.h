@@ -0,0 +1,72 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SQLSTORAGE_SNAPSHOT_H
+#define SQLSTORAGE_SNAPSHOT_H
+
+#include "Common.h"
+
+#include <string>
+#include <vector>
+
+class SQLStorageBase;
+
+/**
+ * @brief Binary snapshots of the SQLStorage tables, one file per table in the snapshot directory.
+ * A snapshot holds the records exactly as the loader built them (after the patch
+ * filtering and the loader conversions), strings are stored as offsets in a
+ * trailing block. It is keyed by the CHECKSUM TABLE of the source table, the
+ * patch, the storage formats and a salt provided by the loader, so any change
+ * falls back to the SQL path which then writes a new snapshot.
+ */
+class SQLStorageSnapshot
+{
+    public:
+        /**
+         * @brief SetDirectory enables the snapshots, an empty directory disables them.
+         */
+        static void SetDirectory(std::string const& directory);
+        static bool IsEnabled() { return !m_directory.empty(); }
+
+        /**
+         * @brief SetRebuild ignores the existing snapshots, every storage loaded from SQL writes a new one.
+         */
+        static void SetRebuild(bool rebuild) { m_rebuild = rebuild; }
+
+        /**
+         * @brief ComputeKey returns the key of the current content of the table, 0 when the storage can not be snapshotted.
+         */
+        static uint64 ComputeKey(SQLStorageBase const& storage, uint32 patch, char const* patchColumn, uint64 salt);
+
+        /**
+         * @brief Read fills the storage from its snapshot, returns false when missing, outdated or invalid.
+         */
+        static bool Read(SQLStorageBase& storage, uint64 key);
+        static void Write(SQLStorageBase const& storage, uint64 key);
+
+        static uint64 Hash(void const* data, size_t size, uint64 hash = 14695981039346656037ULL);
+        static uint64 Hash(std::string const& str, uint64 hash = 14695981039346656037ULL) { return Hash(str.c_str(), str.size() + 1, hash); }
+
+    private:
+        static std::string GetFileName(SQLStorageBase const& storage);
+        // Returns the record size (0 for unsupported formats) and the offsets of the string fields
+        static uint32 GetRecordLayout(SQLStorageBase const& storage, std::vector<uint32>& stringOffsets);
+
+        static std::string m_directory;
+        static bool m_rebuild;
+};
+
+#endif
@@ -22,9 +22,12 @@
 #include "Database/SqlDelayThread.h"
 #include "Database/SqlOperations.h"
 #include "DatabaseEnv.h"
+#include "Timer.h"
+
+#include <chrono>
 
 SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn)
-    : m_dbEngine(db), m_dbConnection(conn), m_running(true)
+    : m_dbEngine(db), m_dbConnection(conn), m_running(true), m_batchStartTime(0)
 {
 }
 
@@ -32,6 +35,7 @@ SqlDelayThread::~SqlDelayThread()
 {
     //process all requests which might have been queued while thread was stopping
     ProcessRequests();
+    FlushBatch();
     delete m_dbConnection;
 }
 
@@ -64,6 +68,10 @@ void SqlDelayThread::run()
 
         ProcessRequests();
 
+        // keep the batch open a bit longer to group more writes, but not when stopping
+        if (!m_running || WorldTimer::getMSTimeDiffToNow(m_batchStartTime) >= m_dbEngine->GetMaxBatchDelay())
+            FlushBatch();
+
         if((loopCounter++) >= pingEveryLoop)
         {
             loopCounter = 0;
@@ -87,15 +95,70 @@ void SqlDelayThread::ProcessRequests()
 {
     SqlOperation* s = nullptr;
     while (m_dbEngine->NextDelayedOperation(s))
-    {
-        s->Execute(m_dbConnection);
-        delete s;
-    }
+        ProcessOperation(s);
 
     // Process any serial operations for this worker
     while (m_serialDelayQueue.next(s))
+        ProcessOperation(s);
+}
+
+void SqlDelayThread::ProcessOperation(SqlOperation* op)
+{
+    if (!op->IsBatchable())
     {
-        s->Execute(m_dbConnection);
-        delete s;
+        // queries must see the previous writes, and their callbacks must not wait for the batch
+        FlushBatch();
+        op->Execute(m_dbConnection);
+        delete op;
+        m_dbEngine->OnOperationsExecuted(1);
+        return;
     }
+
+    if (m_batch.empty())
+        m_batchStartTime = WorldTimer::getMSTime();
+
+    m_batch.push_back(op);
+    if (m_batch.size() >= m_dbEngine->GetMaxBatchSize())
+        FlushBatch();
+}
+
+void SqlDelayThread::FlushBatch()
+{
+    if (m_batch.empty())
+        return;
+
+    auto const start = std::chrono::steady_clock::now();
+    bool replayed = false;
+
+    if (m_batch.size() == 1)
+        m_batch.front()->Execute(m_dbConnection);
+    else
+    {
+        SqlConnection::Lock guard(m_dbConnection);
+
+        bool success = guard->BeginTransaction();
+        for (size_t i = 0; success && i < m_batch.size(); ++i)
+            success = m_batch[i]->ExecuteInBatch(m_dbConnection);
+
+        if (success)
+            success = guard->CommitTransaction();
+
+        if (!success)
+        {
+            // nothing was applied: execute the operations again one by one, so
+            // that a single failing statement does not discard the other ones
+            guard->RollbackTransaction();
+            for (SqlOperation* op : m_batch)
+                op->Execute(m_dbConnection);
+            replayed = true;
+        }
+    }
+
+    uint32 const size = m_batch.size();
+    for (SqlOperation* op : m_batch)
+        delete op;
+    m_batch.clear();
+
+    m_dbEngine->OnBatchExecuted(size, uint32(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()), replayed);
+    m_dbEngine->OnOperationsExecuted(size);
 }
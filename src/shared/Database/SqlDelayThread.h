@@ -23,6 +23,9 @@
 #define __SQLDELAYTHREAD_H
 
 #include "LockedQueue.h"
+#include "Platform/Define.h"
+
+#include <vector>
 
 
 class Database;
@@ -40,9 +43,14 @@ class SqlDelayThread
         SqlConnection *m_dbConnection;                      // Pointer to DB connection
         volatile bool m_running;
 
+        std::vector<SqlOperation*> m_batch;                 // Writes executed together in one transaction
+        uint32 m_batchStartTime;
 
         //process all enqueued requests
         void ProcessRequests();
+        void ProcessOperation(SqlOperation* op);
+        //commit the pending batch
+        void FlushBatch();
 
     public:
         SqlDelayThread(Database* db, SqlConnection* conn);
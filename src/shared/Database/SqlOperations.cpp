@@ -70,6 +70,18 @@ bool SqlTransaction::Execute(SqlConnection* conn)
     return conn->CommitTransaction();
 }
 
+bool SqlTransaction::ExecuteInBatch(SqlConnection* conn)
+{
+    LOCK_DB_CONN(conn);
+
+    // The enclosing batch is already a transaction, the caller rolls it back on failure
+    for (SqlOperation* pStmt : m_queue)
+        if (!pStmt->Execute(conn))
+            return false;
+
+    return true;
+}
+
 SqlPreparedRequest::SqlPreparedRequest(int nIndex, SqlStmtParameters* arg) : m_nIndex(nIndex), m_param(arg)
 {
 }
@@ -44,6 +44,10 @@ class SqlOperation
         uint32 GetSerialId() const { return serialId; }
         virtual void OnRemove() { delete this; }
         virtual bool Execute(SqlConnection* conn) = 0;
+        // Write without result: the delay thread may group it with others in one transaction
+        virtual bool IsBatchable() const { return false; }
+        // Execute inside the batch transaction opened by the delay thread
+        virtual bool ExecuteInBatch(SqlConnection* conn) { return Execute(conn); }
         virtual ~SqlOperation() {}
 
     protected:
@@ -60,6 +64,7 @@ class SqlPlainRequest : public SqlOperation
         SqlPlainRequest(char const* sql) : m_sql(mangos_strdup(sql)){}
         ~SqlPlainRequest() { char* tofree = const_cast<char*>(m_sql); delete [] tofree; }
         bool Execute(SqlConnection* conn);
+        bool IsBatchable() const { return true; }
 };
 
 class SqlTransaction : public SqlOperation
@@ -74,6 +79,8 @@ class SqlTransaction : public SqlOperation
         void DelayExecute(SqlOperation* sql)   {   m_queue.push_back(sql); }
 
         bool Execute(SqlConnection* conn);
+        bool IsBatchable() const { return true; }
+        bool ExecuteInBatch(SqlConnection* conn);
 };
 
 class SqlPreparedRequest : public SqlOperation
@@ -83,6 +90,7 @@ class SqlPreparedRequest : public SqlOperation
         ~SqlPreparedRequest();
 
         bool Execute(SqlConnection* conn);
+        bool IsBatchable() const { return true; }
 
     private:
         int const m_nIndex;
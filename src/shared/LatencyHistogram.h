@@ -0,0 +1,137 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_LATENCYHISTOGRAM_H
+#define MANGOS_LATENCYHISTOGRAM_H
+
+#include "Platform/Define.h"
+
+#include <atomic>
+#include <algorithm>
+
+/**
+ * @brief Lock-free log-linear histogram of durations (any unit, usually microseconds).
+ * Each power of two is split in 8 linear sub-buckets, so any recorded value is
+ * reported with less than 12.5% error. Record() can be called concurrently from
+ * any thread; readers get a consistent enough view for monitoring purposes.
+ */
+class LatencyHistogram
+{
+    public:
+        static uint32 const SUB_BUCKET_BITS = 3;
+        static uint32 const SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+        static uint32 const BUCKET_COUNT = (32 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+        struct Summary
+        {
+            uint64 count = 0;
+            uint64 mean = 0;
+            uint64 p50 = 0;
+            uint64 p99 = 0;
+            uint64 max = 0;
+        };
+
+        LatencyHistogram() { Reset(); }
+
+        LatencyHistogram(LatencyHistogram const&) = delete;
+        LatencyHistogram& operator=(LatencyHistogram const&) = delete;
+
+        void Record(uint32 value)
+        {
+            m_buckets[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+            m_count.fetch_add(1, std::memory_order_relaxed);
+            m_sum.fetch_add(value, std::memory_order_relaxed);
+
+            uint32 max = m_max.load(std::memory_order_relaxed);
+            while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed));
+        }
+
+        void Reset()
+        {
+            for (auto& bucket : m_buckets)
+                bucket.store(0, std::memory_order_relaxed);
+            m_count.store(0, std::memory_order_relaxed);
+            m_sum.store(0, std::memory_order_relaxed);
+            m_max.store(0, std::memory_order_relaxed);
+        }
+
+        uint64 GetCount() const { return m_count.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief GetPercentile returns the upper bound of the bucket holding the given percentile (0-100).
+         */
+        uint64 GetPercentile(double percentile) const
+        {
+            uint64 const count = GetCount();
+            if (!count)
+                return 0;
+
+            uint64 const rank = uint64(count * percentile / 100.0 + 0.5);
+            uint64 seen = 0;
+            for (uint32 i = 0; i < BUCKET_COUNT; ++i)
+            {
+                seen += m_buckets[i].load(std::memory_order_relaxed);
+                if (seen >= rank && seen)
+                    return std::min<uint64>(GetBucketUpperBound(i), m_max.load(std::memory_order_relaxed));
+            }
+            return m_max.load(std::memory_order_relaxed);
+        }
+
+        Summary GetSummary() const
+        {
+            Summary summary;
+            summary.count = GetCount();
+            if (!summary.count)
+                return summary;
+
+            summary.mean = m_sum.load(std::memory_order_relaxed) / summary.count;
+            summary.p50 = GetPercentile(50.0);
+            summary.p99 = GetPercentile(99.0);
+            summary.max = m_max.load(std::memory_order_relaxed);
+            return summary;
+        }
+
+        static uint32 GetBucketIndex(uint32 value)
+        {
+            if (value < SUB_BUCKET_COUNT)
+                return value;
+
+            uint32 msb = SUB_BUCKET_BITS;
+            while (msb < 31 && (value >> (msb + 1)))
+                ++msb;
+
+            uint32 const shift = msb - SUB_BUCKET_BITS;
+            return (msb - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + ((value >> shift) & (SUB_BUCKET_COUNT - 1));
+        }
+
+        static uint64 GetBucketUpperBound(uint32 index)
+        {
+            if (index < SUB_BUCKET_COUNT)
+                return index;
+
+            uint32 const shift = index / SUB_BUCKET_COUNT - 1;
+            uint64 const lower = uint64(SUB_BUCKET_COUNT + index % SUB_BUCKET_COUNT) << shift;
+            return lower + (uint64(1) << shift) - 1;
+        }
+
+    private:
+        std::atomic<uint32> m_buckets[BUCKET_COUNT];
+        std::atomic<uint64> m_count;
+        std::atomic<uint64> m_sum;
+        std::atomic<uint32> m_max;
+};
+
+#endif
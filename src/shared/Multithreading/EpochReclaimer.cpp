@@ -0,0 +1,152 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "EpochReclaimer.h"
+#include "Policies/SingletonImp.h"
+
+typedef MaNGOS::ClassLevelLockable<EpochReclaimer, std::mutex> EpochReclaimerLock;
+INSTANTIATE_SINGLETON_2(EpochReclaimer, EpochReclaimerLock);
+INSTANTIATE_CLASS_MUTEX(EpochReclaimer, std::mutex);
+
+namespace
+{
+    // Reader slot of the current thread, given back when the thread exits
+    struct ThreadReader
+    {
+        int32 slot = -1;                                    // -1 until the first read, -2 when no slot was free
+        uint32 depth = 0;
+        std::atomic<bool>* owned = nullptr;
+
+        ~ThreadReader()
+        {
+            if (owned)
+                owned->store(false, std::memory_order_release);
+        }
+    };
+
+    thread_local ThreadReader t_reader;
+}
+
+EpochReclaimer::EpochReclaimer() : m_epoch(1), m_slotlessReaders(0)
+{
+}
+
+EpochReclaimer::~EpochReclaimer()
+{
+    for (auto& retired : m_retired)
+        retired.second();
+}
+
+EpochReclaimer::ReadGuard::ReadGuard()
+{
+    sEpochReclaimer.EnterRead();
+}
+
+EpochReclaimer::ReadGuard::~ReadGuard()
+{
+    sEpochReclaimer.LeaveRead();
+}
+
+int32 EpochReclaimer::AcquireSlot()
+{
+    for (uint32 i = 0; i < MAX_READER_SLOTS; ++i)
+    {
+        bool expected = false;
+        if (!m_slots[i].owned.load(std::memory_order_relaxed) && m_slots[i].owned.compare_exchange_strong(expected, true, std::memory_order_acquire))
+        {
+            t_reader.owned = &m_slots[i].owned;
+            return int32(i);
+        }
+    }
+    return -2;
+}
+
+void EpochReclaimer::EnterRead()
+{
+    if (t_reader.depth++ > 0)
+        return;
+
+    if (t_reader.slot == -1)
+        t_reader.slot = AcquireSlot();
+
+    // Sequentially consistent: the announcement must be visible to the writers
+    // before this thread loads any published pointer
+    if (t_reader.slot >= 0)
+        m_slots[t_reader.slot].epoch.store(m_epoch.load());
+    else
+        ++m_slotlessReaders;
+}
+
+void EpochReclaimer::LeaveRead()
+{
+    if (--t_reader.depth > 0)
+        return;
+
+    if (t_reader.slot >= 0)
+        m_slots[t_reader.slot].epoch.store(0, std::memory_order_release);
+    else
+        --m_slotlessReaders;
+}
+
+void EpochReclaimer::Retire(std::function<void()> deleter)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_retiredLock);
+        // Readers announcing a later epoch started after the object was unpublished
+        m_retired.emplace_back(m_epoch.fetch_add(1), std::move(deleter));
+    }
+
+    Reclaim();
+}
+
+void EpochReclaimer::Reclaim()
+{
+    std::vector<std::function<void()>> reclaimable;
+    {
+        std::lock_guard<std::mutex> guard(m_retiredLock);
+        if (m_retired.empty() || m_slotlessReaders.load() != 0)
+            return;
+
+        uint64 oldestReader = m_epoch.load();
+        for (uint32 i = 0; i < MAX_READER_SLOTS; ++i)
+        {
+            uint64 const epoch = m_slots[i].epoch.load();
+            if (epoch != 0 && epoch < oldestReader)
+                oldestReader = epoch;
+        }
+
+        auto itr = m_retired.begin();
+        while (itr != m_retired.end())
+        {
+            if (itr->first < oldestReader)
+            {
+                reclaimable.push_back(std::move(itr->second));
+                itr = m_retired.erase(itr);
+            }
+            else
+                ++itr;
+        }
+    }
+
+    for (auto& deleter : reclaimable)
+        deleter();
+}
+
+uint32 EpochReclaimer::GetPendingCount() const
+{
+    std::lock_guard<std::mutex> guard(m_retiredLock);
+    return m_retired.size();
+}
@@ -0,0 +1,94 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_EPOCHRECLAIMER_H
+#define MANGOS_EPOCHRECLAIMER_H
+
+#include "Platform/Define.h"
+#include "Policies/Singleton.h"
+#include "Policies/ThreadingModel.h"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Epoch based reclamation for read-mostly structures published through an atomic pointer.
+ * Readers never block: they announce the current epoch in a per-thread slot
+ * for the duration of a ReadGuard. A writer publishes the new version, then
+ * retires the old one, which is deleted once every reader that could still
+ * see it has left its critical section.
+ */
+class EpochReclaimer : public MaNGOS::Singleton<EpochReclaimer, MaNGOS::ClassLevelLockable<EpochReclaimer, std::mutex> >
+{
+    public:
+        static uint32 const MAX_READER_SLOTS = 256;
+
+        EpochReclaimer();
+        ~EpochReclaimer();
+
+        /**
+         * @brief Critical section of a reader, can be nested.
+         */
+        class ReadGuard
+        {
+            public:
+                ReadGuard();
+                ~ReadGuard();
+
+                ReadGuard(ReadGuard const&) = delete;
+                ReadGuard& operator=(ReadGuard const&) = delete;
+        };
+
+        /**
+         * @brief Retire calls the deleter once no reader can reference the retired object anymore.
+         * Must be called after the object was unpublished.
+         */
+        void Retire(std::function<void()> deleter);
+
+        /**
+         * @brief Reclaim runs the deleters of the objects no reader can see anymore.
+         */
+        void Reclaim();
+
+        uint32 GetPendingCount() const;
+
+    private:
+        friend class ReadGuard;
+
+        struct alignas(64) ReaderSlot
+        {
+            std::atomic<bool> owned{false};
+            std::atomic<uint64> epoch{0};                   // 0 when outside of a critical section
+        };
+
+        void EnterRead();
+        void LeaveRead();
+        int32 AcquireSlot();
+
+        std::atomic<uint64> m_epoch;
+        ReaderSlot m_slots[MAX_READER_SLOTS];
+        std::atomic<uint32> m_slotlessReaders;              // Readers of threads that did not get a slot
+
+        mutable std::mutex m_retiredLock;
+        std::vector<std::pair<uint64, std::function<void()>>> m_retired;
+};
+
+#define sEpochReclaimer MaNGOS::Singleton<EpochReclaimer, MaNGOS::ClassLevelLockable<EpochReclaimer, std::mutex> >::Instance()
+
+#endif
@@ -0,0 +1,116 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_SHARDEDREADMAP_H
+#define MANGOS_SHARDEDREADMAP_H
+
+#include "EpochReclaimer.h"
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+/**
+ * @brief Read-mostly concurrent map, lookups never take a lock.
+ * Keys are spread over SHARD_COUNT shards, each shard publishes an immutable
+ * map through an atomic pointer. Writers of a shard are serialized, copy the
+ * map, publish the copy and retire the previous version to the EpochReclaimer.
+ * Meant for small values (pointers) and maps written far less often than read.
+ */
+template<class Key, class Value, class Hash = std::hash<Key>, uint32 SHARD_COUNT = 16>
+class ShardedReadMap
+{
+    public:
+        typedef std::unordered_map<Key, Value, Hash> ShardMap;
+
+        ShardedReadMap()
+        {
+            for (auto& shard : m_shards)
+                shard.map.store(new ShardMap());
+        }
+
+        ~ShardedReadMap()
+        {
+            for (auto& shard : m_shards)
+                delete shard.map.load();
+        }
+
+        ShardedReadMap(ShardedReadMap const&) = delete;
+        ShardedReadMap& operator=(ShardedReadMap const&) = delete;
+
+        bool Find(Key const& key, Value& value) const
+        {
+            EpochReclaimer::ReadGuard guard;
+            ShardMap const* map = GetShard(key).map.load();
+            auto itr = map->find(key);
+            if (itr == map->end())
+                return false;
+
+            value = itr->second;
+            return true;
+        }
+
+        void Insert(Key const& key, Value const& value)
+        {
+            Shard& shard = GetShard(key);
+            std::lock_guard<std::mutex> guard(shard.writeLock);
+            ShardMap* map = new ShardMap(*shard.map.load());
+            (*map)[key] = value;
+            Publish(shard, map);
+        }
+
+        void Erase(Key const& key)
+        {
+            Shard& shard = GetShard(key);
+            std::lock_guard<std::mutex> guard(shard.writeLock);
+            ShardMap const* current = shard.map.load();
+            if (current->find(key) == current->end())
+                return;
+
+            ShardMap* map = new ShardMap(*current);
+            map->erase(key);
+            Publish(shard, map);
+        }
+
+        size_t Size() const
+        {
+            EpochReclaimer::ReadGuard guard;
+            size_t size = 0;
+            for (auto const& shard : m_shards)
+                size += shard.map.load()->size();
+            return size;
+        }
+
+    private:
+        struct alignas(64) Shard
+        {
+            std::mutex writeLock;
+            std::atomic<ShardMap const*> map;
+        };
+
+        Shard& GetShard(Key const& key) { return m_shards[Hash()(key) % SHARD_COUNT]; }
+        Shard const& GetShard(Key const& key) const { return m_shards[Hash()(key) % SHARD_COUNT]; }
+
+        static void Publish(Shard& shard, ShardMap const* map)
+        {
+            ShardMap const* previous = shard.map.exchange(map);
+            sEpochReclaimer.Retire([previous]() { delete previous; });
+        }
+
+        Shard m_shards[SHARD_COUNT];
+};
+
+#endif
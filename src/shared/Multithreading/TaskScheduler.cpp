@@ -0,0 +1,323 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "TaskScheduler.h"
+#include "Policies/SingletonImp.h"
+#include "Log.h"
+#include <mysql.h>
+
+#include <chrono>
+#include <iterator>
+
+INSTANTIATE_SINGLETON_1(TaskScheduler);
+
+// Index of the queue owned by the current thread, -1 for threads outside of the scheduler
+static thread_local int32 t_workerIndex = -1;
+
+char const* GetTaskPhaseName(TaskPhase phase)
+{
+    switch (phase)
+    {
+        case TASK_PHASE_GENERIC:        return "Generic";
+        case TASK_PHASE_MAP_UPDATE:     return "MapUpdate";
+        case TASK_PHASE_CELLS:          return "Cells";
+        case TASK_PHASE_MOTION:         return "Motion";
+        case TASK_PHASE_OBJECT_UPDATES: return "ObjectUpdates";
+        case TASK_PHASE_VISIBILITY:     return "Visibility";
+        case TASK_PHASE_ANTICHEAT:      return "Anticheat";
+        default:                        return "Unknown";
+    }
+}
+
+TaskGroup::~TaskGroup()
+{
+    // Tasks reference the group, never let it go out of scope while they run
+    while (!IsDone())
+    {
+        try
+        {
+            Wait();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    // The last task may still be inside OnTaskDone
+    std::lock_guard<std::mutex> lock(m_doneLock);
+}
+
+void TaskGroup::Run(std::function<void()> task)
+{
+    if (!sTaskScheduler.IsRunning())
+    {
+        task();
+        return;
+    }
+
+    ++m_pending;
+    sTaskScheduler.Submit(this, std::move(task));
+}
+
+void TaskGroup::Wait()
+{
+    // A thread waiting on an inner phase must not start whole map updates,
+    // it would delay its own map by the duration of another one.
+    bool const allowMapUpdates = m_phase == TASK_PHASE_MAP_UPDATE || m_phase == TASK_PHASE_GENERIC;
+
+    while (!IsDone())
+    {
+        if (sTaskScheduler.TryExecuteOne(allowMapUpdates))
+            continue;
+
+        // Nothing to steal: remaining tasks are running on other threads
+        std::unique_lock<std::mutex> lock(m_doneLock);
+        m_done.wait_for(lock, std::chrono::microseconds(500), [this]() { return IsDone(); });
+    }
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(m_doneLock);
+        std::swap(error, m_error);
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void TaskGroup::OnTaskDone(std::exception_ptr error)
+{
+    std::lock_guard<std::mutex> lock(m_doneLock);
+    if (error && !m_error)
+        m_error = error;
+    if (--m_pending == 0)
+        m_done.notify_all();
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    Stop();
+}
+
+void TaskScheduler::Start(uint32 numThreads)
+{
+    if (IsRunning())
+        return;
+
+    if (!numThreads)
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    m_stopping = false;
+    m_queues.reserve(numThreads);
+    for (uint32 i = 0; i < numThreads; ++i)
+        m_queues.emplace_back(new WorkerQueue());
+
+    m_workers.reserve(numThreads);
+    for (uint32 i = 0; i < numThreads; ++i)
+        m_workers.emplace_back(&TaskScheduler::WorkerLoop, this, i);
+
+    sLog.Out(LOG_BASIC, LOG_LVL_MINIMAL, "TaskScheduler: started %u worker threads", numThreads);
+}
+
+void TaskScheduler::Stop()
+{
+    if (!IsRunning())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_sleepLock);
+        m_stopping = true;
+    }
+    m_wakeUp.notify_all();
+
+    for (auto& worker : m_workers)
+        worker.join();
+
+    m_workers.clear();
+    m_queues.clear();
+}
+
+TaskScheduler::PhaseStats TaskScheduler::GetStats(TaskPhase phase) const
+{
+    PhaseStats stats;
+    AtomicPhaseStats const& s = m_stats[phase];
+    stats.submitted = s.submitted.load();
+    stats.executed = s.executed.load();
+    stats.stolen = s.stolen.load();
+    stats.helped = s.helped.load();
+    stats.queued = std::max<int64>(0, s.queued.load());
+    stats.peakQueued = std::max<int64>(0, s.peakQueued.load());
+    return stats;
+}
+
+void TaskScheduler::ResetStats()
+{
+    for (auto& s : m_stats)
+    {
+        s.submitted = 0;
+        s.executed = 0;
+        s.stolen = 0;
+        s.helped = 0;
+        s.peakQueued = s.queued.load();
+    }
+}
+
+void TaskScheduler::Submit(TaskGroup* group, std::function<void()>&& function)
+{
+    AtomicPhaseStats& stats = m_stats[group->GetPhase()];
+    ++stats.submitted;
+    int64 depth = ++stats.queued;
+    int64 peak = stats.peakQueued.load();
+    while (depth > peak && !stats.peakQueued.compare_exchange_weak(peak, depth));
+
+    // Workers keep their own subtasks local, other threads spread the load
+    uint32 index = t_workerIndex >= 0 ? uint32(t_workerIndex) : (m_nextQueue++ % m_queues.size());
+    {
+        WorkerQueue& queue = *m_queues[index];
+        std::lock_guard<std::mutex> lock(queue.lock);
+        queue.tasks.push_back({ std::move(function), group });
+    }
+
+    ++m_queuedTotal;
+    m_wakeUp.notify_one();
+}
+
+bool TaskScheduler::PopOwn(uint32 index, Task& task, bool allowMapUpdates)
+{
+    WorkerQueue& queue = *m_queues[index];
+    std::lock_guard<std::mutex> lock(queue.lock);
+    if (queue.tasks.empty())
+        return false;
+
+    if (allowMapUpdates)
+    {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    // Inner phase tasks can be queued under map updates, the newest one is taken
+    for (auto itr = queue.tasks.rbegin(); itr != queue.tasks.rend(); ++itr)
+    {
+        if (itr->group->GetPhase() == TASK_PHASE_MAP_UPDATE)
+            continue;
+
+        task = std::move(*itr);
+        queue.tasks.erase(std::next(itr).base());
+        return true;
+    }
+    return false;
+}
+
+bool TaskScheduler::Steal(uint32 thief, Task& task, bool allowMapUpdates)
+{
+    uint32 const count = m_queues.size();
+    for (uint32 i = 1; i <= count; ++i)
+    {
+        uint32 victim = (thief + i) % count;
+        WorkerQueue& queue = *m_queues[victim];
+        std::lock_guard<std::mutex> lock(queue.lock);
+        if (queue.tasks.empty())
+            continue;
+
+        if (allowMapUpdates)
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+
+        // The oldest task that is not a map update
+        for (auto itr = queue.tasks.begin(); itr != queue.tasks.end(); ++itr)
+        {
+            if (itr->group->GetPhase() == TASK_PHASE_MAP_UPDATE)
+                continue;
+
+            task = std::move(*itr);
+            queue.tasks.erase(itr);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TaskScheduler::TryExecuteOne(bool allowMapUpdates)
+{
+    if (!IsRunning() || m_queuedTotal.load() <= 0)
+        return false;
+
+    Task task;
+    if (t_workerIndex >= 0)
+    {
+        uint32 index = uint32(t_workerIndex);
+        if (!PopOwn(index, task, allowMapUpdates) && !Steal(index, task, allowMapUpdates))
+            return false;
+    }
+    else if (!Steal(m_nextQueue.load() % m_queues.size(), task, allowMapUpdates))
+        return false;
+
+    ++m_stats[task.group->GetPhase()].helped;
+    Execute(task);
+    return true;
+}
+
+void TaskScheduler::Execute(Task& task)
+{
+    --m_queuedTotal;
+    AtomicPhaseStats& stats = m_stats[task.group->GetPhase()];
+    --stats.queued;
+
+    std::exception_ptr error;
+    try
+    {
+        task.function();
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+
+    ++stats.executed;
+    task.group->OnTaskDone(error);
+}
+
+void TaskScheduler::WorkerLoop(uint32 index)
+{
+    t_workerIndex = int32(index);
+    mysql_thread_init();
+
+    while (!m_stopping)
+    {
+        Task task;
+        if (PopOwn(index, task, true))
+        {
+            Execute(task);
+            continue;
+        }
+
+        if (Steal(index, task, true))
+        {
+            ++m_stats[task.group->GetPhase()].stolen;
+            Execute(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepLock);
+        m_wakeUp.wait_for(lock, std::chrono::milliseconds(1), [this]() { return m_stopping || m_queuedTotal.load() > 0; });
+    }
+
+    mysql_thread_end();
+    t_workerIndex = -1;
+}
@@ -0,0 +1,167 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_TASKSCHEDULER_H
+#define MANGOS_TASKSCHEDULER_H
+
+#include "Platform/Define.h"
+#include "Policies/Singleton.h"
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <exception>
+
+// Used to attribute queue depth and steal statistics to a part of the map update.
+enum TaskPhase : uint8
+{
+    TASK_PHASE_GENERIC          = 0,
+    TASK_PHASE_MAP_UPDATE       = 1,                        // MapManager: whole map (continent or instance) updates
+    TASK_PHASE_CELLS            = 2,                        // Map::UpdateActiveCellsAsynch
+    TASK_PHASE_MOTION           = 3,                        // MotionMaster::UpdateMotionAsync
+    TASK_PHASE_OBJECT_UPDATES   = 4,                        // Map::SendObjectUpdates
+    TASK_PHASE_VISIBILITY       = 5,                        // Map::UpdateVisibilityForRelocations
+    TASK_PHASE_ANTICHEAT        = 6,                        // MovementCheckBatch::Process
+    MAX_TASK_PHASE
+};
+
+char const* GetTaskPhaseName(TaskPhase phase);
+
+/**
+ * @brief A set of tasks submitted to the scheduler that can be waited on together.
+ * Waiting does not block: the calling thread executes queued tasks until the
+ * whole group has completed. Exceptions thrown by tasks are rethrown by Wait().
+ */
+class TaskGroup
+{
+    public:
+        explicit TaskGroup(TaskPhase phase = TASK_PHASE_GENERIC) : m_phase(phase) {}
+        ~TaskGroup();
+
+        TaskGroup(TaskGroup const&) = delete;
+        TaskGroup& operator=(TaskGroup const&) = delete;
+
+        /**
+         * @brief Run queues a task. Executed inline when the scheduler has no worker.
+         */
+        void Run(std::function<void()> task);
+
+        /**
+         * @brief Wait executes pending tasks from the scheduler until every task of the group is done.
+         */
+        void Wait();
+
+        bool IsDone() const { return m_pending.load() == 0; }
+        TaskPhase GetPhase() const { return m_phase; }
+
+    private:
+        friend class TaskScheduler;
+
+        void OnTaskDone(std::exception_ptr error);
+
+        TaskPhase m_phase;
+        std::atomic<uint32> m_pending{0};
+        std::mutex m_doneLock;
+        std::condition_variable m_done;
+        std::exception_ptr m_error;
+};
+
+/**
+ * @brief Process-wide work-stealing scheduler shared by all map update phases.
+ * Each worker owns a deque: it pushes and pops tasks at the back, idle workers
+ * and waiting threads steal from the front of the other deques.
+ */
+class TaskScheduler
+{
+    public:
+        struct PhaseStats
+        {
+            uint64 submitted = 0;
+            uint64 executed = 0;
+            uint64 stolen = 0;                              // executed by a worker that did not own the queue
+            uint64 helped = 0;                              // executed by a thread waiting on a TaskGroup
+            uint64 queued = 0;                              // current queue depth
+            uint64 peakQueued = 0;
+        };
+
+        TaskScheduler() = default;
+        ~TaskScheduler();
+
+        /**
+         * @brief Start spawns the workers. 0 uses the number of hardware threads.
+         */
+        void Start(uint32 numThreads);
+        void Stop();
+
+        bool IsRunning() const { return !m_workers.empty(); }
+        uint32 GetWorkerCount() const { return m_workers.size(); }
+
+        /**
+         * @brief GetStats returns counters accumulated since start (or last ResetStats).
+         */
+        PhaseStats GetStats(TaskPhase phase) const;
+        void ResetStats();
+
+    private:
+        friend class TaskGroup;
+
+        struct Task
+        {
+            std::function<void()> function;
+            TaskGroup* group;
+        };
+
+        struct WorkerQueue
+        {
+            std::mutex lock;
+            std::deque<Task> tasks;
+        };
+
+        struct AtomicPhaseStats
+        {
+            std::atomic<uint64> submitted{0};
+            std::atomic<uint64> executed{0};
+            std::atomic<uint64> stolen{0};
+            std::atomic<uint64> helped{0};
+            std::atomic<int64> queued{0};
+            std::atomic<int64> peakQueued{0};
+        };
+
+        void Submit(TaskGroup* group, std::function<void()>&& function);
+        bool PopOwn(uint32 index, Task& task, bool allowMapUpdates);
+        bool Steal(uint32 thief, Task& task, bool allowMapUpdates);
+        bool TryExecuteOne(bool allowMapUpdates);
+        void Execute(Task& task);
+        void WorkerLoop(uint32 index);
+
+        std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+        std::vector<std::thread> m_workers;
+        std::atomic<bool> m_stopping{false};
+        std::atomic<uint32> m_nextQueue{0};
+        std::atomic<int64> m_queuedTotal{0};
+        std::mutex m_sleepLock;
+        std::condition_variable m_wakeUp;
+        AtomicPhaseStats m_stats[MAX_TASK_PHASE];
+};
+
+#define sTaskScheduler MaNGOS::Singleton<TaskScheduler>::Instance()
+
+#endif
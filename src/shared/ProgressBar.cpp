@@ -127,3 +127,8 @@ void BarGoLink::SetOutputState(bool on)
 {
     m_showOutput = on;
 }
+
+bool BarGoLink::GetOutputState()
+{
+    return m_showOutput;
+}
@@ -42,6 +42,7 @@ class BarGoLink
         void step();
 
         static void SetOutputState(bool on);
+        static bool GetOutputState();
     private:
         void init(int row_count);
 
@@ -24,6 +24,7 @@
 
 #include "Common.h"
 #include "ByteBuffer.h"
+#include <memory>
 
 // Note: m_opcode and size stored in platfom dependent format
 // ignore endianess until send, and converted at receive
@@ -69,4 +70,7 @@ class WorldPacket : public ByteBuffer
         uint16 m_opcode;
         uint32 m_recvdTime;
 };
+
+// Immutable packet sent as is to several sockets
+typedef std::shared_ptr<WorldPacket const> SharedWorldPacket;
 #endif